@@ -30,8 +30,10 @@
 #include "openpilot.h"
 #include "modulesettings.h"
 #include "pios_thread.h"
+#include "pios_queue.h"
 #include "timeutils.h"
 #include "uavobjectmanager.h"
+#include "logging_priv.h"
 
 #include "pios_streamfs.h"
 #include <pios_board_info.h>
@@ -59,6 +61,12 @@
 // Private constants
 #define STACK_SIZE_BYTES 1200
 #define TASK_PRIORITY PIOS_THREAD_PRIO_LOW
+// Only requests from the GCS are queued, the logged objects are polled
+#define MAX_QUEUE_SIZE 2
+// The logged objects are polled every tick, faster than the sensors update
+#define POLL_PERIOD_MS 1
+#define STATUS_PERIOD_MS 100
+#define CRC_CHUNK_SIZE 32
 const char DIGITS[16] = "0123456789abcdef";
 
 // Private types
@@ -66,19 +74,47 @@ const char DIGITS[16] = "0123456789abcdef";
 // Private variables
 static UAVTalkConnection uavTalkCon;
 static struct pios_thread *loggingTaskHandle;
+static struct pios_queue *queue;
 static bool module_enabled;
 static LoggingSettingsData settings;
-static bool flightstatus_updated = false;
-static bool waypoint_updated = false;
+
+// Objects logged on update, in the order of LoggingSettings.LogPeriod
+static UAVObjHandle (* const loggedHandles[LOGGINGSETTINGS_LOGPERIOD_NUMELEM])() = {
+	[LOGGINGSETTINGS_LOGPERIOD_ACCELS] = AccelsHandle,
+	[LOGGINGSETTINGS_LOGPERIOD_GYROS] = GyrosHandle,
+	[LOGGINGSETTINGS_LOGPERIOD_ATTITUDEACTUAL] = AttitudeActualHandle,
+	[LOGGINGSETTINGS_LOGPERIOD_MAGNETOMETER] = MagnetometerHandle,
+	[LOGGINGSETTINGS_LOGPERIOD_MANUALCONTROLCOMMAND] = ManualControlCommandHandle,
+	[LOGGINGSETTINGS_LOGPERIOD_ACTUATORCOMMAND] = ActuatorCommandHandle,
+	[LOGGINGSETTINGS_LOGPERIOD_BAROALTITUDE] = BaroAltitudeHandle,
+	[LOGGINGSETTINGS_LOGPERIOD_AIRSPEEDACTUAL] = AirspeedActualHandle,
+	[LOGGINGSETTINGS_LOGPERIOD_GPSPOSITION] = GPSPositionHandle,
+	[LOGGINGSETTINGS_LOGPERIOD_POSITIONACTUAL] = PositionActualHandle,
+	[LOGGINGSETTINGS_LOGPERIOD_VELOCITYACTUAL] = VelocityActualHandle,
+	[LOGGINGSETTINGS_LOGPERIOD_GPSTIME] = GPSTimeHandle,
+	[LOGGINGSETTINGS_LOGPERIOD_GPSSATELLITES] = GPSSatellitesHandle,
+	[LOGGINGSETTINGS_LOGPERIOD_FLIGHTSTATUS] = FlightStatusHandle,
+	[LOGGINGSETTINGS_LOGPERIOD_WAYPOINTACTIVE] = WaypointActiveHandle,
+	[LOGGINGSETTINGS_LOGPERIOD_WAYPOINT] = WaypointHandle,
+};
+static UAVObjHandle loggedObjects[LOGGINGSETTINGS_LOGPERIOD_NUMELEM];
+static struct logging_rate loggedRates[LOGGINGSETTINGS_LOGPERIOD_NUMELEM];
+static uint32_t lastStamp;
 
 // Private functions
 static void    loggingTask(void *parameters);
 static int32_t send_data(uint8_t *data, int32_t length);
 static void logSettings(UAVObjHandle obj);
 static void SettingsUpdatedCb(UAVObjEvent * ev);
-static void FlightStatusUpdatedCb(UAVObjEvent * ev);
-static void WaypointActiveUpdatedCb(UAVObjEvent * ev);
 static void writeHeader();
+static void startDeltas();
+static void startLogging();
+static void logUpdates();
+static void logUpdate(int index, uint32_t time);
+static void logDue(uint32_t now);
+static void logObject(int index, uint32_t now, uint32_t time);
+static void logInstance(UAVObjHandle obj, uint16_t instId, uint32_t time);
+static uint32_t dataCRC(UAVObjHandle obj);
 
 // Local variables
 static uintptr_t logging_com_id;
@@ -121,6 +157,11 @@ int32_t LoggingInitialize(void)
 	// Initialise UAVTalk
 	uavTalkCon = UAVTalkInitialize(&send_data);
 
+	// Create the queue waking the task for requests
+	queue = PIOS_Queue_Create(MAX_QUEUE_SIZE, sizeof(UAVObjEvent));
+	if (queue == NULL)
+		return -1;
+
 	return 0;
 }
 
@@ -151,7 +192,6 @@ static void loggingTask(void *parameters)
 	bool armed = false;
 	bool write_open = false;
 	bool read_open = false;
-	bool first_run = true;
 	int32_t read_sector = 0;
 	uint8_t read_data[LOGGINGSTATS_FILESECTOR_NUMELEM];
 
@@ -161,10 +201,12 @@ static void loggingTask(void *parameters)
 	LoggingSettingsGet(&settings);
 	LoggingSettingsConnectCallback(SettingsUpdatedCb);
 
-	// Connect callbacks for UAVOs being logged on change
-	FlightStatusConnectCallback(FlightStatusUpdatedCb);
-	if (WaypointActiveHandle())
-		WaypointActiveConnectCallback(WaypointActiveUpdatedCb);
+	// Requests from the GCS are handled as soon as they arrive
+	UAVObjConnectQueue(LoggingStatsHandle(), queue, EV_UNPACKED);
+
+	// Look up the logged objects once, some of them are optional
+	for (int i = 0; i < LOGGINGSETTINGS_LOGPERIOD_NUMELEM; i++)
+		loggedObjects[i] = loggedHandles[i]();
 
 	LoggingStatsData loggingData;
 	LoggingStatsGet(&loggingData);
@@ -179,7 +221,7 @@ static void loggingTask(void *parameters)
 		} else {
 			loggingData.Operation = LOGGINGSTATS_OPERATION_LOGGING;
 			write_open = true;
-			first_run = true;
+			startLogging();
 		}
 	} else {
 		loggingData.Operation = LOGGINGSTATS_OPERATION_IDLE;
@@ -187,39 +229,41 @@ static void loggingTask(void *parameters)
 
 	LoggingStatsSet(&loggingData);
 
-	int i = 0;
+	uint32_t last_status = PIOS_Thread_Systime();
+
 	// Loop forever
 	while (1) {
-
-		// Sleep for some time depending on logging rate
-		switch(settings.MaxLogRate){
-			case LOGGINGSETTINGS_MAXLOGRATE_5:
-				PIOS_Thread_Sleep(200);
-				break;
-			case LOGGINGSETTINGS_MAXLOGRATE_10:
-				PIOS_Thread_Sleep(100);
-				break;
-			case LOGGINGSETTINGS_MAXLOGRATE_25:
-				PIOS_Thread_Sleep(40);
-				break;
-			case LOGGINGSETTINGS_MAXLOGRATE_50:
-				PIOS_Thread_Sleep(20);
-				break;
-			case LOGGINGSETTINGS_MAXLOGRATE_100:
-				PIOS_Thread_Sleep(10);
-				break;
-			default:
-				PIOS_Thread_Sleep(1000);
+		uint32_t now = PIOS_Thread_Systime();
+
+		// Wait for a request until the status must be checked, or until
+		// the next poll of the logged objects while logging
+		uint32_t elapsed = now - last_status;
+		int32_t timeout = (elapsed >= STATUS_PERIOD_MS) ? 0 : STATUS_PERIOD_MS - elapsed;
+		if (write_open && timeout > POLL_PERIOD_MS)
+			timeout = POLL_PERIOD_MS;
+
+		UAVObjEvent ev;
+		bool request = PIOS_Queue_Receive(queue, &ev, timeout);
+		now = PIOS_Thread_Systime();
+
+		if (write_open) {
+			logUpdates();
+			logDue(now);
 		}
 
+		// Check for requests and arming at a lower rate
+		if (!request && now - last_status < STATUS_PERIOD_MS)
+			continue;
+		last_status = now;
+
 		LoggingStatsGet(&loggingData);
 
 		// Check for change in armed state if logging on armed
 
-		if (settings.LogBehavior == LOGGINGSETTINGS_LOGBEHAVIOR_LOGONARM) {
-			FlightStatusData flightStatus;
-			FlightStatusGet(&flightStatus);
+		FlightStatusData flightStatus;
+		FlightStatusGet(&flightStatus);
 
+		if (settings.LogBehavior == LOGGINGSETTINGS_LOGBEHAVIOR_LOGONARM) {
 			if (flightStatus.Armed == FLIGHTSTATUS_ARMED_ARMED && !armed) {
 				// Start logging because just armed
 				loggingData.Operation = LOGGINGSTATS_OPERATION_LOGGING;
@@ -230,6 +274,13 @@ static void loggingTask(void *parameters)
 				armed = false;
 				LoggingStatsSet(&loggingData);
 			}
+		} else if (flightStatus.Armed != FLIGHTSTATUS_ARMED_DISARMED) {
+			armed = true;
+		} else if (armed) {
+			// The log goes on, but write out the flight in case the power is removed
+			if (write_open)
+				PIOS_STREAMFS_Flush(streamfs_id);
+			armed = false;
 		}
 
 
@@ -244,6 +295,7 @@ static void loggingTask(void *parameters)
 				loggingData.Operation = LOGGINGSTATS_OPERATION_ERROR;
 			} else {
 				write_open = true;
+				startLogging();
 			}
 			loggingData.MinFileId = PIOS_STREAMFS_MinFileId(streamfs_id);
 			loggingData.MaxFileId = PIOS_STREAMFS_MaxFileId(streamfs_id);
@@ -261,76 +313,6 @@ static void loggingTask(void *parameters)
 			if (!write_open)
 				continue;
 
-			if (first_run){
-				// Write information at start of the log file
-				writeHeader();
-
-				// Log settings
-				if (settings.LogSettingsOnStart == LOGGINGSETTINGS_LOGSETTINGSONSTART_TRUE){
-					UAVObjIterate(&logSettings);
-				}
-
-				// Log some data objects that are unlikely to change during flight
-				// Waypoints
-				if (WaypointHandle()){
-					for (int i = 0; i < UAVObjGetNumInstances(WaypointHandle()); i++) {
-						UAVTalkSendObjectTimestamped(uavTalkCon, WaypointHandle(), i, false, 0);
-					}
-				}
-
-				// Trigger logging for objects that are logged on change
-				flightstatus_updated = true;
-				waypoint_updated = true;
-
-				first_run = false;
-			}
-
-			// Log objects on change
-			if (flightstatus_updated){
-				UAVTalkSendObjectTimestamped(uavTalkCon, FlightStatusHandle(), 0, false, 0);
-				flightstatus_updated = false;
-			}
-
-			if (waypoint_updated && WaypointActiveHandle()){
-				UAVTalkSendObjectTimestamped(uavTalkCon, WaypointActiveHandle(), 0, false, 0);
-				waypoint_updated = false;
-			}
-
-			// Log very fast
-			UAVTalkSendObjectTimestamped(uavTalkCon, AccelsHandle(), 0, false, 0);
-			UAVTalkSendObjectTimestamped(uavTalkCon, GyrosHandle(), 0, false, 0);
-
-			// Log a bit slower
-			if ((i % 2) == 0) {
-				UAVTalkSendObjectTimestamped(uavTalkCon, AttitudeActualHandle(), 0, false, 0);
-				UAVTalkSendObjectTimestamped(uavTalkCon, MagnetometerHandle(), 0, false, 0);
-				UAVTalkSendObjectTimestamped(uavTalkCon, ManualControlCommandHandle(), 0, false, 0);
-				UAVTalkSendObjectTimestamped(uavTalkCon, ActuatorCommandHandle(), 0, false, 0);
-			}
-
-			// Log slower
-			if ((i % 10) == 1) {
-				UAVTalkSendObjectTimestamped(uavTalkCon, BaroAltitudeHandle(), 0, false, 0);
-				if (AirspeedActualHandle())
-					UAVTalkSendObjectTimestamped(uavTalkCon, AirspeedActualHandle(), 0, false, 0);
-				if (GPSPositionHandle())
-					UAVTalkSendObjectTimestamped(uavTalkCon, GPSPositionHandle(), 0, false, 0);
-				if (PositionActualHandle())
-					UAVTalkSendObjectTimestamped(uavTalkCon, PositionActualHandle(), 0, false, 0);
-				if (VelocityActualHandle())
-					UAVTalkSendObjectTimestamped(uavTalkCon, VelocityActualHandle(), 0, false, 0);
-			}
-
-			// Log slow
-			if ((i % 50) == 2 && GPSTimeHandle()) {
-				UAVTalkSendObjectTimestamped(uavTalkCon, GPSTimeHandle(), 0, false, 0);
-			}
-
-			// Log very slow
-			if ((i % 500) == 3 && GPSSatellitesHandle()) {
-				UAVTalkSendObjectTimestamped(uavTalkCon, GPSSatellitesHandle(), 0, false, 0);
-			}
-
 			LoggingStatsBytesLoggedSet(&written_bytes);
 
 			break;
@@ -383,9 +365,154 @@ static void loggingTask(void *parameters)
 			LoggingStatsSet(&loggingData);
 
 		}
+	}
+}
+
+/**
+ * Start a new log file with the header, the settings and the current
+ * data of the logged objects, the updates after it are logged as they
+ * are polled
+ */
+static void startLogging()
+{
+	startDeltas();
+
+	// Write information at start of the log file
+	writeHeader();
+
+	// Log settings
+	if (settings.LogSettingsOnStart == LOGGINGSETTINGS_LOGSETTINGSONSTART_TRUE){
+		UAVObjIterate(&logSettings);
+	}
+
+	// The current data is stamped with the start of the log
+	uint32_t now = PIOS_Thread_Systime();
+	lastStamp = now;
+
+	for (int i = 0; i < LOGGINGSETTINGS_LOGPERIOD_NUMELEM; i++) {
+		UAVObjHandle obj = loggedObjects[i];
+		struct logging_rate *rate = &loggedRates[i];
+
+		if (obj == NULL) {
+			logging_rate_reset(rate, LOGGING_PERIOD_DISABLED);
+			continue;
+		}
+
+		logging_rate_reset(rate, settings.LogPeriod[i]);
+		if (rate->period == LOGGING_PERIOD_DISABLED)
+			continue;
+
+		uint32_t seq;
+		UAVObjGetUpdateTime(obj, &seq);
+		logging_rate_poll(rate, seq);
+
+		if (UAVObjIsSingleInstance(obj)) {
+			logObject(i, now, now);
+		} else {
+			for (int j = 0; j < UAVObjGetNumInstances(obj); j++)
+				logInstance(obj, j, now);
+		}
+	}
+}
+
+/**
+ * Log the objects updated since the last call, with the time they were
+ * updated. This only reads the update sequence of the objects, which the
+ * object manager keeps anyway, so no event is queued per sensor update.
+ */
+static void logUpdates()
+{
+	for (int i = 0; i < LOGGINGSETTINGS_LOGPERIOD_NUMELEM; i++) {
+		if (loggedRates[i].period == LOGGING_PERIOD_DISABLED)
+			continue;
+
+		uint32_t seq;
+		uint32_t time = UAVObjGetUpdateTime(loggedObjects[i], &seq);
+		if (logging_rate_poll(&loggedRates[i], seq) > 0)
+			logUpdate(i, time);
+	}
+}
+
+/**
+ * Log an update of an object unless it is held back by the rate limit
+ * \param[in] index Index of the object in LoggingSettings.LogPeriod
+ * \param[in] time Time of the update (ms)
+ */
+static void logUpdate(int index, uint32_t time)
+{
+	UAVObjHandle obj = loggedObjects[index];
+
+	// The updated instance is not known, all instances of multi instance
+	// objects are logged
+	if (!UAVObjIsSingleInstance(obj)) {
+		for (int j = 0; j < UAVObjGetNumInstances(obj); j++)
+			logInstance(obj, j, time);
+	} else if (logging_rate_update(&loggedRates[index], time)) {
+		logObject(index, time, time);
+	}
+}
+
+/**
+ * Log the held back updates which are due
+ * \param[in] now Current time (ms)
+ */
+static void logDue(uint32_t now)
+{
+	for (int i = 0; i < LOGGINGSETTINGS_LOGPERIOD_NUMELEM; i++) {
+		if (logging_rate_due(&loggedRates[i], now) == 0)
+			logObject(i, now, loggedRates[i].pending_time);
+	}
+}
+
+/**
+ * Log the current data of a single instance object if it changed
+ * \param[in] index Index of the object in LoggingSettings.LogPeriod
+ * \param[in] now Current time (ms)
+ * \param[in] time Time of the update (ms)
+ */
+static void logObject(int index, uint32_t now, uint32_t time)
+{
+	UAVObjHandle obj = loggedObjects[index];
+
+	if (logging_rate_log(&loggedRates[index], now, dataCRC(obj)))
+		logInstance(obj, 0, time);
+}
 
-		i++;
+/**
+ * Log an instance of an object stamped with the time it was updated. The
+ * timestamps of the log never go back, an update polled after a later one,
+ * such as a held back update, gets the timestamp of the later one.
+ * \param[in] obj The object
+ * \param[in] instId The instance
+ * \param[in] time Time of the update (ms)
+ */
+static void logInstance(UAVObjHandle obj, uint16_t instId, uint32_t time)
+{
+	if ((int32_t) (time - lastStamp) < 0)
+		time = lastStamp;
+	lastStamp = time;
+
+	UAVTalkSendObjectAtTime(uavTalkCon, obj, instId, time);
+}
+
+/**
+ * Compute the CRC of the data of a single instance object
+ * \param[in] obj The object
+ * \return The CRC
+ */
+static uint32_t dataCRC(UAVObjHandle obj)
+{
+	uint8_t chunk[CRC_CHUNK_SIZE];
+	uint32_t numBytes = UAVObjGetNumBytes(obj);
+	uint32_t crc = 0;
+
+	for (uint32_t offset = 0; offset < numBytes; offset += CRC_CHUNK_SIZE) {
+		uint32_t size = (numBytes - offset < CRC_CHUNK_SIZE) ? numBytes - offset : CRC_CHUNK_SIZE;
+		UAVObjGetInstanceDataField(obj, 0, chunk, offset, size);
+		crc = PIOS_CRC32_updateCRC(crc, chunk, size);
 	}
+
+	return crc;
 }
 
 
@@ -400,6 +527,15 @@ static void logSettings(UAVObjHandle obj)
 	}
 }
 
+/**
+ * Every log file starts over from full updates, after that the objects
+ * which allow it are logged as deltas if enabled in the settings
+ */
+static void startDeltas()
+{
+	UAVTalkSetDeltaEncoding(uavTalkCon, settings.DeltaEncoding == LOGGINGSETTINGS_DELTAENCODING_ENABLED);
+}
+
 /**
  * Write log file header
  * see firmwareinfotemplate.c
@@ -458,22 +594,6 @@ static void SettingsUpdatedCb(UAVObjEvent * ev)
 }
 
 
-/**
- * Callback triggered when FlightStatus is updated
- */
-static void FlightStatusUpdatedCb(UAVObjEvent * ev)
-{
-	flightstatus_updated = true;
-}
-
-/**
- * Callback triggered when WaypointActive is updated
- */
-static void WaypointActiveUpdatedCb(UAVObjEvent * ev)
-{
-	waypoint_updated = true;
-}
-
 /**
  * Forward data from UAVTalk out the serial port
  * \param[in] data Data buffer to send
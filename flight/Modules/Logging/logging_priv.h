@@ -0,0 +1,66 @@
+/**
+ ******************************************************************************
+ * @addtogroup TauLabsModules Tau Labs Modules
+ * @{
+ * @addtogroup Logging Logging Module
+ * @{
+ *
+ * @file       logging_priv.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @brief      Rate limiting of the objects logged on update
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef LOGGING_PRIV_H
+#define LOGGING_PRIV_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//! Period of LoggingSettings.LogPeriod which disables logging an object
+#define LOGGING_PERIOD_DISABLED 0xFFFF
+
+/**
+ * Logging state of an object. Every update is logged unless it comes less
+ * than a period after the last logged one, the latest of the held back
+ * updates is then logged at the end of the period. Updates which don't
+ * change the data are never logged.
+ */
+struct logging_rate {
+	uint32_t last_time;	/**< Time the object was logged last (ms) */
+	uint32_t last_crc;	/**< CRC of the data logged last */
+	uint16_t period;	/**< Minimum time between logged updates (ms), 0 to log all */
+	bool logged;		/**< The object was logged since the rate was reset */
+	uint32_t pending_time;	/**< Time of the held back update (ms) */
+	uint32_t seq;		/**< Update sequence of the object when the logging task last looked */
+	bool pending;		/**< An update is held back until the end of the period */
+};
+
+void logging_rate_reset(struct logging_rate *rate, uint16_t period);
+bool logging_rate_update(struct logging_rate *rate, uint32_t now);
+int32_t logging_rate_due(const struct logging_rate *rate, uint32_t now);
+bool logging_rate_log(struct logging_rate *rate, uint32_t now, uint32_t crc);
+uint32_t logging_rate_poll(struct logging_rate *rate, uint32_t seq);
+
+#endif /* LOGGING_PRIV_H */
+
+/**
+ * @}
+ * @}
+ */
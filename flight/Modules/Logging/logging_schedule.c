@@ -0,0 +1,120 @@
+/**
+ ******************************************************************************
+ * @addtogroup TauLabsModules Tau Labs Modules
+ * @{
+ * @addtogroup Logging Logging Module
+ * @{
+ *
+ * @file       logging_schedule.c
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @brief      Rate limiting of the objects logged on update
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "logging_priv.h"
+
+/**
+ * Start over, the next update is logged in any case
+ * \param[in] rate The logging state of the object
+ * \param[in] period Minimum time between logged updates (ms), 0 to log all
+ */
+void logging_rate_reset(struct logging_rate *rate, uint16_t period)
+{
+	rate->last_time = 0;
+	rate->last_crc = 0;
+	rate->period = period;
+	rate->logged = false;
+	rate->pending = false;
+	rate->pending_time = 0;
+	rate->seq = 0;
+}
+
+/**
+ * Handle an update of the object
+ * \param[in] rate The logging state of the object
+ * \param[in] now Time of the update (ms)
+ * \return true if the update should be logged now, false if it is held back
+ */
+bool logging_rate_update(struct logging_rate *rate, uint32_t now)
+{
+	if (!rate->logged || rate->period == 0 || now - rate->last_time >= rate->period) {
+		rate->pending = false;
+		return true;
+	}
+
+	rate->pending = true;
+	rate->pending_time = now;
+	return false;
+}
+
+/**
+ * Get the time until a held back update is due
+ * \param[in] rate The logging state of the object
+ * \param[in] now Current time (ms)
+ * \return -1 if no update is held back
+ * \return the time until it should be logged (ms), 0 if it is due
+ */
+int32_t logging_rate_due(const struct logging_rate *rate, uint32_t now)
+{
+	if (!rate->pending)
+		return -1;
+
+	uint32_t elapsed = now - rate->last_time;
+	return (elapsed >= rate->period) ? 0 : (int32_t) (rate->period - elapsed);
+}
+
+/**
+ * Check the data of an update about to be logged
+ * \param[in] rate The logging state of the object
+ * \param[in] now Time the update is logged at (ms), the next period starts then
+ * \param[in] crc CRC of the object data
+ * \return true if the data changed and must be logged, false if it is the same as logged last
+ */
+bool logging_rate_log(struct logging_rate *rate, uint32_t now, uint32_t crc)
+{
+	rate->pending = false;
+
+	if (rate->logged && crc == rate->last_crc)
+		return false;
+
+	rate->last_time = now;
+	rate->last_crc = crc;
+	rate->logged = true;
+	return true;
+}
+
+/**
+ * Check the update sequence of the object, see UAVObjGetUpdateTime()
+ * \param[in] rate The logging state of the object
+ * \param[in] seq Current update sequence of the object
+ * \return the number of updates since the last call, more than one if
+ * the logging task missed some of them
+ */
+uint32_t logging_rate_poll(struct logging_rate *rate, uint32_t seq)
+{
+	uint32_t updates = (seq - rate->seq) / 2;
+
+	rate->seq = seq;
+	return updates;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -227,6 +227,15 @@ static void systemTask(void *parameters)
 		FlightStatusData flightStatus;
 		FlightStatusGet(&flightStatus);
 
+#if defined(PIOS_INCLUDE_LOGFS_SETTINGS)
+		// Erase flash for the next settings saves while it can't disturb flying,
+		// this only stalls once the settings log is half full
+		if (flightStatus.Armed == FLIGHTSTATUS_ARMED_DISARMED) {
+			extern uintptr_t pios_uavo_settings_fs_id;
+			PIOS_FLASHFS_Idle(pios_uavo_settings_fs_id);
+		}
+#endif
+
 		UAVObjEvent ev;
 		int delayTime = flightStatus.Armed == FLIGHTSTATUS_ARMED_ARMED ?
 			SYSTEM_UPDATE_PERIOD_MS / (LED_BLINK_RATE_HZ * 2) :
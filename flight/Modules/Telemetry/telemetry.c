@@ -64,10 +64,10 @@ static void telemetryTxPriTask(void *parameters);
 static struct pios_thread *telemetryTxTaskHandle;
 static struct pios_thread *telemetryRxTaskHandle;
 static uint32_t txErrors;
-static uint32_t txRetries;
 static uint32_t timeOfLastObjectUpdate;
 static UAVTalkConnection uavTalkCon;
 static bool pausePeriodicUpdates;
+static bool deltaEncoding;
 static uint32_t pausePeriodicUpdatesTime;
 // Private functions
 static void telemetryTxTask(void *parameters);
@@ -140,7 +140,6 @@ int32_t TelemetryInitialize(void)
     
 	// Create periodic event that will be used to update the telemetry stats
 	txErrors = 0;
-	txRetries = 0;
 	UAVObjEvent ev;
 	memset(&ev, 0, sizeof(UAVObjEvent));
 	EventPeriodicQueueCreate(&ev, priorityQueue, STATS_UPDATE_PERIOD_MS);
@@ -269,7 +268,6 @@ static void processObjEvent(UAVObjEvent * ev)
 	UAVObjMetadata metadata;
 	UAVObjUpdateMode updateMode;
 	FlightTelemetryStatsData flightStats;
-	int32_t retries;
 	int32_t success;
 
 	if (ev->obj == 0) {
@@ -283,34 +281,25 @@ static void processObjEvent(UAVObjEvent * ev)
 		updateMode = UAVObjGetTelemetryUpdateMode(&metadata);
 
 		// Act on event
-		retries = 0;
 		success = -1;
 		if (ev->event == EV_UPDATED || ev->event == EV_UPDATED_MANUAL || ((ev->event == EV_UPDATED_PERIODIC) && (updateMode != UPDATEMODE_THROTTLED))) {
 			// Send update to GCS (with retries)
 			if (pausePeriodicUpdates) {
 				check_pause_periodic_updates_timeout();
 			}
-			while (retries < MAX_RETRIES && success == -1) {
-				if((ev->obj !=FlightTelemetryStatsHandle()) && (ev->event == EV_UPDATED_PERIODIC) && pausePeriodicUpdates) {
-					success = 0;
-				} else {
-					success = UAVTalkSendObject(uavTalkCon, ev->obj, ev->instId, UAVObjGetTelemetryAcked(&metadata), REQ_TIMEOUT_MS);	// call blocks until ack is received or timeout
-				}
-				++retries;
+			if((ev->obj !=FlightTelemetryStatsHandle()) && (ev->event == EV_UPDATED_PERIODIC) && pausePeriodicUpdates) {
+				success = 0;
+			} else {
+				success = UAVTalkSendObjectWindowed(uavTalkCon, ev->obj, ev->instId, UAVObjGetTelemetryAcked(&metadata), REQ_TIMEOUT_MS, MAX_RETRIES - 1);	// only blocks while the ack window is full
 			}
-			// Update stats
-			txRetries += (retries - 1);
+			// Update stats, retries and missing acks are counted by UAVTalk
 			if (success == -1) {
 				++txErrors;
 			}
 		} else if (ev->event == EV_UPDATE_REQ) {
 			// Request object update from GCS (with retries)
-			while (retries < MAX_RETRIES && success == -1) {
-				success = UAVTalkSendObjectRequest(uavTalkCon, ev->obj, ev->instId, REQ_TIMEOUT_MS);	// call blocks until update is received or timeout
-				++retries;
-			}
+			success = UAVTalkSendObjectRequestWindowed(uavTalkCon, ev->obj, ev->instId, REQ_TIMEOUT_MS, MAX_RETRIES - 1);
 			// Update stats
-			txRetries += (retries - 1);
 			if (success == -1) {
 				++txErrors;
 			}
@@ -324,16 +313,12 @@ static void processObjEvent(UAVObjEvent * ev)
 				if (pausePeriodicUpdates) {
 					check_pause_periodic_updates_timeout();
 				}
-				while (retries < MAX_RETRIES && success == -1) {
-					if (pausePeriodicUpdates) {
-						success = 0;
-					} else {
-						success = UAVTalkSendObject(uavTalkCon, ev->obj, ev->instId, UAVObjGetTelemetryAcked(&metadata), REQ_TIMEOUT_MS);	// call blocks until ack is received or timeout
-					}
-					++retries;
+				if (pausePeriodicUpdates) {
+					success = 0;
+				} else {
+					success = UAVTalkSendObjectWindowed(uavTalkCon, ev->obj, ev->instId, UAVObjGetTelemetryAcked(&metadata), REQ_TIMEOUT_MS, MAX_RETRIES - 1);
 				}
 				// Update stats
-				txRetries += (retries - 1);
 				if (success == -1) {
 					++txErrors;
 				}
@@ -360,11 +345,21 @@ static void telemetryTxTask(void *parameters)
 
 	// Loop forever
 	while (1) {
-		// Wait for queue message
-		if (PIOS_Queue_Receive(queue, &ev, PIOS_QUEUE_TIMEOUT_MAX) == true) {
-			// Process event
-			processObjEvent(&ev);
+		// Resend unacked objects, and wake up in time for the next one
+		int32_t next = UAVTalkProcessPendingTransactions(uavTalkCon);
+
+		// Objects are batched as long as more events are waiting, send
+		// them before going to sleep
+		if (PIOS_Queue_Receive(queue, &ev, 0) == false) {
+			UAVTalkFlush(uavTalkCon);
+
+			// Wait for queue message
+			if (PIOS_Queue_Receive(queue, &ev, next < 0 ? PIOS_QUEUE_TIMEOUT_MAX : next) == false)
+				continue;
 		}
+
+		// Process event
+		processObjEvent(&ev);
 	}
 }
 
@@ -378,11 +373,18 @@ static void telemetryTxPriTask(void *parameters)
 
 	// Loop forever
 	while (1) {
-		// Wait for queue message
-		if (PIOS_Queue_Receive(priorityQueue, &ev, PIOS_QUEUE_TIMEOUT_MAX) == true) {
-			// Process event
-			processObjEvent(&ev);
+		int32_t next = UAVTalkProcessPendingTransactions(uavTalkCon);
+
+		if (PIOS_Queue_Receive(priorityQueue, &ev, 0) == false) {
+			UAVTalkFlush(uavTalkCon);
+
+			// Wait for queue message
+			if (PIOS_Queue_Receive(priorityQueue, &ev, next < 0 ? PIOS_QUEUE_TIMEOUT_MAX : next) == false)
+				continue;
 		}
+
+		// Process event
+		processObjEvent(&ev);
 	}
 }
 #endif
@@ -490,10 +492,9 @@ static void updateTelemetryStats()
 		flightStats.RxDataRate = (float)utalkStats.rxBytes / ((float)STATS_UPDATE_PERIOD_MS / 1000.0f);
 		flightStats.TxDataRate = (float)utalkStats.txBytes / ((float)STATS_UPDATE_PERIOD_MS / 1000.0f);
 		flightStats.RxFailures += utalkStats.rxErrors;
-		flightStats.TxFailures += txErrors;
-		flightStats.TxRetries += txRetries;
+		flightStats.TxFailures += txErrors + utalkStats.txErrors;
+		flightStats.TxRetries += utalkStats.txRetries;
 		txErrors = 0;
-		txRetries = 0;
 	} else {
 		flightStats.RxDataRate = 0;
 		flightStats.TxDataRate = 0;
@@ -501,7 +502,6 @@ static void updateTelemetryStats()
 		flightStats.TxFailures = 0;
 		flightStats.TxRetries = 0;
 		txErrors = 0;
-		txRetries = 0;
 	}
 
 	// Check for connection timeout
@@ -539,6 +539,21 @@ static void updateTelemetryStats()
 		flightStats.Status = FLIGHTTELEMETRYSTATS_STATUS_DISCONNECTED;
 	}
 
+	// Batch objects into shared frames once the GCS told us it can parse them
+	flightStats.BatchedFrames = FLIGHTTELEMETRYSTATS_BATCHEDFRAMES_SUPPORTED;
+	UAVTalkSetBatching(uavTalkCon, flightStats.Status == FLIGHTTELEMETRYSTATS_STATUS_CONNECTED &&
+			gcsStats.BatchedFrames == GCSTELEMETRYSTATS_BATCHEDFRAMES_SUPPORTED);
+
+	// Send deltas once the GCS told us it can apply them, every connection
+	// starts over from full updates
+	flightStats.DeltaEncoding = FLIGHTTELEMETRYSTATS_DELTAENCODING_SUPPORTED;
+	bool delta = flightStats.Status == FLIGHTTELEMETRYSTATS_STATUS_CONNECTED &&
+			gcsStats.DeltaEncoding == GCSTELEMETRYSTATS_DELTAENCODING_SUPPORTED;
+	if (delta != deltaEncoding) {
+		UAVTalkSetDeltaEncoding(uavTalkCon, delta);
+		deltaEncoding = delta;
+	}
+
 	// Update the telemetry alarm
 	if (flightStats.Status == FLIGHTTELEMETRYSTATS_STATUS_CONNECTED) {
 		AlarmsClear(SYSTEMALARMS_ALARM_TELEMETRY);
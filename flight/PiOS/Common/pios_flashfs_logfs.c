@@ -32,6 +32,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>		/* NULL */
+#include <string.h>		/* memmove */
 
 #define MIN(x,y) ((x) < (y) ? (x) : (y))
 
@@ -43,6 +44,19 @@ enum pios_flashfs_logfs_dev_magic {
 	PIOS_FLASHFS_LOGFS_DEV_MAGIC = 0x94938201,
 };
 
+enum logfs_spare_state {
+	SPARE_STATE_UNKNOWN,	/* spare arena must be checked and probably erased */
+	SPARE_STATE_DIRTY,	/* spare arena must be erased before it is reserved */
+	SPARE_STATE_ERASED,	/* spare arena is ready to be reserved */
+	SPARE_STATE_COLLECTING,	/* active slots are being migrated to the spare arena */
+};
+
+struct logfs_index_entry {
+	uint32_t obj_id;
+	uint16_t obj_inst_id;
+	uint16_t slot_id;
+};
+
 struct logfs_state {
 	enum pios_flashfs_logfs_dev_magic magic;
 	const struct flashfs_logfs_cfg *cfg;
@@ -56,6 +70,18 @@ struct logfs_state {
 	uint16_t num_free_slots;   /* slots in free state */
 	uint16_t num_active_slots; /* slots in active state */
 
+	/* Active slots of the mounted arena sorted by object and instance id.
+	 * Only used while index_valid, otherwise the arena is scanned.
+	 */
+	struct logfs_index_entry *index;
+	uint16_t index_entries;
+	bool index_valid;
+
+	/* Garbage collection into the arena after the active one */
+	enum logfs_spare_state spare_state;
+	uint16_t gc_src_slot;	/* next slot of the active arena to migrate */
+	uint16_t gc_dst_slot;	/* next free slot of the spare arena */
+
 	/* Underlying flash partition handle */
 	uintptr_t partition_id;
 	uint32_t partition_size;
@@ -398,12 +424,94 @@ static bool logfs_log_is_full(const struct logfs_state *logfs)
 	return (logfs->num_free_slots == 0);
 }
 
+/**
+ * @brief Find an object in the RAM index
+ * @param[out] pos position of the object in the index, or where it would be inserted
+ * @return true if the object is in the index
+ */
+static bool logfs_index_search(const struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id, uint16_t *pos)
+{
+	uint16_t lo = 0;
+	uint16_t hi = logfs->index_entries;
+
+	while (lo < hi) {
+		uint16_t mid = (lo + hi) / 2;
+		const struct logfs_index_entry *entry = &logfs->index[mid];
+
+		if (entry->obj_id < obj_id ||
+			(entry->obj_id == obj_id && entry->obj_inst_id < obj_inst_id)) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	*pos = lo;
+	return (lo < logfs->index_entries &&
+		logfs->index[lo].obj_id == obj_id &&
+		logfs->index[lo].obj_inst_id == obj_inst_id);
+}
+
+/**
+ * @brief Clear the RAM index, it is used again if it was allocated
+ */
+static void logfs_index_reset(struct logfs_state *logfs)
+{
+	logfs->index_entries = 0;
+	logfs->index_valid   = (logfs->index != NULL);
+}
+
+/**
+ * @brief Add an active slot to the RAM index
+ * @note The index is not used again until the next mount when it runs out
+ *       of room or the object is already active in another slot
+ */
+static void logfs_index_add(struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id, uint16_t slot_id)
+{
+	if (!logfs->index_valid)
+		return;
+
+	uint16_t pos;
+	if (logfs->index_entries >= logfs->cfg->index_slots ||
+		logfs_index_search(logfs, obj_id, obj_inst_id, &pos)) {
+		logfs->index_valid = false;
+		return;
+	}
+
+	memmove(&logfs->index[pos + 1], &logfs->index[pos],
+		(logfs->index_entries - pos) * sizeof(*logfs->index));
+
+	logfs->index[pos].obj_id      = obj_id;
+	logfs->index[pos].obj_inst_id = obj_inst_id;
+	logfs->index[pos].slot_id     = slot_id;
+	logfs->index_entries++;
+}
+
+/**
+ * @brief Remove an object which is no longer active from the RAM index
+ */
+static void logfs_index_remove(struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id)
+{
+	if (!logfs->index_valid)
+		return;
+
+	uint16_t pos;
+	if (!logfs_index_search(logfs, obj_id, obj_inst_id, &pos))
+		return;
+
+	memmove(&logfs->index[pos], &logfs->index[pos + 1],
+		(logfs->index_entries - pos - 1) * sizeof(*logfs->index));
+	logfs->index_entries--;
+}
+
 static int32_t logfs_unmount_log(struct logfs_state *logfs)
 {
 	PIOS_Assert (logfs->mounted);
 
 	logfs->num_active_slots = 0;
 	logfs->num_free_slots   = 0;
+	logfs->index_entries    = 0;
+	logfs->index_valid      = false;
 	logfs->mounted          = false;
 
 	return 0;
@@ -416,8 +524,10 @@ static int32_t logfs_mount_log(struct logfs_state *logfs, uint8_t arena_id)
 	logfs->num_active_slots = 0;
 	logfs->num_free_slots   = 0;
 	logfs->active_arena_id  = arena_id;
+	logfs->spare_state      = SPARE_STATE_UNKNOWN;
+	logfs_index_reset(logfs);
 
-	/* Scan the log to find out how full it is */
+	/* Scan the log to find out how full it is and index the active slots */
 	for (uint16_t slot_id = 1;
 	     slot_id < (logfs->cfg->arena_size / logfs->cfg->slot_size);
 	     slot_id++) {
@@ -443,6 +553,7 @@ static int32_t logfs_mount_log(struct logfs_state *logfs, uint8_t arena_id)
 			break;
 		case SLOT_STATE_ACTIVE:
 			logfs->num_active_slots++;
+			logfs_index_add(logfs, slot_hdr.obj_id, slot_hdr.obj_inst_id, slot_id);
 			break;
 		case SLOT_STATE_RESERVED:
 		case SLOT_STATE_OBSOLETE:
@@ -476,6 +587,8 @@ static void PIOS_FLASHFS_Logfs_free(struct logfs_state *logfs)
 {
 	/* Invalidate the magic */
 	logfs->magic = ~PIOS_FLASHFS_LOGFS_DEV_MAGIC;
+	if (logfs->index)
+		PIOS_free(logfs->index);
 	PIOS_free(logfs);
 }
 
@@ -502,6 +615,9 @@ int32_t PIOS_FLASHFS_Logfs_Init(uintptr_t *fs_id, const struct flashfs_logfs_cfg
 	/* We must have at least 2 arenas for garbage collection to work */
 	PIOS_Assert((partition_size / cfg->arena_size > 1));
 
+	/* Incremental garbage collection must migrate more than it saves */
+	PIOS_Assert(cfg->gc_slots != 1);
+
 	/* arena_size must exactly divide the partition size */
 	PIOS_Assert((partition_size % cfg->arena_size) == 0);
 
@@ -521,6 +637,13 @@ int32_t PIOS_FLASHFS_Logfs_Init(uintptr_t *fs_id, const struct flashfs_logfs_cfg
 	logfs->partition_size = partition_size; /* size of underlying partition */
 	logfs->mounted        = false;
 
+	/* The index is optional, without it the objects are found by scanning the flash */
+	logfs->index = NULL;
+	if (cfg->index_slots > 0)
+		logfs->index = (struct logfs_index_entry *)PIOS_malloc(cfg->index_slots * sizeof(*logfs->index));
+	logfs->index_entries = 0;
+	logfs->index_valid   = false;
+
 	if (PIOS_FLASH_start_transaction(logfs->partition_id) != 0) {
 		rc = -1;
 		goto out_exit;
@@ -587,83 +710,288 @@ out_exit:
 	return rc;
 }
 
-/* NOTE: Must be called while holding the flash transaction lock */
-static int32_t logfs_garbage_collect (struct logfs_state *logfs) {
-	PIOS_Assert (logfs->mounted);
+/**
+ * @brief Return the arena the active arena is garbage collected into
+ */
+static uint8_t logfs_spare_arena_id(const struct logfs_state *logfs)
+{
+	return (logfs->active_arena_id + 1) % (logfs->partition_size / logfs->cfg->arena_size);
+}
 
-	/* Source arena is the active arena */
-	uint8_t src_arena_id = logfs->active_arena_id;
+/*
+ * Should the active slots be migrated to the spare arena as objects are saved?
+ * true = the log will be full soon, migrating gc_slots per save still catches up with it
+ * false = there is plenty of room left, or the garbage is collected all at once when full
+ */
+static bool logfs_gc_due(const struct logfs_state *logfs)
+{
+	if (logfs->cfg->gc_slots == 0)
+		return false;
+
+	uint16_t num_slots = logfs->cfg->arena_size / logfs->cfg->slot_size;
+	return (logfs->num_free_slots <= (num_slots - 1) / (logfs->cfg->gc_slots - 1) + 2);
+}
+
+/*
+ * Should the spare arena be erased ahead of the garbage collection?
+ * true = half of the arena is used, or the slots are about to be migrated
+ * false = the log still has plenty of room, the erase can wait
+ * A sector erase of the internal flash stalls the CPU, so it is only done
+ * once the spare arena will be needed soon rather than after every boot
+ * or collection.
+ */
+static bool logfs_erase_due(const struct logfs_state *logfs)
+{
+	uint16_t num_slots = logfs->cfg->arena_size / logfs->cfg->slot_size;
+	return (logfs->num_free_slots <= num_slots / 2) || logfs_gc_due(logfs);
+}
 
-	/* Compute destination arena */
-	uint8_t dst_arena_id = (logfs->active_arena_id + 1) % (logfs->partition_size / logfs->cfg->arena_size);
+/* NOTE: Must be called while holding the flash transaction lock */
+static int32_t logfs_gc_finish (struct logfs_state *logfs)
+{
+	uint8_t src_arena_id = logfs->active_arena_id;
+	uint8_t dst_arena_id = logfs_spare_arena_id(logfs);
 
-	/* Erase destination arena */
-	if (logfs_erase_arena (logfs, dst_arena_id) != 0) {
+	/* Activate the destination arena */
+	if (logfs_activate_arena (logfs, dst_arena_id) != 0) {
 		return -1;
 	}
 
-	/* Reserve the destination arena so we can start filling it */
-	if (logfs_reserve_arena (logfs, dst_arena_id) != 0) {
-		/* Unable to reserve the arena */
+	/* Unmount the source arena */
+	if (logfs_unmount_log (logfs) != 0) {
 		return -2;
 	}
 
-	/* Copy active slots from active arena to destination arena */
-	uint16_t dst_slot_id = 1;
-	for (uint16_t src_slot_id = 1;
-	     src_slot_id < (logfs->cfg->arena_size / logfs->cfg->slot_size);
-	     src_slot_id++) {
+	/* Obsolete the source arena */
+	if (logfs_obsolete_arena (logfs, src_arena_id) != 0) {
+		return -3;
+	}
+
+	/* Mount the new arena */
+	if (logfs_mount_log (logfs, dst_arena_id) != 0) {
+		return -4;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Do a bounded amount of garbage collection into the spare arena
+ * @param[in] max_slots the most slots of the active arena to migrate
+ * @param[in] force erase the spare arena and start migrating even if the log
+ *            still has plenty of room
+ * @return 1 if the collection completed and the new arena is mounted
+ * @return 0 if there is more work to do, or nothing to do yet
+ * @return < 0 on failure, the collection starts over with erasing the spare arena
+ * @note Erasing the spare arena is a step of its own
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t logfs_gc_step (struct logfs_state *logfs, uint16_t max_slots, bool force)
+{
+	PIOS_Assert (logfs->mounted);
+
+	int32_t rc;
+	uint8_t dst_arena_id = logfs_spare_arena_id(logfs);
+	uint16_t num_slots = logfs->cfg->arena_size / logfs->cfg->slot_size;
+
+	switch (logfs->spare_state) {
+	case SPARE_STATE_UNKNOWN:
+	{
+		/* Only erase the spare arena if it wasn't left erased */
+		struct arena_header arena_hdr;
+		if (PIOS_FLASH_read_data(logfs->partition_id,
+						logfs_get_addr (logfs, dst_arena_id, 0),
+						(uint8_t *)&arena_hdr,
+						sizeof (arena_hdr)) != 0) {
+			rc = -1;
+			goto out_fail;
+		}
+
+		if (arena_hdr.magic == logfs->cfg->fs_magic &&
+			arena_hdr.state == ARENA_STATE_ERASED) {
+			logfs->spare_state = SPARE_STATE_ERASED;
+			goto spare_erased;
+		}
+		logfs->spare_state = SPARE_STATE_DIRTY;
+	}
+		/* Fall through */
+	case SPARE_STATE_DIRTY:
+		if (!force && !logfs_erase_due(logfs)) {
+			return 0;
+		}
+
+		if (logfs_erase_arena (logfs, dst_arena_id) != 0) {
+			rc = -2;
+			goto out_fail;
+		}
+		logfs->spare_state = SPARE_STATE_ERASED;
+		return 0;
+
+	case SPARE_STATE_ERASED:
+spare_erased:
+		if (!force && !logfs_gc_due(logfs)) {
+			return 0;
+		}
+
+		/* Reserve the destination arena so we can start filling it */
+		if (logfs_reserve_arena (logfs, dst_arena_id) != 0) {
+			rc = -3;
+			goto out_fail;
+		}
+		logfs->gc_src_slot = 1;
+		logfs->gc_dst_slot = 1;
+		logfs->spare_state = SPARE_STATE_COLLECTING;
+		/* Fall through */
+	case SPARE_STATE_COLLECTING:
+		break;
+	}
+
+	/* Copy active slots from active arena to destination arena, up to the end of the log */
+	uint16_t log_end = num_slots - logfs->num_free_slots;
+	for (; max_slots > 0 && logfs->gc_src_slot < log_end; max_slots--, logfs->gc_src_slot++) {
 		struct slot_header slot_hdr;
-		uintptr_t src_addr = logfs_get_addr (logfs, src_arena_id, src_slot_id);
+		uintptr_t src_addr = logfs_get_addr (logfs, logfs->active_arena_id, logfs->gc_src_slot);
 		if (PIOS_FLASH_read_data(logfs->partition_id,
 						src_addr,
 						(uint8_t *)&slot_hdr,
 						sizeof (slot_hdr)) != 0) {
-			return -3;
+			rc = -4;
+			goto out_fail;
 		}
 
-		if (slot_hdr.state == SLOT_STATE_ACTIVE) {
-			uintptr_t dst_addr = logfs_get_addr (logfs, dst_arena_id, dst_slot_id);
-			if (logfs_raw_copy_bytes(logfs,
-							src_addr,
-							sizeof(slot_hdr) + slot_hdr.obj_size,
-							dst_addr) != 0) {
-				/* Failed to copy all bytes */
-				return -4;
-			}
-			dst_slot_id++;
+		if (slot_hdr.state != SLOT_STATE_ACTIVE)
+			continue;
+
+		if (logfs->gc_dst_slot >= num_slots) {
+			/* Objects saved since the migration started filled the destination */
+			rc = -5;
+			goto out_fail;
 		}
-	}
 
-	/* Activate the destination arena */
-	if (logfs_activate_arena (logfs, dst_arena_id) != 0) {
-		return -5;
+		uintptr_t dst_addr = logfs_get_addr (logfs, dst_arena_id, logfs->gc_dst_slot);
+		if (logfs_raw_copy_bytes(logfs,
+						src_addr,
+						sizeof(slot_hdr) + slot_hdr.obj_size,
+						dst_addr) != 0) {
+			/* Failed to copy all bytes */
+			rc = -6;
+			goto out_fail;
+		}
+		logfs->gc_dst_slot++;
 	}
 
-	/* Unmount the source arena */
-	if (logfs_unmount_log (logfs) != 0) {
-		return -6;
+	if (logfs->gc_src_slot < log_end) {
+		return 0;
 	}
 
-	/* Obsolete the source arena */
-	if (logfs_obsolete_arena (logfs, src_arena_id) != 0) {
-		return -7;
+	/* Everything has been migrated, switch over to the destination arena */
+	if (logfs_gc_finish (logfs) != 0) {
+		rc = -7;
+		goto out_fail;
 	}
 
-	/* Mount the new arena */
-	if (logfs_mount_log (logfs, dst_arena_id) != 0) {
-		return -8;
+	return 1;
+
+out_fail:
+	logfs->spare_state = SPARE_STATE_UNKNOWN;
+	return rc;
+}
+
+/**
+ * @brief Obsolete the copy of an object which was already migrated to the spare arena
+ * @return 0 if success, < 0 on failure
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t logfs_gc_forget (struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id)
+{
+	uint8_t dst_arena_id = logfs_spare_arena_id(logfs);
+
+	for (uint16_t slot_id = 1; slot_id < logfs->gc_dst_slot; slot_id++) {
+		struct slot_header slot_hdr;
+		uintptr_t slot_addr = logfs_get_addr (logfs, dst_arena_id, slot_id);
+		if (PIOS_FLASH_read_data(logfs->partition_id,
+						slot_addr,
+						(uint8_t *)&slot_hdr,
+						sizeof (slot_hdr)) != 0) {
+			return -1;
+		}
+
+		if (slot_hdr.state == SLOT_STATE_ACTIVE &&
+			slot_hdr.obj_id      == obj_id &&
+			slot_hdr.obj_inst_id == obj_inst_id) {
+			slot_hdr.state = SLOT_STATE_OBSOLETE;
+			if (PIOS_FLASH_write_data(logfs->partition_id,
+							slot_addr,
+							(uint8_t *)&slot_hdr,
+							sizeof(slot_hdr)) != 0) {
+				return -2;
+			}
+			return 0;
+		}
 	}
 
 	return 0;
 }
 
 /* NOTE: Must be called while holding the flash transaction lock */
-static int16_t logfs_object_find_next (const struct logfs_state *logfs, struct slot_header *slot_hdr, uint16_t *curr_slot, uint32_t obj_id, uint16_t obj_inst_id)
+static int32_t logfs_garbage_collect (struct logfs_state *logfs) {
+	PIOS_Assert (logfs->mounted);
+
+	uint16_t num_slots = logfs->cfg->arena_size / logfs->cfg->slot_size;
+
+	/*
+	 * Complete the migration in one go.  If the objects saved while it was
+	 * in progress filled the destination, start over: all active slots fit.
+	 */
+	for (uint8_t try = 0; try < 2; try++) {
+		int32_t rc;
+		do {
+			rc = logfs_gc_step (logfs, num_slots, true);
+		} while (rc == 0);
+
+		if (rc == 1) {
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+/* NOTE: Must be called while holding the flash transaction lock */
+static int16_t logfs_object_find_next (struct logfs_state *logfs, struct slot_header *slot_hdr, uint16_t *curr_slot, uint32_t obj_id, uint16_t obj_inst_id)
 {
 	PIOS_Assert(slot_hdr);
 	PIOS_Assert(curr_slot);
 
+	/* A search from the start of the log is answered by the index */
+	if (*curr_slot == 0 && logfs->index_valid) {
+		uint16_t pos;
+		if (!logfs_index_search(logfs, obj_id, obj_inst_id, &pos)) {
+			/* No matching entry was found */
+			return -1;
+		}
+
+		uint16_t slot_id = logfs->index[pos].slot_id;
+		uintptr_t slot_addr = logfs_get_addr (logfs, logfs->active_arena_id, slot_id);
+		if (PIOS_FLASH_read_data(logfs->partition_id,
+						slot_addr,
+						(uint8_t *)slot_hdr,
+						sizeof (*slot_hdr)) != 0) {
+			return -2;
+		}
+
+		if (slot_hdr->state == SLOT_STATE_ACTIVE &&
+			slot_hdr->obj_id      == obj_id &&
+			slot_hdr->obj_inst_id == obj_inst_id) {
+			*curr_slot = slot_id;
+			return 0;
+		}
+
+		/* The index doesn't match the flash, scan it instead */
+		PIOS_DEBUG_Assert(0);
+		logfs->index_valid = false;
+	}
+
 	/* First slot in the arena is reserved for arena header, skip it. */
 	if (*curr_slot == 0) *curr_slot = 1;
 
@@ -696,7 +1024,7 @@ static int16_t logfs_object_find_next (const struct logfs_state *logfs, struct s
 }
 
 /* NOTE: Must be called while holding the flash transaction lock */
-/* OPTIMIZE: could trust that there is at most one active version of every object and terminate the search when we find one */
+/* NOTE: the whole log is only searched for other active versions of the object when it isn't indexed */
 static int8_t logfs_delete_object (struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id)
 {
 	int8_t rc;
@@ -720,6 +1048,20 @@ static int8_t logfs_delete_object (struct logfs_state *logfs, uint32_t obj_id, u
 			}
 			/* Object has been successfully obsoleted and is no longer active */
 			logfs->num_active_slots--;
+
+			/* Drop the copy made by a garbage collection in progress as well */
+			if (logfs->spare_state == SPARE_STATE_COLLECTING &&
+				curr_slot_id < logfs->gc_src_slot &&
+				logfs_gc_forget (logfs, obj_id, obj_inst_id) != 0) {
+				logfs->spare_state = SPARE_STATE_UNKNOWN;
+			}
+
+			/* The index holds at most one active version of every object */
+			if (logfs->index_valid) {
+				logfs_index_remove(logfs, obj_id, obj_inst_id);
+				more = false;
+				rc = 0;
+			}
 			break;
 		case -1:
 			/* Search completed, object not found */
@@ -832,6 +1174,7 @@ static int8_t logfs_append_to_log (struct logfs_state *logfs, uint32_t obj_id, u
 
 	/* Object has been successfully written to the slot */
 	logfs->num_active_slots++;
+	logfs_index_add(logfs, obj_id, obj_inst_id, free_slot_id);
 	return 0;
 }
 
@@ -912,6 +1255,13 @@ int32_t PIOS_FLASHFS_ObjSave(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst
 			rc = -6;
 			goto out_end_trans;
 		}
+	} else if (logfs_gc_due(logfs)) {
+		/*
+		 * Spread the garbage collection over the saves made while the log
+		 * fills up, the spare arena should have been erased by then from
+		 * PIOS_FLASHFS_Idle(). A failed step just starts the collection over.
+		 */
+		logfs_gc_step(logfs, logfs->cfg->gc_slots, false);
 	}
 
 	/* We have room for our new object.  Append it to the log. */
@@ -1043,6 +1393,47 @@ out_exit:
 	return rc;
 }
 
+/**
+ * @brief Do a bounded amount of filesystem maintenance in the background
+ * @param[in] fs_id The filesystem to use for this action
+ * @return 0 if success or error code
+ * @retval -1 if fs_id is not a valid filesystem instance
+ * @retval -2 if failed to start transaction
+ * @retval -3 if the garbage collection failed
+ * @note Erases the spare arena once half of the log is used, ahead of the
+ *       next garbage collection, and continues an incremental garbage
+ *       collection in progress
+ */
+int32_t PIOS_FLASHFS_Idle(uintptr_t fs_id)
+{
+	int32_t rc;
+
+	struct logfs_state *logfs = (struct logfs_state *)fs_id;
+
+	if (!PIOS_FLASHFS_Logfs_validate(logfs)) {
+		rc = -1;
+		goto out_exit;
+	}
+
+	if (PIOS_FLASH_start_transaction(logfs->partition_id) != 0) {
+		rc = -2;
+		goto out_exit;
+	}
+
+	if (logfs_gc_step(logfs, logfs->cfg->gc_slots, false) < 0) {
+		rc = -3;
+		goto out_end_trans;
+	}
+
+	rc = 0;
+
+out_end_trans:
+	PIOS_FLASH_end_transaction(logfs->partition_id);
+
+out_exit:
+	return rc;
+}
+
 /**
  * @brief Erases all filesystem arenas and activate the first arena
  * @param[in] fs_id The filesystem to use for this action
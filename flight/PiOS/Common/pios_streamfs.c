@@ -32,6 +32,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>		/* NULL */
+#include <string.h>		/* memcpy */
 
 #define MIN(x,y) ((x) < (y) ? (x) : (y))
 
@@ -47,6 +48,12 @@
  * sector has a footer to indicate the file id and the sector id.
  *
  * Arenas map onto sectors. 
+ *
+ * Appended data is combined in RAM into spans which end at a write_size
+ * boundary (or at the footer), so each page of the flash is programmed
+ * with a single write however small the appends are. Buffered data only
+ * reaches the flash when a page fills, on PIOS_STREAMFS_Flush and when
+ * the file is closed.
  */
 
 #include <pios_com.h>
@@ -84,6 +91,10 @@ struct streamfs_state {
 	uintptr_t tx_out_context;
 	uint8_t *com_buffer;
 
+	/* Write combining buffer for the page being appended to */
+	uint8_t *write_buffer;
+	uint32_t write_buffered;
+
 	/* Information for current file handle */
 	bool file_open_writing;
 	bool file_open_reading;
@@ -185,6 +196,8 @@ static void streamfs_free(struct streamfs_state *streamfs)
 {
 	/* Invalidate the magic */
 	streamfs->magic = ~PIOS_FLASHFS_STREAMFS_DEV_MAGIC;
+	PIOS_free(streamfs->write_buffer);
+	PIOS_free(streamfs->com_buffer);
 	PIOS_free(streamfs);
 }
 
@@ -346,6 +359,75 @@ static int32_t streamfs_find_new_sector(struct streamfs_state *streamfs)
 	return (last_sector + 1) % num_arenas;
 }
 
+/**
+ * Get the free space of the write buffer. The buffered data always ends at
+ * the next write_size boundary or at the footer, whichever comes first.
+ * @param[in] streamfs the file system handle
+ * @return the number of bytes that can still be buffered
+ */
+static uint32_t streamfs_write_space(const struct streamfs_state *streamfs)
+{
+	uint32_t data_end = streamfs->cfg->arena_size - sizeof(struct streamfs_footer);
+	uint32_t page_end = (streamfs->active_file_arena_offset / streamfs->cfg->write_size + 1) * streamfs->cfg->write_size;
+
+	if (page_end > data_end)
+		page_end = data_end;
+
+	return page_end - streamfs->active_file_arena_offset - streamfs->write_buffered;
+}
+
+/**
+ * Program the buffered data into the flash and start the next sector
+ * if the current one is full
+ * @param[in] streamfs the file system handle
+ * @return 0 if success, < 0 on failure
+ *
+ * @NOTE: Must be called while holding the flash transaction lock
+ */
+static int32_t streamfs_flush(struct streamfs_state *streamfs)
+{
+	if (streamfs->write_buffered == 0)
+		return 0;
+
+	uint32_t start_address = streamfs_get_addr(streamfs, streamfs->active_file_arena,
+		                                                 streamfs->active_file_arena_offset);
+
+	if (PIOS_FLASH_write_data(streamfs->partition_id, start_address, streamfs->write_buffer, streamfs->write_buffered) != 0) {
+		return -1;
+	}
+
+	streamfs->active_file_arena_offset += streamfs->write_buffered;
+	streamfs->write_buffered = 0;
+
+	// Make sure not to write into the space for the footer
+	if (streamfs->active_file_arena_offset >= (streamfs->cfg->arena_size - sizeof(struct streamfs_footer))) {
+		if (streamfs_new_sector(streamfs) != 0) {
+			return -2;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Account for data placed at the end of the write buffer and program
+ * the buffer when it is full
+ * @param[in] streamfs the file system handle
+ * @param[in] len the number of bytes added to the buffer
+ * @return 0 if success, < 0 on failure
+ *
+ * @NOTE: Must be called while holding the flash transaction lock
+ */
+static int32_t streamfs_commit_buffered(struct streamfs_state *streamfs, uint32_t len)
+{
+	streamfs->write_buffered += len;
+
+	if (streamfs_write_space(streamfs) == 0)
+		return streamfs_flush(streamfs);
+
+	return 0;
+}
+
 /* NOTE: Must be called while holding the flash transaction lock */
 static int32_t streamfs_append_to_file(struct streamfs_state *streamfs, uint8_t *data, uint32_t len)
 {
@@ -358,30 +440,17 @@ static int32_t streamfs_append_to_file(struct streamfs_state *streamfs, uint8_t
 	uint32_t total_written = 0;
 
 	while (len > 0) {
-		uint32_t start_address = streamfs_get_addr(streamfs, streamfs->active_file_arena,
-			                                                 streamfs->active_file_arena_offset);
-
-		// Make sure not to write into the space for the footer
-		uint32_t bytes_to_write = len;
-		if ((streamfs->active_file_arena_offset + bytes_to_write) > (streamfs->cfg->arena_size - sizeof(struct streamfs_footer))) {
-			bytes_to_write = streamfs->cfg->arena_size - sizeof(struct streamfs_footer) - streamfs->active_file_arena_offset;
-		}
+		uint32_t bytes_to_write = MIN(len, streamfs_write_space(streamfs));
 
-		if (PIOS_FLASH_write_data(streamfs->partition_id, start_address, data, bytes_to_write) != 0) {
-			return -3;
-		}
+		memcpy(&streamfs->write_buffer[streamfs->write_buffered], data, bytes_to_write);
 
 		// Increment pointers
-		streamfs->active_file_arena_offset += bytes_to_write;
 		len -= bytes_to_write;
 		total_written += bytes_to_write;
 		data = &data[bytes_to_write];
 
-
-		if (streamfs->active_file_arena_offset >= (streamfs->cfg->arena_size - sizeof(struct streamfs_footer))) {
-			if (streamfs_new_sector(streamfs) != 0) {
-				return -4;
-			}
+		if (streamfs_commit_buffered(streamfs, bytes_to_write) != 0) {
+			return -3;
 		}
 	}
 
@@ -548,6 +617,14 @@ int32_t PIOS_STREAMFS_Init(uintptr_t *fs_id, const struct streamfs_cfg *cfg, enu
 		return -1;
 	}
 
+	streamfs->write_buffer = (uint8_t *)PIOS_malloc(cfg->write_size);
+	if (!streamfs->write_buffer) {
+		PIOS_free(streamfs->com_buffer);
+		PIOS_free(streamfs);
+		return -1;
+	}
+	streamfs->write_buffered = 0;
+
 	/* Bind configuration parameters to this filesystem instance */
 	streamfs->cfg            = cfg;	/* filesystem configuration */
 	streamfs->partition_id   = partition_id; /* underlying partition */
@@ -683,6 +760,7 @@ int32_t PIOS_STREAMFS_OpenWrite(uintptr_t fs_id)
 	streamfs->active_file_segment = 0;
 	streamfs->active_file_arena = streamfs_find_new_sector(streamfs);
 	streamfs->active_file_arena_offset = 0;
+	streamfs->write_buffered = 0;
 	streamfs->file_open_writing = true;
 
 	// Erase this sector to prepare for streaming
@@ -797,6 +875,12 @@ int32_t PIOS_STREAMFS_Close(uintptr_t fs_id)
 		goto out_exit;
 	}
 
+	// Write out the data still in the buffer before the footer
+	if (streamfs_flush(streamfs) != 0) {
+		rc = -3;
+		goto out_end_trans;
+	}
+
 	if (streamfs->active_file_segment != 0 && streamfs->active_file_arena_offset != 0) {
 		// Close segment when something has been written. This avoids creating
 		// null files with an open/close operation
@@ -806,8 +890,6 @@ int32_t PIOS_STREAMFS_Close(uintptr_t fs_id)
 		}
 	}
 
-
-	// TODO: make sure to flush remaining data
 	streamfs->file_open_writing = false;
 
 	if (streamfs_scan_filesystem(streamfs) != 0) {
@@ -824,6 +906,47 @@ out_exit:
 	return rc;
 }
 
+/**
+ * Write the buffered data of the file being written to the flash
+ *
+ * @param[in] fs_id the streaming device handle
+ * @returns 0 if successful, <0 if not
+ */
+int32_t PIOS_STREAMFS_Flush(uintptr_t fs_id)
+{
+	int32_t rc;
+
+	struct streamfs_state *streamfs = (struct streamfs_state *)fs_id;
+
+	if (!streamfs_validate(streamfs)) {
+		rc = -1;
+		goto out_exit;
+	}
+
+	if (!streamfs->file_open_writing) {
+		rc = -2;
+		goto out_exit;
+	}
+
+	if (PIOS_FLASH_start_transaction(streamfs->partition_id) != 0) {
+		rc = -3;
+		goto out_exit;
+	}
+
+	if (streamfs_flush(streamfs) != 0) {
+		rc = -4;
+		goto out_end_trans;
+	}
+
+	rc = 0;
+
+out_end_trans:
+	PIOS_FLASH_end_transaction(streamfs->partition_id);
+
+out_exit:
+	return rc;
+}
+
 // Testing methods for unit tests
 
 int32_t PIOS_STREAMFS_Testing_Write(uintptr_t fs_id, uint8_t *data, uint32_t len)
@@ -947,16 +1070,17 @@ static void PIOS_STREAMFS_TxStart(uintptr_t fs_id, uint16_t tx_bytes_avail)
 		return;
 	}
 
-	// Flush available data from PIOS_COM interface to file system
+	// Move available data from PIOS_COM interface straight into the write buffer
 	int32_t bytes_to_write;
 	while(1) {
 		bytes_to_write = (streamfs->tx_out_cb)(streamfs->tx_out_context,
-			              streamfs->com_buffer, streamfs->cfg->write_size, NULL, NULL);
+			              &streamfs->write_buffer[streamfs->write_buffered],
+			              streamfs_write_space(streamfs), NULL, NULL);
 
 		if (bytes_to_write <= 0)
 			break;
 
-		if (streamfs_append_to_file (streamfs, streamfs->com_buffer, bytes_to_write) != 0) {
+		if (streamfs_commit_buffered(streamfs, bytes_to_write) != 0) {
 			goto out_end_trans;
 		}
 	}
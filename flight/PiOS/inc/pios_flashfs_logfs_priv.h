@@ -35,11 +35,18 @@
  *
  * Note: a filesystem requires room for at least 2 arenas within its partition.
  * Note: a filesystem requires room for at least 2 slots per arena.  The first slot is reserved.
+ * Note: index_slots costs 8 bytes of RAM per slot.  The objects are looked up by scanning
+ *       the flash whenever the arena has more active slots than the index can hold.
+ * Note: with gc_slots the garbage collection is spread over the saves made while the arena
+ *       fills up.  Each save migrates at most that many slots to the spare arena, which
+ *       PIOS_FLASHFS_Idle() erases ahead of time.  It must be 0 or at least 2.
  */
 struct flashfs_logfs_cfg {
 	uint32_t fs_magic;
 	uint32_t arena_size;	/* Max size of one generation of the filesystem */
 	uint32_t slot_size;	/* Max size of a "file" within the filesystem */
+	uint16_t index_slots;	/* Max active slots indexed in RAM, 0 to disable the index */
+	uint16_t gc_slots;	/* Max slots migrated per save, 0 to collect all at once when full */
 };
 
 int32_t PIOS_FLASHFS_Logfs_Init(uintptr_t * fs_id, const struct flashfs_logfs_cfg * cfg, enum pios_flash_partition_labels partition_label);
@@ -34,6 +34,7 @@ int32_t PIOS_STREAMFS_OpenWrite(uintptr_t fs_id);
 int32_t PIOS_STREAMFS_OpenRead(uintptr_t fs_id, uint32_t file_id);
 int32_t PIOS_STREAMFS_MinFileId(uintptr_t fs_id);
 int32_t PIOS_STREAMFS_MaxFileId(uintptr_t fs_id);
+int32_t PIOS_STREAMFS_Flush(uintptr_t fs_id);
 int32_t PIOS_STREAMFS_Close(uintptr_t fs_id);
 int32_t PIOS_STREAMFS_Destroy(uintptr_t fs_id);
 
@@ -47,6 +47,14 @@
 #define STACK_SIZE_BYTES PIOS_THREAD_STACK_SIZE_MIN
 #endif /* PIOS_EVENTDISPATCHER_STACK_SIZE */
 
+// The PiOS heap can't free, so the update heap is never reallocated. It
+// holds the entries with a period, a few callbacks and the periodic objects.
+#if defined(PIOS_EVENTDISPATCHER_MAX_PERIODIC)
+#define MAX_PERIODIC_UPDATES PIOS_EVENTDISPATCHER_MAX_PERIODIC
+#else
+#define MAX_PERIODIC_UPDATES 64
+#endif
+
 #define TASK_PRIORITY PIOS_THREAD_PRIO_HIGH
 #define MAX_UPDATE_PERIOD_MS 1000
 
@@ -69,12 +77,15 @@ struct PeriodicObjectListStruct {
 	EventCallbackInfo evInfo; /** Event callback information */
     uint16_t updatePeriodMs; /** Update period in ms or 0 if no periodic updates are needed */
     int32_t timeToNextUpdateMs; /** Time delay to the next update */
+    int16_t heapIndex; /** Position in the update heap or -1 if not scheduled */
     struct PeriodicObjectListStruct* next; /** Needed by linked list library (utlist.h) */
 };
 typedef struct PeriodicObjectListStruct PeriodicObjectList;
 
 // Private variables
 static PeriodicObjectList* objList;
+static PeriodicObjectList* updateHeap[MAX_PERIODIC_UPDATES]; /** Min-heap of the scheduled entries, on timeToNextUpdateMs */
+static uint16_t updateHeapSize;
 static struct pios_queue *queue;
 static struct pios_thread *eventTaskHandle;
 static struct pios_recursive_mutex *mutex;
@@ -86,6 +97,10 @@ static void eventTask();
 static int32_t eventPeriodicCreate(UAVObjEvent* ev, UAVObjEventCallback cb, struct pios_queue *queue, uint16_t periodMs);
 static int32_t eventPeriodicUpdate(UAVObjEvent* ev, UAVObjEventCallback cb, struct pios_queue *queue, uint16_t periodMs);
 static uint16_t randomizePeriod(uint16_t periodMs);
+static int32_t heapInsert(PeriodicObjectList* objEntry);
+static void heapRemove(PeriodicObjectList* objEntry);
+static void heapSiftUp(uint16_t index);
+static void heapSiftDown(uint16_t index);
 
 
 /**
@@ -96,6 +111,7 @@ int32_t EventDispatcherInitialize()
 {
 	// Initialize variables
 	objList = NULL;
+	updateHeapSize = 0;
 	memset(&stats, 0, sizeof(EventStats));
 
 	// Create mutex
@@ -230,6 +246,15 @@ static int32_t eventPeriodicCreate(UAVObjEvent* ev, UAVObjEventCallback cb, stru
 			return -1;
 		}
 	}
+	// Check that it can be scheduled before allocating it, it can't be freed
+	if (periodMs > 0 && updateHeapSize >= MAX_PERIODIC_UPDATES)
+	{
+		if (ev->obj != NULL)
+			stats.lastErrorID = UAVObjGetID(ev->obj);
+		++stats.eventErrors;
+		PIOS_Recursive_Mutex_Unlock(mutex);
+		return -1;
+	}
     // Create handle
 	objEntry = (PeriodicObjectList*)PIOS_malloc(sizeof(PeriodicObjectList));
 	if (objEntry == NULL) return -1;
@@ -240,6 +265,10 @@ static int32_t eventPeriodicCreate(UAVObjEvent* ev, UAVObjEventCallback cb, stru
 	objEntry->evInfo.queue = queue;
     objEntry->updatePeriodMs = periodMs;
     objEntry->timeToNextUpdateMs = randomizePeriod(periodMs); // avoid bunching of updates
+    objEntry->heapIndex = -1;
+    // Schedule the first update
+    if (periodMs > 0)
+        heapInsert(objEntry);
     // Add to list
     LL_APPEND(objList, objEntry);
 	// Release lock
@@ -272,9 +301,20 @@ static int32_t eventPeriodicUpdate(UAVObjEvent* ev, UAVObjEventCallback cb, stru
 			// Object found, update period
 			objEntry->updatePeriodMs = periodMs;
 			objEntry->timeToNextUpdateMs = randomizePeriod(periodMs); // avoid bunching of updates
+			// Reschedule
+			int32_t ret = 0;
+			if (periodMs == 0)
+				heapRemove(objEntry);
+			else if (objEntry->heapIndex < 0)
+				ret = heapInsert(objEntry);
+			else
+			{
+				heapSiftUp(objEntry->heapIndex);
+				heapSiftDown(objEntry->heapIndex);
+			}
 			// Release lock
 			PIOS_Recursive_Mutex_Unlock(mutex);
-			return 0;
+			return ret;
 		}
 	}
     // If this point is reached the object was not found
@@ -326,61 +366,150 @@ static void eventTask()
 }
 
 /**
- * Handle periodic updates for all objects.
+ * Handle periodic updates for the objects that are due. The scheduled
+ * objects are kept in a min-heap on their next update time, so only the
+ * objects that are updated are visited.
  * \return The system time until the next update (in ms) or -1 if failed
  */
 static int32_t processPeriodicUpdates()
 {
 	PeriodicObjectList* objEntry;
 	int32_t timeNow;
-    int32_t timeToNextUpdate;
-    int32_t offset;
+	int32_t timeToNextUpdate;
+	int32_t offset;
 
 	// Get lock
 	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
 
-    // Iterate through each object and update its timer, if zero then transmit object.
-    // Also calculate smallest delay to next update.
-    timeToNextUpdate = PIOS_Thread_Systime() + MAX_UPDATE_PERIOD_MS;
-    LL_FOREACH(objList, objEntry)
-    {
-        // If object is configured for periodic updates
-        if (objEntry->updatePeriodMs > 0)
-        {
-            // Check if time for the next update
-        	timeNow = PIOS_Thread_Systime();
-            if (objEntry->timeToNextUpdateMs <= timeNow)
-            {
-                // Reset timer
-            	offset = ( timeNow - objEntry->timeToNextUpdateMs ) % objEntry->updatePeriodMs;
-            	objEntry->timeToNextUpdateMs = timeNow + objEntry->updatePeriodMs - offset;
-    			// Invoke callback, if one
-    			if ( objEntry->evInfo.cb != 0)
-    			{
-    				objEntry->evInfo.cb(&objEntry->evInfo.ev); // the function is expected to copy the event information
-    			}
-    			// Push event to queue, if one
-    			if ( objEntry->evInfo.queue != 0)
-    			{
-    				if (PIOS_Queue_Send(objEntry->evInfo.queue, &objEntry->evInfo.ev, 0) != true ) // do not block if queue is full
-    				{
-						if (objEntry->evInfo.ev.obj != NULL)
-							stats.lastErrorID = UAVObjGetID(objEntry->evInfo.ev.obj);
-    					++stats.eventErrors;
-    				}
-    			}
-            }
-            // Update minimum delay
-            if (objEntry->timeToNextUpdateMs < timeToNextUpdate)
-            {
-            	timeToNextUpdate = objEntry->timeToNextUpdateMs;
-            }
-        }
-    }
-
-    // Done
-    PIOS_Recursive_Mutex_Unlock(mutex);
-    return timeToNextUpdate;
+	// Update the objects at the top of the heap until the next one is not due
+	timeNow = PIOS_Thread_Systime();
+	while (updateHeapSize > 0 && updateHeap[0]->timeToNextUpdateMs <= timeNow)
+	{
+		objEntry = updateHeap[0];
+
+		// Reset timer, this moves the object down the heap
+		offset = ( timeNow - objEntry->timeToNextUpdateMs ) % objEntry->updatePeriodMs;
+		objEntry->timeToNextUpdateMs = timeNow + objEntry->updatePeriodMs - offset;
+		heapSiftDown(0);
+
+		// Invoke callback, if one
+		if ( objEntry->evInfo.cb != 0)
+		{
+			objEntry->evInfo.cb(&objEntry->evInfo.ev); // the function is expected to copy the event information
+		}
+		// Push event to queue, if one
+		if ( objEntry->evInfo.queue != 0)
+		{
+			if (PIOS_Queue_Send(objEntry->evInfo.queue, &objEntry->evInfo.ev, 0) != true ) // do not block if queue is full
+			{
+				if (objEntry->evInfo.ev.obj != NULL)
+					stats.lastErrorID = UAVObjGetID(objEntry->evInfo.ev.obj);
+				++stats.eventErrors;
+			}
+		}
+	}
+
+	// The next update is the one at the top of the heap
+	timeToNextUpdate = timeNow + MAX_UPDATE_PERIOD_MS;
+	if (updateHeapSize > 0 && updateHeap[0]->timeToNextUpdateMs < timeToNextUpdate)
+	{
+		timeToNextUpdate = updateHeap[0]->timeToNextUpdateMs;
+	}
+
+	// Done
+	PIOS_Recursive_Mutex_Unlock(mutex);
+	return timeToNextUpdate;
+}
+
+/**
+ * Add an object to the update heap. A full heap is counted as an event error.
+ * Must be called with the mutex held.
+ * \return Success (0), failure (-1)
+ */
+static int32_t heapInsert(PeriodicObjectList* objEntry)
+{
+	if (updateHeapSize >= MAX_PERIODIC_UPDATES)
+	{
+		if (objEntry->evInfo.ev.obj != NULL)
+			stats.lastErrorID = UAVObjGetID(objEntry->evInfo.ev.obj);
+		++stats.eventErrors;
+		return -1;
+	}
+
+	objEntry->heapIndex = updateHeapSize;
+	updateHeap[updateHeapSize++] = objEntry;
+	heapSiftUp(objEntry->heapIndex);
+	return 0;
+}
+
+/**
+ * Remove an object from the update heap, if it is scheduled.
+ * Must be called with the mutex held.
+ */
+static void heapRemove(PeriodicObjectList* objEntry)
+{
+	uint16_t index;
+
+	if (objEntry->heapIndex < 0)
+		return;
+
+	index = objEntry->heapIndex;
+	objEntry->heapIndex = -1;
+
+	// Fill the hole with the last object and restore the heap order
+	if (--updateHeapSize == index)
+		return;
+	updateHeap[index] = updateHeap[updateHeapSize];
+	updateHeap[index]->heapIndex = index;
+	heapSiftUp(index);
+	heapSiftDown(updateHeap[index]->heapIndex);
+}
+
+/**
+ * Move an object up the heap until its parent is not updated later.
+ */
+static void heapSiftUp(uint16_t index)
+{
+	PeriodicObjectList* objEntry = updateHeap[index];
+
+	while (index > 0)
+	{
+		uint16_t parent = (index - 1) / 2;
+		if (updateHeap[parent]->timeToNextUpdateMs <= objEntry->timeToNextUpdateMs)
+			break;
+		updateHeap[index] = updateHeap[parent];
+		updateHeap[index]->heapIndex = index;
+		index = parent;
+	}
+
+	updateHeap[index] = objEntry;
+	objEntry->heapIndex = index;
+}
+
+/**
+ * Move an object down the heap until none of its children is updated earlier.
+ */
+static void heapSiftDown(uint16_t index)
+{
+	PeriodicObjectList* objEntry = updateHeap[index];
+
+	while (1)
+	{
+		uint32_t child = 2 * (uint32_t)index + 1;
+		if (child >= updateHeapSize)
+			break;
+		if (child + 1 < updateHeapSize &&
+			updateHeap[child + 1]->timeToNextUpdateMs < updateHeap[child]->timeToNextUpdateMs)
+			child++;
+		if (objEntry->timeToNextUpdateMs <= updateHeap[child]->timeToNextUpdateMs)
+			break;
+		updateHeap[index] = updateHeap[child];
+		updateHeap[index]->heapIndex = index;
+		index = child;
+	}
+
+	updateHeap[index] = objEntry;
+	objEntry->heapIndex = index;
 }
 
 /**
@@ -0,0 +1,48 @@
+/**
+ ******************************************************************************
+ * @addtogroup TauLabsCore Tau Labs Core components
+ * @{
+ * @addtogroup UAVObjects UAVObject set for this firmware
+ * @{
+ *
+ * @file       uavobjectids.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @brief      Sorted IDs of the objects in this firmware. This file is
+ *             automatically updated by the parser.
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef UAVOBJECTIDS_H
+#define UAVOBJECTIDS_H
+
+/*
+ * IDs of the objects built into this firmware, in ascending order so
+ * that the object manager can find an object with a binary search.
+ * Only included by the object manager.
+ */
+static const uint32_t uavo_ids[] = {
+$(OBJIDS)
+};
+
+#endif /* UAVOBJECTIDS_H */
+
+/**
+ * @}
+ * @}
+ */
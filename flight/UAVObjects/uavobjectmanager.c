@@ -32,8 +32,11 @@
 #include "openpilot.h"
 #include "pios_struct_helper.h"
 #include "pios_heap.h"		/* PIOS_malloc_no_dma */
+#include "pios_delay.h"
 #include "pios_mutex.h"
 #include "pios_queue.h"
+#include "pios_thread.h"
+#include "uavobjectids.h"
 
 extern uintptr_t pios_uavo_settings_fs_id;
 
@@ -61,11 +64,12 @@ struct ObjectEventEntry {
 /*
   MetaInstance   == [UAVOBase [UAVObjMetadata]]
   SingleInstance == [UAVOBase [UAVOData [InstanceData]]]
-  MultiInstance  == [UAVOBase [UAVOData [NumInstances [InstanceData0 [next]]]]
-                                                  ____________________/
-                                                  \-->[InstanceData1 [next]]
-                                                  _________...________/
-                                                  \-->[InstanceDataN [next]]
+  MultiInstance  == [UAVOBase [UAVOData [NumInstances [Blocks] [InstanceData0]]]]
+                                                         |
+                                                         \-->[InstanceData1]
+                                                         \-->[InstanceData2 InstanceData3]
+                                                         \-->[InstanceData4 ... InstanceData7]
+                                                         \-->...
  */
 
 /*
@@ -82,6 +86,7 @@ struct UAVOBase {
 		bool isMeta        : 1;
 		bool isSingle      : 1;
 		bool isSettings    : 1;
+		bool isDeltaEncoded : 1;
 	} flags;
 
 } __attribute__((packed));
@@ -101,10 +106,21 @@ struct UAVOData {
 	 * inside the payload for this UAVO.
 	 */
 	struct UAVOMeta   metaObj;
-	struct UAVOData * next;
 	uint16_t          instance_size;
+	uint8_t           reserved;
+	/*
+	 * Sequence lock for the instance data of this object and its
+	 * meta object, odd while a write is in progress. It must be word
+	 * aligned to be read and written in a single access.
+	 */
+	uint32_t          seq;
+	/* Time of the last write (ms), protected by the sequence lock */
+	uint32_t          update_time;
 } __attribute__((packed));
 
+_Static_assert((offsetof(struct UAVOData, seq) & 3) == 0, "UAVO sequence must be word aligned");
+_Static_assert((offsetof(struct UAVOData, update_time) & 3) == 0, "UAVO update time must be word aligned");
+
 /* Augmented type for Single Instance Data UAVO */
 struct UAVOSingle {
 	struct UAVOData   uavo;
@@ -116,22 +132,22 @@ struct UAVOSingle {
 	 */
 } __attribute__((packed));
 
-/* Part of a linked list of instances chained off of a multi instance UAVO. */
-struct UAVOMultiInst {
-	struct UAVOMultiInst * next;
-	uint8_t                instance[];
-	/* 
-	 * Additional space will be malloc'd here to hold the
-	 * the data for this instance.
-	 */
-} __attribute__((packed));
+/*
+ * The instances after instance 0 are stored in blocks of doubling size,
+ * block k holding instances 2^k to 2^(k+1)-1. Blocks never move once
+ * allocated and any instance is found with a single bit scan.
+ */
+#define UAVO_INSTANCE_BLOCKS 10
+
+_Static_assert((1 << UAVO_INSTANCE_BLOCKS) > UAVOBJ_MAX_INSTANCES, "Not enough instance blocks");
 
 /* Augmented type for Multi Instance Data UAVO */
 struct UAVOMulti {
 	struct UAVOData        uavo;
 
+	uint8_t              * instance_blocks[UAVO_INSTANCE_BLOCKS];
 	uint16_t               num_instances;
-	struct UAVOMultiInst   instance0;
+	uint8_t                instance0[];
 	/*
 	 * Additional space will be malloc'd here to hold the
 	 * the data for instance 0.
@@ -148,21 +164,32 @@ struct UAVOMulti {
 
 /** all information about instances are dependant on object type **/
 #define ObjSingleInstanceDataOffset(obj) ((void*)(&(( (struct UAVOSingle*)obj )->instance0)))
-#define InstanceDataOffset(inst) ((void*)&(( (struct UAVOMultiInst*)inst )->instance))
 #define InstanceData(instance) (void*)instance
+#define InstanceBlock(instId) (31 - __builtin_clz(instId))
 
 // Private functions
 static int32_t sendEvent(struct UAVOBase * obj, uint16_t instId,
 			UAVObjEventType event);
 static InstanceHandle createInstance(struct UAVOData * obj, uint16_t instId);
 static InstanceHandle getInstance(struct UAVOData * obj, uint16_t instId);
+static int32_t idIndex(uint32_t id);
+static int32_t readInstance(UAVObjHandle obj_handle, uint16_t instId,
+			void *dataOut, uint32_t offset, uint32_t size);
 static int32_t connectObj(UAVObjHandle obj_handle, struct pios_queue *queue,
 			UAVObjEventCallback cb, uint8_t eventMask);
 static int32_t disconnectObj(UAVObjHandle obj_handle, struct pios_queue *queue,
 			UAVObjEventCallback cb);
 
 // Private variables
-static struct UAVOData * uavo_list;
+
+/* Registered objects, indexed like uavo_ids[] */
+static struct UAVOData * uavo_handles[NELEMENTS(uavo_ids)];
+
+/* Iterate over the registered objects in ID order */
+#define FOREACH_UAVO(obj) \
+	for (uint16_t uavo_index = 0; uavo_index < NELEMENTS(uavo_ids); uavo_index++) \
+		if (((obj) = uavo_handles[uavo_index]) != NULL)
+
 static struct pios_recursive_mutex *mutex;
 static const UAVObjMetadata defMetadata = {
 	.flags = (ACCESS_READWRITE << UAVOBJ_ACCESS_SHIFT |
@@ -178,6 +205,65 @@ static const UAVObjMetadata defMetadata = {
 
 static UAVObjStats stats;
 static new_uavo_instance_cb_t newUavObjInstanceCB;
+
+/*
+ * Instance data is protected by a per object sequence lock. Writers are
+ * serialized by the object manager mutex and increment the sequence of
+ * the object before and after changing its data. Readers copy the data
+ * without taking the mutex and only fall back to it if the sequence
+ * changed during the copy. A reader may have preempted the writer, so
+ * it must never spin waiting for the write to complete.
+ */
+static struct UAVOData * seqObject(UAVObjHandle obj_handle)
+{
+	if (UAVObjIsMetaobject(obj_handle))
+		return container_of((struct UAVOMeta *)obj_handle, struct UAVOData, metaObj);
+	else
+		return (struct UAVOData *) obj_handle;
+}
+
+static volatile uint32_t * seqCounter(UAVObjHandle obj_handle)
+{
+	return (volatile uint32_t *) ((uint8_t *) seqObject(obj_handle) + offsetof(struct UAVOData, seq));
+}
+
+static volatile uint32_t * seqUpdateTime(UAVObjHandle obj_handle)
+{
+	return (volatile uint32_t *) ((uint8_t *) seqObject(obj_handle) + offsetof(struct UAVOData, update_time));
+}
+
+static inline void seqWriteBegin(UAVObjHandle obj_handle)
+{
+	(*seqCounter(obj_handle))++;
+	__sync_synchronize();
+}
+
+static inline void seqWriteEnd(UAVObjHandle obj_handle)
+{
+	*seqUpdateTime(obj_handle) = PIOS_Thread_Systime();
+	__sync_synchronize();
+	(*seqCounter(obj_handle))++;
+}
+
+/**
+ * Take the object manager mutex, accounting for the time spent waiting
+ * for it. On RTOSes without timed recursive locks the first attempt
+ * always succeeds and no contention is recorded.
+ */
+static void lockObjects()
+{
+	if (PIOS_Recursive_Mutex_Lock(mutex, 0))
+		return;
+
+	uint32_t start = PIOS_DELAY_GetRaw();
+	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+	uint32_t waited = PIOS_DELAY_DiffuS(start);
+
+	++stats.lockContentions;
+	if (waited > stats.lockMaxWait)
+		stats.lockMaxWait = waited;
+}
+
 /**
  * Initialize the object manager
  * \return 0 Success
@@ -186,7 +272,7 @@ static new_uavo_instance_cb_t newUavObjInstanceCB;
 int32_t UAVObjInitialize()
 {
 	// Initialize variables
-	uavo_list = NULL;
+	memset(uavo_handles, 0, sizeof(uavo_handles));
 
 	memset(&stats, 0, sizeof(UAVObjStats));
 
@@ -208,7 +294,7 @@ int32_t UAVObjInitialize()
  */
 void UAVObjGetStats(UAVObjStats * statsOut)
 {
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+	lockObjects();
 	memcpy(statsOut, &stats, sizeof(UAVObjStats));
 	PIOS_Recursive_Mutex_Unlock(mutex);
 }
@@ -218,7 +304,7 @@ void UAVObjGetStats(UAVObjStats * statsOut)
  */
 void UAVObjClearStats()
 {
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+	lockObjects();
 	memset(&stats, 0, sizeof(UAVObjStats));
 	PIOS_Recursive_Mutex_Unlock(mutex);
 }
@@ -281,10 +367,10 @@ static struct UAVOData * UAVObjAllocMulti(uint32_t num_bytes)
 
 	/* Set up the type-specific part of the UAVO */
 	uavo_multi->num_instances = 1;
+	memset(uavo_multi->instance_blocks, 0, sizeof(uavo_multi->instance_blocks));
 
 	/* Clear the instance data carried in the UAVO */
-	uavo_multi->instance0.next = NULL;
-	memset (&(uavo_multi->instance0.instance), 0, num_bytes);
+	memset(&(uavo_multi->instance0), 0, num_bytes);
 
 	/* Give back the generic UAVO part */
 	return (&(uavo_multi->uavo));
@@ -311,10 +397,15 @@ UAVObjHandle UAVObjRegister(uint32_t id,
 {
 	struct UAVOData * uavo_data = NULL;
 
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+	lockObjects();
+
+	/* Only objects built into the firmware can be registered */
+	int32_t index = idIndex(id);
+	if (index < 0)
+		goto unlock_exit;
 
 	/* Don't allow duplicate registrations */
-	if (UAVObjGetByID(id))
+	if (uavo_handles[index])
 		goto unlock_exit;
 
 	/* Map the various flags to one of the UAVO types we understand */
@@ -330,6 +421,8 @@ UAVObjHandle UAVObjRegister(uint32_t id,
 	/* Fill in the details about this UAVO */
 	uavo_data->id            = id;
 	uavo_data->instance_size = num_bytes;
+	uavo_data->seq           = 0;
+	uavo_data->update_time   = 0;
 	if (isSettings) {
 		uavo_data->base.flags.isSettings = true;
 	}
@@ -337,9 +430,6 @@ UAVObjHandle UAVObjRegister(uint32_t id,
 	/* Initialize the embedded meta UAVO */
 	UAVObjInitMetaData (&uavo_data->metaObj);
 
-	/* Add the newly created object to the global list of objects */
-	LL_APPEND(uavo_list, uavo_data);
-
 	/* Initialize object fields and metadata to default values */
 	if (initCb)
 		initCb((UAVObjHandle) uavo_data, 0);
@@ -355,6 +445,10 @@ UAVObjHandle UAVObjRegister(uint32_t id,
 	UAVObjInstanceUpdated((UAVObjHandle) uavo_data, 0);
 	UAVObjInstanceUpdated((UAVObjHandle) &(uavo_data->metaObj), 0);
 
+	/* Lookups don't take the lock, only publish the object once it is complete */
+	__sync_synchronize();
+	uavo_handles[index] = uavo_data;
+
 unlock_exit:
 	PIOS_Recursive_Mutex_Unlock(mutex);
 	return (UAVObjHandle) uavo_data;
@@ -367,27 +461,16 @@ unlock_exit:
  */
 UAVObjHandle UAVObjGetByID(uint32_t id)
 {
-	UAVObjHandle * found_obj = (UAVObjHandle *) NULL;
+	int32_t index = idIndex(id);
+	if (index >= 0 && uavo_handles[index])
+		return (UAVObjHandle) uavo_handles[index];
 
-	// Get lock
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+	// Meta objects use the ID of their parent object plus one
+	index = idIndex(id - 1);
+	if (index >= 0 && uavo_handles[index])
+		return (UAVObjHandle) &(uavo_handles[index]->metaObj);
 
-	// Look for object
-	struct UAVOData * tmp_obj;
-	LL_FOREACH(uavo_list, tmp_obj) {
-		if (tmp_obj->id == id) {
-			found_obj = (UAVObjHandle *)tmp_obj;
-			goto unlock_exit;
-		}
-		if (MetaObjectId(tmp_obj->id) == id) {
-			found_obj = (UAVObjHandle *)&(tmp_obj->metaObj);
-			goto unlock_exit;
-		}
-	}
-
-unlock_exit:
-	PIOS_Recursive_Mutex_Unlock(mutex);
-	return found_obj;
+	return NULL;
 }
 
 /**
@@ -501,7 +584,7 @@ uint16_t UAVObjCreateInstance(UAVObjHandle obj_handle, UAVObjInitializeCallback
 	}
 
 	// Lock
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+	lockObjects();
 
 	InstanceHandle instEntry;
 	uint16_t instId = 0;
@@ -569,6 +652,37 @@ bool UAVObjIsSettings(UAVObjHandle obj_handle)
 	return uavo_base->flags.isSettings;
 }
 
+/**
+ * Is this object sent as a delta against its previous update?
+ * \param[in] obj The object handle
+ * \return True (1) if delta encoding is enabled for the object
+ */
+bool UAVObjIsDeltaEncoded(UAVObjHandle obj_handle)
+{
+	PIOS_Assert(obj_handle);
+
+	/* Recover the common object header */
+	struct UAVOBase * uavo_base = (struct UAVOBase *) obj_handle;
+
+	return uavo_base->flags.isDeltaEncoded;
+}
+
+/**
+ * Select if an object can be sent as a delta against its previous update,
+ * set from the object definition once the object is registered.
+ * \param[in] obj The object handle
+ * \param[in] enable True to enable delta encoding
+ */
+void UAVObjSetDeltaEncoded(UAVObjHandle obj_handle, bool enable)
+{
+	PIOS_Assert(obj_handle);
+
+	/* Recover the common object header */
+	struct UAVOBase * uavo_base = (struct UAVOBase *) obj_handle;
+
+	uavo_base->flags.isDeltaEncoded = enable;
+}
+
 /**
  * Unpack an object from a byte array
  * \param[in] obj The object handle
@@ -582,7 +696,7 @@ int32_t UAVObjUnpack(UAVObjHandle obj_handle, uint16_t instId,
 	PIOS_Assert(obj_handle);
 
 	// Lock
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+	lockObjects();
 
 	int32_t rc = -1;
 
@@ -590,7 +704,9 @@ int32_t UAVObjUnpack(UAVObjHandle obj_handle, uint16_t instId,
 		if (instId != 0) {
 			goto unlock_exit;
 		}
+		seqWriteBegin(obj_handle);
 		memcpy(MetaDataPtr((struct UAVOMeta *)obj_handle), dataIn, MetaNumBytes);
+		seqWriteEnd(obj_handle);
 	} else {
 		struct UAVOData *obj;
 		InstanceHandle instEntry;
@@ -609,7 +725,9 @@ int32_t UAVObjUnpack(UAVObjHandle obj_handle, uint16_t instId,
 			}
 		}
 		// Set the data
+		seqWriteBegin(obj_handle);
 		memcpy(InstanceData(instEntry), dataIn, obj->instance_size);
+		seqWriteEnd(obj_handle);
 	}
 
 	// Fire event
@@ -632,37 +750,7 @@ int32_t UAVObjPack(UAVObjHandle obj_handle, uint16_t instId, uint8_t * dataOut)
 {
 	PIOS_Assert(obj_handle);
 
-	// Lock
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
-
-	int32_t rc = -1;
-
-	if (UAVObjIsMetaobject(obj_handle)) {
-		if (instId != 0) {
-			goto unlock_exit;
-		}
-		memcpy(dataOut, MetaDataPtr((struct UAVOMeta *)obj_handle), MetaNumBytes);
-	} else {
-		struct UAVOData *obj;
-		InstanceHandle instEntry;
-
-		// Cast handle to object
-		obj = (struct UAVOData *) obj_handle;
-
-		// Get the instance
-		instEntry = getInstance(obj, instId);
-		if (instEntry == NULL) {
-			goto unlock_exit;
-		}
-		// Pack data
-		memcpy(dataOut, InstanceData(instEntry), obj->instance_size);
-	}
-
-	rc = 0;
-
-unlock_exit:
-	PIOS_Recursive_Mutex_Unlock(mutex);
-	return rc;
+	return readInstance(obj_handle, instId, dataOut, 0, UAVObjGetNumBytes(obj_handle));
 }
 
 #if defined(PIOS_INCLUDE_FASTHEAP)
@@ -777,6 +865,9 @@ int32_t UAVObjLoad(UAVObjHandle obj_handle, uint16_t instId)
 		if (instId != 0)
 			return -1;
 
+		lockObjects();
+		seqWriteBegin(obj_handle);
+
 		// Load the object from the filesystem
 		int32_t rc;
 #if defined(PIOS_INCLUDE_FASTHEAP)
@@ -793,13 +884,16 @@ int32_t UAVObjLoad(UAVObjHandle obj_handle, uint16_t instId)
 					UAVObjGetNumBytes(obj_handle));
 #endif  /* PIOS_INCLUDE_FASTHEAP */
 
-		if (rc != 0)
-			return -1;
-
 #if defined(PIOS_INCLUDE_FASTHEAP)
-		memcpy(MetaDataPtr((struct UAVOMeta *)obj_handle), uavobj_load_trampoline, UAVObjGetNumBytes(obj_handle));
+		if (rc == 0)
+			memcpy(MetaDataPtr((struct UAVOMeta *)obj_handle), uavobj_load_trampoline, UAVObjGetNumBytes(obj_handle));
 #endif  /* PIOS_INCLUDE_FASTHEAP */
 
+		seqWriteEnd(obj_handle);
+		PIOS_Recursive_Mutex_Unlock(mutex);
+
+		if (rc != 0)
+			return -1;
 	} else {
 
 		InstanceHandle instEntry = getInstance( (struct UAVOData *)obj_handle, instId);
@@ -807,6 +901,9 @@ int32_t UAVObjLoad(UAVObjHandle obj_handle, uint16_t instId)
 		if (instEntry == NULL)
 			return -1;
 
+		lockObjects();
+		seqWriteBegin(obj_handle);
+
 		// Load the object from the filesystem
 		int32_t rc;
 #if defined(PIOS_INCLUDE_FASTHEAP)
@@ -823,13 +920,16 @@ int32_t UAVObjLoad(UAVObjHandle obj_handle, uint16_t instId)
 					UAVObjGetNumBytes(obj_handle));
 #endif  /* PIOS_INCLUDE_FASTHEAP */
 
-		if (rc != 0)
-			return -1;
-
 #if defined(PIOS_INCLUDE_FASTHEAP)
-		memcpy(InstanceData(instEntry), uavobj_load_trampoline, UAVObjGetNumBytes(obj_handle));
+		if (rc == 0)
+			memcpy(InstanceData(instEntry), uavobj_load_trampoline, UAVObjGetNumBytes(obj_handle));
 #endif  /* PIOS_INCLUDE_FASTHEAP */
 
+		seqWriteEnd(obj_handle);
+		PIOS_Recursive_Mutex_Unlock(mutex);
+
+		if (rc != 0)
+			return -1;
 	}
 
 	sendEvent((struct UAVOBase*)obj_handle, instId, EV_UNPACKED);
@@ -858,12 +958,12 @@ int32_t UAVObjSaveSettings()
 	struct UAVOData *obj;
 
 	// Get lock
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+	lockObjects();
 
 	int32_t rc = -1;
 
 	// Save all settings objects
-	LL_FOREACH(uavo_list, obj) {
+	FOREACH_UAVO(obj) {
 		// Check if this is a settings object
 		if (UAVObjIsSettings(obj)) {
 			// Save object
@@ -890,12 +990,12 @@ int32_t UAVObjLoadSettings()
 	struct UAVOData *obj;
 
 	// Get lock
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+	lockObjects();
 
 	int32_t rc = -1;
 
 	// Load all settings objects
-	LL_FOREACH(uavo_list, obj) {
+	FOREACH_UAVO(obj) {
 		// Check if this is a settings object
 		if (UAVObjIsSettings(obj)) {
 			// Load object
@@ -922,12 +1022,12 @@ int32_t UAVObjDeleteSettings()
 	struct UAVOData *obj;
 
 	// Get lock
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+	lockObjects();
 
 	int32_t rc = -1;
 
 	// Save all settings objects
-	LL_FOREACH(uavo_list, obj) {
+	FOREACH_UAVO(obj) {
 		// Check if this is a settings object
 		if (UAVObjIsSettings(obj)) {
 			// Save object
@@ -954,12 +1054,12 @@ int32_t UAVObjSaveMetaobjects()
 	struct UAVOData *obj;
 
 	// Get lock
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+	lockObjects();
 
 	int32_t rc = -1;
 
 	// Save all settings objects
-	LL_FOREACH(uavo_list, obj) {
+	FOREACH_UAVO(obj) {
 		// Save object
 		if (UAVObjSave( (UAVObjHandle) MetaObjectPtr(obj), 0) ==
 			-1) {
@@ -983,12 +1083,12 @@ int32_t UAVObjLoadMetaobjects()
 	struct UAVOData *obj;
 
 	// Get lock
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+	lockObjects();
 
 	int32_t rc = -1;
 
 	// Load all settings objects
-	LL_FOREACH(uavo_list, obj) {
+	FOREACH_UAVO(obj) {
 		// Load object
 		if (UAVObjLoad((UAVObjHandle) MetaObjectPtr(obj), 0) ==
 			-1) {
@@ -1012,12 +1112,12 @@ int32_t UAVObjDeleteMetaobjects()
 	struct UAVOData *obj;
 
 	// Get lock
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+	lockObjects();
 
 	int32_t rc = -1;
 
 	// Load all settings objects
-	LL_FOREACH(uavo_list, obj) {
+	FOREACH_UAVO(obj) {
 		// Load object
 		if (UAVObjDeleteById(UAVObjGetID(MetaObjectPtr(obj)), 0)
 			== -1) {
@@ -1089,7 +1189,7 @@ int32_t UAVObjSetInstanceData(UAVObjHandle obj_handle, uint16_t instId,
 	PIOS_Assert(obj_handle);
 
 	// Lock
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+	lockObjects();
 
 	int32_t rc = -1;
 
@@ -1097,7 +1197,9 @@ int32_t UAVObjSetInstanceData(UAVObjHandle obj_handle, uint16_t instId,
 		if (instId != 0) {
 			goto unlock_exit;
 		}
+		seqWriteBegin(obj_handle);
 		memcpy(MetaDataPtr((struct UAVOMeta *)obj_handle), dataIn, MetaNumBytes);
+		seqWriteEnd(obj_handle);
 	} else {
 		struct UAVOData *obj;
 		InstanceHandle instEntry;
@@ -1115,7 +1217,9 @@ int32_t UAVObjSetInstanceData(UAVObjHandle obj_handle, uint16_t instId,
 			goto unlock_exit;
 		}
 		// Set data
+		seqWriteBegin(obj_handle);
 		memcpy(InstanceData(instEntry), dataIn, obj->instance_size);
+		seqWriteEnd(obj_handle);
 	}
 
 	// Fire event
@@ -1139,7 +1243,7 @@ int32_t UAVObjSetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, con
 	PIOS_Assert(obj_handle);
 
 	// Lock
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+	lockObjects();
 
 	int32_t rc = -1;
 
@@ -1155,7 +1259,9 @@ int32_t UAVObjSetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, con
 		}
 
 		// Set data
+		seqWriteBegin(obj_handle);
 		memcpy(MetaDataPtr((struct UAVOMeta *)obj_handle) + offset, dataIn, size);
+		seqWriteEnd(obj_handle);
 	} else {
 		struct UAVOData * obj;
 		InstanceHandle instEntry;
@@ -1180,7 +1286,9 @@ int32_t UAVObjSetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, con
 		}
 
 		// Set data
+		seqWriteBegin(obj_handle);
 		memcpy(InstanceData(instEntry) + offset, dataIn, size);
+		seqWriteEnd(obj_handle);
 	}
 
 
@@ -1205,39 +1313,7 @@ int32_t UAVObjGetInstanceData(UAVObjHandle obj_handle, uint16_t instId,
 {
 	PIOS_Assert(obj_handle);
 
-	// Lock
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
-
-	int32_t rc = -1;
-
-	if (UAVObjIsMetaobject(obj_handle)) {
-		// Get instance information
-		if (instId != 0) {
-			goto unlock_exit;
-		}
-		// Set data
-		memcpy(dataOut, MetaDataPtr((struct UAVOMeta *)obj_handle), MetaNumBytes);
-	} else {
-		struct UAVOData *obj;
-		InstanceHandle instEntry;
-
-		// Cast to object info
-		obj = (struct UAVOData *) obj_handle;
-
-		// Get instance information
-		instEntry = getInstance(obj, instId);
-		if (instEntry == NULL) {
-			goto unlock_exit;
-		}
-		// Set data
-		memcpy(dataOut, InstanceData(instEntry), obj->instance_size);
-	}
-
-	rc = 0;
-
-unlock_exit:
-	PIOS_Recursive_Mutex_Unlock(mutex);
-	return rc;
+	return readInstance(obj_handle, instId, dataOut, 0, UAVObjGetNumBytes(obj_handle));
 }
 
 /**
@@ -1251,51 +1327,7 @@ int32_t UAVObjGetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, voi
 {
 	PIOS_Assert(obj_handle);
 
-	// Lock
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
-
-	int32_t rc = -1;
-
-	if (UAVObjIsMetaobject(obj_handle)) {
-		// Get instance information
-		if (instId != 0) {
-			goto unlock_exit;
-		}
-
-		// Check for overrun
-		if ((size + offset) > MetaNumBytes) {
-			goto unlock_exit;
-		}
-
-		// Set data
-		memcpy(dataOut, MetaDataPtr((struct UAVOMeta *)obj_handle) + offset, size);
-	} else {
-		struct UAVOData * obj;
-		InstanceHandle instEntry;
-
-		// Cast to object info
-		obj = (struct UAVOData *)obj_handle;
-
-		// Get instance information
-		instEntry = getInstance(obj, instId);
-		if (instEntry == NULL) {
-			goto unlock_exit;
-		}
-
-		// Check for overrun
-		if ((size + offset) > obj->instance_size) {
-			goto unlock_exit;
-		}
-		
-		// Set data
-		memcpy(dataOut, InstanceData(instEntry) + offset, size);
-	}
-
-	rc = 0;
-
-unlock_exit:
-	PIOS_Recursive_Mutex_Unlock(mutex);
-	return rc;
+	return readInstance(obj_handle, instId, dataOut, offset, size);
 }
 
 /**
@@ -1313,7 +1345,7 @@ int32_t UAVObjSetMetadata(UAVObjHandle obj_handle, const UAVObjMetadata * dataIn
 		return -1;
 	}
 
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+	lockObjects();
 
 	UAVObjSetData((UAVObjHandle) MetaObjectPtr((struct UAVOData *)obj_handle), dataIn);
 
@@ -1331,9 +1363,6 @@ int32_t UAVObjGetMetadata(UAVObjHandle obj_handle, UAVObjMetadata * dataOut)
 {
 	PIOS_Assert(obj_handle);
 
-	// Lock
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
-
 	// Get metadata
 	if (UAVObjIsMetaobject(obj_handle)) {
 		memcpy(dataOut, &defMetadata, sizeof(UAVObjMetadata));
@@ -1342,8 +1371,6 @@ int32_t UAVObjGetMetadata(UAVObjHandle obj_handle, UAVObjMetadata * dataOut)
 			dataOut);
 	}
 
-	// Unlock
-	PIOS_Recursive_Mutex_Unlock(mutex);
 	return 0;
 }
 
@@ -1492,6 +1519,41 @@ int8_t UAVObjReadOnly(UAVObjHandle obj_handle)
 	return -1;
 }
 
+/**
+ * Get the time of the last write to the data of an object or to its
+ * metadata, without waiting for the object manager lock. The writes are
+ * told apart by the sequence, which grows by two with each of them.
+ * \param[in] obj_handle The object handle
+ * \param[out] seq The sequence of the last write
+ * \return The time of the last write (ms)
+ */
+uint32_t UAVObjGetUpdateTime(UAVObjHandle obj_handle, uint32_t *seq)
+{
+	PIOS_Assert(obj_handle);
+
+	volatile uint32_t *counter = seqCounter(obj_handle);
+	volatile uint32_t *updateTime = seqUpdateTime(obj_handle);
+
+	uint32_t first = *counter;
+	__sync_synchronize();
+	uint32_t time = *updateTime;
+	__sync_synchronize();
+
+	if ((first & 1) == 0 && *counter == first) {
+		*seq = first;
+		return time;
+	}
+
+	// Raced with a writer, which holds the lock for the whole update
+	lockObjects();
+	++stats.readRetries;
+	*seq = *counter;
+	time = *updateTime;
+	PIOS_Recursive_Mutex_Unlock(mutex);
+
+	return time;
+}
+
 /**
  * Connect an event queue to the object, if the queue is already connected then the event mask is only updated.
  * All events matching the event mask will be pushed to the event queue.
@@ -1506,7 +1568,7 @@ int32_t UAVObjConnectQueue(UAVObjHandle obj_handle, struct pios_queue *queue,
 	PIOS_Assert(obj_handle);
 	PIOS_Assert(queue);
 	int32_t res;
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+	lockObjects();
 	res = connectObj(obj_handle, queue, 0, eventMask);
 	PIOS_Recursive_Mutex_Unlock(mutex);
 	return res;
@@ -1523,7 +1585,7 @@ int32_t UAVObjDisconnectQueue(UAVObjHandle obj_handle, struct pios_queue *queue)
 	PIOS_Assert(obj_handle);
 	PIOS_Assert(queue);
 	int32_t res;
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+	lockObjects();
 	res = disconnectObj(obj_handle, queue, 0);
 	PIOS_Recursive_Mutex_Unlock(mutex);
 	return res;
@@ -1542,7 +1604,7 @@ int32_t UAVObjConnectCallback(UAVObjHandle obj_handle, UAVObjEventCallback cb,
 {
 	PIOS_Assert(obj_handle);
 	int32_t res;
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+	lockObjects();
 	res = connectObj(obj_handle, 0, cb, eventMask);
 	PIOS_Recursive_Mutex_Unlock(mutex);
 	return res;
@@ -1558,7 +1620,7 @@ int32_t UAVObjDisconnectCallback(UAVObjHandle obj_handle, UAVObjEventCallback cb
 {
 	PIOS_Assert(obj_handle);
 	int32_t res;
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+	lockObjects();
 	res = disconnectObj(obj_handle, 0, cb);
 	PIOS_Recursive_Mutex_Unlock(mutex);
 	return res;
@@ -1583,7 +1645,7 @@ void UAVObjRequestUpdate(UAVObjHandle obj_handle)
 void UAVObjRequestInstanceUpdate(UAVObjHandle obj_handle, uint16_t instId)
 {
 	PIOS_Assert(obj_handle);
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+	lockObjects();
 	sendEvent((struct UAVOBase *) obj_handle, instId, EV_UPDATE_REQ);
 	PIOS_Recursive_Mutex_Unlock(mutex);
 }
@@ -1605,7 +1667,7 @@ void UAVObjUpdated(UAVObjHandle obj_handle)
 void UAVObjInstanceUpdated(UAVObjHandle obj_handle, uint16_t instId)
 {
 	PIOS_Assert(obj_handle);
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+	lockObjects();
 	sendEvent((struct UAVOBase *) obj_handle, instId, EV_UPDATED_MANUAL);
 	PIOS_Recursive_Mutex_Unlock(mutex);
 }
@@ -1620,11 +1682,11 @@ void UAVObjIterate(void (*iterator) (UAVObjHandle obj))
 	PIOS_Assert(iterator);
 
 	// Get lock
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+	lockObjects();
 
 	// Iterate through the list and invoke iterator for each object
 	struct UAVOData *obj;
-	LL_FOREACH(uavo_list, obj) {
+	FOREACH_UAVO(obj) {
 		(*iterator) ((UAVObjHandle) obj);
 		(*iterator) ((UAVObjHandle) &obj->metaObj);
 	}
@@ -1679,7 +1741,7 @@ static int32_t sendEvent(struct UAVOBase * obj, uint16_t instId,
  */
 static InstanceHandle createInstance(struct UAVOData * obj, uint16_t instId)
 {
-	struct UAVOMultiInst *instEntry;
+	struct UAVOMulti *uavo_multi = (struct UAVOMulti *) obj;
 
 	/* Don't allow more than one instance for single instance objects */
 	if (UAVObjIsSingleInstance(&(obj->base))) {
@@ -1704,14 +1766,21 @@ static InstanceHandle createInstance(struct UAVOData * obj, uint16_t instId)
 		}
 	}
 
-	/* Create the actual instance */
-	instEntry = (struct UAVOMultiInst *) PIOS_malloc_no_dma(sizeof(struct UAVOMultiInst)+obj->instance_size);
-	if (!instEntry)
-		return NULL;
-	memset(InstanceDataOffset(instEntry), 0, obj->instance_size);
-	LL_APPEND(( (struct UAVOMulti*)obj )->instance0.next, instEntry);
+	/* Allocate the whole block on its first instance, instance 0 is never created here */
+	uint8_t block = InstanceBlock(instId);
+	uint16_t blockStart = 1 << block;
+	if (instId == blockStart) {
+		uint32_t blockSize = (uint32_t) blockStart * obj->instance_size;
+		uint8_t *blockData = (uint8_t *) PIOS_malloc_no_dma(blockSize);
+		if (!blockData)
+			return NULL;
+		memset(blockData, 0, blockSize);
+		uavo_multi->instance_blocks[block] = blockData;
+	}
 
-	( (struct UAVOMulti*)obj )->num_instances++;
+	// Readers look up instances without the lock, publish the block first
+	__sync_synchronize();
+	uavo_multi->num_instances++;
 
 	// Fire event
 	UAVObjInstanceUpdated((UAVObjHandle) obj, instId);
@@ -1720,7 +1789,7 @@ static InstanceHandle createInstance(struct UAVOData * obj, uint16_t instId)
 	if (newUavObjInstanceCB) {
 		newUavObjInstanceCB(obj->id, UAVObjGetNumInstances(obj));
 	}
-	return InstanceDataOffset(instEntry);
+	return getInstance(obj, instId);
 }
 
 /**
@@ -1754,18 +1823,80 @@ static InstanceHandle getInstance(struct UAVOData * obj, uint16_t instId)
 		if (instId >= uavo_multi->num_instances)
 			return NULL;
 
-		// Look for specified instance ID
-		uint16_t instance = 0;
-		struct UAVOMultiInst *instEntry;
-		LL_FOREACH(&(uavo_multi->instance0), instEntry) {
-			if (instance++ == instId) {
-				/* Found it */
-				return &(instEntry->instance);
-			}
+		if (instId == 0)
+			return (&(uavo_multi->instance0));
+
+		uint8_t block = InstanceBlock(instId);
+		return uavo_multi->instance_blocks[block] + (instId - (1 << block)) * obj->instance_size;
+	}
+}
+
+/**
+ * Find the position of an object in the ID table
+ * \return The index in uavo_ids[] or -1 if the ID is not in the table
+ */
+static int32_t idIndex(uint32_t id)
+{
+	int32_t low = 0;
+	int32_t high = NELEMENTS(uavo_ids) - 1;
+
+	while (low <= high) {
+		int32_t mid = (low + high) / 2;
+
+		if (uavo_ids[mid] < id)
+			low = mid + 1;
+		else if (uavo_ids[mid] > id)
+			high = mid - 1;
+		else
+			return mid;
+	}
+
+	return -1;
+}
+
+/**
+ * Copy (part of) the data of an instance without blocking on writers
+ * \param[in] obj The object handle
+ * \param[in] instId The object instance ID
+ * \param[out] dataOut Destination of the copy
+ * \param[in] offset Offset of the copy in the instance data
+ * \param[in] size Number of bytes to copy
+ * \return 0 if success or -1 if the instance does not exist or the copy is out of range
+ */
+static int32_t readInstance(UAVObjHandle obj_handle, uint16_t instId,
+			void *dataOut, uint32_t offset, uint32_t size)
+{
+	// Instances are never removed, so the pointer stays valid without the lock
+	uint8_t *instData = (uint8_t *) getInstance((struct UAVOData *) obj_handle, instId);
+	if (instData == NULL) {
+		return -1;
+	}
+
+	// Check for overrun
+	if ((size + offset) > UAVObjGetNumBytes(obj_handle)) {
+		return -1;
+	}
+
+	volatile uint32_t *counter = seqCounter(obj_handle);
+	uint32_t seq = *counter;
+	__sync_synchronize();
+
+	if ((seq & 1) == 0) {
+		memcpy(dataOut, instData + offset, size);
+		__sync_synchronize();
+
+		if (*counter == seq) {
+			return 0;
 		}
-		/* Instance was not found */
-		return NULL;
 	}
+
+	// Raced with a writer, which holds the lock for the whole update
+	lockObjects();
+	++stats.readRetries;
+	memcpy(dataOut, instData + offset, size);
+	PIOS_Recursive_Mutex_Unlock(mutex);
+
+	return 0;
 }
 
 /**
@@ -1869,11 +2000,11 @@ uint8_t UAVObjCount()
 {
 	uint8_t count = 0;
 	// Get lock
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+	lockObjects();
 
 	// Look for object
 	struct UAVOData * tmp_obj;
-	LL_FOREACH(uavo_list, tmp_obj) {
+	FOREACH_UAVO(tmp_obj) {
 		++count;
 	}
 
@@ -1890,11 +2021,11 @@ uint32_t UAVObjIDByIndex(uint8_t index)
 {
 	uint8_t count = 0;
 	// Get lock
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+	lockObjects();
 
 	// Look for object
 	struct UAVOData * tmp_obj;
-	LL_FOREACH(uavo_list, tmp_obj) {
+	FOREACH_UAVO(tmp_obj) {
 		if (count == index)
 		{
 			// Release lock
@@ -58,6 +58,7 @@ int32_t $(NAME)Initialize(void)
 	// Done
 	if (handle != 0)
 	{
+		UAVObjSetDeltaEncoded(handle, $(NAMEUC)_ISDELTAENCODED);
 		return 0;
 	}
 	else
@@ -44,6 +44,7 @@ typedef struct {
     uint32_t txObjects;
     uint32_t txErrors;
     uint32_t rxErrors;
+    uint32_t txRetries;
 } UAVTalkStats;
 
 typedef void* UAVTalkConnection;
@@ -56,7 +57,14 @@ int32_t UAVTalkSetOutputStream(UAVTalkConnection connection, UAVTalkOutputStream
 UAVTalkOutputStream UAVTalkGetOutputStream(UAVTalkConnection connection);
 int32_t UAVTalkSendObject(UAVTalkConnection connection, UAVObjHandle obj, uint16_t instId, uint8_t acked, int32_t timeoutMs);
 int32_t UAVTalkSendObjectTimestamped(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId, uint8_t acked, int32_t timeoutMs);
+int32_t UAVTalkSendObjectAtTime(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId, uint32_t timeMs);
 int32_t UAVTalkSendObjectRequest(UAVTalkConnection connection, UAVObjHandle obj, uint16_t instId, int32_t timeoutMs);
+int32_t UAVTalkSendObjectWindowed(UAVTalkConnection connection, UAVObjHandle obj, uint16_t instId, uint8_t acked, uint16_t timeoutMs, uint8_t retries);
+int32_t UAVTalkSendObjectRequestWindowed(UAVTalkConnection connection, UAVObjHandle obj, uint16_t instId, uint16_t timeoutMs, uint8_t retries);
+int32_t UAVTalkProcessPendingTransactions(UAVTalkConnection connection);
+int32_t UAVTalkSetBatching(UAVTalkConnection connection, bool enable);
+int32_t UAVTalkFlush(UAVTalkConnection connection);
+int32_t UAVTalkSetDeltaEncoding(UAVTalkConnection connection, bool enable);
 int32_t UAVTalkSendAck(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId);
 int32_t UAVTalkSendNack(UAVTalkConnection connectionHandle, uint32_t objId);
 int32_t UAVTalkSendBuf(UAVTalkConnection connectionHandle, uint8_t *buf, uint16_t len);
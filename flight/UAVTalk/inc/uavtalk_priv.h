@@ -63,6 +63,28 @@ typedef uint8_t uavtalk_checksum;
 #define UAVTALK_MIN_PACKET_LENGTH       UAVTALK_MAX_HEADER_LENGTH + UAVTALK_CHECKSUM_LENGTH
 #define UAVTALK_MAX_PACKET_LENGTH       UAVTALK_MIN_PACKET_LENGTH + UAVTALK_MAX_PAYLOAD_LENGTH
 
+//! Batched frames carry records of an object ID and a length byte followed by the
+//! instance ID (multi instance objects only) and the object data
+#define UAVTALK_BATCH_RECORD_HEADER_LENGTH 5
+#define UAVTALK_MAX_BATCH_LENGTH        (UAVTALK_MAX_PAYLOAD_LENGTH - 1 < 255 ? UAVTALK_MAX_PAYLOAD_LENGTH - 1 : 255)
+
+//! Deltas start with the CRC of the update they apply to and the CRC of the result,
+//! followed by runs of unchanged bytes and runs of changed bytes XORed with the previous update
+#define UAVTALK_DELTA_HEADER_LENGTH     2
+#define UAVTALK_DELTA_RUN_UNCHANGED     0x80
+#define UAVTALK_DELTA_MAX_RUN           128
+
+//! Unacked deltas are interleaved with full updates so that a receiver which missed
+//! one (or a log which is read from the middle) catches up again
+#ifndef UAVTALK_DELTA_KEYFRAME_INTERVAL
+#define UAVTALK_DELTA_KEYFRAME_INTERVAL 16
+#endif
+
+//! Number of acknowledged transactions that can be outstanding on a connection
+#ifndef UAVTALK_ACK_WINDOW
+#define UAVTALK_ACK_WINDOW              4
+#endif
+
 //! State information for the UAVTalk parser
 typedef struct {
     UAVObjHandle obj;
@@ -80,6 +102,27 @@ typedef struct {
     uint16_t rxPacketLength;
 } UAVTalkInputProcessor;
 
+//! An acknowledged transaction waiting for its ACK (or OBJ for a request)
+typedef struct {
+	UAVObjHandle obj;
+	uint32_t deadline;
+	uint16_t instId;
+	uint16_t timeoutMs;
+	uint8_t type;
+	uint8_t retriesLeft;
+} UAVTalkPendingTransaction;
+
+//! Last update sent of a delta encoded object instance
+typedef struct UAVTalkDeltaRef {
+	struct UAVTalkDeltaRef *next;
+	UAVObjHandle obj;
+	uint16_t instId;
+	uint8_t sinceFull;
+	bool valid;
+	bool sentDelta;
+	uint8_t data[];
+} UAVTalkDeltaRef;
+
 //! Information for the physical link
 typedef struct {
     uint8_t canari;
@@ -89,11 +132,21 @@ typedef struct {
     struct pios_semaphore *respSema;
     UAVObjHandle respObj;
     uint16_t respInstId;
+    struct pios_semaphore *windowSema;
+    UAVTalkPendingTransaction pending[UAVTALK_ACK_WINDOW];
+    uint8_t numPending;
     UAVTalkStats stats;
     UAVTalkInputProcessor iproc;
     uint8_t *rxBuffer;
     uint32_t txSize;
     uint8_t *txBuffer;
+    bool batching;
+    uint16_t batchLength;
+    uint8_t *batchBuffer;
+    bool deltaEncoding;
+    uint8_t *deltaBuffer;
+    uint8_t *rxDeltaBuffer;
+    UAVTalkDeltaRef *deltaRefs;
 } UAVTalkConnectionData;
 
 #define UAVTALK_CANARI         0xCA
@@ -108,8 +161,12 @@ typedef struct {
 #define UAVTALK_TYPE_OBJ_ACK   (UAVTALK_TYPE_VER | 0x02)
 #define UAVTALK_TYPE_ACK       (UAVTALK_TYPE_VER | 0x03)
 #define UAVTALK_TYPE_NACK      (UAVTALK_TYPE_VER | 0x04)
+#define UAVTALK_TYPE_OBJ_BATCH (UAVTALK_TYPE_VER | 0x05)
+#define UAVTALK_TYPE_OBJ_DELTA (UAVTALK_TYPE_VER | 0x06)
+#define UAVTALK_TYPE_OBJ_ACK_DELTA (UAVTALK_TYPE_VER | 0x07)
 #define UAVTALK_TYPE_OBJ_TS       (UAVTALK_TIMESTAMPED | UAVTALK_TYPE_OBJ)
 #define UAVTALK_TYPE_OBJ_ACK_TS   (UAVTALK_TIMESTAMPED | UAVTALK_TYPE_OBJ_ACK)
+#define UAVTALK_TYPE_OBJ_DELTA_TS (UAVTALK_TIMESTAMPED | UAVTALK_TYPE_OBJ_DELTA)
 
 //macros
 #define CHECKCONHANDLE(handle,variable,failcommand) \
@@ -40,11 +40,21 @@
 
 // Private functions
 static int32_t objectTransaction(UAVTalkConnectionData *connection, UAVObjHandle objectId, uint16_t instId, uint8_t type, int32_t timeout);
+static int32_t windowedTransaction(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t type, uint16_t timeoutMs, uint8_t retries);
+static int32_t processPending(UAVTalkConnectionData *connection);
+static void removePending(UAVTalkConnectionData *connection, uint32_t idx);
 static int32_t sendObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t type);
-static int32_t sendSingleObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t type);
+static int32_t sendSingleObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t type, uint32_t time);
 static int32_t sendNack(UAVTalkConnectionData *connection, uint32_t objId);
+static int32_t appendBatch(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId);
+static int32_t flushBatch(UAVTalkConnectionData *connection);
+static int32_t receiveBatch(UAVTalkConnectionData *connection, uint8_t* data, int32_t length);
+static int32_t packDelta(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t *type, uint8_t *dataOut);
+static int32_t receiveDelta(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t* data, int32_t length);
+static void resetDelta(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId);
+static void resendFull(UAVTalkConnectionData *connection, UAVObjHandle obj);
 static int32_t receiveObject(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId, uint8_t* data, int32_t length);
-static void updateAck(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId);
+static void updateAck(UAVTalkConnectionData *connection, uint8_t type, UAVObjHandle obj, uint16_t instId);
 
 /**
  * Initialize the UAVTalk library
@@ -73,6 +83,16 @@ UAVTalkConnection UAVTalkInitialize(UAVTalkOutputStream outputStream)
 	if (!connection->txBuffer) return 0;
 	connection->respSema = PIOS_Semaphore_Create();
 	PIOS_Semaphore_Take(connection->respSema, 0); // reset to zero
+	connection->windowSema = PIOS_Semaphore_Create();
+	PIOS_Semaphore_Take(connection->windowSema, 0); // reset to zero
+	connection->numPending = 0;
+	connection->batching = false;
+	connection->batchLength = 0;
+	connection->batchBuffer = NULL;
+	connection->deltaEncoding = false;
+	connection->deltaBuffer = NULL;
+	connection->rxDeltaBuffer = NULL;
+	connection->deltaRefs = NULL;
 	UAVTalkResetStats( (UAVTalkConnection) connection );
 	return (UAVTalkConnection) connection;
 }
@@ -103,6 +123,103 @@ int32_t UAVTalkSetOutputStream(UAVTalkConnection connectionHandle, UAVTalkOutput
 
 }
 
+/**
+ * Select if unacked objects are batched into shared frames. Batched objects
+ * are only sent once a frame is full, another message is sent or
+ * \ref UAVTalkFlush is called, so the caller must flush when it runs out of
+ * objects to send. Only enable this when the other end supports batched frames.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] enable Batch objects if true
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSetBatching(UAVTalkConnection connectionHandle, bool enable)
+{
+	UAVTalkConnectionData *connection;
+	CHECKCONHANDLE(connectionHandle,connection,return -1);
+
+	// Lock
+	PIOS_Recursive_Mutex_Lock(connection->lock, PIOS_MUTEX_TIMEOUT_MAX);
+
+	int32_t ret = 0;
+	if (enable && connection->batchBuffer == NULL) {
+		// Only connections that ever batch pay for the buffer
+		connection->batchBuffer = PIOS_malloc(UAVTALK_MIN_HEADER_LENGTH + UAVTALK_MAX_BATCH_LENGTH + UAVTALK_CHECKSUM_LENGTH);
+		if (connection->batchBuffer == NULL)
+			ret = -1;
+	}
+
+	if (ret == 0) {
+		flushBatch(connection);
+		connection->batching = enable;
+	}
+
+	// Release lock
+	PIOS_Recursive_Mutex_Unlock(connection->lock);
+
+	return ret;
+}
+
+/**
+ * Send the objects waiting in a batched frame
+ * \param[in] connection UAVTalkConnection to be used
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkFlush(UAVTalkConnection connectionHandle)
+{
+	UAVTalkConnectionData *connection;
+	CHECKCONHANDLE(connectionHandle,connection,return -1);
+
+	// Lock
+	PIOS_Recursive_Mutex_Lock(connection->lock, PIOS_MUTEX_TIMEOUT_MAX);
+
+	int32_t ret = flushBatch(connection);
+
+	// Release lock
+	PIOS_Recursive_Mutex_Unlock(connection->lock);
+
+	return ret;
+}
+
+/**
+ * Select if updates of delta encoded objects (see \ref UAVObjIsDeltaEncoded) are
+ * sent as a delta against the previous update of the same instance. The connection
+ * keeps a copy of the last update of every such instance it sends. Only enable this
+ * when the other end supports deltas. Every call starts all instances over from a
+ * full update, e.g. when the other end or the log file changes.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] enable Send deltas if true
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSetDeltaEncoding(UAVTalkConnection connectionHandle, bool enable)
+{
+	UAVTalkConnectionData *connection;
+	CHECKCONHANDLE(connectionHandle,connection,return -1);
+
+	// Lock
+	PIOS_Recursive_Mutex_Lock(connection->lock, PIOS_MUTEX_TIMEOUT_MAX);
+
+	int32_t ret = 0;
+	if (enable && connection->deltaBuffer == NULL) {
+		// Only connections that ever send deltas pay for the buffer
+		connection->deltaBuffer = PIOS_malloc(UAVOBJECTS_LARGEST);
+		if (connection->deltaBuffer == NULL)
+			ret = -1;
+	}
+
+	if (ret == 0) {
+		resetDelta(connection, NULL, UAVOBJ_ALL_INSTANCES);
+		connection->deltaEncoding = enable;
+	}
+
+	// Release lock
+	PIOS_Recursive_Mutex_Unlock(connection->lock);
+
+	return ret;
+}
+
 /**
  * Get current output stream
  * \param[in] connection UAVTalkConnection to be used
@@ -234,6 +351,31 @@ int32_t UAVTalkSendObjectTimestamped(UAVTalkConnection connectionHandle, UAVObjH
 	}
 }
 
+/**
+ * Send an instance of an object through the telemetry link, timestamped with
+ * the time it was updated rather than the time it is sent. No ack is requested.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object to send
+ * \param[in] instId The instance ID (can NOT be UAVOBJ_ALL_INSTANCES)
+ * \param[in] timeMs The timestamp (ms)
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSendObjectAtTime(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId, uint32_t timeMs)
+{
+	UAVTalkConnectionData *connection;
+	CHECKCONHANDLE(connectionHandle,connection,return -1);
+
+	if (instId == UAVOBJ_ALL_INSTANCES)
+		return -1;
+
+	PIOS_Recursive_Mutex_Lock(connection->lock, PIOS_MUTEX_TIMEOUT_MAX);
+	int32_t ret = sendSingleObject(connection, obj, instId, UAVTALK_TYPE_OBJ_TS, timeMs);
+	PIOS_Recursive_Mutex_Unlock(connection->lock);
+
+	return ret;
+}
+
 /**
  * Execute the requested transaction on an object.
  * \param[in] connection UAVTalkConnection to be used
@@ -293,6 +435,176 @@ static int32_t objectTransaction(UAVTalkConnectionData *connection, UAVObjHandle
 	}
 }
 
+/**
+ * Send the specified object through the telemetry link without waiting for the ack.
+ * Up to UAVTALK_ACK_WINDOW acked objects can be outstanding on a connection, the
+ * call only blocks when all of them are in use. Missing acks are handled by
+ * \ref UAVTalkProcessPendingTransactions which must be called regularly.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object to send
+ * \param[in] instId The instance ID or UAVOBJ_ALL_INSTANCES for all instances.
+ * \param[in] acked Selects if an ack is required (1:ack required, 0: ack not required)
+ * \param[in] timeoutMs Time to wait for each ack before the object is sent again
+ * \param[in] retries Number of times the object is sent again before the transaction fails
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSendObjectWindowed(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId, uint8_t acked, uint16_t timeoutMs, uint8_t retries)
+{
+	UAVTalkConnectionData *connection;
+	CHECKCONHANDLE(connectionHandle,connection,return -1);
+	if (acked == 1)
+	{
+		return windowedTransaction(connection, obj, instId, UAVTALK_TYPE_OBJ_ACK, timeoutMs, retries);
+	}
+	else
+	{
+		return objectTransaction(connection, obj, instId, UAVTALK_TYPE_OBJ, 0);
+	}
+}
+
+/**
+ * Request an update for the specified object without waiting for it, see
+ * \ref UAVTalkSendObjectWindowed.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object to update
+ * \param[in] instId The instance ID or UAVOBJ_ALL_INSTANCES for all instances.
+ * \param[in] timeoutMs Time to wait for the object before the request is sent again
+ * \param[in] retries Number of times the request is sent again before the transaction fails
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSendObjectRequestWindowed(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId, uint16_t timeoutMs, uint8_t retries)
+{
+	UAVTalkConnectionData *connection;
+	CHECKCONHANDLE(connectionHandle,connection,return -1);
+	return windowedTransaction(connection, obj, instId, UAVTALK_TYPE_OBJ_REQ, timeoutMs, retries);
+}
+
+/**
+ * Resend the windowed transactions whose ack is overdue and fail the ones
+ * that ran out of retries. Retries and failures are counted in the
+ * txRetries and txErrors statistics.
+ * \param[in] connection UAVTalkConnection to be used
+ * \return Time in ms until the next transaction times out
+ * \return -1 if no transaction is pending
+ */
+int32_t UAVTalkProcessPendingTransactions(UAVTalkConnection connectionHandle)
+{
+	UAVTalkConnectionData *connection;
+	CHECKCONHANDLE(connectionHandle,connection,return -1);
+
+	PIOS_Recursive_Mutex_Lock(connection->lock, PIOS_MUTEX_TIMEOUT_MAX);
+	int32_t next = processPending(connection);
+	PIOS_Recursive_Mutex_Unlock(connection->lock);
+
+	return next;
+}
+
+/**
+ * Start an acked transaction in the window of the connection.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object
+ * \param[in] instId The instance ID of UAVOBJ_ALL_INSTANCES for all instances.
+ * \param[in] type Transaction type, UAVTALK_TYPE_OBJ_ACK or UAVTALK_TYPE_OBJ_REQ
+ * \return 0 Success
+ * \return -1 Failure
+ */
+static int32_t windowedTransaction(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t type, uint16_t timeoutMs, uint8_t retries)
+{
+	UAVTalkPendingTransaction *trans = NULL;
+
+	PIOS_Recursive_Mutex_Lock(connection->lock, PIOS_MUTEX_TIMEOUT_MAX);
+
+	// A newer update of an object that is still waiting for its ack
+	// takes over the transaction, the ack can't tell them apart anyway
+	for (uint32_t i = 0; i < connection->numPending; i++) {
+		UAVTalkPendingTransaction *p = &connection->pending[i];
+		if (p->obj == obj && p->instId == instId && p->type == type) {
+			trans = p;
+			break;
+		}
+	}
+
+	// Otherwise wait for a free slot. Every transaction either gets its
+	// ack or fails once its retries are used up, so this terminates.
+	while (trans == NULL && connection->numPending >= UAVTALK_ACK_WINDOW) {
+		int32_t next = processPending(connection);
+		if (connection->numPending < UAVTALK_ACK_WINDOW)
+			break;
+
+		PIOS_Recursive_Mutex_Unlock(connection->lock);
+		PIOS_Semaphore_Take(connection->windowSema, next);
+		PIOS_Recursive_Mutex_Lock(connection->lock, PIOS_MUTEX_TIMEOUT_MAX);
+	}
+
+	if (trans == NULL)
+		trans = &connection->pending[connection->numPending++];
+
+	trans->obj = obj;
+	trans->instId = instId;
+	trans->type = type;
+	trans->timeoutMs = timeoutMs;
+	trans->retriesLeft = retries;
+	trans->deadline = PIOS_Thread_Systime() + timeoutMs;
+
+	int32_t ret = sendObject(connection, obj, instId, type);
+	if (ret < 0)
+		removePending(connection, trans - connection->pending);
+
+	PIOS_Recursive_Mutex_Unlock(connection->lock);
+
+	return ret;
+}
+
+/**
+ * Retry or fail the overdue transactions, connection must be locked.
+ * \return Time in ms until the next transaction times out
+ * \return -1 if no transaction is pending
+ */
+static int32_t processPending(UAVTalkConnectionData *connection)
+{
+	uint32_t now = PIOS_Thread_Systime();
+	int32_t next = -1;
+	uint32_t i = 0;
+
+	while (i < connection->numPending) {
+		UAVTalkPendingTransaction *trans = &connection->pending[i];
+		int32_t remaining = (int32_t) (trans->deadline - now);
+
+		if (remaining <= 0) {
+			if (trans->retriesLeft == 0) {
+				++connection->stats.txErrors;
+				removePending(connection, i);
+				continue;
+			}
+
+			--trans->retriesLeft;
+			++connection->stats.txRetries;
+			trans->deadline = now + trans->timeoutMs;
+			remaining = trans->timeoutMs;
+			// The other end may not have the update the delta would be based on
+			resetDelta(connection, trans->obj, trans->instId);
+			sendObject(connection, trans->obj, trans->instId, trans->type);
+		}
+
+		if (next < 0 || remaining < next)
+			next = remaining;
+		i++;
+	}
+
+	return next;
+}
+
+/**
+ * Drop a transaction from the window and wake up a sender waiting for a free slot
+ */
+static void removePending(UAVTalkConnectionData *connection, uint32_t idx)
+{
+	connection->pending[idx] = connection->pending[--connection->numPending];
+	PIOS_Semaphore_Give(connection->windowSema);
+}
+
 /**
  * Process an byte from the telemetry stream.
  * \param[in] connection UAVTalkConnection to be used
@@ -389,20 +701,31 @@ UAVTalkRxState UAVTalkProcessInputStreamQuiet(UAVTalkConnection connectionHandle
 			if (iproc->type == UAVTALK_TYPE_OBJ_REQ || iproc->type == UAVTALK_TYPE_ACK || iproc->type == UAVTALK_TYPE_NACK)
 			{
 				iproc->length = 0;
-				iproc->instanceLength = 0;
+				iproc->timestampLength = 0;
+				// Requests and acks of multi instance objects carry the instance ID
+				if (iproc->obj && iproc->type != UAVTALK_TYPE_NACK)
+					iproc->instanceLength = (UAVObjIsSingleInstance(iproc->obj) ? 0 : 2);
+				else
+					iproc->instanceLength = 0;
 			}
 			else
 			{
 				if (iproc->obj)
 				{
-					iproc->length = UAVObjGetNumBytes(iproc->obj);
 					iproc->instanceLength = (UAVObjIsSingleInstance(iproc->obj) ? 0 : 2);
 					iproc->timestampLength = (iproc->type & UAVTALK_TIMESTAMPED) ? 2 : 0;
+					if (iproc->type == UAVTALK_TYPE_OBJ_DELTA || iproc->type == UAVTALK_TYPE_OBJ_DELTA_TS || iproc->type == UAVTALK_TYPE_OBJ_ACK_DELTA)
+						// Deltas only fill the rest of the packet
+						iproc->length = iproc->packet_size - iproc->rxPacketLength - iproc->instanceLength - iproc->timestampLength;
+					else
+						iproc->length = UAVObjGetNumBytes(iproc->obj);
 				}
 				else
 				{
 					// We don't know if it's a multi-instance object, so just assume it's 0.
+					// This is also how batched frames (object ID 0) take the rest of the packet.
 					iproc->instanceLength = 0;
+					iproc->timestampLength = 0;
 					iproc->length = iproc->packet_size - iproc->rxPacketLength;
 				}
 			}
@@ -498,9 +821,7 @@ UAVTalkRxState UAVTalkProcessInputStreamQuiet(UAVTalkConnection connectionHandle
 
 		case UAVTALK_STATE_DATA:
 			
-			// update the CRC
-			iproc->cs = PIOS_CRC_updateByte(iproc->cs, rxbyte);
-			
+			// the CRC over the payload is computed in one go once it is complete
 			connection->rxBuffer[iproc->rxCount++] = rxbyte;
 			if (iproc->rxCount < iproc->length)
 				break;
@@ -511,6 +832,10 @@ UAVTalkRxState UAVTalkProcessInputStreamQuiet(UAVTalkConnection connectionHandle
 			
 		case UAVTALK_STATE_CS:
 			
+			// update the CRC with the payload
+			if (iproc->length > 0)
+				iproc->cs = PIOS_CRC_updateCRC(iproc->cs, connection->rxBuffer, iproc->length);
+
 			// the CRC byte
 			if (rxbyte != iproc->cs)
 			{   // packet error - faulty CRC
@@ -601,6 +926,9 @@ int32_t UAVTalkRelayPacket(UAVTalkConnection inConnectionHandle, UAVTalkConnecti
     // Lock
     PIOS_Recursive_Mutex_Lock(outConnection->lock, PIOS_MUTEX_TIMEOUT_MAX);
 
+    // Keep the order of the messages
+    flushBatch(outConnection);
+
     outConnection->txBuffer[0] = UAVTALK_SYNC_VAL;
     // Setup type
     outConnection->txBuffer[1] = inIproc->type;
@@ -839,6 +1167,9 @@ int32_t UAVTalkSendBuf(UAVTalkConnection connectionHandle, uint8_t *buf, uint16_
 	// Lock
 	PIOS_Recursive_Mutex_Lock(connection->lock, PIOS_MUTEX_TIMEOUT_MAX);
 
+	// Keep the order of the messages
+	flushBatch(connection);
+
 	// Output the buffer
 	int32_t rc = (*connection->outStream)(buf, len);
 
@@ -884,7 +1215,7 @@ static int32_t receiveObject(UAVTalkConnectionData *connection, uint8_t type, ui
 				// Unpack object, if the instance does not exist it will be created!
 				UAVObjUnpack(obj, instId, data);
 				// Check if an ack is pending
-				updateAck(connection, obj, instId);
+				updateAck(connection, type, obj, instId);
 			}
 			else
 			{
@@ -921,16 +1252,42 @@ static int32_t receiveObject(UAVTalkConnectionData *connection, uint8_t type, ui
 				sendNack(connection, objId);
 			else
 				sendObject(connection, obj, instId, UAVTALK_TYPE_OBJ);
+			// Answer right away instead of waiting for the batch to fill
+			flushBatch(connection);
+			break;
+		case UAVTALK_TYPE_OBJ_DELTA:
+		case UAVTALK_TYPE_OBJ_DELTA_TS:
+		case UAVTALK_TYPE_OBJ_ACK_DELTA:
+			// All instances, not allowed for delta messages
+			if (obj && (instId != UAVOBJ_ALL_INSTANCES) && receiveDelta(connection, obj, instId, data, length) == 0)
+			{
+				if (type == UAVTALK_TYPE_OBJ_ACK_DELTA)
+					sendObject(connection, obj, instId, UAVTALK_TYPE_ACK);
+				else
+					updateAck(connection, type, obj, instId);
+			}
+			else
+			{
+				// Ask for the full object, we don't have what the delta applies to
+				sendNack(connection, objId);
+				ret = -1;
+			}
 			break;
 		case UAVTALK_TYPE_NACK:
-			// Do nothing on flight side, let it time out.
+			// Start over from a full update if a delta could not be applied,
+			// otherwise do nothing on flight side and let it time out.
+			if (obj)
+				resendFull(connection, obj);
+			break;
+		case UAVTALK_TYPE_OBJ_BATCH:
+			ret = receiveBatch(connection, data, length);
 			break;
 		case UAVTALK_TYPE_ACK:
 			// All instances, not allowed for ACK messages
 			if (obj && (instId != UAVOBJ_ALL_INSTANCES))
 			{
 				// Check if an ack is pending
-				updateAck(connection, obj, instId);
+				updateAck(connection, type, obj, instId);
 			}
 			else
 			{
@@ -947,16 +1304,31 @@ static int32_t receiveObject(UAVTalkConnectionData *connection, uint8_t type, ui
 /**
  * Check if an ack is pending on an object and give response semaphore
  * \param[in] connection UAVTalkConnection to be used
+ * \param[in] type Type of the received message, UAVTALK_TYPE_ACK or an object
  * \param[in] obj Object
  * \param[in] instId The instance ID of UAVOBJ_ALL_INSTANCES for all instances.
  */
-static void updateAck(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId)
+static void updateAck(UAVTalkConnectionData *connection, uint8_t type, UAVObjHandle obj, uint16_t instId)
 {
 	if (connection->respObj == obj && (connection->respInstId == instId || connection->respInstId == UAVOBJ_ALL_INSTANCES))
 	{
 		PIOS_Semaphore_Give(connection->respSema);
 		connection->respObj = 0;
 	}
+
+	// Windowed transactions only complete on their own kind of response
+	uint8_t pendingType = (type == UAVTALK_TYPE_ACK) ? UAVTALK_TYPE_OBJ_ACK : UAVTALK_TYPE_OBJ_REQ;
+
+	PIOS_Recursive_Mutex_Lock(connection->lock, PIOS_MUTEX_TIMEOUT_MAX);
+	for (uint32_t i = 0; i < connection->numPending; i++) {
+		UAVTalkPendingTransaction *trans = &connection->pending[i];
+		if (trans->obj == obj && trans->type == pendingType &&
+				(trans->instId == instId || trans->instId == UAVOBJ_ALL_INSTANCES)) {
+			removePending(connection, i);
+			break;
+		}
+	}
+	PIOS_Recursive_Mutex_Unlock(connection->lock);
 }
 
 /**
@@ -972,6 +1344,7 @@ static int32_t sendObject(UAVTalkConnectionData *connection, UAVObjHandle obj, u
 {
 	uint32_t numInst;
 	uint32_t n;
+	uint32_t time = PIOS_Thread_Systime();
 	
 	// If all instances are requested and this is a single instance object, force instance ID to zero
 	if ( instId == UAVOBJ_ALL_INSTANCES && UAVObjIsSingleInstance(obj) )
@@ -989,24 +1362,24 @@ static int32_t sendObject(UAVTalkConnectionData *connection, UAVObjHandle obj, u
 			// Send all instances
 			for (n = 0; n < numInst; ++n)
 			{
-				sendSingleObject(connection, obj, n, type);
+				sendSingleObject(connection, obj, n, type, time);
 			}
 			return 0;
 		}
 		else
 		{
-			return sendSingleObject(connection, obj, instId, type);
+			return sendSingleObject(connection, obj, instId, type, time);
 		}
 	}
 	else if (type == UAVTALK_TYPE_OBJ_REQ)
 	{
-		return sendSingleObject(connection, obj, instId, UAVTALK_TYPE_OBJ_REQ);
+		return sendSingleObject(connection, obj, instId, UAVTALK_TYPE_OBJ_REQ, time);
 	}
 	else if (type == UAVTALK_TYPE_ACK)
 	{
 		if ( instId != UAVOBJ_ALL_INSTANCES )
 		{
-			return sendSingleObject(connection, obj, instId, UAVTALK_TYPE_ACK);
+			return sendSingleObject(connection, obj, instId, UAVTALK_TYPE_ACK, time);
 		}
 		else
 		{
@@ -1025,10 +1398,11 @@ static int32_t sendObject(UAVTalkConnectionData *connection, UAVObjHandle obj, u
  * \param[in] obj Object handle to send
  * \param[in] instId The instance ID (can NOT be UAVOBJ_ALL_INSTANCES, use sendObject() instead)
  * \param[in] type Transaction type
+ * \param[in] time Timestamp of timestamped transactions (ms)
  * \return 0 Success
  * \return -1 Failure
  */
-static int32_t sendSingleObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t type)
+static int32_t sendSingleObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t type, uint32_t time)
 {
 	int32_t length;
 	int32_t dataOffset;
@@ -1036,6 +1410,17 @@ static int32_t sendSingleObject(UAVTalkConnectionData *connection, UAVObjHandle
 
 	if (!connection->outStream) return -1;
 
+	if (connection->batching)
+	{
+		// Deltas are sent on their own, they are smaller than a batch record
+		if (type == UAVTALK_TYPE_OBJ && !(connection->deltaEncoding && UAVObjIsDeltaEncoded(obj)) &&
+				appendBatch(connection, obj, instId) == 0)
+			return 0;
+
+		// Keep the order of the messages
+		flushBatch(connection);
+	}
+
 	// Setup type and object id fields
 	objId = UAVObjGetID(obj);
 	connection->txBuffer[0] = UAVTALK_SYNC_VAL;  // sync byte
@@ -1061,7 +1446,6 @@ static int32_t sendSingleObject(UAVTalkConnectionData *connection, UAVObjHandle
 	// Add timestamp when the transaction type is appropriate
 	if (type & UAVTALK_TIMESTAMPED)
 	{
-		uint32_t time = PIOS_Thread_Systime();
 		connection->txBuffer[dataOffset] = (uint8_t)(time & 0xFF);
 		connection->txBuffer[dataOffset + 1] = (uint8_t)((time >> 8) & 0xFF);
 		dataOffset += 2;
@@ -1086,7 +1470,17 @@ static int32_t sendSingleObject(UAVTalkConnectionData *connection, UAVObjHandle
 	// Copy data (if any)
 	if (length > 0)
 	{
-		if ( UAVObjPack(obj, instId, &connection->txBuffer[dataOffset]) < 0 )
+		if (connection->deltaEncoding && UAVObjIsDeltaEncoded(obj))
+		{
+			// The update may go out as a delta of another type and length
+			length = packDelta(connection, obj, instId, &type, &connection->txBuffer[dataOffset]);
+			if (length < 0)
+			{
+				return -1;
+			}
+			connection->txBuffer[1] = type;
+		}
+		else if ( UAVObjPack(obj, instId, &connection->txBuffer[dataOffset]) < 0 )
 		{
 			return -1;
 		}
@@ -1126,6 +1520,9 @@ static int32_t sendNack(UAVTalkConnectionData *connection, uint32_t objId)
 
 	if (!connection->outStream) return -1;
 
+	// Keep the order of the messages
+	flushBatch(connection);
+
 	connection->txBuffer[0] = UAVTALK_SYNC_VAL;  // sync byte
 	connection->txBuffer[1] = UAVTALK_TYPE_NACK;
 	// data length inserted here below
@@ -1155,6 +1552,399 @@ static int32_t sendNack(UAVTalkConnectionData *connection, uint32_t objId)
 	return 0;
 }
 
+/**
+ * Add an object to the batched frame, sending the frame first if the object doesn't fit.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object handle to send
+ * \param[in] instId The instance ID (can NOT be UAVOBJ_ALL_INSTANCES)
+ * \return 0 Success
+ * \return -1 The object is too large to be batched
+ */
+static int32_t appendBatch(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId)
+{
+	uint32_t objId = UAVObjGetID(obj);
+	uint32_t length = UAVObjGetNumBytes(obj);
+	uint32_t instanceLength = UAVObjIsSingleInstance(obj) ? 0 : 2;
+	uint32_t recordLength = UAVTALK_BATCH_RECORD_HEADER_LENGTH + instanceLength + length;
+
+	if (instanceLength + length > 255 || recordLength > UAVTALK_MAX_BATCH_LENGTH)
+		return -1;
+
+	if (connection->batchLength + recordLength > UAVTALK_MAX_BATCH_LENGTH)
+		flushBatch(connection);
+
+	uint8_t *record = &connection->batchBuffer[UAVTALK_MIN_HEADER_LENGTH + connection->batchLength];
+	record[0] = (uint8_t)(objId & 0xFF);
+	record[1] = (uint8_t)((objId >> 8) & 0xFF);
+	record[2] = (uint8_t)((objId >> 16) & 0xFF);
+	record[3] = (uint8_t)((objId >> 24) & 0xFF);
+	record[4] = (uint8_t)(instanceLength + length);
+	if (instanceLength > 0)
+	{
+		record[5] = (uint8_t)(instId & 0xFF);
+		record[6] = (uint8_t)((instId >> 8) & 0xFF);
+	}
+
+	if (UAVObjPack(obj, instId, &record[UAVTALK_BATCH_RECORD_HEADER_LENGTH + instanceLength]) < 0)
+		return -1;
+
+	connection->batchLength += recordLength;
+
+	// Update stats
+	++connection->stats.txObjects;
+	connection->stats.txObjectBytes += length;
+
+	return 0;
+}
+
+/**
+ * Send the batched frame if it holds any object.
+ * \param[in] connection UAVTalkConnection to be used
+ * \return 0 Success
+ * \return -1 Failure
+ */
+static int32_t flushBatch(UAVTalkConnectionData *connection)
+{
+	if (connection->batchLength == 0)
+		return 0;
+
+	uint8_t *frame = connection->batchBuffer;
+	uint16_t size = UAVTALK_MIN_HEADER_LENGTH + connection->batchLength;
+	connection->batchLength = 0;
+
+	// Batched frames have no object ID of their own
+	frame[0] = UAVTALK_SYNC_VAL;
+	frame[1] = UAVTALK_TYPE_OBJ_BATCH;
+	frame[2] = (uint8_t)(size & 0xFF);
+	frame[3] = (uint8_t)((size >> 8) & 0xFF);
+	frame[4] = 0;
+	frame[5] = 0;
+	frame[6] = 0;
+	frame[7] = 0;
+	frame[size] = PIOS_CRC_updateCRC(0, frame, size);
+
+	uint16_t tx_msg_len = size + UAVTALK_CHECKSUM_LENGTH;
+	int32_t rc = (*connection->outStream)(frame, tx_msg_len);
+
+	if (rc != tx_msg_len)
+		return -1;
+
+	connection->stats.txBytes += tx_msg_len;
+	return 0;
+}
+
+/**
+ * Receive the objects of a batched frame.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] data Payload of the frame
+ * \param[in] length Payload length
+ * \return 0 Success
+ * \return -1 Failure, the known objects of the frame are still received
+ */
+static int32_t receiveBatch(UAVTalkConnectionData *connection, uint8_t* data, int32_t length)
+{
+	int32_t ret = 0;
+	int32_t pos = 0;
+
+	while (pos + UAVTALK_BATCH_RECORD_HEADER_LENGTH <= length)
+	{
+		uint32_t objId = data[pos] | (data[pos + 1] << 8) | (data[pos + 2] << 16) | ((uint32_t) data[pos + 3] << 24);
+		int32_t recordLength = data[pos + 4];
+		pos += UAVTALK_BATCH_RECORD_HEADER_LENGTH;
+
+		if (pos + recordLength > length)
+			return -1;
+
+		// Skip the objects we don't know or whose size doesn't match
+		UAVObjHandle obj = UAVObjGetByID(objId);
+		int32_t instanceLength = (obj && !UAVObjIsSingleInstance(obj)) ? 2 : 0;
+		if (obj && recordLength == instanceLength + (int32_t) UAVObjGetNumBytes(obj))
+		{
+			uint16_t instId = 0;
+			if (instanceLength > 0)
+				instId = data[pos] | (data[pos + 1] << 8);
+			if (receiveObject(connection, UAVTALK_TYPE_OBJ, objId, instId, &data[pos + instanceLength], recordLength - instanceLength) < 0)
+				ret = -1;
+		}
+		else
+		{
+			ret = -1;
+		}
+
+		pos += recordLength;
+	}
+
+	return (pos == length) ? ret : -1;
+}
+
+/**
+ * Get the last update sent of an object instance, adding it if it is new.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object handle
+ * \param[in] instId The instance ID
+ * \return The reference or NULL if it could not be allocated
+ */
+static UAVTalkDeltaRef *getDeltaRef(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId)
+{
+	for (UAVTalkDeltaRef *ref = connection->deltaRefs; ref != NULL; ref = ref->next) {
+		if (ref->obj == obj && ref->instId == instId)
+			return ref;
+	}
+
+	UAVTalkDeltaRef *ref = PIOS_malloc(sizeof(UAVTalkDeltaRef) + UAVObjGetNumBytes(obj));
+	if (ref == NULL)
+		return NULL;
+
+	ref->obj = obj;
+	ref->instId = instId;
+	ref->sinceFull = 0;
+	ref->valid = false;
+	ref->sentDelta = false;
+	ref->next = connection->deltaRefs;
+	connection->deltaRefs = ref;
+
+	return ref;
+}
+
+/**
+ * Run length encode the bytes of an update which differ from the reference.
+ * A control byte with UAVTALK_DELTA_RUN_UNCHANGED set skips (c & 0x7F) + 1
+ * unchanged bytes, otherwise it is followed by c + 1 bytes XORed with the
+ * reference. Trailing unchanged bytes are not encoded.
+ * \param[in] ref The reference
+ * \param[in] update The new data
+ * \param[in] length Length of both
+ * \param[out] out Encoded delta
+ * \param[in] maxLength Size of the output, deltas that don't fit aren't worth sending
+ * \return Encoded length or -1 if it is larger than maxLength
+ */
+static int32_t encodeDelta(const uint8_t *ref, const uint8_t *update, uint32_t length, uint8_t *out, uint32_t maxLength)
+{
+	uint32_t outLength = 0;
+	uint32_t unchanged = 0;
+	uint32_t pos = 0;
+
+	while (pos < length) {
+		if (ref[pos] == update[pos]) {
+			unchanged++;
+			pos++;
+			continue;
+		}
+
+		// Flush the unchanged bytes before this change
+		while (unchanged > 0) {
+			uint32_t run = (unchanged < UAVTALK_DELTA_MAX_RUN) ? unchanged : UAVTALK_DELTA_MAX_RUN;
+			if (outLength + 1 > maxLength)
+				return -1;
+			out[outLength++] = UAVTALK_DELTA_RUN_UNCHANGED | (run - 1);
+			unchanged -= run;
+		}
+
+		// A single unchanged byte between two changes is cheaper to copy than to skip
+		uint32_t run = 0;
+		while (pos + run < length && run < UAVTALK_DELTA_MAX_RUN &&
+				(ref[pos + run] != update[pos + run] ||
+				 (pos + run + 1 < length && ref[pos + run + 1] != update[pos + run + 1])))
+			run++;
+
+		if (outLength + 1 + run > maxLength)
+			return -1;
+		out[outLength++] = run - 1;
+		for (uint32_t i = 0; i < run; i++)
+			out[outLength++] = ref[pos + i] ^ update[pos + i];
+		pos += run;
+	}
+
+	return outLength;
+}
+
+/**
+ * Apply a run length encoded delta, see \ref encodeDelta
+ * \param[in,out] data The reference, updated in place
+ * \param[in] length Length of the data
+ * \param[in] in Encoded delta
+ * \param[in] inLength Length of the delta
+ * \return 0 Success
+ * \return -1 The delta doesn't match the data
+ */
+static int32_t decodeDelta(uint8_t *data, uint32_t length, const uint8_t *in, uint32_t inLength)
+{
+	uint32_t pos = 0;
+	uint32_t i = 0;
+
+	while (i < inLength) {
+		uint8_t control = in[i++];
+		uint32_t run = (control & ~UAVTALK_DELTA_RUN_UNCHANGED) + 1;
+		if (pos + run > length)
+			return -1;
+
+		if ((control & UAVTALK_DELTA_RUN_UNCHANGED) == 0) {
+			if (i + run > inLength)
+				return -1;
+			for (uint32_t j = 0; j < run; j++)
+				data[pos + j] ^= in[i + j];
+			i += run;
+		}
+		pos += run;
+	}
+
+	return 0;
+}
+
+/**
+ * Pack an object update, as a delta against the last update sent of the instance
+ * when that is shorter. The update becomes the reference for the next one.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object handle to send
+ * \param[in] instId The instance ID (can NOT be UAVOBJ_ALL_INSTANCES)
+ * \param[in,out] type Transaction type, changed to the delta type if a delta is packed
+ * \param[out] dataOut The packed update
+ * \return Number of bytes packed
+ * \return -1 Failure
+ */
+static int32_t packDelta(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t *type, uint8_t *dataOut)
+{
+	uint32_t numBytes = UAVObjGetNumBytes(obj);
+
+	uint8_t deltaType;
+	switch (*type) {
+	case UAVTALK_TYPE_OBJ:
+		deltaType = UAVTALK_TYPE_OBJ_DELTA;
+		break;
+	case UAVTALK_TYPE_OBJ_TS:
+		deltaType = UAVTALK_TYPE_OBJ_DELTA_TS;
+		break;
+	case UAVTALK_TYPE_OBJ_ACK:
+		deltaType = UAVTALK_TYPE_OBJ_ACK_DELTA;
+		break;
+	default:
+		deltaType = 0;
+	}
+
+	// Without memory for the reference the object is simply sent in full
+	UAVTalkDeltaRef *ref = getDeltaRef(connection, obj, instId);
+	if (ref == NULL)
+		return (UAVObjPack(obj, instId, dataOut) < 0) ? -1 : (int32_t) numBytes;
+
+	uint8_t *update = connection->deltaBuffer;
+	if (UAVObjPack(obj, instId, update) < 0)
+		return -1;
+
+	// Acked updates recover from a lost delta through the NACK
+	bool keyframe = (deltaType != UAVTALK_TYPE_OBJ_ACK_DELTA) && ref->sinceFull >= UAVTALK_DELTA_KEYFRAME_INTERVAL - 1;
+
+	int32_t length = -1;
+	if (deltaType != 0 && ref->valid && !keyframe && numBytes > UAVTALK_DELTA_HEADER_LENGTH + 1) {
+		length = encodeDelta(ref->data, update, numBytes, &dataOut[UAVTALK_DELTA_HEADER_LENGTH],
+				numBytes - UAVTALK_DELTA_HEADER_LENGTH - 1);
+	}
+
+	if (length >= 0) {
+		dataOut[0] = PIOS_CRC_updateCRC(0, ref->data, numBytes);
+		dataOut[1] = PIOS_CRC_updateCRC(0, update, numBytes);
+		length += UAVTALK_DELTA_HEADER_LENGTH;
+		*type = deltaType;
+		ref->sinceFull++;
+		ref->sentDelta = true;
+	} else {
+		memcpy(dataOut, update, numBytes);
+		length = numBytes;
+		ref->sinceFull = 0;
+		ref->sentDelta = false;
+	}
+
+	memcpy(ref->data, update, numBytes);
+	ref->valid = true;
+
+	return length;
+}
+
+/**
+ * Apply a received delta to the current data of an object instance.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object handle
+ * \param[in] instId The instance ID
+ * \param[in] data The delta
+ * \param[in] length Length of the delta
+ * \return 0 Success
+ * \return -1 The delta is not based on the current data
+ */
+static int32_t receiveDelta(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t* data, int32_t length)
+{
+	uint32_t numBytes = UAVObjGetNumBytes(obj);
+
+	if (length < UAVTALK_DELTA_HEADER_LENGTH || instId >= UAVObjGetNumInstances(obj))
+		return -1;
+
+	// Packets are received without the connection lock, so the transmit buffer may
+	// be in use by a sender. Only connections that ever receive deltas pay for the
+	// receive side buffer.
+	if (connection->rxDeltaBuffer == NULL) {
+		connection->rxDeltaBuffer = PIOS_malloc(UAVOBJECTS_LARGEST);
+		if (connection->rxDeltaBuffer == NULL)
+			return -1;
+	}
+	uint8_t *update = connection->rxDeltaBuffer;
+
+	if (UAVObjPack(obj, instId, update) < 0)
+		return -1;
+
+	if (PIOS_CRC_updateCRC(0, update, numBytes) != data[0])
+		return -1;
+
+	if (decodeDelta(update, numBytes, &data[UAVTALK_DELTA_HEADER_LENGTH], length - UAVTALK_DELTA_HEADER_LENGTH) < 0 ||
+			PIOS_CRC_updateCRC(0, update, numBytes) != data[1])
+		return -1;
+
+	return UAVObjUnpack(obj, instId, update);
+}
+
+/**
+ * Send the next update of object instances in full.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object handle, or NULL for all objects
+ * \param[in] instId The instance ID or UAVOBJ_ALL_INSTANCES for all instances
+ */
+static void resetDelta(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId)
+{
+	for (UAVTalkDeltaRef *ref = connection->deltaRefs; ref != NULL; ref = ref->next) {
+		if ((obj == NULL || ref->obj == obj) && (instId == UAVOBJ_ALL_INSTANCES || ref->instId == instId)) {
+			ref->valid = false;
+			ref->sentDelta = false;
+		}
+	}
+}
+
+/**
+ * Handle a NACK for an object. If a delta of the object was sent the other end
+ * could not apply it, so the pending updates are sent again in full.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object handle
+ */
+static void resendFull(UAVTalkConnectionData *connection, UAVObjHandle obj)
+{
+	bool sentDelta = false;
+	for (UAVTalkDeltaRef *ref = connection->deltaRefs; ref != NULL; ref = ref->next) {
+		if (ref->obj == obj)
+			sentDelta |= ref->sentDelta;
+	}
+
+	// Objects the other end doesn't know are NACKed as well, only
+	// answer a NACK once so that the two ends can't ping pong.
+	resetDelta(connection, obj, UAVOBJ_ALL_INSTANCES);
+	if (!sentDelta)
+		return;
+
+	uint32_t now = PIOS_Thread_Systime();
+	for (uint32_t i = 0; i < connection->numPending; i++) {
+		UAVTalkPendingTransaction *trans = &connection->pending[i];
+		if (trans->obj == obj && trans->type == UAVTALK_TYPE_OBJ_ACK) {
+			trans->deadline = now + trans->timeoutMs;
+			sendObject(connection, obj, trans->instId, UAVTALK_TYPE_OBJ_ACK);
+		}
+	}
+}
+
 /**
  * @}
  * @}
@@ -616,6 +616,8 @@ static const struct flashfs_logfs_cfg flashfs_settings_cfg = {
 	.fs_magic      = 0x3b1b14cf,
 	.arena_size    = 0x00004000, /* 64 * slot size = 16K bytes = 1 sector */
 	.slot_size     = 0x00000100, /* 256 bytes */
+	.index_slots   = 63,         /* 504 bytes of RAM */
+	.gc_slots      = 4,          /* migrated per save when nearly full */
 };
 
 static const struct flashfs_logfs_cfg flashfs_waypoints_cfg = {
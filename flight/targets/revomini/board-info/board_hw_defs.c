@@ -500,6 +500,8 @@ static const struct flashfs_logfs_cfg flashfs_settings_cfg = {
 	.fs_magic      = 0x99abcedf,
 	.arena_size    = 0x00010000, /* 256 * slot size */
 	.slot_size     = 0x00000100, /* 256 bytes */
+	.index_slots   = 128,        /* 1024 bytes of RAM */
+	.gc_slots      = 4,          /* migrated per save when nearly full */
 };
 
 static const struct flashfs_logfs_cfg flashfs_waypoints_cfg = {
@@ -0,0 +1,3 @@
+/* Minimal PiOS environment for compiling pios_crc.c on the host */
+#include <stdint.h>
+#include <pios_crc.h>
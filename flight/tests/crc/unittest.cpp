@@ -0,0 +1,118 @@
+/**
+ ******************************************************************************
+ * @file       unittest.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Unit test
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * NOTE: This program uses the Google Test infrastructure to drive the unit test
+ *
+ * Main site for Google Test: http://code.google.com/p/googletest/
+ * Documentation and examples: http://code.google.com/p/googletest/wiki/Documentation
+ */
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>		/* printf */
+#include <stdlib.h>		/* rand */
+#include <stdint.h>		/* uint*_t */
+#include <time.h>		/* clock */
+
+extern "C" {
+
+#include "pios_crc.h"		/* API for CRC functions */
+
+}
+
+#define BUF_LEN 512
+
+// To use a test fixture, derive a class from testing::Test.
+class CRC8 : public testing::Test {
+protected:
+  virtual void SetUp() {
+    srand(1234);
+    for (int i = 0; i < BUF_LEN; i++)
+      buf[i] = rand() & 0xff;
+  }
+
+  virtual void TearDown() {
+  }
+
+  /* Reference implementation, one table lookup per byte */
+  uint8_t crc_bytewise(uint8_t crc, const uint8_t *data, int32_t length) {
+    while (length--)
+      crc = PIOS_CRC_updateByte(crc, *data++);
+    return crc;
+  }
+
+  uint8_t buf[BUF_LEN];
+};
+
+TEST_F(CRC8, KnownValue) {
+  const uint8_t check[] = "123456789";
+
+  /* CRC-8 with poly 0x07, no reflection and no final xor */
+  EXPECT_EQ(0xf4, PIOS_CRC_updateCRC(0, check, 9));
+}
+
+TEST_F(CRC8, MatchesBytewiseAllLengths) {
+  for (int32_t len = 0; len <= BUF_LEN; len++) {
+    EXPECT_EQ(crc_bytewise(0, buf, len), PIOS_CRC_updateCRC(0, buf, len)) << "length " << len;
+  }
+}
+
+TEST_F(CRC8, MatchesBytewiseUnaligned) {
+  for (int32_t offset = 1; offset < 8; offset++) {
+    for (int32_t len = 0; len < 64; len++) {
+      EXPECT_EQ(crc_bytewise(0x5a, &buf[offset], len), PIOS_CRC_updateCRC(0x5a, &buf[offset], len));
+    }
+  }
+}
+
+TEST_F(CRC8, Chained) {
+  uint8_t crc = PIOS_CRC_updateCRC(0, buf, 13);
+  crc = PIOS_CRC_updateCRC(crc, &buf[13], BUF_LEN - 13);
+
+  EXPECT_EQ(crc_bytewise(0, buf, BUF_LEN), crc);
+}
+
+TEST_F(CRC8, Throughput) {
+  const int iterations = 20000;
+  volatile uint8_t sink = 0;
+
+  clock_t start = clock();
+  for (int i = 0; i < iterations; i++)
+    sink ^= crc_bytewise(i, buf, BUF_LEN);
+  clock_t bytewise = clock() - start;
+
+  start = clock();
+  for (int i = 0; i < iterations; i++)
+    sink ^= PIOS_CRC_updateCRC(i, buf, BUF_LEN);
+  clock_t sliced = clock() - start;
+
+  double mb = (double)iterations * BUF_LEN / (1024 * 1024);
+  printf("bytewise: %.1f MB/s, sliced: %.1f MB/s\n",
+    mb / ((double)bytewise / CLOCKS_PER_SEC + 1e-9),
+    mb / ((double)sliced / CLOCKS_PER_SEC + 1e-9));
+  (void)sink;
+}
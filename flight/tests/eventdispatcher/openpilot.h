@@ -0,0 +1,29 @@
+/* The dispatcher is built against the FreeRTOS flavour of the PiOS headers */
+#define PIOS_INCLUDE_FREERTOS
+
+/* Room for the 200 entries of the ManyEntries test */
+#define PIOS_EVENTDISPATCHER_MAX_PERIODIC 256
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pios_heap.h"
+#include "pios_thread.h"
+#include "uavobjectmanager.h"
+#include "eventdispatcher.h"
+#include "utlist.h"
+
+typedef enum {
+	TASKINFO_RUNNING_EVENTDISPATCHER,
+} TaskInfoRunningElem;
+
+int32_t TaskMonitorAdd(TaskInfoRunningElem task, struct pios_thread *handlep);
+
+/* Simulation of the event task, see unittest_mocks.c */
+void mock_reset(void);
+void mock_run_event_task(uint32_t duration_ms);
+uint32_t mock_queue_count(struct pios_queue *queuep);
+uint32_t mock_heap_allocs(void);
+uint32_t mock_heap_frees(void);
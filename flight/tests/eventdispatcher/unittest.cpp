@@ -0,0 +1,264 @@
+/**
+ ******************************************************************************
+ * @file       unittest.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Unit test
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * NOTE: This program uses the Google Test infrastructure to drive the unit test
+ *
+ * Main site for Google Test: http://code.google.com/p/googletest/
+ * Documentation and examples: http://code.google.com/p/googletest/wiki/Documentation
+ */
+
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>		/* printf */
+#include <stdint.h>		/* uint*_t */
+#include <time.h>		/* clock */
+#include <map>
+#include <vector>
+
+extern "C" {
+
+#include "openpilot.h"
+
+}
+
+static std::map<uintptr_t, std::vector<uint32_t> > calls;
+
+static void recordCallback(UAVObjEvent *ev)
+{
+  calls[(uintptr_t)ev->obj].push_back(PIOS_Thread_Systime());
+}
+
+static UAVObjEvent makeEvent(uintptr_t id)
+{
+  UAVObjEvent ev;
+  ev.obj = (UAVObjHandle)id;
+  ev.instId = 0;
+  ev.event = EV_UPDATED_PERIODIC;
+  return ev;
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class EventDispatcher : public testing::Test {
+protected:
+  virtual void SetUp() {
+    calls.clear();
+    mock_reset();
+    ASSERT_EQ(0, EventDispatcherInitialize());
+  }
+
+  virtual void TearDown() {
+  }
+
+  /* Every call after the first ones must be exactly one period later. The
+   * update following a period change re-randomizes the phase, so that
+   * interval can be shorter. */
+  void checkPeriod(uintptr_t id, uint32_t periodMs, size_t first = 1) {
+    const std::vector<uint32_t> &times = calls[id];
+    for (size_t i = first; i < times.size(); i++)
+      EXPECT_EQ(periodMs, times[i] - times[i - 1]) << "entry " << id << " call " << i;
+  }
+};
+
+TEST_F(EventDispatcher, CallbacksAtTheirPeriod) {
+  const uint16_t periods[] = { 10, 25, 100, 333 };
+
+  for (uintptr_t i = 0; i < 4; i++) {
+    UAVObjEvent ev = makeEvent(i + 1);
+    EXPECT_EQ(0, EventPeriodicCallbackCreate(&ev, recordCallback, periods[i]));
+  }
+
+  mock_run_event_task(10000);
+
+  for (uintptr_t i = 0; i < 4; i++) {
+    uint32_t expected = 10000 / periods[i];
+    EXPECT_LE(expected - 1, calls[i + 1].size());
+    EXPECT_GE(expected + 1, calls[i + 1].size());
+    checkPeriod(i + 1, periods[i]);
+  }
+}
+
+TEST_F(EventDispatcher, QueueEvents) {
+  struct pios_queue *queue = PIOS_Queue_Create(1000, sizeof(UAVObjEvent));
+  UAVObjEvent ev = makeEvent(42);
+
+  EXPECT_EQ(0, EventPeriodicQueueCreate(&ev, queue, 20));
+  mock_run_event_task(1000);
+
+  EXPECT_LE(49U, mock_queue_count(queue));
+  EXPECT_GE(51U, mock_queue_count(queue));
+}
+
+TEST_F(EventDispatcher, FullQueueCountsErrors) {
+  struct pios_queue *queue = PIOS_Queue_Create(2, sizeof(UAVObjEvent));
+  UAVObjEvent ev = makeEvent(42);
+  EventStats stats;
+
+  EXPECT_EQ(0, EventPeriodicQueueCreate(&ev, queue, 100));
+  mock_run_event_task(1000);
+
+  EventGetStats(&stats);
+  EXPECT_EQ(2U, mock_queue_count(queue));
+  EXPECT_LE(7U, stats.eventErrors);
+  EXPECT_EQ(42U, stats.lastErrorID);
+}
+
+TEST_F(EventDispatcher, RejectsDuplicates) {
+  UAVObjEvent ev = makeEvent(1);
+
+  EXPECT_EQ(0, EventPeriodicCallbackCreate(&ev, recordCallback, 10));
+  EXPECT_EQ(-1, EventPeriodicCallbackCreate(&ev, recordCallback, 20));
+
+  ev.instId = 1;
+  EXPECT_EQ(0, EventPeriodicCallbackCreate(&ev, recordCallback, 20));
+}
+
+TEST_F(EventDispatcher, UpdateUnknownFails) {
+  UAVObjEvent ev = makeEvent(1);
+
+  EXPECT_EQ(-1, EventPeriodicCallbackUpdate(&ev, recordCallback, 10));
+}
+
+TEST_F(EventDispatcher, UpdatePeriod) {
+  UAVObjEvent slow = makeEvent(1);
+  UAVObjEvent fast = makeEvent(2);
+
+  EXPECT_EQ(0, EventPeriodicCallbackCreate(&slow, recordCallback, 100));
+  EXPECT_EQ(0, EventPeriodicCallbackCreate(&fast, recordCallback, 10));
+  mock_run_event_task(1000);
+
+  // Swap the periods
+  EXPECT_EQ(0, EventPeriodicCallbackUpdate(&slow, recordCallback, 10));
+  EXPECT_EQ(0, EventPeriodicCallbackUpdate(&fast, recordCallback, 100));
+  calls.clear();
+  mock_run_event_task(1000);
+
+  EXPECT_LE(99U, calls[1].size());
+  EXPECT_GE(11U, calls[2].size());
+  checkPeriod(1, 10, 2);
+  checkPeriod(2, 100, 2);
+}
+
+TEST_F(EventDispatcher, ZeroPeriodStopsUpdates) {
+  UAVObjEvent ev = makeEvent(1);
+  UAVObjEvent other = makeEvent(2);
+
+  EXPECT_EQ(0, EventPeriodicCallbackCreate(&ev, recordCallback, 10));
+  EXPECT_EQ(0, EventPeriodicCallbackCreate(&other, recordCallback, 30));
+  mock_run_event_task(500);
+
+  EXPECT_EQ(0, EventPeriodicCallbackUpdate(&ev, recordCallback, 0));
+  calls.clear();
+  mock_run_event_task(500);
+  EXPECT_EQ(0U, calls[1].size());
+  EXPECT_LE(15U, calls[2].size());
+
+  // And restart them
+  EXPECT_EQ(0, EventPeriodicCallbackUpdate(&ev, recordCallback, 50));
+  calls.clear();
+  mock_run_event_task(500);
+  EXPECT_LE(9U, calls[1].size());
+  checkPeriod(1, 50, 2);
+}
+
+TEST_F(EventDispatcher, ManyEntries) {
+  const uintptr_t entries = 200;
+
+  for (uintptr_t i = 0; i < entries; i++) {
+    UAVObjEvent ev = makeEvent(i + 1);
+    EXPECT_EQ(0, EventPeriodicCallbackCreate(&ev, recordCallback, 5 + (i % 50) * 20));
+  }
+
+  clock_t start = clock();
+  mock_run_event_task(60000);
+  clock_t elapsed = clock() - start;
+
+  uint32_t total = 0;
+  for (uintptr_t i = 0; i < entries; i++) {
+    uint16_t period = 5 + (i % 50) * 20;
+    uint32_t expected = 60000 / period;
+    EXPECT_LE(expected - 1, calls[i + 1].size());
+    EXPECT_GE(expected + 1, calls[i + 1].size());
+    checkPeriod(i + 1, period);
+    total += calls[i + 1].size();
+  }
+
+  printf("%u periodic events from %u entries: %.0f ns per event\n", total, (unsigned)entries,
+    (double)elapsed / CLOCKS_PER_SEC * 1e9 / total);
+}
+
+TEST_F(EventDispatcher, HeapNeverReallocated) {
+  const uintptr_t entries = PIOS_EVENTDISPATCHER_MAX_PERIODIC;
+  uint32_t allocs = mock_heap_allocs();
+
+  // The PiOS heap can't free, anything but the entries themselves would be lost
+  for (uintptr_t i = 0; i < entries; i++) {
+    UAVObjEvent ev = makeEvent(i + 1);
+    EXPECT_EQ(0, EventPeriodicCallbackCreate(&ev, recordCallback, 10 + i % 7));
+  }
+
+  EXPECT_EQ(entries, mock_heap_allocs() - allocs);
+  EXPECT_EQ(0U, mock_heap_frees());
+
+  mock_run_event_task(1000);
+  for (uintptr_t i = 0; i < entries; i++)
+    checkPeriod(i + 1, 10 + i % 7);
+}
+
+TEST_F(EventDispatcher, FullHeapCountsErrors) {
+  const uintptr_t entries = PIOS_EVENTDISPATCHER_MAX_PERIODIC;
+  EventStats stats;
+
+  for (uintptr_t i = 0; i < entries; i++) {
+    UAVObjEvent ev = makeEvent(i + 1);
+    EXPECT_EQ(0, EventPeriodicCallbackCreate(&ev, recordCallback, 100));
+  }
+
+  // No room to schedule another one, and nothing allocated for it
+  uint32_t allocs = mock_heap_allocs();
+  UAVObjEvent extra = makeEvent(1000);
+  EXPECT_EQ(-1, EventPeriodicCallbackCreate(&extra, recordCallback, 100));
+  EXPECT_EQ(allocs, mock_heap_allocs());
+  EventGetStats(&stats);
+  EXPECT_EQ(1U, stats.eventErrors);
+  EXPECT_EQ(1000U, stats.lastErrorID);
+
+  // Entries without a period don't take room, but can't be started
+  EXPECT_EQ(0, EventPeriodicCallbackCreate(&extra, recordCallback, 0));
+  EXPECT_EQ(-1, EventPeriodicCallbackUpdate(&extra, recordCallback, 100));
+  EventGetStats(&stats);
+  EXPECT_EQ(2U, stats.eventErrors);
+
+  // Until another one is stopped
+  UAVObjEvent first = makeEvent(1);
+  EXPECT_EQ(0, EventPeriodicCallbackUpdate(&first, recordCallback, 0));
+  EXPECT_EQ(0, EventPeriodicCallbackUpdate(&extra, recordCallback, 100));
+  mock_run_event_task(1000);
+  EXPECT_EQ(0U, calls[1].size());
+  EXPECT_LE(9U, calls[1000].size());
+  checkPeriod(1000, 100, 2);
+}
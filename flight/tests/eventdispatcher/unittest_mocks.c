@@ -0,0 +1,179 @@
+/**
+ ******************************************************************************
+ * @file       unittest_mocks.c
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Simulated OS for the event dispatcher unit test
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "openpilot.h"
+#include "pios_mutex.h"
+#include "pios_thread.h"
+#include "pios_queue.h"
+
+#include <setjmp.h>
+
+/*
+ * Time only advances while the event task waits on its queue, by the
+ * time it asked to wait. When the end of the simulation is reached the
+ * (endless) event task is left with a longjmp.
+ */
+static uint32_t sim_time;
+static uint32_t sim_end;
+static jmp_buf sim_exit;
+static void (*event_task)(void *);
+
+/*
+ * Like the flight PiOS heap, free does nothing. Memory that is freed is
+ * lost, so the calls are counted for the tests to check.
+ */
+static uint32_t heap_allocs;
+static uint32_t heap_frees;
+
+struct mock_queue {
+	struct pios_queue queue;
+	size_t item_size;
+	size_t length;
+	size_t head;
+	size_t count;
+	uint8_t *items;
+};
+
+void mock_reset(void)
+{
+	sim_time = 0;
+	event_task = NULL;
+	heap_allocs = 0;
+	heap_frees = 0;
+}
+
+void mock_run_event_task(uint32_t duration_ms)
+{
+	sim_end = sim_time + duration_ms;
+	if (event_task != NULL && setjmp(sim_exit) == 0)
+		event_task(NULL);
+}
+
+uint32_t mock_queue_count(struct pios_queue *queuep)
+{
+	return ((struct mock_queue *)queuep)->count;
+}
+
+uint32_t mock_heap_allocs(void)
+{
+	return heap_allocs;
+}
+
+uint32_t mock_heap_frees(void)
+{
+	return heap_frees;
+}
+
+void *PIOS_malloc(size_t size)
+{
+	heap_allocs++;
+	return malloc(size);
+}
+
+void PIOS_free(void *buf)
+{
+	heap_frees++;
+}
+
+struct pios_recursive_mutex *PIOS_Recursive_Mutex_Create(void)
+{
+	return (struct pios_recursive_mutex *)PIOS_malloc(sizeof(struct pios_recursive_mutex));
+}
+
+bool PIOS_Recursive_Mutex_Lock(struct pios_recursive_mutex *mtx, uint32_t timeout_ms)
+{
+	return true;
+}
+
+bool PIOS_Recursive_Mutex_Unlock(struct pios_recursive_mutex *mtx)
+{
+	return true;
+}
+
+struct pios_thread *PIOS_Thread_Create(void (*fp)(void *), const char *namep, size_t stack_bytes, void *argp, enum pios_thread_prio_e prio)
+{
+	event_task = fp;
+	return (struct pios_thread *)PIOS_malloc(sizeof(struct pios_thread));
+}
+
+uint32_t PIOS_Thread_Systime(void)
+{
+	return sim_time;
+}
+
+struct pios_queue *PIOS_Queue_Create(size_t queue_length, size_t item_size)
+{
+	struct mock_queue *mq = (struct mock_queue *)PIOS_malloc(sizeof(struct mock_queue));
+	mq->item_size = item_size;
+	mq->length = queue_length;
+	mq->head = 0;
+	mq->count = 0;
+	mq->items = (uint8_t *)PIOS_malloc(queue_length * item_size);
+	return &mq->queue;
+}
+
+bool PIOS_Queue_Send(struct pios_queue *queuep, const void *itemp, uint32_t timeout_ms)
+{
+	struct mock_queue *mq = (struct mock_queue *)queuep;
+	if (mq->count == mq->length)
+		return false;
+	memcpy(&mq->items[((mq->head + mq->count) % mq->length) * mq->item_size], itemp, mq->item_size);
+	mq->count++;
+	return true;
+}
+
+bool PIOS_Queue_Receive(struct pios_queue *queuep, void *itemp, uint32_t timeout_ms)
+{
+	struct mock_queue *mq = (struct mock_queue *)queuep;
+	if (mq->count > 0) {
+		memcpy(itemp, &mq->items[mq->head * mq->item_size], mq->item_size);
+		mq->head = (mq->head + 1) % mq->length;
+		mq->count--;
+		return true;
+	}
+
+	if (sim_time + timeout_ms >= sim_end) {
+		sim_time = sim_end;
+		longjmp(sim_exit, 1);
+	}
+	sim_time += timeout_ms;
+	return false;
+}
+
+uint32_t UAVObjGetID(UAVObjHandle obj)
+{
+	return (uint32_t)(uintptr_t)obj;
+}
+
+int32_t TaskMonitorAdd(TaskInfoRunningElem task, struct pios_thread *handlep)
+{
+	return 0;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -17,6 +17,9 @@ struct flash_posix_dev {
 	const struct pios_flash_posix_cfg * cfg;
 	bool transaction_in_progress;
 	FILE * flash_file;
+	uint32_t read_ops;
+	uint32_t write_ops;
+	uint32_t erase_ops;
 };
 
 static struct flash_posix_dev * PIOS_Flash_Posix_Alloc(void)
@@ -42,6 +45,9 @@ int32_t PIOS_Flash_Posix_Init(uintptr_t * chip_id, const struct pios_flash_posix
 
 	flash_dev->cfg = cfg;
 	flash_dev->transaction_in_progress = false;
+	flash_dev->read_ops = 0;
+	flash_dev->write_ops = 0;
+	flash_dev->erase_ops = 0;
 
 	flash_dev->flash_file = fopen ("theflash.bin", "r+");
 	if (flash_dev->flash_file == NULL) {
@@ -66,6 +72,30 @@ void PIOS_Flash_Posix_Destroy(uintptr_t chip_id)
 	free(flash_dev);
 }
 
+/* Number of read operations since the flash was initialized */
+uint32_t PIOS_Flash_Posix_GetReadOps(uintptr_t chip_id)
+{
+	struct flash_posix_dev * flash_dev = (struct flash_posix_dev *)chip_id;
+
+	return flash_dev->read_ops;
+}
+
+/* Number of write operations since the flash was initialized */
+uint32_t PIOS_Flash_Posix_GetWriteOps(uintptr_t chip_id)
+{
+	struct flash_posix_dev * flash_dev = (struct flash_posix_dev *)chip_id;
+
+	return flash_dev->write_ops;
+}
+
+/* Number of sector erases since the flash was initialized */
+uint32_t PIOS_Flash_Posix_GetEraseOps(uintptr_t chip_id)
+{
+	struct flash_posix_dev * flash_dev = (struct flash_posix_dev *)chip_id;
+
+	return flash_dev->erase_ops;
+}
+
 /**********************************
  *
  * Provide a PIOS flash driver API
@@ -116,6 +146,8 @@ static int32_t PIOS_Flash_Posix_EraseSector(uintptr_t chip_id, uint32_t chip_sec
 
 	assert (s == flash_dev->cfg->size_of_sector);
 
+	flash_dev->erase_ops++;
+
 	return 0;
 }
 
@@ -137,6 +169,8 @@ static int32_t PIOS_Flash_Posix_WriteData(uintptr_t chip_id, uint32_t chip_offse
 
 	assert (s == len);
 
+	flash_dev->write_ops++;
+
 	return 0;
 }
 
@@ -158,6 +192,8 @@ static int32_t PIOS_Flash_Posix_ReadData(uintptr_t chip_id, uint32_t chip_offset
 
 	assert (s == len);
 
+	flash_dev->read_ops++;
+
 	return 0;
 }
 
@@ -7,5 +7,8 @@ struct pios_flash_posix_cfg {
 
 int32_t PIOS_Flash_Posix_Init(uintptr_t * chip_id, const struct pios_flash_posix_cfg * cfg);
 void PIOS_Flash_Posix_Destroy(uintptr_t chip_id);
+uint32_t PIOS_Flash_Posix_GetReadOps(uintptr_t chip_id);
+uint32_t PIOS_Flash_Posix_GetWriteOps(uintptr_t chip_id);
+uint32_t PIOS_Flash_Posix_GetEraseOps(uintptr_t chip_id);
 
 extern const struct pios_flash_driver pios_posix_flash_driver;
@@ -37,6 +37,7 @@
 #include <stdlib.h>		/* abort */
 #include <string.h>		/* memset */
 #include <stdint.h>		/* uint*_t */
+#include <time.h>		/* clock */
 
 extern "C" {
 
@@ -56,6 +57,9 @@ extern struct pios_flash_posix_cfg flash_config;
 
 extern struct flashfs_logfs_cfg flashfs_config_settings;
 extern struct flashfs_logfs_cfg flashfs_config_waypoints;
+extern struct flashfs_logfs_cfg flashfs_config_settings_noindex;
+extern struct flashfs_logfs_cfg flashfs_config_settings_smallindex;
+extern struct flashfs_logfs_cfg flashfs_config_settings_incremental;
 
 #include "pios_flashfs.h"	/* PIOS_FLASHFS_* */
 
@@ -425,3 +429,385 @@ TEST_F(LogfsTestCookedMultiPart, WriteLarge) {
   memset(obj4_check, 0, sizeof(obj4_check));
   EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id_b, OBJ4_ID, 0, obj4_check, sizeof(obj4_check)));
 }
+
+class LogfsTestIndex : public LogfsTestRaw {
+protected:
+  virtual void SetUp() {
+    /* First, we need to set up the super fixture (LogfsTestRaw) */
+    LogfsTestRaw::SetUp();
+
+    EXPECT_EQ(0, PIOS_Flash_Posix_Init(&pios_posix_flash_id, &flash_config));
+
+    /* Register the partition table */
+    PIOS_FLASH_register_partition_table(pios_flash_partition_table, pios_flash_partition_table_size);
+    fs_id = 0;
+  }
+
+  virtual void TearDown() {
+    if (fs_id)
+      PIOS_FLASHFS_Logfs_Destroy(fs_id);
+    PIOS_Flash_Posix_Destroy(pios_posix_flash_id);
+  }
+
+  /* Mount the settings partition as on boot */
+  void Mount(const struct flashfs_logfs_cfg *cfg) {
+    if (fs_id)
+      PIOS_FLASHFS_Logfs_Destroy(fs_id);
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, cfg, FLASH_PARTITION_LABEL_SETTINGS));
+  }
+
+  /* Number of flash reads needed to look up an object which isn't saved */
+  uint32_t MissingLookupReads() {
+    uint32_t reads = PIOS_Flash_Posix_GetReadOps(pios_posix_flash_id);
+    EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id, OBJ4_ID, 0, obj1, sizeof(obj1)));
+    return PIOS_Flash_Posix_GetReadOps(pios_posix_flash_id) - reads;
+  }
+
+  void VerifyInstances(uint16_t first, uint16_t last) {
+    unsigned char obj1_check[OBJ1_SIZE];
+    for (uint16_t i = first; i < last; i++) {
+      memset(obj1_check, 0, sizeof(obj1_check));
+      EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, i, obj1_check, sizeof(obj1_check)));
+      EXPECT_EQ(0, memcmp(obj1, obj1_check, sizeof(obj1)));
+    }
+  }
+
+  uintptr_t fs_id;
+};
+
+TEST_F(LogfsTestIndex, IndexedLookupSkipsScan) {
+  Mount(&flashfs_config_settings_smallindex);
+
+  for (uint16_t i = 0; i < 8; i++)
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, i, obj1, sizeof(obj1)));
+  EXPECT_EQ(0u, MissingLookupReads());
+  VerifyInstances(0, 8);
+
+  /* A new version replaces the indexed one */
+  EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 3, obj1_alt, sizeof(obj1_alt)));
+  unsigned char obj1_check[OBJ1_SIZE];
+  EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 3, obj1_check, sizeof(obj1_check)));
+  EXPECT_EQ(0, memcmp(obj1_alt, obj1_check, sizeof(obj1_alt)));
+
+  EXPECT_EQ(0, PIOS_FLASHFS_ObjDelete(fs_id, OBJ1_ID, 3));
+  EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 3, obj1_check, sizeof(obj1_check)));
+  EXPECT_EQ(0u, MissingLookupReads());
+
+  /* The index is rebuilt on mount */
+  Mount(&flashfs_config_settings_smallindex);
+  EXPECT_EQ(0u, MissingLookupReads());
+  VerifyInstances(0, 3);
+  VerifyInstances(4, 8);
+  EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 3, obj1_check, sizeof(obj1_check)));
+}
+
+TEST_F(LogfsTestIndex, IndexOverflowFallsBackToScan) {
+  Mount(&flashfs_config_settings_smallindex);
+
+  /* More active objects than the index can hold */
+  for (uint16_t i = 0; i < 12; i++)
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, i, obj1, sizeof(obj1)));
+  EXPECT_LT(0u, MissingLookupReads());
+  VerifyInstances(0, 12);
+
+  Mount(&flashfs_config_settings_smallindex);
+  EXPECT_LT(0u, MissingLookupReads());
+  VerifyInstances(0, 12);
+
+  /* Back within the budget the next mount uses the index again */
+  for (uint16_t i = 6; i < 12; i++)
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjDelete(fs_id, OBJ1_ID, i));
+
+  Mount(&flashfs_config_settings_smallindex);
+  EXPECT_EQ(0u, MissingLookupReads());
+  VerifyInstances(0, 6);
+}
+
+TEST_F(LogfsTestIndex, IndexMatchesScan) {
+  Mount(&flashfs_config_settings);
+
+  for (uint32_t i = 0; i < 1000; i++) {
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, i % 37, obj1, sizeof(obj1)));
+    if (i % 5 == 0) {
+      EXPECT_EQ(0, PIOS_FLASHFS_ObjDelete(fs_id, OBJ1_ID, (i * 7) % 37));
+    }
+  }
+
+  /* Both ways of looking up the objects find the same ones */
+  int32_t found[37];
+  unsigned char obj1_check[OBJ1_SIZE];
+  for (uint16_t i = 0; i < 37; i++)
+    found[i] = PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, i, obj1_check, sizeof(obj1_check));
+
+  Mount(&flashfs_config_settings_noindex);
+  for (uint16_t i = 0; i < 37; i++)
+    EXPECT_EQ(found[i], PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, i, obj1_check, sizeof(obj1_check))) << i;
+}
+
+/*
+ * Loading the settings on boot, like UAVObjLoadSettings() does for every
+ * settings object. Some settings were saved several times and some objects
+ * were never saved so keep their defaults.
+ */
+#define BOOT_SAVED_OBJECTS 60
+#define BOOT_DEFAULT_OBJECTS 40
+
+static uint32_t bootObjId(uint32_t i)
+{
+  return 0x10000000 + i * 0x01234567;
+}
+
+static uint16_t bootObjSize(uint32_t i)
+{
+  return 8 + (i * 37) % 200;
+}
+
+static void bootObjData(uint32_t i, uint8_t *data)
+{
+  for (uint16_t j = 0; j < bootObjSize(i); j++)
+    data[j] = i + j;
+}
+
+TEST_F(LogfsTestIndex, BootSettingsLoad) {
+  uint8_t data[256];
+  uint8_t check[256];
+
+  Mount(&flashfs_config_settings);
+  for (uint32_t rev = 0; rev < 4; rev++) {
+    for (uint32_t i = 0; i < BOOT_SAVED_OBJECTS; i++) {
+      if (rev > 0 && i % 3 != 0)
+        continue;
+      bootObjData(i, data);
+      EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, bootObjId(i), 0, data, bootObjSize(i)));
+    }
+  }
+
+  const struct {
+    const char *name;
+    const struct flashfs_logfs_cfg *cfg;
+  } boots[] = {
+    { "scanning the flash", &flashfs_config_settings_noindex },
+    { "with the RAM index", &flashfs_config_settings },
+  };
+  uint32_t reads[2];
+
+  for (uint32_t b = 0; b < 2; b++) {
+    uint32_t start_reads = PIOS_Flash_Posix_GetReadOps(pios_posix_flash_id);
+    clock_t start = clock();
+
+    Mount(boots[b].cfg);
+    for (uint32_t i = 0; i < BOOT_SAVED_OBJECTS + BOOT_DEFAULT_OBJECTS; i++) {
+      if (i < BOOT_SAVED_OBJECTS) {
+        bootObjData(i, data);
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, bootObjId(i), 0, check, bootObjSize(i)));
+        EXPECT_EQ(0, memcmp(data, check, bootObjSize(i)));
+      } else {
+        EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id, bootObjId(i), 0, check, bootObjSize(i)));
+      }
+    }
+
+    double ms = (double) (clock() - start) * 1000 / CLOCKS_PER_SEC;
+    reads[b] = PIOS_Flash_Posix_GetReadOps(pios_posix_flash_id) - start_reads;
+
+    fprintf(stdout, "boot loading %u settings (%u saved) %s: %u flash reads, %.2f ms\n",
+            BOOT_SAVED_OBJECTS + BOOT_DEFAULT_OBJECTS, BOOT_SAVED_OBJECTS, boots[b].name, reads[b], ms);
+  }
+
+  EXPECT_LT(reads[1], reads[0]);
+}
+
+class LogfsTestGarbageCollect : public LogfsTestIndex {
+protected:
+  /* Contents of an instance for a version of it */
+  void InstanceData(uint16_t inst, uint32_t version, unsigned char *data) {
+    for (uint32_t i = 0; i < OBJ1_SIZE; i++)
+      data[i] = inst + version + i;
+  }
+
+  void VerifyModel(const int32_t *versions, uint16_t instances) {
+    unsigned char data[OBJ1_SIZE];
+    unsigned char check[OBJ1_SIZE];
+    for (uint16_t inst = 0; inst < instances; inst++) {
+      if (versions[inst] < 0) {
+        EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, inst, check, sizeof(check))) << inst;
+      } else {
+        InstanceData(inst, versions[inst], data);
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, inst, check, sizeof(check))) << inst;
+        EXPECT_EQ(0, memcmp(data, check, sizeof(data))) << inst;
+      }
+    }
+  }
+};
+
+TEST_F(LogfsTestGarbageCollect, IncrementalKeepsLatestVersions) {
+#define GC_INSTANCES 100
+  int32_t versions[GC_INSTANCES];
+  unsigned char data[OBJ1_SIZE];
+
+  for (uint16_t inst = 0; inst < GC_INSTANCES; inst++)
+    versions[inst] = -1;
+
+  Mount(&flashfs_config_settings_incremental);
+
+  for (uint32_t i = 0; i < 5000; i++) {
+    uint16_t inst = (i * 7) % GC_INSTANCES;
+    if (i % 11 == 0) {
+      EXPECT_EQ(0, PIOS_FLASHFS_ObjDelete(fs_id, OBJ1_ID, inst));
+      versions[inst] = -1;
+    } else {
+      InstanceData(inst, i, data);
+      ASSERT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, inst, data, sizeof(data)));
+      versions[inst] = i;
+    }
+
+    if (i % 13 == 0) {
+      EXPECT_EQ(0, PIOS_FLASHFS_Idle(fs_id));
+    }
+
+    /* Lose power now and then, also in the middle of a collection */
+    if (i % 701 == 0) {
+      Mount(&flashfs_config_settings_incremental);
+      VerifyModel(versions, GC_INSTANCES);
+    }
+  }
+
+  VerifyModel(versions, GC_INSTANCES);
+
+  Mount(&flashfs_config_settings_noindex);
+  VerifyModel(versions, GC_INSTANCES);
+}
+
+/*
+ * Once the log wraps around the partition, the spare arena has to be erased
+ * before the next collection. The system module calls PIOS_FLASHFS_Idle()
+ * right after boot, which must not stall the CPU with a sector erase while
+ * the freshly collected log still has plenty of room.
+ */
+TEST_F(LogfsTestGarbageCollect, IdleDefersSpareErase) {
+  unsigned char data[OBJ1_SIZE];
+  uint32_t min_writes = UINT32_MAX;
+  uint32_t last_collect = 0;
+  uint32_t idle_erases = 0;
+
+  Mount(&flashfs_config_settings_incremental);
+  EXPECT_EQ(0, PIOS_FLASHFS_Format(fs_id));
+
+  /* A plain save replaces a slot, a collection step also copies slots */
+  for (uint32_t i = 0; i < 20; i++) {
+    uint32_t writes = PIOS_Flash_Posix_GetWriteOps(pios_posix_flash_id);
+    InstanceData(i % 10, i, data);
+    ASSERT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, i % 10, data, sizeof(data)));
+    writes = PIOS_Flash_Posix_GetWriteOps(pios_posix_flash_id) - writes;
+    if (i >= 10 && writes < min_writes) min_writes = writes;
+  }
+
+  uint16_t num_slots = flashfs_config_settings_incremental.arena_size /
+    flashfs_config_settings_incremental.slot_size;
+
+  /* Long enough to wrap around the partition a couple of times */
+  for (uint32_t i = 20; i < 15000; i++) {
+    uint32_t writes = PIOS_Flash_Posix_GetWriteOps(pios_posix_flash_id);
+    uint32_t erases = PIOS_Flash_Posix_GetEraseOps(pios_posix_flash_id);
+    InstanceData(i % 10, i, data);
+    ASSERT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, i % 10, data, sizeof(data)));
+    if (PIOS_Flash_Posix_GetWriteOps(pios_posix_flash_id) - writes > min_writes)
+      last_collect = i;
+
+    /* The spare arena is always erased ahead of the collection */
+    EXPECT_EQ(erases, PIOS_Flash_Posix_GetEraseOps(pios_posix_flash_id)) << i;
+
+    /* Reboot once the collection has finished and left the log almost empty */
+    if (last_collect > 0 && i == last_collect + 5)
+      Mount(&flashfs_config_settings_incremental);
+
+    writes = PIOS_Flash_Posix_GetWriteOps(pios_posix_flash_id);
+    erases = PIOS_Flash_Posix_GetEraseOps(pios_posix_flash_id);
+    EXPECT_EQ(0, PIOS_FLASHFS_Idle(fs_id));
+    if (PIOS_Flash_Posix_GetEraseOps(pios_posix_flash_id) != erases) {
+      /* Not right after the collection, only once the log fills up again */
+      EXPECT_GT(i - last_collect, num_slots / 4u) << i;
+      idle_erases++;
+    } else if (PIOS_Flash_Posix_GetWriteOps(pios_posix_flash_id) - writes > 1) {
+      last_collect = i;
+    }
+  }
+
+  EXPECT_GT(idle_erases, 10u);
+}
+
+/*
+ * Worst case cost of a save while a few settings objects are saved over and
+ * over again, like TxPID and Autotune do. The system module calls
+ * PIOS_FLASHFS_Idle() between the saves.
+ */
+struct save_cost {
+  uint32_t erases;
+  uint32_t writes;
+  uint32_t reads;
+  double ms;
+};
+
+static void worstCost(save_cost &worst, const save_cost &cost)
+{
+  if (cost.erases > worst.erases) worst.erases = cost.erases;
+  if (cost.writes > worst.writes) worst.writes = cost.writes;
+  if (cost.reads > worst.reads) worst.reads = cost.reads;
+  if (cost.ms > worst.ms) worst.ms = cost.ms;
+}
+
+TEST_F(LogfsTestGarbageCollect, WorstCaseSaveLatency) {
+  const struct {
+    const char *name;
+    const struct flashfs_logfs_cfg *cfg;
+    bool idle;
+  } modes[] = {
+    { "all at once when full", &flashfs_config_settings, false },
+    { "incremental", &flashfs_config_settings_incremental, false },
+    { "incremental + idle", &flashfs_config_settings_incremental, true },
+  };
+  save_cost worst[3];
+  unsigned char data[OBJ1_SIZE];
+
+  for (uint32_t m = 0; m < 3; m++) {
+    Mount(modes[m].cfg);
+    EXPECT_EQ(0, PIOS_FLASHFS_Format(fs_id));
+
+    /* The settings which are not changed */
+    for (uint16_t inst = 0; inst < 60; inst++) {
+      InstanceData(inst, 0, data);
+      EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ2_ID, inst, data, sizeof(data)));
+    }
+
+    /* Long enough to wrap around the partition and reuse the arenas */
+    memset(&worst[m], 0, sizeof(worst[m]));
+    for (uint32_t i = 0; i < 15000; i++) {
+      if (modes[m].idle && i % 10 == 0) {
+        EXPECT_EQ(0, PIOS_FLASHFS_Idle(fs_id));
+      }
+
+      save_cost cost;
+      uint32_t erases = PIOS_Flash_Posix_GetEraseOps(pios_posix_flash_id);
+      uint32_t writes = PIOS_Flash_Posix_GetWriteOps(pios_posix_flash_id);
+      uint32_t reads = PIOS_Flash_Posix_GetReadOps(pios_posix_flash_id);
+      clock_t start = clock();
+
+      InstanceData(i % 10, i, data);
+      ASSERT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, i % 10, data, sizeof(data)));
+
+      cost.ms = (double) (clock() - start) * 1000 / CLOCKS_PER_SEC;
+      cost.erases = PIOS_Flash_Posix_GetEraseOps(pios_posix_flash_id) - erases;
+      cost.writes = PIOS_Flash_Posix_GetWriteOps(pios_posix_flash_id) - writes;
+      cost.reads = PIOS_Flash_Posix_GetReadOps(pios_posix_flash_id) - reads;
+      worstCost(worst[m], cost);
+    }
+
+    fprintf(stdout, "worst case save, garbage collected %-22s: %u sector erases, %u writes, %u reads, %.2f ms\n",
+            modes[m].name, worst[m].erases, worst[m].writes, worst[m].reads, worst[m].ms);
+  }
+
+  /* Saves never wait for an erase nor for copying the whole arena */
+  EXPECT_EQ(1u, worst[0].erases);
+  EXPECT_EQ(0u, worst[2].erases);
+  EXPECT_LT(worst[1].writes * 4, worst[0].writes);
+  EXPECT_LT(worst[2].writes * 4, worst[0].writes);
+}
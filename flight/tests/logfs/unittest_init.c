@@ -11,6 +11,31 @@ const struct flashfs_logfs_cfg flashfs_config_settings = {
 	.fs_magic      = 0x89abceef,
 	.arena_size    = 0x00010000, /* 256 * slot size */
 	.slot_size     = 0x00000100, /* 256 bytes */
+	.index_slots   = 255,        /* every slot */
+};
+
+/* The settings filesystem collecting its garbage a few slots per save */
+const struct flashfs_logfs_cfg flashfs_config_settings_incremental = {
+	.fs_magic      = 0x89abceef,
+	.arena_size    = 0x00010000, /* 256 * slot size */
+	.slot_size     = 0x00000100, /* 256 bytes */
+	.index_slots   = 255,        /* every slot */
+	.gc_slots      = 4,
+};
+
+/* The settings filesystem without the RAM index */
+const struct flashfs_logfs_cfg flashfs_config_settings_noindex = {
+	.fs_magic      = 0x89abceef,
+	.arena_size    = 0x00010000, /* 256 * slot size */
+	.slot_size     = 0x00000100, /* 256 bytes */
+};
+
+/* The settings filesystem with an index too small for some tests */
+const struct flashfs_logfs_cfg flashfs_config_settings_smallindex = {
+	.fs_magic      = 0x89abceef,
+	.arena_size    = 0x00010000, /* 256 * slot size */
+	.slot_size     = 0x00000100, /* 256 bytes */
+	.index_slots   = 8,
 };
 
 const struct flashfs_logfs_cfg flashfs_config_waypoints = {
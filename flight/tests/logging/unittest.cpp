@@ -0,0 +1,489 @@
+/**
+ ******************************************************************************
+ * @file       unittest.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Unit test
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * NOTE: This program uses the Google Test infrastructure to drive the unit test
+ *
+ * Main site for Google Test: http://code.google.com/p/googletest/
+ * Documentation and examples: http://code.google.com/p/googletest/wiki/Documentation
+ */
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>		/* printf */
+#include <stdint.h>		/* uint*_t */
+
+extern "C" {
+
+#include "logging_priv.h"
+
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class LoggingRate : public testing::Test {
+protected:
+  virtual void SetUp() {
+    logging_rate_reset(&rate, 20);
+  }
+
+  struct logging_rate rate;
+};
+
+TEST_F(LoggingRate, FirstUpdateIsLogged) {
+  EXPECT_TRUE(logging_rate_update(&rate, 1000));
+  EXPECT_TRUE(logging_rate_log(&rate, 1000, 1));
+  EXPECT_EQ(-1, logging_rate_due(&rate, 1000));
+}
+
+TEST_F(LoggingRate, ZeroPeriodLogsEveryUpdate) {
+  logging_rate_reset(&rate, 0);
+
+  for (uint32_t t = 0; t < 10; t++) {
+    EXPECT_TRUE(logging_rate_update(&rate, t));
+    EXPECT_TRUE(logging_rate_log(&rate, t, t + 1));
+    EXPECT_EQ(-1, logging_rate_due(&rate, t));
+  }
+}
+
+TEST_F(LoggingRate, UpdatesWithinPeriodAreHeldBack) {
+  ASSERT_TRUE(logging_rate_update(&rate, 100));
+  ASSERT_TRUE(logging_rate_log(&rate, 100, 1));
+
+  // Held back until the period since the last logged update ends
+  EXPECT_FALSE(logging_rate_update(&rate, 105));
+  EXPECT_EQ(15, logging_rate_due(&rate, 105));
+  EXPECT_FALSE(logging_rate_update(&rate, 112));
+  EXPECT_EQ(8, logging_rate_due(&rate, 112));
+  EXPECT_EQ(0, logging_rate_due(&rate, 120));
+  EXPECT_EQ(0, logging_rate_due(&rate, 125));
+
+  // Only the latest data is logged
+  EXPECT_TRUE(logging_rate_log(&rate, 120, 3));
+  EXPECT_EQ(-1, logging_rate_due(&rate, 120));
+
+  // The next period starts when it was logged
+  EXPECT_FALSE(logging_rate_update(&rate, 139));
+  EXPECT_TRUE(logging_rate_update(&rate, 140));
+}
+
+TEST_F(LoggingRate, UnchangedDataIsNotLogged) {
+  logging_rate_reset(&rate, 0);
+
+  ASSERT_TRUE(logging_rate_update(&rate, 0));
+  EXPECT_TRUE(logging_rate_log(&rate, 0, 42));
+  ASSERT_TRUE(logging_rate_update(&rate, 5));
+  EXPECT_FALSE(logging_rate_log(&rate, 5, 42));
+  ASSERT_TRUE(logging_rate_update(&rate, 10));
+  EXPECT_TRUE(logging_rate_log(&rate, 10, 43));
+}
+
+TEST_F(LoggingRate, HeldBackUnchangedDataIsDropped) {
+  ASSERT_TRUE(logging_rate_update(&rate, 0));
+  ASSERT_TRUE(logging_rate_log(&rate, 0, 42));
+
+  EXPECT_FALSE(logging_rate_update(&rate, 10));
+  EXPECT_EQ(0, logging_rate_due(&rate, 20));
+  EXPECT_FALSE(logging_rate_log(&rate, 20, 42));
+  EXPECT_EQ(-1, logging_rate_due(&rate, 20));
+}
+
+TEST_F(LoggingRate, ResetLogsNextUpdate) {
+  ASSERT_TRUE(logging_rate_update(&rate, 0));
+  ASSERT_TRUE(logging_rate_log(&rate, 0, 42));
+  EXPECT_FALSE(logging_rate_update(&rate, 10));
+
+  logging_rate_reset(&rate, 20);
+  EXPECT_EQ(-1, logging_rate_due(&rate, 10));
+  EXPECT_TRUE(logging_rate_update(&rate, 11));
+  EXPECT_TRUE(logging_rate_log(&rate, 11, 42));
+}
+
+TEST_F(LoggingRate, TimeWraps) {
+  uint32_t t = 0xFFFFFFF0;
+
+  ASSERT_TRUE(logging_rate_update(&rate, t));
+  ASSERT_TRUE(logging_rate_log(&rate, t, 1));
+  EXPECT_FALSE(logging_rate_update(&rate, t + 10));
+  EXPECT_EQ(10, logging_rate_due(&rate, t + 10));
+  EXPECT_EQ(0, logging_rate_due(&rate, t + 20));
+}
+
+/*
+ * Simulated flight comparing the logging of the objects on update against
+ * the polling logger this replaces. The polling logger ran at the default
+ * MaxLogRate of 25 Hz and logged the objects every 1, 2, 10, 50 and 500
+ * loops, FlightStatus whenever it was updated since the last loop.
+ */
+struct log_source {
+  const char *name;
+  uint32_t updatePeriod;	// ms between updates of the object
+  uint32_t changePeriod;	// ms between changes of the data
+  uint32_t pollDivider;		// 0 if logged when updated
+  uint32_t pollOffset;
+  uint16_t logPeriod;		// LoggingSettings.LogPeriod default
+
+  // Statistics of a logger
+  struct stats {
+    uint32_t lastValue;
+    bool logged;
+    uint32_t logs;
+    uint32_t distinct;
+    uint32_t duplicates;
+    uint64_t delay;
+  };
+};
+
+static const log_source sources[] = {
+  { "Gyros",                2,     2,  1, 0,    0 },
+  { "Accels",               2,     2,  1, 0,    0 },
+  { "AttitudeActual",       2,     2,  2, 0,   20 },
+  { "Magnetometer",        13,    13,  2, 0,   20 },
+  { "ManualControlCommand", 20,   20,  2, 0,   20 },
+  { "ActuatorCommand",      2,     2,  2, 0,   20 },
+  { "BaroAltitude",        25,    25, 10, 1,   50 },
+  { "GPSPosition",        200,   200, 10, 1,    0 },
+  { "GPSTime",           1000,  1000, 50, 2, 1000 },
+  { "GPSSatellites",     1000,  5000, 500, 3, 5000 },
+  { "FlightStatus",        20, 20000,  0, 0,    0 },
+};
+
+#define NUM_SOURCES (sizeof(sources) / sizeof(sources[0]))
+#define POLL_PERIOD_MS 40
+#define FLIGHT_MS (5 * 60 * 1000)
+
+// The data of a source changes every changePeriod, the value identifies it
+static uint32_t sourceValue(const log_source &s, uint32_t t)
+{
+  return t / s.changePeriod + 1;
+}
+
+static void countLog(log_source::stats &st, uint32_t value, uint32_t changed, uint32_t t)
+{
+  st.logs++;
+  if (st.logged && st.lastValue == value) {
+    st.duplicates++;
+  } else {
+    st.distinct++;
+    st.delay += t - changed;
+  }
+  st.logged = true;
+  st.lastValue = value;
+}
+
+TEST(LoggingSchedule, DroppedSamplesAgainstPolling) {
+  log_source::stats poll[NUM_SOURCES] = {};
+  log_source::stats event[NUM_SOURCES] = {};
+  struct logging_rate rates[NUM_SOURCES];
+  bool polledUpdate[NUM_SOURCES] = {};
+  uint32_t changes[NUM_SOURCES] = {};
+
+  for (uint32_t i = 0; i < NUM_SOURCES; i++)
+    logging_rate_reset(&rates[i], sources[i].logPeriod);
+
+  for (uint32_t t = 0; t < FLIGHT_MS; t++) {
+    for (uint32_t i = 0; i < NUM_SOURCES; i++) {
+      const log_source &s = sources[i];
+      uint32_t value = sourceValue(s, t);
+      uint32_t changed = (value - 1) * s.changePeriod;
+
+      if (t % s.changePeriod == 0)
+        changes[i]++;
+
+      // Updates are logged as they arrive
+      if (t % s.updatePeriod == 0) {
+        polledUpdate[i] = true;
+        if (logging_rate_update(&rates[i], t) && logging_rate_log(&rates[i], t, value))
+          countLog(event[i], value, changed, t);
+      }
+      if (logging_rate_due(&rates[i], t) == 0 && logging_rate_log(&rates[i], t, value))
+        countLog(event[i], value, changed, t);
+
+      // The polling logger takes whatever the data is at its loop
+      if (t % POLL_PERIOD_MS == 0) {
+        uint32_t loop = t / POLL_PERIOD_MS;
+        bool poll_now = s.pollDivider ? (loop % s.pollDivider) == s.pollOffset : polledUpdate[i];
+        if (poll_now) {
+          countLog(poll[i], value, changed, t);
+          polledUpdate[i] = false;
+        }
+      }
+    }
+  }
+
+  fprintf(stdout, "%-22s %8s | %8s %8s %8s %8s | %8s %8s %8s %8s\n", "5 min flight", "changes",
+          "polled", "dropped", "dupes", "delay", "events", "dropped", "dupes", "delay");
+
+  uint32_t pollDropped = 0, eventDropped = 0, pollLogs = 0, eventLogs = 0;
+  for (uint32_t i = 0; i < NUM_SOURCES; i++) {
+    const log_source &s = sources[i];
+    uint32_t pd = changes[i] - poll[i].distinct;
+    uint32_t ed = changes[i] - event[i].distinct;
+
+    fprintf(stdout, "%-22s %8u | %8u %8u %8u %6.1fms | %8u %8u %8u %6.1fms\n", s.name, changes[i],
+            poll[i].logs, pd, poll[i].duplicates, (double) poll[i].delay / poll[i].distinct,
+            event[i].logs, ed, event[i].duplicates, (double) event[i].delay / event[i].distinct);
+
+    // Nothing is logged twice and no more is dropped than by polling
+    EXPECT_EQ(0u, event[i].duplicates) << s.name;
+    EXPECT_LE(ed, pd) << s.name;
+
+    // Without a rate limit every change is logged as it happens
+    if (s.logPeriod == 0) {
+      EXPECT_EQ(0u, ed) << s.name;
+      EXPECT_EQ(0u, event[i].delay) << s.name;
+    }
+
+    pollDropped += pd;
+    eventDropped += ed;
+    pollLogs += poll[i].logs;
+    eventLogs += event[i].logs;
+  }
+
+  fprintf(stdout, "dropped changes: polling %u in %u logs, on update %u in %u logs\n",
+          pollDropped, pollLogs, eventDropped, eventLogs);
+}
+
+/*
+ * The object manager counts the writes to every object and records the time
+ * of the last one, as in UAVObjGetUpdateTime()
+ */
+struct polled_object {
+  uint32_t seq;
+  uint32_t updateTime;
+};
+
+static void updateObject(polled_object &obj, uint32_t t)
+{
+  obj.seq += 2;
+  obj.updateTime = t;
+}
+
+/*
+ * The logger stalls while the flash erases a sector. Nothing is queued
+ * meanwhile, the updates it missed are counted from the update sequence and
+ * the latest data is logged with its update time when the stall ends.
+ */
+#define STALL_PERIOD_MS 1000
+#define STALL_MS 50
+
+TEST(LoggingSchedule, FlashStallsLogLatestData) {
+  struct logging_rate rates[NUM_SOURCES];
+  polled_object objects[NUM_SOURCES] = {};
+  uint32_t logged[NUM_SOURCES] = {};
+  uint32_t updates[NUM_SOURCES] = {};
+  uint32_t missed[NUM_SOURCES] = {};
+
+  for (uint32_t i = 0; i < NUM_SOURCES; i++)
+    logging_rate_reset(&rates[i], sources[i].logPeriod);
+
+  for (uint32_t t = 0; t < FLIGHT_MS; t++) {
+    for (uint32_t i = 0; i < NUM_SOURCES; i++) {
+      if (t % sources[i].updatePeriod == 0) {
+        updateObject(objects[i], t);
+        updates[i]++;
+      }
+    }
+
+    // The logger polls every tick unless it is stalled
+    if (t % STALL_PERIOD_MS < STALL_MS)
+      continue;
+
+    for (uint32_t i = 0; i < NUM_SOURCES; i++) {
+      uint32_t value = sourceValue(sources[i], t);
+      uint32_t time = objects[i].updateTime;
+      uint32_t n = logging_rate_poll(&rates[i], objects[i].seq);
+      if (n > 1)
+        missed[i] += n - 1;
+
+      if (n > 0 && logging_rate_update(&rates[i], time) && logging_rate_log(&rates[i], time, value))
+        logged[i] = value;
+      if (logging_rate_due(&rates[i], t) == 0) {
+        // The held back update is logged with the time of the latest data
+        EXPECT_EQ(value, sourceValue(sources[i], rates[i].pending_time)) << sources[i].name;
+        if (logging_rate_log(&rates[i], t, value))
+          logged[i] = value;
+      }
+
+      // Without a rate limit the data at the end of a stall is logged right away
+      if (t % STALL_PERIOD_MS == STALL_MS && sources[i].logPeriod == 0) {
+        EXPECT_EQ(value, logged[i]) << sources[i].name << " at " << t;
+      }
+    }
+  }
+
+  for (uint32_t i = 0; i < NUM_SOURCES; i++) {
+    // Only the updates during the stalls are missed
+    uint32_t perStall = (STALL_MS + sources[i].updatePeriod - 1) / sources[i].updatePeriod;
+    EXPECT_LE(missed[i], perStall * (FLIGHT_MS / STALL_PERIOD_MS)) << sources[i].name;
+  }
+
+  fprintf(stdout, "during %u ms stalls every %u ms: Gyros missed %u of %u updates\n",
+          STALL_MS, STALL_PERIOD_MS, missed[0], updates[0]);
+}
+
+/*
+ * The event dispatcher runs the update callbacks of all modules from a
+ * single 20 entry queue. An update callback on the logged objects takes an
+ * entry for every sensor update, and the dispatcher is held off while the
+ * higher priority tasks run, or while the callback of another module saves
+ * an object to flash. A full queue drops the event and raises the EVENTSYSTEM
+ * alarm. The callback only flagged the object for the logger, which logged
+ * the data of all the updates it was woken for at once, stamped when it ran.
+ *
+ * Polling the update sequence of the objects every tick takes no entry of
+ * the queue, and every update is logged with the time it happened.
+ */
+#define DISPATCHER_QUEUE_SIZE 20
+#define DISPATCHER_STALL_PERIOD_MS 100
+#define DISPATCHER_STALL_MS 10
+
+TEST(LoggingSchedule, DispatcherQueueAtSensorRate) {
+  struct logging_rate rates[NUM_SOURCES];
+  struct logging_rate callbackRates[NUM_SOURCES];
+  polled_object objects[NUM_SOURCES] = {};
+  log_source::stats callback[NUM_SOURCES] = {};
+  log_source::stats polled[NUM_SOURCES] = {};
+  bool flagged[NUM_SOURCES] = {};
+  uint32_t changes[NUM_SOURCES] = {};
+  uint64_t callbackStampError[NUM_SOURCES] = {};
+  uint32_t queueDepth = 0, queueMax = 0, queueErrors = 0;
+  uint32_t pollMissed = 0;
+
+  for (uint32_t i = 0; i < NUM_SOURCES; i++) {
+    logging_rate_reset(&rates[i], sources[i].logPeriod);
+    logging_rate_reset(&callbackRates[i], sources[i].logPeriod);
+  }
+
+  for (uint32_t t = 0; t < FLIGHT_MS; t++) {
+    for (uint32_t i = 0; i < NUM_SOURCES; i++) {
+      if (t % sources[i].changePeriod == 0)
+        changes[i]++;
+      if (t % sources[i].updatePeriod != 0)
+        continue;
+
+      updateObject(objects[i], t);
+
+      // One dispatcher event per update of every object with a callback
+      if (queueDepth < DISPATCHER_QUEUE_SIZE) {
+        queueDepth++;
+        flagged[i] = true;
+      } else {
+        queueErrors++;
+      }
+    }
+    if (queueDepth > queueMax)
+      queueMax = queueDepth;
+
+    // The dispatcher drains its queue when it gets to run, the logger runs right after it
+    if (t % DISPATCHER_STALL_PERIOD_MS >= DISPATCHER_STALL_MS) {
+      queueDepth = 0;
+      for (uint32_t i = 0; i < NUM_SOURCES; i++) {
+        const log_source &s = sources[i];
+        uint32_t value = sourceValue(s, t);
+        bool log = false;
+
+        if (flagged[i] && logging_rate_update(&callbackRates[i], t))
+          log = logging_rate_log(&callbackRates[i], t, value);
+        else if (logging_rate_due(&callbackRates[i], t) == 0)
+          log = logging_rate_log(&callbackRates[i], t, value);
+        flagged[i] = false;
+
+        if (log) {
+          countLog(callback[i], value, (value - 1) * s.changePeriod, t);
+          callbackStampError[i] += t - objects[i].updateTime;
+        }
+      }
+    }
+
+    // The polling logger doesn't depend on the dispatcher
+    for (uint32_t i = 0; i < NUM_SOURCES; i++) {
+      const log_source &s = sources[i];
+      uint32_t value = sourceValue(s, t);
+      uint32_t changed = (value - 1) * s.changePeriod;
+      uint32_t time = objects[i].updateTime;
+      uint32_t n = logging_rate_poll(&rates[i], objects[i].seq);
+      if (n > 1)
+        pollMissed += n - 1;
+
+      if (n > 0 && logging_rate_update(&rates[i], time) && logging_rate_log(&rates[i], time, value)) {
+        countLog(polled[i], value, changed, time);
+        EXPECT_EQ(value, sourceValue(s, time)) << s.name;
+      }
+      if (logging_rate_due(&rates[i], t) == 0 && logging_rate_log(&rates[i], t, value)) {
+        // It goes in the log after the later updates of other objects, with their timestamp
+        countLog(polled[i], value, changed, t);
+        EXPECT_EQ(value, sourceValue(s, rates[i].pending_time)) << s.name;
+      }
+    }
+  }
+
+  fprintf(stdout, "%-22s %8s | %8s %8s %8s | %8s %8s %8s\n", "dispatcher stalls", "changes",
+          "callback", "dropped", "stamp", "polled", "dropped", "stamp");
+
+  for (uint32_t i = 0; i < NUM_SOURCES; i++) {
+    const log_source &s = sources[i];
+    uint32_t cd = changes[i] - callback[i].distinct;
+    uint32_t pd = changes[i] - polled[i].distinct;
+
+    fprintf(stdout, "%-22s %8u | %8u %8u %6.2fms | %8u %8u %6.2fms\n", s.name, changes[i],
+            callback[i].logs, cd, (double) callbackStampError[i] / callback[i].logs,
+            polled[i].logs, pd, (double) polled[i].delay / polled[i].distinct);
+
+    EXPECT_LE(pd, cd) << s.name;
+
+    // Without a rate limit every update is logged, stamped with its update time
+    if (s.logPeriod == 0) {
+      EXPECT_EQ(0u, pd) << s.name;
+      EXPECT_EQ(0u, polled[i].delay) << s.name;
+    }
+  }
+
+  fprintf(stdout, "dispatcher queue: max %u of %u, %u events dropped\n",
+          queueMax, DISPATCHER_QUEUE_SIZE, queueErrors);
+
+  // The callbacks overflow the queue and drop Gyros samples, polling misses none
+  EXPECT_GT(queueErrors, 0u);
+  EXPECT_GT(changes[0] - callback[0].distinct, 0u);
+  EXPECT_EQ(0u, pollMissed);
+}
+
+TEST_F(LoggingRate, PollCountsUpdates) {
+  // Every write moves the sequence on by two
+  EXPECT_EQ(0u, logging_rate_poll(&rate, 0));
+  EXPECT_EQ(1u, logging_rate_poll(&rate, 2));
+  EXPECT_EQ(0u, logging_rate_poll(&rate, 2));
+  EXPECT_EQ(3u, logging_rate_poll(&rate, 8));
+
+  // The sequence wraps
+  logging_rate_poll(&rate, 0xFFFFFFFC);
+  EXPECT_EQ(1u, logging_rate_poll(&rate, 0xFFFFFFFE));
+  EXPECT_EQ(2u, logging_rate_poll(&rate, 2));
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -17,6 +17,7 @@ struct flash_posix_dev {
 	const struct pios_flash_posix_cfg * cfg;
 	bool transaction_in_progress;
 	FILE * flash_file;
+	uint32_t write_ops;
 };
 
 static struct flash_posix_dev * PIOS_Flash_Posix_Alloc(void)
@@ -42,6 +43,7 @@ int32_t PIOS_Flash_Posix_Init(uintptr_t * chip_id, const struct pios_flash_posix
 
 	flash_dev->cfg = cfg;
 	flash_dev->transaction_in_progress = false;
+	flash_dev->write_ops = 0;
 
 	flash_dev->flash_file = fopen ("theflash.bin", "r+");
 	if (flash_dev->flash_file == NULL) {
@@ -66,6 +68,14 @@ void PIOS_Flash_Posix_Destroy(uintptr_t chip_id)
 	free(flash_dev);
 }
 
+/* Number of write operations since the flash was initialized */
+uint32_t PIOS_Flash_Posix_GetWriteOps(uintptr_t chip_id)
+{
+	struct flash_posix_dev * flash_dev = (struct flash_posix_dev *)chip_id;
+
+	return flash_dev->write_ops;
+}
+
 /**********************************
  *
  * Provide a PIOS flash driver API
@@ -137,6 +147,8 @@ static int32_t PIOS_Flash_Posix_WriteData(uintptr_t chip_id, uint32_t chip_offse
 
 	assert (s == len);
 
+	flash_dev->write_ops++;
+
 	return 0;
 }
 
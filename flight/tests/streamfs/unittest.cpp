@@ -37,6 +37,7 @@
 #include <stdlib.h>		/* abort */
 #include <string.h>		/* memset */
 #include <stdint.h>		/* uint*_t */
+#include <time.h>		/* clock */
 
 extern "C" {
 
@@ -462,3 +463,98 @@ TEST_F(StreamfsComTest, ComRead) {
   EXPECT_EQ(0, PIOS_STREAMFS_Close(fs_id));
   CompareArray(data1, data_read, DATA_LEN);
 }
+
+TEST_F(StreamfsComTest, ComFlush) {
+  uint8_t data_read[DATA_LEN];
+
+  EXPECT_EQ(-2, PIOS_STREAMFS_Flush(fs_id));
+
+  EXPECT_EQ(0, PIOS_STREAMFS_OpenWrite(fs_id));
+  uint32_t write_ops = PIOS_Flash_Posix_GetWriteOps(pios_posix_flash_id);
+
+  // Small writes are kept in RAM until flushed
+  EXPECT_EQ(10, PIOS_COM_SendBuffer(com_id, data1, 10));
+  EXPECT_EQ(20, PIOS_COM_SendBuffer(com_id, &data1[10], 20));
+  EXPECT_EQ(write_ops, PIOS_Flash_Posix_GetWriteOps(pios_posix_flash_id));
+
+  EXPECT_EQ(0, PIOS_STREAMFS_Flush(fs_id));
+  EXPECT_EQ(write_ops + 1, PIOS_Flash_Posix_GetWriteOps(pios_posix_flash_id));
+  EXPECT_EQ(0, PIOS_STREAMFS_Flush(fs_id));
+  EXPECT_EQ(write_ops + 1, PIOS_Flash_Posix_GetWriteOps(pios_posix_flash_id));
+
+  // Data after a flush continues where it ended
+  EXPECT_EQ(0, PIOS_STREAMFS_Testing_Write(fs_id, &data1[30], DATA_LEN - 30));
+  EXPECT_EQ(0, PIOS_STREAMFS_Close(fs_id));
+
+  EXPECT_EQ(0, PIOS_STREAMFS_OpenRead(fs_id, PIOS_STREAMFS_MaxFileId(fs_id)));
+  EXPECT_EQ(DATA_LEN, PIOS_STREAMFS_Testing_Read(fs_id, data_read, DATA_LEN));
+  CompareArray(data1, data_read, DATA_LEN);
+  EXPECT_EQ(0, PIOS_STREAMFS_Close(fs_id));
+}
+
+/*
+ * Benchmark of logging a stream of UAVTalk sized packets through PIOS_COM,
+ * the way the logging module writes to the file system
+ */
+#define LOG_LEN (1024 * 1024)
+#define LOG_PACKET_MIN 12
+#define LOG_PACKET_MAX 48
+
+static uint8_t logPattern(uint32_t i)
+{
+  return (i * 31 + i / 251) & 0xFF;
+}
+
+TEST_F(StreamfsComTest, ComLoggingThroughput) {
+  uint8_t packet[LOG_PACKET_MAX];
+  uint32_t logged = 0;
+  uint32_t packets = 0;
+
+  EXPECT_EQ(0, PIOS_STREAMFS_OpenWrite(fs_id));
+  uint32_t write_ops = PIOS_Flash_Posix_GetWriteOps(pios_posix_flash_id);
+  clock_t start = clock();
+
+  while (logged < LOG_LEN) {
+    uint16_t len = LOG_PACKET_MIN + (packets * 7) % (LOG_PACKET_MAX - LOG_PACKET_MIN + 1);
+    if (len > LOG_LEN - logged)
+      len = LOG_LEN - logged;
+    for (uint16_t i = 0; i < len; i++)
+      packet[i] = logPattern(logged + i);
+
+    ASSERT_EQ(len, PIOS_COM_SendBuffer(com_id, packet, len));
+    logged += len;
+    packets++;
+  }
+  EXPECT_EQ(0, PIOS_STREAMFS_Close(fs_id));
+
+  double seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+  write_ops = PIOS_Flash_Posix_GetWriteOps(pios_posix_flash_id) - write_ops;
+
+  fprintf(stdout, "logged %u bytes in %u packets: %.0f bytes/sec, %.2f flash writes per KB "
+          "(%.2f writes per KB when programming every packet)\n", logged, packets,
+          seconds > 0 ? logged / seconds : 0.0, write_ops * 1024.0 / logged, packets * 1024.0 / logged);
+
+  // Every page is programmed once, plus the footer of each sector
+  uint32_t data_size = streamfs_settings.arena_size - 14; /* footer */
+  uint32_t pages = (logged + streamfs_settings.write_size - 1) / streamfs_settings.write_size;
+  uint32_t sectors = logged / data_size + 1;
+  EXPECT_LE(write_ops, pages + 2 * sectors);
+
+  // All of it reads back
+  uint8_t data_read[4096];
+  uint32_t total_read = 0;
+  EXPECT_EQ(0, PIOS_STREAMFS_OpenRead(fs_id, PIOS_STREAMFS_MaxFileId(fs_id)));
+  while (total_read < LOG_LEN) {
+    int32_t read = PIOS_STREAMFS_Testing_Read(fs_id, data_read, sizeof(data_read));
+    ASSERT_GT(read, 0);
+    for (int32_t i = 0; i < read; i++) {
+      if (data_read[i] != logPattern(total_read + i)) {
+        ADD_FAILURE() << "Mismatch on element " << total_read + i;
+        break;
+      }
+    }
+    total_read += read;
+  }
+  EXPECT_EQ(0, PIOS_STREAMFS_Testing_Read(fs_id, data_read, sizeof(data_read)));
+  EXPECT_EQ(0, PIOS_STREAMFS_Close(fs_id));
+}
@@ -0,0 +1,20 @@
+/* The object manager is built against the FreeRTOS flavour of the PiOS headers */
+#define PIOS_INCLUDE_FREERTOS
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PIOS_Assert(x) if (!(x)) { while (1) ; }
+#define NELEMENTS(x) (sizeof(x) / sizeof(*(x)))
+
+#include "pios_heap.h"
+#include "pios_mutex.h"
+#include "pios_thread.h"
+#include "pios_flashfs.h"
+#include "uavobjectmanager.h"
+#include "eventdispatcher.h"
+#include "utlist.h"
+
+void mock_set_systime(uint32_t time_ms);
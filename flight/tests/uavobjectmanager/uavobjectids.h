@@ -0,0 +1,6 @@
+/* Objects known to the unit test, in ascending order */
+static const uint32_t uavo_ids[] = {
+	0x00001234,
+	0x00005678,
+	0x00009ABC,
+};
@@ -0,0 +1,384 @@
+/**
+ ******************************************************************************
+ * @file       unittest.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Unit test
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * NOTE: This program uses the Google Test infrastructure to drive the unit test
+ *
+ * Main site for Google Test: http://code.google.com/p/googletest/
+ * Documentation and examples: http://code.google.com/p/googletest/wiki/Documentation
+ */
+
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>		/* printf */
+#include <stdint.h>		/* uint*_t */
+#include <pthread.h>
+
+extern "C" {
+
+#include "openpilot.h"
+
+}
+
+#define TEST_OBJ_ID 0x1234
+#define TEST_MULTI_OBJ_ID 0x5678
+#define TEST_UNREGISTERED_OBJ_ID 0x9ABC
+#define TEST_WORDS 256
+
+/* Every write stores the same value in all words, so any mix of two
+ * writes is detected by the readers */
+struct TestData {
+  uint32_t words[TEST_WORDS];
+};
+
+static bool consistent(const TestData &data)
+{
+  for (int i = 1; i < TEST_WORDS; i++) {
+    if (data.words[i] != data.words[0])
+      return false;
+  }
+  return true;
+}
+
+static void fill(TestData *data, uint32_t value)
+{
+  for (int i = 0; i < TEST_WORDS; i++)
+    data->words[i] = value;
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class UAVObjectManager : public testing::Test {
+protected:
+  virtual void SetUp() {
+    ASSERT_EQ(0, UAVObjInitialize());
+    obj = UAVObjRegister(TEST_OBJ_ID, 1, 0, sizeof(TestData), NULL);
+    ASSERT_TRUE(obj != NULL);
+    multi = UAVObjRegister(TEST_MULTI_OBJ_ID, 0, 0, sizeof(TestData), NULL);
+    ASSERT_TRUE(multi != NULL);
+  }
+
+  virtual void TearDown() {
+  }
+
+  UAVObjHandle obj;
+  UAVObjHandle multi;
+};
+
+TEST_F(UAVObjectManager, GetByID) {
+  EXPECT_EQ(obj, UAVObjGetByID(TEST_OBJ_ID));
+  EXPECT_EQ(multi, UAVObjGetByID(TEST_MULTI_OBJ_ID));
+  EXPECT_EQ(UAVObjGetLinkedObj(obj), UAVObjGetByID(TEST_OBJ_ID + 1));
+  EXPECT_EQ(UAVObjGetLinkedObj(multi), UAVObjGetByID(TEST_MULTI_OBJ_ID + 1));
+  EXPECT_EQ((uint32_t)TEST_OBJ_ID + 1, UAVObjGetID(UAVObjGetByID(TEST_OBJ_ID + 1)));
+
+  // Known but not registered
+  EXPECT_TRUE(UAVObjGetByID(TEST_UNREGISTERED_OBJ_ID) == NULL);
+  EXPECT_TRUE(UAVObjGetByID(TEST_UNREGISTERED_OBJ_ID + 1) == NULL);
+
+  // Not part of the build
+  EXPECT_TRUE(UAVObjGetByID(0x4321) == NULL);
+  EXPECT_TRUE(UAVObjGetByID(0) == NULL);
+  EXPECT_TRUE(UAVObjGetByID(0xFFFFFFFF) == NULL);
+  EXPECT_TRUE(UAVObjRegister(0x4321, 1, 0, sizeof(TestData), NULL) == NULL);
+
+  // Objects can only be registered once
+  EXPECT_TRUE(UAVObjRegister(TEST_OBJ_ID, 1, 0, sizeof(TestData), NULL) == NULL);
+
+  EXPECT_EQ(2, UAVObjCount());
+  EXPECT_EQ((uint32_t)TEST_OBJ_ID, UAVObjIDByIndex(0));
+  EXPECT_EQ((uint32_t)TEST_MULTI_OBJ_ID, UAVObjIDByIndex(1));
+  EXPECT_EQ(0U, UAVObjIDByIndex(2));
+}
+
+TEST_F(UAVObjectManager, SetGetPack) {
+  TestData in, out;
+  fill(&in, 42);
+
+  EXPECT_EQ(0, UAVObjSetData(obj, &in));
+  EXPECT_EQ(0, UAVObjGetData(obj, &out));
+  EXPECT_EQ(0, memcmp(&in, &out, sizeof(in)));
+
+  uint8_t packed[sizeof(TestData)];
+  EXPECT_EQ(0, UAVObjPack(obj, 0, packed));
+  EXPECT_EQ(0, memcmp(&in, packed, sizeof(in)));
+
+  fill(&in, 7);
+  EXPECT_EQ(0, UAVObjUnpack(obj, 0, (uint8_t *)&in));
+  EXPECT_EQ(0, UAVObjGetData(obj, &out));
+  EXPECT_EQ(0, memcmp(&in, &out, sizeof(in)));
+
+  // A single instance object has no instance 1
+  EXPECT_EQ(-1, UAVObjGetInstanceData(obj, 1, &out));
+  EXPECT_EQ(-1, UAVObjPack(obj, 1, packed));
+}
+
+TEST_F(UAVObjectManager, Fields) {
+  TestData in;
+  fill(&in, 1);
+  EXPECT_EQ(0, UAVObjSetData(obj, &in));
+
+  uint32_t value = 99;
+  EXPECT_EQ(0, UAVObjSetDataField(obj, &value, 3 * sizeof(uint32_t), sizeof(value)));
+  value = 0;
+  EXPECT_EQ(0, UAVObjGetDataField(obj, &value, 3 * sizeof(uint32_t), sizeof(value)));
+  EXPECT_EQ(99U, value);
+  EXPECT_EQ(0, UAVObjGetDataField(obj, &value, 4 * sizeof(uint32_t), sizeof(value)));
+  EXPECT_EQ(1U, value);
+
+  // Fields must stay within the object
+  EXPECT_EQ(-1, UAVObjGetDataField(obj, &value, sizeof(TestData) - 2, sizeof(value)));
+  EXPECT_EQ(-1, UAVObjSetDataField(obj, &value, sizeof(TestData) - 2, sizeof(value)));
+}
+
+TEST_F(UAVObjectManager, Metadata) {
+  UAVObjMetadata meta;
+  EXPECT_EQ(0, UAVObjGetMetadata(obj, &meta));
+  meta.telemetryUpdatePeriod = 123;
+  EXPECT_EQ(0, UAVObjSetMetadata(obj, &meta));
+
+  UAVObjMetadata out;
+  EXPECT_EQ(0, UAVObjGetMetadata(obj, &out));
+  EXPECT_EQ(0, memcmp(&meta, &out, sizeof(meta)));
+
+  // The meta object packs the same data
+  uint8_t packed[sizeof(UAVObjMetadata)];
+  EXPECT_EQ(0, UAVObjPack(UAVObjGetLinkedObj(obj), 0, packed));
+  EXPECT_EQ(0, memcmp(&meta, packed, sizeof(meta)));
+}
+
+TEST_F(UAVObjectManager, UpdateTime) {
+  TestData in;
+  uint32_t seq, next;
+  fill(&in, 1);
+
+  EXPECT_EQ(0U, UAVObjGetUpdateTime(obj, &seq));
+
+  // Every write records its time and moves the sequence on
+  mock_set_systime(1000);
+  EXPECT_EQ(0, UAVObjSetData(obj, &in));
+  EXPECT_EQ(1000U, UAVObjGetUpdateTime(obj, &next));
+  EXPECT_EQ(seq + 2, next);
+
+  mock_set_systime(1002);
+  EXPECT_EQ(0, UAVObjSetDataField(obj, &in, 0, sizeof(uint32_t)));
+  EXPECT_EQ(1002U, UAVObjGetUpdateTime(obj, &seq));
+  EXPECT_EQ(next + 2, seq);
+
+  // Reading leaves them alone
+  mock_set_systime(1010);
+  EXPECT_EQ(0, UAVObjGetData(obj, &in));
+  EXPECT_EQ(1002U, UAVObjGetUpdateTime(obj, &next));
+  EXPECT_EQ(seq, next);
+
+  // The metadata shares the sequence of the object
+  UAVObjMetadata meta;
+  EXPECT_EQ(0, UAVObjGetMetadata(obj, &meta));
+  EXPECT_EQ(0, UAVObjSetMetadata(obj, &meta));
+  EXPECT_EQ(1010U, UAVObjGetUpdateTime(UAVObjGetLinkedObj(obj), &next));
+  EXPECT_EQ(seq + 2, next);
+  EXPECT_EQ(1010U, UAVObjGetUpdateTime(obj, &seq));
+  EXPECT_EQ(next, seq);
+
+  // Any instance of a multi instance object
+  mock_set_systime(1020);
+  EXPECT_EQ(1U, UAVObjCreateInstance(multi, NULL));
+  EXPECT_EQ(0, UAVObjSetInstanceData(multi, 1, &in));
+  EXPECT_EQ(1020U, UAVObjGetUpdateTime(multi, &seq));
+}
+
+TEST_F(UAVObjectManager, Instances) {
+  TestData in, out;
+
+  // Unpacking an instance creates all instances before it
+  fill(&in, 5);
+  EXPECT_EQ(0, UAVObjUnpack(multi, 3, (uint8_t *)&in));
+  EXPECT_EQ(4, UAVObjGetNumInstances(multi));
+  EXPECT_EQ(0, UAVObjGetInstanceData(multi, 3, &out));
+  EXPECT_EQ(0, memcmp(&in, &out, sizeof(in)));
+  EXPECT_EQ(0, UAVObjGetInstanceData(multi, 2, &out));
+  EXPECT_EQ(0U, out.words[0]);
+  EXPECT_EQ(-1, UAVObjGetInstanceData(multi, 4, &out));
+
+  EXPECT_EQ(4, UAVObjCreateInstance(multi, NULL));
+  EXPECT_EQ(5, UAVObjGetNumInstances(multi));
+}
+
+TEST_F(UAVObjectManager, ManyInstances) {
+  TestData in, out;
+  const uint16_t count = 512;
+
+  for (uint16_t i = 1; i < count; i++)
+    EXPECT_EQ(i, UAVObjCreateInstance(multi, NULL));
+  EXPECT_EQ(count, UAVObjGetNumInstances(multi));
+
+  for (uint16_t i = 0; i < count; i++) {
+    fill(&in, i);
+    EXPECT_EQ(0, UAVObjSetInstanceData(multi, i, &in));
+  }
+
+  // Every instance has its own storage
+  for (uint16_t i = 0; i < count; i++) {
+    EXPECT_EQ(0, UAVObjGetInstanceData(multi, i, &out));
+    EXPECT_EQ(i, out.words[0]);
+    EXPECT_TRUE(consistent(out));
+  }
+  EXPECT_EQ(-1, UAVObjGetInstanceData(multi, count, &out));
+
+  // The limit is enforced
+  EXPECT_EQ(-1, UAVObjUnpack(multi, UAVOBJ_MAX_INSTANCES, (uint8_t *)&in));
+  EXPECT_EQ(0, UAVObjUnpack(multi, UAVOBJ_MAX_INSTANCES - 1, (uint8_t *)&in));
+  EXPECT_EQ(UAVOBJ_MAX_INSTANCES, UAVObjGetNumInstances(multi));
+  EXPECT_EQ(0, UAVObjGetInstanceData(multi, UAVOBJ_MAX_INSTANCES - 1, &out));
+  EXPECT_EQ(0, memcmp(&in, &out, sizeof(in)));
+}
+
+/* Shared state of the stress test threads */
+struct StressState {
+  UAVObjHandle obj;
+  UAVObjHandle multi;
+  volatile bool done;
+  uint32_t iterations;
+  uint32_t inconsistent;
+  uint32_t reads;
+};
+
+static void *writerThread(void *arg)
+{
+  StressState *state = (StressState *)arg;
+  TestData data;
+
+  for (uint32_t i = 1; i <= state->iterations; i++) {
+    fill(&data, i);
+    if (i % 2)
+      UAVObjSetData(state->obj, &data);
+    else
+      UAVObjUnpack(state->obj, 0, (uint8_t *)&data);
+  }
+
+  return NULL;
+}
+
+static void *readerThread(void *arg)
+{
+  StressState *state = (StressState *)arg;
+  TestData data;
+  uint32_t reads = 0, inconsistent = 0;
+
+  while (!state->done) {
+    switch (reads % 3) {
+    case 0:
+      UAVObjGetData(state->obj, &data);
+      break;
+    case 1:
+      UAVObjGetDataField(state->obj, &data, 0, sizeof(data));
+      break;
+    case 2:
+      UAVObjPack(state->obj, 0, (uint8_t *)&data);
+      break;
+    }
+    if (!consistent(data))
+      inconsistent++;
+    reads++;
+  }
+
+  __sync_fetch_and_add(&state->reads, reads);
+  __sync_fetch_and_add(&state->inconsistent, inconsistent);
+  return NULL;
+}
+
+static void *instanceThread(void *arg)
+{
+  StressState *state = (StressState *)arg;
+  TestData data;
+
+  // Instances are created while the readers walk the list
+  for (uint32_t i = 1; i < 200; i++) {
+    fill(&data, i);
+    UAVObjUnpack(state->multi, i, (uint8_t *)&data);
+  }
+
+  return NULL;
+}
+
+static void *instanceReaderThread(void *arg)
+{
+  StressState *state = (StressState *)arg;
+  TestData data;
+  uint32_t inconsistent = 0;
+
+  while (!state->done) {
+    uint16_t instId = UAVObjGetNumInstances(state->multi) - 1;
+    if (UAVObjGetInstanceData(state->multi, instId, &data) != 0 || !consistent(data))
+      inconsistent++;
+  }
+
+  __sync_fetch_and_add(&state->inconsistent, inconsistent);
+  return NULL;
+}
+
+TEST_F(UAVObjectManager, ConcurrentReadersAndWriters) {
+  const int numWriters = 2;
+  const int numReaders = 4;
+  StressState state;
+  state.obj = obj;
+  state.multi = multi;
+  state.done = false;
+  state.iterations = 200000;
+  state.inconsistent = 0;
+  state.reads = 0;
+
+  UAVObjClearStats();
+
+  pthread_t writers[numWriters], readers[numReaders], creator, instanceReader;
+  for (int i = 0; i < numReaders; i++)
+    ASSERT_EQ(0, pthread_create(&readers[i], NULL, readerThread, &state));
+  ASSERT_EQ(0, pthread_create(&instanceReader, NULL, instanceReaderThread, &state));
+  for (int i = 0; i < numWriters; i++)
+    ASSERT_EQ(0, pthread_create(&writers[i], NULL, writerThread, &state));
+  ASSERT_EQ(0, pthread_create(&creator, NULL, instanceThread, &state));
+
+  for (int i = 0; i < numWriters; i++)
+    pthread_join(writers[i], NULL);
+  pthread_join(creator, NULL);
+  state.done = true;
+  for (int i = 0; i < numReaders; i++)
+    pthread_join(readers[i], NULL);
+  pthread_join(instanceReader, NULL);
+
+  EXPECT_EQ(0U, state.inconsistent);
+  EXPECT_EQ(200, UAVObjGetNumInstances(multi));
+
+  UAVObjStats stats;
+  UAVObjGetStats(&stats);
+  printf("%u reads, %u read retries, %u lock contentions, %u us max wait\n",
+    state.reads, stats.readRetries, stats.lockContentions, stats.lockMaxWait);
+
+  UAVObjClearStats();
+  UAVObjGetStats(&stats);
+  EXPECT_EQ(0U, stats.readRetries);
+  EXPECT_EQ(0U, stats.lockContentions);
+}
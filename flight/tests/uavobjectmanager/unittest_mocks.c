@@ -0,0 +1,133 @@
+/**
+ ******************************************************************************
+ * @file       unittest_mocks.c
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Posix backed PiOS services for the object manager unit test
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "openpilot.h"
+#include "pios_delay.h"
+
+#include <pthread.h>
+#include <time.h>
+
+uintptr_t pios_uavo_settings_fs_id;
+
+void *PIOS_malloc_no_dma(size_t size)
+{
+	return malloc(size);
+}
+
+void *PIOS_malloc(size_t size)
+{
+	return malloc(size);
+}
+
+void PIOS_free(void *buf)
+{
+	free(buf);
+}
+
+struct pios_recursive_mutex *PIOS_Recursive_Mutex_Create(void)
+{
+	struct pios_recursive_mutex *mtx = malloc(sizeof(*mtx));
+	pthread_mutex_t *handle = malloc(sizeof(*handle));
+	pthread_mutexattr_t attr;
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(handle, &attr);
+	pthread_mutexattr_destroy(&attr);
+
+	mtx->mtx_handle = (uintptr_t) handle;
+	return mtx;
+}
+
+bool PIOS_Recursive_Mutex_Lock(struct pios_recursive_mutex *mtx, uint32_t timeout_ms)
+{
+	pthread_mutex_t *handle = (pthread_mutex_t *) mtx->mtx_handle;
+
+	if (timeout_ms == 0)
+		return pthread_mutex_trylock(handle) == 0;
+
+	return pthread_mutex_lock(handle) == 0;
+}
+
+bool PIOS_Recursive_Mutex_Unlock(struct pios_recursive_mutex *mtx)
+{
+	return pthread_mutex_unlock((pthread_mutex_t *) mtx->mtx_handle) == 0;
+}
+
+static uint32_t sim_time;
+
+void mock_set_systime(uint32_t time_ms)
+{
+	sim_time = time_ms;
+}
+
+uint32_t PIOS_Thread_Systime(void)
+{
+	return sim_time;
+}
+
+uint32_t PIOS_DELAY_GetRaw()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+uint32_t PIOS_DELAY_DiffuS(uint32_t raw)
+{
+	return PIOS_DELAY_GetRaw() - raw;
+}
+
+bool PIOS_Queue_Send(struct pios_queue *queuep, const void *itemp, uint32_t timeout_ms)
+{
+	return true;
+}
+
+int32_t EventCallbackDispatch(UAVObjEvent *ev, UAVObjEventCallback cb)
+{
+	return 0;
+}
+
+/* There is no settings partition, objects keep their defaults */
+int32_t PIOS_FLASHFS_ObjSave(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst_id, uint8_t * obj_data, uint16_t obj_size)
+{
+	return -1;
+}
+
+int32_t PIOS_FLASHFS_ObjLoad(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst_id, uint8_t * obj_data, uint16_t obj_size)
+{
+	return -1;
+}
+
+int32_t PIOS_FLASHFS_ObjDelete(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst_id)
+{
+	return -1;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,2 @@
+/* Only what the PiOS headers need from the FreeRTOS configuration */
+#define configMINIMAL_STACK_SIZE 128
@@ -0,0 +1,2 @@
+/* pios_crc.c expects its declarations from pios.h */
+#include "openpilot.h"
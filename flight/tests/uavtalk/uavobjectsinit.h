@@ -0,0 +1,2 @@
+/* Size of the largest object known to the unit test */
+#define UAVOBJECTS_LARGEST 64
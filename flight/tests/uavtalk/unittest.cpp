@@ -0,0 +1,683 @@
+/**
+ ******************************************************************************
+ * @file       unittest.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Unit test
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * NOTE: This program uses the Google Test infrastructure to drive the unit test
+ *
+ * Main site for Google Test: http://code.google.com/p/googletest/
+ * Documentation and examples: http://code.google.com/p/googletest/wiki/Documentation
+ */
+
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>		/* printf */
+#include <stdint.h>		/* uint*_t */
+#include <vector>
+extern "C" {
+
+#include "openpilot.h"
+#include "uavtalk_priv.h"
+#include "unittest_mocks.h"
+
+}
+
+#define TIMEOUT_MS 250
+
+static std::vector< std::vector<uint8_t> > sent;
+
+static int32_t capture(uint8_t *data, int32_t length)
+{
+  sent.push_back(std::vector<uint8_t>(data, data + length));
+  return length;
+}
+
+static uint8_t sentType(size_t i)
+{
+  return sent[i][1];
+}
+
+static uint32_t sentObjId(size_t i)
+{
+  return sent[i][4] | (sent[i][5] << 8) | (sent[i][6] << 16) | (sent[i][7] << 24);
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class UAVTalk : public testing::Test {
+protected:
+  virtual void SetUp() {
+    mock_systime = 0;
+    mock_peer = false;
+    sent.clear();
+    for (int i = 0; i < MOCK_UAVO_COUNT; i++)
+      mock_uavos[i].unpacked = 0;
+    con = UAVTalkInitialize(&capture);
+    ASSERT_TRUE(con != NULL);
+  }
+
+  UAVObjHandle obj(int i) {
+    return (UAVObjHandle) &mock_uavos[i];
+  }
+
+  /* Feed a packet from the other end of the link into the parser */
+  void receive(uint8_t type, int i, uint16_t instId) {
+    struct mock_uavo *uavo = &mock_uavos[i];
+    uint8_t pkt[UAVTALK_MAX_PACKET_LENGTH];
+    uint16_t len = 8;
+
+    pkt[0] = UAVTALK_SYNC_VAL;
+    pkt[1] = type;
+    pkt[4] = uavo->id & 0xFF;
+    pkt[5] = (uavo->id >> 8) & 0xFF;
+    pkt[6] = (uavo->id >> 16) & 0xFF;
+    pkt[7] = (uavo->id >> 24) & 0xFF;
+    if (!uavo->single) {
+      pkt[len++] = instId & 0xFF;
+      pkt[len++] = (instId >> 8) & 0xFF;
+    }
+    if (type == UAVTALK_TYPE_OBJ) {
+      memset(&pkt[len], 0x5A, uavo->num_bytes);
+      len += uavo->num_bytes;
+    }
+    pkt[2] = len & 0xFF;
+    pkt[3] = (len >> 8) & 0xFF;
+    pkt[len] = PIOS_CRC_updateCRC(0, pkt, len);
+
+    UAVTalkRxState state = UAVTALK_STATE_ERROR;
+    for (uint16_t n = 0; n <= len; n++)
+      state = UAVTalkProcessInputStream(con, pkt[n]);
+    ASSERT_EQ(UAVTALK_STATE_COMPLETE, state);
+  }
+
+  UAVTalkStats stats() {
+    UAVTalkStats s;
+    UAVTalkGetStats(con, &s);
+    return s;
+  }
+
+  UAVTalkConnection con;
+};
+
+TEST_F(UAVTalk, WindowedSendsDontWait) {
+  for (int i = 0; i < UAVTALK_ACK_WINDOW; i++)
+    EXPECT_EQ(0, UAVTalkSendObjectWindowed(con, obj(i), 0, 1, TIMEOUT_MS, 1));
+
+  // All objects are on the link without waiting for a single ack
+  EXPECT_EQ(0U, mock_systime);
+  ASSERT_EQ((size_t) UAVTALK_ACK_WINDOW, sent.size());
+  for (int i = 0; i < UAVTALK_ACK_WINDOW; i++) {
+    EXPECT_EQ(UAVTALK_TYPE_OBJ_ACK, sentType(i));
+    EXPECT_EQ(mock_uavos[i].id, sentObjId(i));
+  }
+  EXPECT_EQ(TIMEOUT_MS, UAVTalkProcessPendingTransactions(con));
+
+  // Unacked objects don't use the window
+  EXPECT_EQ(0, UAVTalkSendObjectWindowed(con, obj(4), 0, 0, TIMEOUT_MS, 1));
+  EXPECT_EQ(0U, mock_systime);
+  EXPECT_EQ(UAVTALK_TYPE_OBJ, sentType(UAVTALK_ACK_WINDOW));
+}
+
+TEST_F(UAVTalk, AckCompletesTransaction) {
+  EXPECT_EQ(0, UAVTalkSendObjectWindowed(con, obj(0), 0, 1, TIMEOUT_MS, 1));
+  EXPECT_EQ(0, UAVTalkSendObjectWindowed(con, obj(1), 0, 1, TIMEOUT_MS, 1));
+
+  // An object update is not an ack
+  receive(UAVTALK_TYPE_OBJ, 0, 0);
+  mock_systime = 100;
+  EXPECT_EQ(TIMEOUT_MS - 100, UAVTalkProcessPendingTransactions(con));
+
+  // Acks can arrive in any order
+  receive(UAVTALK_TYPE_ACK, 1, 0);
+  EXPECT_EQ(TIMEOUT_MS - 100, UAVTalkProcessPendingTransactions(con));
+  receive(UAVTALK_TYPE_ACK, 0, 0);
+  EXPECT_EQ(-1, UAVTalkProcessPendingTransactions(con));
+
+  // Nothing is sent again once acked
+  mock_systime = 10 * TIMEOUT_MS;
+  EXPECT_EQ(-1, UAVTalkProcessPendingTransactions(con));
+  EXPECT_EQ(2U, sent.size());
+  EXPECT_EQ(0U, stats().txRetries);
+  EXPECT_EQ(0U, stats().txErrors);
+}
+
+TEST_F(UAVTalk, AckMatchesInstance) {
+  EXPECT_EQ(0, UAVTalkSendObjectWindowed(con, obj(2), 3, 1, TIMEOUT_MS, 1));
+
+  receive(UAVTALK_TYPE_ACK, 2, 2);
+  EXPECT_EQ(TIMEOUT_MS, UAVTalkProcessPendingTransactions(con));
+  receive(UAVTALK_TYPE_ACK, 2, 3);
+  EXPECT_EQ(-1, UAVTalkProcessPendingTransactions(con));
+}
+
+TEST_F(UAVTalk, TimeoutRetriesThenFails) {
+  EXPECT_EQ(0, UAVTalkSendObjectWindowed(con, obj(0), 0, 1, TIMEOUT_MS, 1));
+
+  // Not overdue yet
+  mock_systime = TIMEOUT_MS - 1;
+  EXPECT_EQ(1, UAVTalkProcessPendingTransactions(con));
+  EXPECT_EQ(1U, sent.size());
+
+  // The first timeout sends the object again
+  mock_systime = TIMEOUT_MS;
+  EXPECT_EQ(TIMEOUT_MS, UAVTalkProcessPendingTransactions(con));
+  ASSERT_EQ(2U, sent.size());
+  EXPECT_EQ(UAVTALK_TYPE_OBJ_ACK, sentType(1));
+  EXPECT_EQ(1U, stats().txRetries);
+  EXPECT_EQ(0U, stats().txErrors);
+
+  // The second one gives up
+  mock_systime = 2 * TIMEOUT_MS;
+  EXPECT_EQ(-1, UAVTalkProcessPendingTransactions(con));
+  EXPECT_EQ(2U, sent.size());
+  EXPECT_EQ(1U, stats().txRetries);
+  EXPECT_EQ(1U, stats().txErrors);
+}
+
+TEST_F(UAVTalk, FullWindowWaitsForAck) {
+  for (int i = 0; i < UAVTALK_ACK_WINDOW; i++)
+    EXPECT_EQ(0, UAVTalkSendObjectWindowed(con, obj(i), 0, 1, TIMEOUT_MS, 1));
+
+  // A slot freed by an ack is reused right away
+  receive(UAVTALK_TYPE_ACK, 1, 0);
+  EXPECT_EQ(0, UAVTalkSendObjectWindowed(con, obj(4), 0, 1, TIMEOUT_MS, 1));
+  EXPECT_EQ(0U, mock_systime);
+  EXPECT_EQ((size_t) UAVTALK_ACK_WINDOW + 1, sent.size());
+}
+
+TEST_F(UAVTalk, FullWindowWaitsForTimeout) {
+  for (int i = 0; i < UAVTALK_ACK_WINDOW; i++)
+    EXPECT_EQ(0, UAVTalkSendObjectWindowed(con, obj(i), 0, 1, TIMEOUT_MS, 0));
+
+  // Without acks the sender waits until the oldest transactions fail
+  EXPECT_EQ(0, UAVTalkSendObjectWindowed(con, obj(4), 0, 1, TIMEOUT_MS, 0));
+  EXPECT_EQ((uint32_t) TIMEOUT_MS, mock_systime);
+  EXPECT_EQ((uint32_t) UAVTALK_ACK_WINDOW, stats().txErrors);
+  ASSERT_EQ((size_t) UAVTALK_ACK_WINDOW + 1, sent.size());
+  EXPECT_EQ(mock_uavos[4].id, sentObjId(UAVTALK_ACK_WINDOW));
+
+  // Only the last one is still pending
+  receive(UAVTALK_TYPE_ACK, 4, 0);
+  EXPECT_EQ(-1, UAVTalkProcessPendingTransactions(con));
+}
+
+TEST_F(UAVTalk, UpdateTakesOverTransaction) {
+  for (int n = 0; n < 2 * UAVTALK_ACK_WINDOW; n++)
+    EXPECT_EQ(0, UAVTalkSendObjectWindowed(con, obj(0), 0, 1, TIMEOUT_MS, 1));
+  for (int i = 1; i < UAVTALK_ACK_WINDOW; i++)
+    EXPECT_EQ(0, UAVTalkSendObjectWindowed(con, obj(i), 0, 1, TIMEOUT_MS, 1));
+
+  // Every update was sent but they only used one slot
+  EXPECT_EQ(0U, mock_systime);
+  EXPECT_EQ((size_t) 3 * UAVTALK_ACK_WINDOW - 1, sent.size());
+
+  receive(UAVTALK_TYPE_ACK, 0, 0);
+  for (int i = 1; i < UAVTALK_ACK_WINDOW; i++)
+    receive(UAVTALK_TYPE_ACK, i, 0);
+  EXPECT_EQ(-1, UAVTalkProcessPendingTransactions(con));
+}
+
+TEST_F(UAVTalk, RequestCompletedByObject) {
+  EXPECT_EQ(0, UAVTalkSendObjectRequestWindowed(con, obj(5), 0, TIMEOUT_MS, 1));
+  ASSERT_EQ(1U, sent.size());
+  EXPECT_EQ(UAVTALK_TYPE_OBJ_REQ, sentType(0));
+
+  // Requests are answered with the object, not an ack
+  receive(UAVTALK_TYPE_ACK, 5, 0);
+  EXPECT_EQ(TIMEOUT_MS, UAVTalkProcessPendingTransactions(con));
+
+  receive(UAVTALK_TYPE_OBJ, 5, 0);
+  EXPECT_EQ(1U, mock_uavos[5].unpacked);
+  EXPECT_EQ(0x5A, mock_uavos[5].data[0]);
+  EXPECT_EQ(-1, UAVTalkProcessPendingTransactions(con));
+}
+
+/* Feed a packet captured from one connection into another one */
+static void forward(UAVTalkConnection to, const std::vector<uint8_t> &pkt)
+{
+  UAVTalkRxState state = UAVTALK_STATE_ERROR;
+  for (size_t n = 0; n < pkt.size(); n++)
+    state = UAVTalkProcessInputStream(to, pkt[n]);
+  EXPECT_EQ(UAVTALK_STATE_COMPLETE, state);
+}
+
+TEST_F(UAVTalk, BatchesUnackedObjects) {
+  ASSERT_EQ(0, UAVTalkSetBatching(con, true));
+  EXPECT_EQ(0, UAVTalkSendObject(con, obj(0), 0, 0, 0));
+  EXPECT_EQ(0, UAVTalkSendObject(con, obj(1), 0, 0, 0));
+  EXPECT_EQ(0, UAVTalkSendObject(con, obj(2), 7, 0, 0));
+
+  // Nothing goes out before the flush
+  EXPECT_EQ(0U, sent.size());
+  EXPECT_EQ(0, UAVTalkFlush(con));
+  ASSERT_EQ(1U, sent.size());
+  EXPECT_EQ(UAVTALK_TYPE_OBJ_BATCH, sentType(0));
+
+  size_t payload = 3 * UAVTALK_BATCH_RECORD_HEADER_LENGTH + 2 + mock_uavos[0].num_bytes +
+      mock_uavos[1].num_bytes + mock_uavos[2].num_bytes;
+  EXPECT_EQ(UAVTALK_MIN_HEADER_LENGTH + payload + UAVTALK_CHECKSUM_LENGTH, sent[0].size());
+  EXPECT_EQ(3U, stats().txObjects);
+
+  // The other end unpacks every object of the frame
+  UAVTalkConnection peer = UAVTalkInitialize(&capture);
+  forward(peer, sent[0]);
+  EXPECT_EQ(1U, mock_uavos[0].unpacked);
+  EXPECT_EQ(1U, mock_uavos[1].unpacked);
+  EXPECT_EQ(1U, mock_uavos[2].unpacked);
+
+  // An empty flush sends nothing
+  EXPECT_EQ(0, UAVTalkFlush(con));
+  EXPECT_EQ(1U, sent.size());
+}
+
+TEST_F(UAVTalk, FullBatchIsSent) {
+  ASSERT_EQ(0, UAVTalkSetBatching(con, true));
+  EXPECT_EQ(0, UAVTalkSendObject(con, obj(5), 0, 0, 0));
+  EXPECT_EQ(0, UAVTalkSendObject(con, obj(1), 0, 0, 0));
+  EXPECT_EQ(0U, sent.size());
+
+  // This one doesn't fit anymore
+  EXPECT_EQ(0, UAVTalkSendObject(con, obj(0), 0, 0, 0));
+  ASSERT_EQ(1U, sent.size());
+  EXPECT_LE(sent[0].size(), (size_t) UAVTALK_MIN_HEADER_LENGTH + UAVTALK_MAX_BATCH_LENGTH + UAVTALK_CHECKSUM_LENGTH);
+
+  EXPECT_EQ(0, UAVTalkFlush(con));
+  ASSERT_EQ(2U, sent.size());
+  EXPECT_EQ(UAVTALK_TYPE_OBJ_BATCH, sentType(1));
+}
+
+TEST_F(UAVTalk, BatchKeepsMessageOrder) {
+  ASSERT_EQ(0, UAVTalkSetBatching(con, true));
+  EXPECT_EQ(0, UAVTalkSendObject(con, obj(0), 0, 0, 0));
+
+  // Acked objects are never batched and go out after the pending batch
+  EXPECT_EQ(0, UAVTalkSendObjectWindowed(con, obj(1), 0, 1, TIMEOUT_MS, 1));
+  ASSERT_EQ(2U, sent.size());
+  EXPECT_EQ(UAVTALK_TYPE_OBJ_BATCH, sentType(0));
+  EXPECT_EQ(UAVTALK_TYPE_OBJ_ACK, sentType(1));
+
+  // Requests from the other end are answered right away
+  receive(UAVTALK_TYPE_OBJ_REQ, 3, 0);
+  ASSERT_EQ(3U, sent.size());
+  EXPECT_EQ(UAVTALK_TYPE_OBJ_BATCH, sentType(2));
+
+  // Disabling batching sends what is left
+  EXPECT_EQ(0, UAVTalkSendObject(con, obj(4), 0, 0, 0));
+  EXPECT_EQ(0, UAVTalkSetBatching(con, false));
+  EXPECT_EQ(4U, sent.size());
+  EXPECT_EQ(0, UAVTalkSendObject(con, obj(4), 0, 0, 0));
+  ASSERT_EQ(5U, sent.size());
+  EXPECT_EQ(UAVTALK_TYPE_OBJ, sentType(4));
+}
+
+TEST_F(UAVTalk, SendAtTimeKeepsTimestamp) {
+  mock_systime = 0x12345;
+
+  // The update time goes out instead of the send time
+  EXPECT_EQ(0, UAVTalkSendObjectAtTime(con, obj(0), 0, 0x4321));
+  EXPECT_EQ(0, UAVTalkSendObjectAtTime(con, obj(2), 3, 0x10203));
+  EXPECT_EQ(0, UAVTalkSendObjectTimestamped(con, obj(0), 0, 0, 0));
+  ASSERT_EQ(3U, sent.size());
+
+  EXPECT_EQ(UAVTALK_TYPE_OBJ_TS, sentType(0));
+  EXPECT_EQ(0x21, sent[0][8]);
+  EXPECT_EQ(0x43, sent[0][9]);
+  EXPECT_EQ(UAVTALK_TYPE_OBJ_TS, sentType(1));
+  EXPECT_EQ(3, sent[1][8]);
+  EXPECT_EQ(0x03, sent[1][10]);
+  EXPECT_EQ(0x02, sent[1][11]);
+  EXPECT_EQ(0x45, sent[2][8]);
+  EXPECT_EQ(0x23, sent[2][9]);
+
+  // The other end reads the timestamp back
+  UAVTalkConnection peer = UAVTalkInitialize(&capture);
+  forward(peer, sent[0]);
+  uint16_t timestamp;
+  UAVTalkGetLastTimestamp(peer, &timestamp);
+  EXPECT_EQ(0x4321, timestamp);
+
+  // Only one instance at a time
+  EXPECT_EQ(-1, UAVTalkSendObjectAtTime(con, obj(2), UAVOBJ_ALL_INSTANCES, 0));
+}
+
+TEST_F(UAVTalk, BatchedThroughput) {
+  // A burst of small objects, like the attitude and actuator updates
+  const int objects[] = { 0, 3, 4, 2 };
+  const int rounds = 100;
+
+  size_t single = 0;
+  for (int r = 0; r < rounds; r++)
+    for (size_t i = 0; i < NELEMENTS(objects); i++)
+      UAVTalkSendObject(con, obj(objects[i]), 0, 0, 0);
+  for (size_t i = 0; i < sent.size(); i++)
+    single += sent[i].size();
+  sent.clear();
+
+  size_t batched = 0;
+  ASSERT_EQ(0, UAVTalkSetBatching(con, true));
+  for (int r = 0; r < rounds; r++) {
+    for (size_t i = 0; i < NELEMENTS(objects); i++)
+      UAVTalkSendObject(con, obj(objects[i]), 0, 0, 0);
+    UAVTalkFlush(con);
+  }
+  for (size_t i = 0; i < sent.size(); i++)
+    batched += sent[i].size();
+
+  // 10 bits per byte on a 57600 baud link
+  printf("%d bursts: %zu bytes (%.0f ms at 57600 baud) single, %zu bytes (%.0f ms) batched\n",
+      rounds, single, single * 10 * 1000.0 / 57600, batched, batched * 10 * 1000.0 / 57600);
+  EXPECT_LT(batched, single);
+}
+
+/* Feed a packet into a connection on the other end of the link, which has
+ * its own copy of the objects. Takes a copy as the answers go to sent too. */
+static void forwardToPeer(UAVTalkConnection peer, std::vector<uint8_t> pkt)
+{
+  mock_peer = true;
+  forward(peer, pkt);
+  mock_peer = false;
+}
+
+static size_t sentPayload(size_t i)
+{
+  return sent[i].size() - UAVTALK_MIN_HEADER_LENGTH - UAVTALK_CHECKSUM_LENGTH;
+}
+
+TEST_F(UAVTalk, DeltaSendsChangedBytes) {
+  struct mock_uavo *uavo = &mock_uavos[6];
+  UAVTalkConnection peer = UAVTalkInitialize(&capture);
+  for (int i = 0; i < uavo->num_bytes; i++)
+    uavo->data[i] = i;
+
+  // The first update has nothing to be compared against
+  ASSERT_EQ(0, UAVTalkSetDeltaEncoding(con, true));
+  EXPECT_EQ(0, UAVTalkSendObject(con, obj(6), 0, 0, 0));
+  ASSERT_EQ(1U, sent.size());
+  EXPECT_EQ(UAVTALK_TYPE_OBJ, sentType(0));
+  forwardToPeer(peer, sent[0]);
+
+  uavo->data[3] = 0xAA;
+  uavo->data[20] = 0xBB;
+  uavo->data[21] = 0xCC;
+  EXPECT_EQ(0, UAVTalkSendObject(con, obj(6), 0, 0, 0));
+  ASSERT_EQ(2U, sent.size());
+  EXPECT_EQ(UAVTALK_TYPE_OBJ_DELTA, sentType(1));
+  // Two CRCs, skip 3, copy 1, skip 16, copy 2
+  EXPECT_EQ((size_t) UAVTALK_DELTA_HEADER_LENGTH + 7, sentPayload(1));
+
+  forwardToPeer(peer, sent[1]);
+  EXPECT_EQ(2U, uavo->unpacked);
+  EXPECT_EQ(0, memcmp(uavo->data, uavo->peer_data, uavo->num_bytes));
+
+  // An unchanged update is just the CRCs
+  EXPECT_EQ(0, UAVTalkSendObject(con, obj(6), 0, 0, 0));
+  ASSERT_EQ(3U, sent.size());
+  EXPECT_EQ((size_t) UAVTALK_DELTA_HEADER_LENGTH, sentPayload(2));
+  forwardToPeer(peer, sent[2]);
+  EXPECT_EQ(3U, uavo->unpacked);
+
+  // Objects without delta encoding are always sent in full
+  EXPECT_EQ(0, UAVTalkSendObject(con, obj(5), 0, 0, 0));
+  EXPECT_EQ(0, UAVTalkSendObject(con, obj(5), 0, 0, 0));
+  EXPECT_EQ(UAVTALK_TYPE_OBJ, sentType(4));
+  EXPECT_EQ(mock_uavos[5].num_bytes, sentPayload(4));
+}
+
+TEST_F(UAVTalk, ReceivedDeltaLeavesTxBuffer) {
+  struct mock_uavo *uavo = &mock_uavos[6];
+  UAVTalkConnection peer = UAVTalkInitialize(&capture);
+  UAVTalkConnectionData *peerData = (UAVTalkConnectionData *) peer;
+  ASSERT_EQ(0, UAVTalkSetDeltaEncoding(con, true));
+  EXPECT_EQ(0, UAVTalkSendObject(con, obj(6), 0, 0, 0));
+  forwardToPeer(peer, sent[0]);
+
+  uavo->data[7] ^= 0xFF;
+  EXPECT_EQ(0, UAVTalkSendObject(con, obj(6), 0, 0, 0));
+  ASSERT_EQ(2U, sent.size());
+  ASSERT_EQ(UAVTALK_TYPE_OBJ_DELTA, sentType(1));
+
+  // A frame being built by a sender of the peer while the delta is applied
+  memset(peerData->txBuffer, 0xA5, UAVTALK_MAX_PACKET_LENGTH);
+  forwardToPeer(peer, sent[1]);
+  EXPECT_EQ(2U, uavo->unpacked);
+  EXPECT_EQ(0, memcmp(uavo->data, uavo->peer_data, uavo->num_bytes));
+  for (size_t i = 0; i < UAVTALK_MAX_PACKET_LENGTH; i++)
+    ASSERT_EQ(0xA5, peerData->txBuffer[i]);
+}
+
+TEST_F(UAVTalk, DeltaIsOptIn) {
+  EXPECT_EQ(0, UAVTalkSendObject(con, obj(6), 0, 0, 0));
+  EXPECT_EQ(0, UAVTalkSendObject(con, obj(6), 0, 0, 0));
+  ASSERT_EQ(2U, sent.size());
+  EXPECT_EQ(UAVTALK_TYPE_OBJ, sentType(1));
+
+  // Enabling starts over from a full update
+  ASSERT_EQ(0, UAVTalkSetDeltaEncoding(con, true));
+  EXPECT_EQ(0, UAVTalkSendObject(con, obj(6), 0, 0, 0));
+  EXPECT_EQ(0, UAVTalkSendObject(con, obj(6), 0, 0, 0));
+  ASSERT_EQ(4U, sent.size());
+  EXPECT_EQ(UAVTALK_TYPE_OBJ, sentType(2));
+  EXPECT_EQ(UAVTALK_TYPE_OBJ_DELTA, sentType(3));
+  ASSERT_EQ(0, UAVTalkSetDeltaEncoding(con, true));
+  EXPECT_EQ(0, UAVTalkSendObject(con, obj(6), 0, 0, 0));
+  EXPECT_EQ(UAVTALK_TYPE_OBJ, sentType(4));
+}
+
+TEST_F(UAVTalk, AckedDeltaIsAcked) {
+  struct mock_uavo *uavo = &mock_uavos[6];
+  UAVTalkConnection peer = UAVTalkInitialize(&capture);
+  ASSERT_EQ(0, UAVTalkSetDeltaEncoding(con, true));
+
+  for (int update = 0; update < 2; update++) {
+    uavo->data[update] ^= 0x55;
+    EXPECT_EQ(0, UAVTalkSendObjectWindowed(con, obj(6), 0, 1, TIMEOUT_MS, 1));
+    size_t pkt = sent.size() - 1;
+    EXPECT_EQ(update ? UAVTALK_TYPE_OBJ_ACK_DELTA : UAVTALK_TYPE_OBJ_ACK, sentType(pkt));
+
+    forwardToPeer(peer, sent[pkt]);
+    ASSERT_EQ(pkt + 2, sent.size());
+    EXPECT_EQ(UAVTALK_TYPE_ACK, sentType(pkt + 1));
+    forward(con, sent[pkt + 1]);
+    EXPECT_EQ(-1, UAVTalkProcessPendingTransactions(con));
+  }
+  EXPECT_EQ(0, memcmp(uavo->data, uavo->peer_data, uavo->num_bytes));
+}
+
+TEST_F(UAVTalk, DeltaMismatchIsSentInFull) {
+  struct mock_uavo *uavo = &mock_uavos[6];
+  UAVTalkConnection peer = UAVTalkInitialize(&capture);
+  ASSERT_EQ(0, UAVTalkSetDeltaEncoding(con, true));
+  memset(uavo->peer_data, 0, uavo->num_bytes);
+
+  // The first update is lost and its ack with it
+  uavo->data[0] = 1;
+  EXPECT_EQ(0, UAVTalkSendObjectWindowed(con, obj(6), 0, 1, TIMEOUT_MS, 1));
+  uavo->data[1] = 2;
+  EXPECT_EQ(0, UAVTalkSendObjectWindowed(con, obj(6), 0, 1, TIMEOUT_MS, 1));
+  ASSERT_EQ(2U, sent.size());
+  EXPECT_EQ(UAVTALK_TYPE_OBJ_ACK_DELTA, sentType(1));
+
+  // The peer can't apply the delta to what it has
+  forwardToPeer(peer, sent[1]);
+  ASSERT_EQ(3U, sent.size());
+  EXPECT_EQ(UAVTALK_TYPE_NACK, sentType(2));
+  EXPECT_EQ(0U, uavo->unpacked);
+
+  // The NACK brings the full update right away
+  forward(con, sent[2]);
+  ASSERT_EQ(4U, sent.size());
+  EXPECT_EQ(UAVTALK_TYPE_OBJ_ACK, sentType(3));
+  EXPECT_EQ(0U, stats().txRetries);
+  forwardToPeer(peer, sent[3]);
+  ASSERT_EQ(5U, sent.size());
+  EXPECT_EQ(UAVTALK_TYPE_ACK, sentType(4));
+  forward(con, sent[4]);
+  EXPECT_EQ(-1, UAVTalkProcessPendingTransactions(con));
+  EXPECT_EQ(0, memcmp(uavo->data, uavo->peer_data, uavo->num_bytes));
+
+  // A NACK after a full update is not answered, the peer just doesn't know the object
+  EXPECT_EQ(0, UAVTalkSendObjectWindowed(con, obj(5), 0, 1, TIMEOUT_MS, 1));
+  receive(UAVTALK_TYPE_NACK, 5, 0);
+  EXPECT_EQ(6U, sent.size());
+}
+
+TEST_F(UAVTalk, DeltaRetriesAreFull) {
+  ASSERT_EQ(0, UAVTalkSetDeltaEncoding(con, true));
+  EXPECT_EQ(0, UAVTalkSendObjectWindowed(con, obj(6), 0, 1, TIMEOUT_MS, 1));
+  receive(UAVTALK_TYPE_ACK, 6, 0);
+  EXPECT_EQ(0, UAVTalkSendObjectWindowed(con, obj(6), 0, 1, TIMEOUT_MS, 1));
+  ASSERT_EQ(2U, sent.size());
+  EXPECT_EQ(UAVTALK_TYPE_OBJ_ACK_DELTA, sentType(1));
+
+  // The retry can't know which update made it to the other end
+  mock_systime += TIMEOUT_MS;
+  UAVTalkProcessPendingTransactions(con);
+  ASSERT_EQ(3U, sent.size());
+  EXPECT_EQ(UAVTALK_TYPE_OBJ_ACK, sentType(2));
+}
+
+TEST_F(UAVTalk, UnackedDeltasHaveKeyframes) {
+  ASSERT_EQ(0, UAVTalkSetDeltaEncoding(con, true));
+  for (int i = 0; i < 2 * UAVTALK_DELTA_KEYFRAME_INTERVAL; i++)
+    EXPECT_EQ(0, UAVTalkSendObject(con, obj(6), 0, 0, 0));
+
+  ASSERT_EQ((size_t) 2 * UAVTALK_DELTA_KEYFRAME_INTERVAL, sent.size());
+  for (size_t i = 0; i < sent.size(); i++)
+    EXPECT_EQ((i % UAVTALK_DELTA_KEYFRAME_INTERVAL) ? UAVTALK_TYPE_OBJ_DELTA : UAVTALK_TYPE_OBJ, sentType(i));
+}
+
+/* A field of a logged object, changing every few samples (never if zero) */
+struct log_field {
+  uint8_t size;
+  uint8_t count;
+  uint8_t every;
+};
+
+/* The objects of the Logging module at their logging rate (in 25 Hz ticks) */
+static const struct {
+  int uavo;
+  int period;
+  struct log_field fields[7];
+} log_objects[] = {
+  { 7, 1, { { 4, 3, 1 }, { 4, 1, 50 } } },
+  { 8, 1, { { 4, 3, 1 }, { 4, 1, 50 } } },
+  { 9, 2, { { 4, 7, 1 } } },
+  { 10, 2, { { 4, 3, 1 } } },
+  /* Sticks, collective, RSSI, stick and switch channels, connected and armed */
+  { 11, 2, { { 4, 4, 1 }, { 4, 1, 0 }, { 2, 1, 10 }, { 4, 1, 10 }, { 2, 4, 1 }, { 2, 5, 0 }, { 1, 2, 0 } } },
+  /* Four motors, unused channels, update times and failures */
+  { 12, 2, { { 4, 4, 1 }, { 4, 6, 0 }, { 1, 1, 1 }, { 2, 1, 0 }, { 1, 1, 0 } } },
+  { 13, 10, { { 4, 3, 1 } } },
+  /* Status, position, altitude, heading and speed, geoid, satellites, accuracy and DOPs */
+  { 14, 10, { { 1, 1, 0 }, { 4, 2, 1 }, { 4, 3, 1 }, { 4, 1, 0 }, { 1, 1, 0 }, { 4, 4, 20 } } },
+};
+
+/* Random walk over the fields of an object. Floats move by a fraction of
+ * their value like sensor noise, integers step by one like RC input. */
+static void logSample(int obj, int tick, uint32_t *seed)
+{
+  struct mock_uavo *uavo = &mock_uavos[log_objects[obj].uavo];
+  uint8_t *data = uavo->data;
+
+  for (size_t f = 0; f < NELEMENTS(log_objects[obj].fields); f++) {
+    const struct log_field *field = &log_objects[obj].fields[f];
+    for (int e = 0; e < field->count; e++, data += field->size) {
+      if (tick > 0 && (field->every == 0 || (tick / log_objects[obj].period) % field->every))
+        continue;
+
+      *seed = *seed * 1103515245 + 12345;
+      int step = (int) ((*seed >> 16) % 3) - 1;
+      if (field->size == 4 && tick == 0) {
+        float value = 10.0f + e;
+        memcpy(data, &value, sizeof(value));
+      } else if (field->size == 4) {
+        float value;
+        memcpy(&value, data, sizeof(value));
+        value += value * 0.01f * ((int) ((*seed >> 16) % 201) - 100) / 100.0f;
+        memcpy(data, &value, sizeof(value));
+      } else if (tick == 0) {
+        data[0] = 1500 & 0xFF;
+        if (field->size == 2)
+          data[1] = 1500 >> 8;
+      } else if (field->size == 2) {
+        uint16_t value = data[0] | (data[1] << 8);
+        value += step;
+        data[0] = value & 0xFF;
+        data[1] = value >> 8;
+      } else {
+        data[0] += step;
+      }
+    }
+  }
+}
+
+/* Bytes written for a 5 minute log, checking that the peer decodes every update */
+static size_t logReplay(UAVTalkConnection con, UAVTalkConnection peer, size_t *deltaObjectBytes)
+{
+  uint32_t seed = 1;
+  size_t bytes = 0;
+
+  *deltaObjectBytes = 0;
+  for (int tick = 0; tick < 5 * 60 * 25; tick++) {
+    for (size_t i = 0; i < NELEMENTS(log_objects); i++) {
+      if (tick % log_objects[i].period)
+        continue;
+
+      struct mock_uavo *uavo = &mock_uavos[log_objects[i].uavo];
+      logSample(i, tick, &seed);
+      sent.clear();
+      UAVTalkSendObjectTimestamped(con, (UAVObjHandle) uavo, 0, 0, 0);
+      if (sent.size() != 1)
+        return 0;
+
+      bytes += sent[0].size();
+      if (uavo->delta)
+        *deltaObjectBytes += sent[0].size();
+
+      forwardToPeer(peer, sent[0]);
+      if (sent.size() != 1 || memcmp(uavo->data, uavo->peer_data, uavo->num_bytes))
+        return 0;
+    }
+  }
+
+  return bytes;
+}
+
+TEST_F(UAVTalk, DeltaLogReplay) {
+  size_t fullDeltaObjects, deltaDeltaObjects;
+
+  size_t full = logReplay(con, UAVTalkInitialize(&capture), &fullDeltaObjects);
+  ASSERT_NE(0U, full);
+
+  UAVTalkConnection deltaCon = UAVTalkInitialize(&capture);
+  ASSERT_EQ(0, UAVTalkSetDeltaEncoding(deltaCon, true));
+  size_t delta = logReplay(deltaCon, UAVTalkInitialize(&capture), &deltaDeltaObjects);
+  ASSERT_NE(0U, delta);
+
+  printf("5 min log: %zu bytes full, %zu bytes with deltas (delta encoded objects %zu -> %zu bytes, %.0f%%)\n",
+      full, delta, fullDeltaObjects, deltaDeltaObjects, 100.0 * deltaDeltaObjects / fullDeltaObjects);
+  EXPECT_LT(deltaDeltaObjects, fullDeltaObjects);
+  EXPECT_EQ(full - fullDeltaObjects, delta - deltaDeltaObjects);
+}
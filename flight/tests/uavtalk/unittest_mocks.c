@@ -0,0 +1,156 @@
+/**
+ ******************************************************************************
+ * @file       unittest_mocks.c
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Single threaded PiOS services and objects for the UAVTalk unit test
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "openpilot.h"
+#include "unittest_mocks.h"
+
+/* The clock only moves when the test advances it or when UAVTalk
+ * waits on a semaphore that nobody can give */
+uint32_t mock_systime;
+
+/* Selects the copy of the objects on the other end of the link */
+bool mock_peer;
+
+struct mock_uavo mock_uavos[MOCK_UAVO_COUNT] = {
+	{ .id = 0x1234, .single = true, .num_bytes = 8 },
+	{ .id = 0x5678, .single = true, .num_bytes = 16 },
+	{ .id = 0x9ABC, .single = false, .num_bytes = 4 },
+	{ .id = 0xDEF0, .single = true, .num_bytes = 2 },
+	{ .id = 0x1357, .single = true, .num_bytes = 1 },
+	{ .id = 0x2468, .single = true, .num_bytes = 32 },
+	{ .id = 0x3579, .single = true, .num_bytes = 32, .delta = true },
+	{ .id = 0x1001, .single = true, .num_bytes = 16 },		/* Gyros */
+	{ .id = 0x1002, .single = true, .num_bytes = 16 },		/* Accels */
+	{ .id = 0x1003, .single = true, .num_bytes = 28 },		/* AttitudeActual */
+	{ .id = 0x1004, .single = true, .num_bytes = 12 },		/* Magnetometer */
+	{ .id = 0x1005, .single = true, .num_bytes = 46, .delta = true },	/* ManualControlCommand */
+	{ .id = 0x1006, .single = true, .num_bytes = 44, .delta = true },	/* ActuatorCommand */
+	{ .id = 0x1007, .single = true, .num_bytes = 12 },		/* BaroAltitude */
+	{ .id = 0x1008, .single = true, .num_bytes = 42, .delta = true },	/* GPSPosition */
+};
+
+void *PIOS_malloc(size_t size)
+{
+	return malloc(size);
+}
+
+uint32_t PIOS_Thread_Systime(void)
+{
+	return mock_systime;
+}
+
+struct pios_recursive_mutex *PIOS_Recursive_Mutex_Create(void)
+{
+	return malloc(sizeof(struct pios_recursive_mutex));
+}
+
+bool PIOS_Recursive_Mutex_Lock(struct pios_recursive_mutex *mtx, uint32_t timeout_ms)
+{
+	return true;
+}
+
+bool PIOS_Recursive_Mutex_Unlock(struct pios_recursive_mutex *mtx)
+{
+	return true;
+}
+
+struct pios_semaphore *PIOS_Semaphore_Create(void)
+{
+	struct pios_semaphore *sema = malloc(sizeof(*sema));
+	sema->sema_handle = 1;
+	return sema;
+}
+
+bool PIOS_Semaphore_Take(struct pios_semaphore *sema, uint32_t timeout_ms)
+{
+	if (sema->sema_handle) {
+		sema->sema_handle = 0;
+		return true;
+	}
+
+	mock_systime += timeout_ms;
+	return false;
+}
+
+bool PIOS_Semaphore_Give(struct pios_semaphore *sema)
+{
+	sema->sema_handle = 1;
+	return true;
+}
+
+UAVObjHandle UAVObjGetByID(uint32_t id)
+{
+	for (int i = 0; i < MOCK_UAVO_COUNT; i++) {
+		if (mock_uavos[i].id == id)
+			return (UAVObjHandle) &mock_uavos[i];
+	}
+	return NULL;
+}
+
+uint32_t UAVObjGetID(UAVObjHandle obj)
+{
+	return ((struct mock_uavo *) obj)->id;
+}
+
+uint32_t UAVObjGetNumBytes(UAVObjHandle obj)
+{
+	return ((struct mock_uavo *) obj)->num_bytes;
+}
+
+uint16_t UAVObjGetNumInstances(UAVObjHandle obj)
+{
+	return 1;
+}
+
+bool UAVObjIsSingleInstance(UAVObjHandle obj)
+{
+	return ((struct mock_uavo *) obj)->single;
+}
+
+bool UAVObjIsDeltaEncoded(UAVObjHandle obj)
+{
+	return ((struct mock_uavo *) obj)->delta;
+}
+
+int32_t UAVObjPack(UAVObjHandle obj, uint16_t instId, uint8_t *dataOut)
+{
+	struct mock_uavo *uavo = (struct mock_uavo *) obj;
+	memcpy(dataOut, mock_peer ? uavo->peer_data : uavo->data, uavo->num_bytes);
+	return 0;
+}
+
+int32_t UAVObjUnpack(UAVObjHandle obj, uint16_t instId, const uint8_t *dataIn)
+{
+	struct mock_uavo *uavo = (struct mock_uavo *) obj;
+	memcpy(mock_peer ? uavo->peer_data : uavo->data, dataIn, uavo->num_bytes);
+	++uavo->unpacked;
+	return 0;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,21 @@
+/* Objects and clock shared between the mocks and the unit test */
+#include "uavobjectsinit.h"
+
+#define MOCK_UAVO_COUNT 15
+
+/* The first objects of the log replay, laid out like the flight objects */
+#define MOCK_UAVO_LOG_FIRST 7
+
+struct mock_uavo {
+	uint32_t id;
+	bool single;
+	bool delta;
+	uint16_t num_bytes;
+	uint32_t unpacked;
+	uint8_t data[UAVOBJECTS_LARGEST];
+	uint8_t peer_data[UAVOBJECTS_LARGEST];
+};
+
+extern struct mock_uavo mock_uavos[MOCK_UAVO_COUNT];
+extern uint32_t mock_systime;
+extern bool mock_peer;
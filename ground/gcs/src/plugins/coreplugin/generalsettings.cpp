@@ -52,7 +52,9 @@ GeneralSettings::GeneralSettings():
     m_dialog(0),
     m_proxyType(QNetworkProxy::NoProxy),
     m_proxyPort(0),
-    m_useSessionManaging(true)
+    m_useSessionManaging(true),
+    m_objectRetrievalRequests(4),
+    m_cacheLogIndex(true)
 {
 }
 
@@ -135,6 +137,8 @@ QWidget *GeneralSettings::createPage(QWidget *parent)
     m_page->cbUseUDPMirror->setChecked(m_useUDPMirror);
     m_page->cbExpertMode->setChecked(m_useExpertMode);
     m_page->cbSessionMessaging->setChecked(m_useSessionManaging);
+    m_page->sbObjectRetrievalRequests->setValue(m_objectRetrievalRequests);
+    m_page->cbCacheLogIndex->setChecked(m_cacheLogIndex);
     m_page->colorButton->setColor(StyleHelper::baseColor());
     m_page->proxyTypeCB->setCurrentIndex(m_page->proxyTypeCB->findData(m_proxyType));
     m_page->portLE->setText(QString::number(m_proxyPort));
@@ -158,6 +162,8 @@ void GeneralSettings::apply()
     m_useUDPMirror = m_page->cbUseUDPMirror->isChecked();
     m_useExpertMode = m_page->cbExpertMode->isChecked();
     m_useSessionManaging = m_page->cbSessionMessaging->isChecked();
+    m_objectRetrievalRequests = m_page->sbObjectRetrievalRequests->value();
+    m_cacheLogIndex = m_page->cbCacheLogIndex->isChecked();
     m_autoConnect = m_page->checkAutoConnect->isChecked();
     m_autoSelect = m_page->checkAutoSelect->isChecked();
     m_proxyType = m_page->proxyTypeCB->itemData(m_page->proxyTypeCB->currentIndex()).toInt();
@@ -184,6 +190,9 @@ void GeneralSettings::readSettings(QSettings* qs)
     m_useUDPMirror = qs->value(QLatin1String("UDPMirror"),m_useUDPMirror).toBool();
     m_useExpertMode = qs->value(QLatin1String("ExpertMode"),m_useExpertMode).toBool();
     m_useSessionManaging = qs->value(QLatin1String("UseSessionManaging"), m_useSessionManaging).toBool();
+    // Same range as the spin box, more requests than the telemetry transactions would only queue up
+    m_objectRetrievalRequests = qBound(1, qs->value(QLatin1String("ObjectRetrievalRequests"), m_objectRetrievalRequests).toInt(), 8);
+    m_cacheLogIndex = qs->value(QLatin1String("CacheLogIndex"), m_cacheLogIndex).toBool();
     m_proxyType = qs->value(QLatin1String("proxytype"),m_proxyType).toInt();
     m_proxyPort = qs->value(QLatin1String("proxyport"),m_proxyPort).toInt();
     m_proxyHostname = qs->value(QLatin1String("proxyhostname"),m_proxyHostname).toString();
@@ -212,6 +221,8 @@ void GeneralSettings::saveSettings(QSettings* qs)
     qs->setValue(QLatin1String("UDPMirror"), m_useUDPMirror);
     qs->setValue(QLatin1String("ExpertMode"), m_useExpertMode);
     qs->setValue(QLatin1String("UseSessionManaging"), m_useSessionManaging);
+    qs->setValue(QLatin1String("ObjectRetrievalRequests"), m_objectRetrievalRequests);
+    qs->setValue(QLatin1String("CacheLogIndex"), m_cacheLogIndex);
 
     qs->setValue(QLatin1String("proxytype"), m_proxyType);
     qs->setValue(QLatin1String("proxyport"), m_proxyPort);
@@ -287,6 +298,16 @@ bool GeneralSettings::useSessionManaging() const
     return m_useSessionManaging;
 }
 
+int GeneralSettings::objectRetrievalRequests() const
+{
+    return m_objectRetrievalRequests;
+}
+
+bool GeneralSettings::cacheLogIndex() const
+{
+    return m_cacheLogIndex;
+}
+
 bool GeneralSettings::useExpertMode() const
 {
     return m_useExpertMode;
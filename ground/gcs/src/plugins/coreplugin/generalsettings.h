@@ -62,6 +62,8 @@ public:
     bool autoSelect() const;
     bool useUDPMirror() const;
     bool useSessionManaging() const;
+    int objectRetrievalRequests() const;
+    bool cacheLogIndex() const;
     void readSettings(QSettings* qs);
     void saveSettings(QSettings* qs);
     bool useExpertMode() const;
@@ -106,6 +108,8 @@ private:
     QString m_observations;
     QString m_aircraft;
     bool m_useSessionManaging;
+    int m_objectRetrievalRequests;
+    bool m_cacheLogIndex;
 };
 } // namespace Internal
 } // namespace Core
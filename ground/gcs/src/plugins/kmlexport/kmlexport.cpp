@@ -373,9 +373,7 @@ void KmlExport::parseLogFile()
 
         // Parse the packet. This operation passes the data to the kmlTalk object, which internally parses the data
         // and then emits objectUpdated(UAVObject *) signals. These signals are connected to in the KmlExport constructor.
-        for (int i=0; i < dataBuffer.size(); i++) {
-            kmlTalk->processInputByte(dataBuffer[i]);
-        }
+        kmlTalk->processInputBlock((quint8 *)dataBuffer.data(), dataBuffer.size());
 
         timeStampIdx++;
     }
@@ -0,0 +1,440 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logdecoder.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      Headless decoder from .tll logs to per object column tables
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup   Logging
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "logdecoder.h"
+#include <uavtalk/uavtalk.h>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QtEndian>
+#include <algorithm>
+
+namespace {
+
+// UAVTalk framing, see uavtalk.h
+const quint8 SYNC_VAL = 0x3C;
+const quint8 TYPE_MASK = 0xF8;
+const quint8 TYPE_VER = 0x20;
+const quint8 TYPE_OBJ = (TYPE_VER | 0x00);
+const quint8 TYPE_OBJ_ACK = (TYPE_VER | 0x02);
+const int MIN_HEADER_LENGTH = 8;
+const int MAX_HEADER_LENGTH = 10;
+const int MAX_PAYLOAD_LENGTH = 256;
+const int CHECKSUM_LENGTH = 1;
+
+// Smallest number of log packets worth handing to a thread
+const int MIN_CHUNK_PACKETS = 4096;
+
+inline quint64 tableKey(quint32 objId, quint16 instId)
+{
+    return ((quint64)objId << 16) | instId;
+}
+
+/**
+ * Decodes a contiguous range of log packets into its own set of tables
+ */
+class DecodeTask : public QRunnable
+{
+public:
+    DecodeTask(const LogIndex *index, const QHash<quint32, LogDecoder::Schema> *schemas, int first, int last) :
+        index(index), schemas(schemas), first(first), last(last), errors(0)
+    {
+        setAutoDelete(false);
+    }
+
+    void run();
+
+    QHash<quint64, LogDecoder::Table> tables;
+    QList<quint64> order;
+    quint32 errors;
+
+private:
+    const LogIndex *index;
+    const QHash<quint32, LogDecoder::Schema> *schemas;
+    int first;
+    int last;
+
+    qint32 parse(const quint8 *data, qint32 length, quint32 timestamp);
+    void append(quint32 objId, quint16 instId, const LogDecoder::Schema &schema, const quint8 *data, quint32 timestamp);
+};
+
+void DecodeTask::run()
+{
+    // Bytes of a packet which is split over two log records
+    QByteArray carry;
+
+    for (int packet = first; packet < last; packet++) {
+        const quint8 *data = index->packetData(packet);
+        qint32 length = index->packetSize(packet);
+        quint32 timestamp = index->timestamp(packet);
+
+        if (carry.isEmpty()) {
+            qint32 consumed = parse(data, length, timestamp);
+            if (consumed < length)
+                carry = QByteArray((const char *) data + consumed, length - consumed);
+        } else {
+            carry.append((const char *) data, length);
+            carry.remove(0, parse((const quint8 *) carry.constData(), carry.size(), timestamp));
+        }
+    }
+}
+
+/**
+ * Decode all complete packets in a buffer
+ * @return Number of bytes consumed, the rest is the start of an incomplete packet
+ */
+qint32 DecodeTask::parse(const quint8 *data, qint32 length, quint32 timestamp)
+{
+    qint32 pos = 0;
+
+    while (pos < length) {
+        const quint8 *sync = (const quint8 *) memchr(&data[pos], SYNC_VAL, length - pos);
+        if (sync == NULL)
+            return length;
+        pos = sync - data;
+
+        const quint8 *packet = sync;
+        qint32 remaining = length - pos;
+        if (remaining < MIN_HEADER_LENGTH)
+            return pos;
+
+        quint8 type = packet[1];
+        qint32 size = qFromLittleEndian<quint16>(&packet[2]);
+        if ((type & TYPE_MASK) != TYPE_VER || size < MIN_HEADER_LENGTH || size > MAX_HEADER_LENGTH + MAX_PAYLOAD_LENGTH) {
+            pos++;
+            continue;
+        }
+
+        if (remaining < size + CHECKSUM_LENGTH)
+            return pos;
+
+        if (UAVTalk::updateCRC(0, packet, size) != packet[size]) {
+            errors++;
+            pos++;
+            continue;
+        }
+        pos += size + CHECKSUM_LENGTH;
+
+        // Only object updates carry data
+        if (type != TYPE_OBJ && type != TYPE_OBJ_ACK)
+            continue;
+
+        quint32 objId = qFromLittleEndian<quint32>(&packet[4]);
+        QHash<quint32, LogDecoder::Schema>::const_iterator schema = schemas->constFind(objId);
+        if (schema == schemas->constEnd())
+            continue;
+
+        qint32 dataOffset = MIN_HEADER_LENGTH + (schema->singleInstance ? 0 : 2);
+        if (dataOffset + (qint32) schema->numBytes != size) {
+            errors++;
+            continue;
+        }
+
+        quint16 instId = schema->singleInstance ? 0 : qFromLittleEndian<quint16>(&packet[MIN_HEADER_LENGTH]);
+        append(objId, instId, *schema, &packet[dataOffset], timestamp);
+    }
+
+    return length;
+}
+
+void DecodeTask::append(quint32 objId, quint16 instId, const LogDecoder::Schema &schema, const quint8 *data, quint32 timestamp)
+{
+    quint64 key = tableKey(objId, instId);
+    QHash<quint64, LogDecoder::Table>::iterator table = tables.find(key);
+    if (table == tables.end()) {
+        LogDecoder::Table newTable;
+        newTable.objId = objId;
+        newTable.instId = instId;
+        newTable.name = schema.name;
+        newTable.columnNames = schema.columnNames;
+        newTable.columns.resize(schema.elements.size());
+        table = tables.insert(key, newTable);
+        order.append(key);
+    }
+
+    table->timestamps.append(timestamp);
+    for (int i = 0; i < schema.elements.size(); i++) {
+        const LogDecoder::Element &element = schema.elements[i];
+        const quint8 *value = &data[element.offset];
+        double decoded;
+        switch (element.type) {
+        case UAVObjectField::INT8:
+            decoded = (qint8) *value;
+            break;
+        case UAVObjectField::INT16:
+            decoded = (qint16) qFromLittleEndian<quint16>(value);
+            break;
+        case UAVObjectField::INT32:
+            decoded = (qint32) qFromLittleEndian<quint32>(value);
+            break;
+        case UAVObjectField::UINT16:
+            decoded = qFromLittleEndian<quint16>(value);
+            break;
+        case UAVObjectField::UINT32:
+            decoded = qFromLittleEndian<quint32>(value);
+            break;
+        case UAVObjectField::FLOAT32:
+        {
+            quint32 raw = qFromLittleEndian<quint32>(value);
+            float tmpfloat;
+            memcpy(&tmpfloat, &raw, sizeof(tmpfloat));
+            decoded = tmpfloat;
+            break;
+        }
+        case UAVObjectField::BITFIELD:
+            decoded = (*value >> element.bit) & 1;
+            break;
+        default:
+            // UINT8 and ENUM (as the raw option index)
+            decoded = *value;
+            break;
+        }
+        table->columns[i].append(decoded);
+    }
+}
+
+bool tableLessThan(const LogDecoder::Table &a, const LogDecoder::Table &b)
+{
+    if (a.name != b.name)
+        return a.name < b.name;
+    return a.instId < b.instId;
+}
+
+}
+
+/**
+ * @brief LogDecoder::LogDecoder Capture the layout of all known objects
+ * @param objMngr The object manager whose object definitions match the log
+ */
+LogDecoder::LogDecoder(UAVObjectManager *objMngr) :
+    errors(0)
+{
+    foreach (QVector<UAVDataObject*> instances, objMngr->getDataObjectsVector()) {
+        UAVDataObject *obj = instances.first();
+
+        Schema schema;
+        schema.name = obj->getName();
+        schema.numBytes = obj->getNumBytes();
+        schema.singleInstance = obj->isSingleInstance();
+
+        foreach (UAVObjectField *field, obj->getFields()) {
+            if (field->getType() == UAVObjectField::STRING)
+                continue;
+
+            quint32 numElements = field->getNumElements();
+            QStringList elementNames = field->getElementNames();
+            quint32 bytesPerElement = (field->getType() == UAVObjectField::BITFIELD) ? 0 : field->getNumBytes() / numElements;
+            for (quint32 i = 0; i < numElements; i++) {
+                Element element;
+                element.type = field->getType();
+                if (element.type == UAVObjectField::BITFIELD) {
+                    element.offset = field->getDataOffset() + i / 8;
+                    element.bit = i % 8;
+                } else {
+                    element.offset = field->getDataOffset() + i * bytesPerElement;
+                    element.bit = 0;
+                }
+                schema.elements.append(element);
+
+                if (numElements == 1)
+                    schema.columnNames.append(field->getName());
+                else if ((int) i < elementNames.size())
+                    schema.columnNames.append(field->getName() + "." + elementNames[i]);
+                else
+                    schema.columnNames.append(field->getName() + "." + QString::number(i));
+            }
+        }
+
+        schemas.insert(obj->getObjID(), schema);
+    }
+}
+
+/**
+ * @brief LogDecoder::findDataStart Skip the text header of a log file
+ * @return Offset of the first packet
+ */
+qint64 LogDecoder::findDataStart(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return 0;
+
+    // Git hash, UAVO hash and the "##" separator, see LogFile::open()
+    for (int line = 0; line < 13 && !file.atEnd(); line++) {
+        if (file.readLine() == "##\n")
+            return file.pos();
+    }
+    return 0;
+}
+
+/**
+ * @brief LogDecoder::decode Decode a whole log into tables
+ * @param fileName The .tll log
+ * @param threads Number of decoding threads, 0 for one per core
+ * @return false if the log can't be read
+ */
+bool LogDecoder::decode(const QString &fileName, int threads)
+{
+    decodedTables.clear();
+    errors = 0;
+
+    LogIndex index;
+    if (!index.open(fileName, findDataStart(fileName)))
+        return false;
+
+    if (threads <= 0)
+        threads = QThread::idealThreadCount();
+    int count = index.count();
+    int chunks = qMax(1, qMin(threads * 4, count / MIN_CHUNK_PACKETS));
+
+    // Packets that straddle two records at a chunk boundary are lost,
+    // which is at most one packet per chunk.
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMax(1, threads));
+    QList<DecodeTask *> tasks;
+    for (int chunk = 0; chunk < chunks; chunk++) {
+        int first = (qint64) count * chunk / chunks;
+        int last = (qint64) count * (chunk + 1) / chunks;
+        DecodeTask *task = new DecodeTask(&index, &schemas, first, last);
+        tasks.append(task);
+        pool.start(task);
+    }
+    pool.waitForDone();
+
+    // Concatenate the chunks in log order
+    QHash<quint64, int> positions;
+    foreach (DecodeTask *task, tasks) {
+        errors += task->errors;
+        foreach (quint64 key, task->order) {
+            const Table &table = task->tables[key];
+            QHash<quint64, int>::const_iterator pos = positions.constFind(key);
+            if (pos == positions.constEnd()) {
+                positions.insert(key, decodedTables.size());
+                decodedTables.append(table);
+            } else {
+                Table &merged = decodedTables[*pos];
+                merged.timestamps += table.timestamps;
+                for (int i = 0; i < merged.columns.size(); i++)
+                    merged.columns[i] += table.columns[i];
+            }
+        }
+        delete task;
+    }
+
+    std::sort(decodedTables.begin(), decodedTables.end(), tableLessThan);
+    return true;
+}
+
+/**
+ * @brief LogDecoder::exportCSV Write one CSV file per table
+ * @param directory Output directory, files are named after the object and
+ * instance
+ */
+bool LogDecoder::exportCSV(const QString &directory) const
+{
+    QDir dir(directory);
+    foreach (const Table &table, decodedTables) {
+        QString name = table.name;
+        if (!schemas.value(table.objId).singleInstance)
+            name += QString("_%1").arg(table.instId);
+
+        QFile file(dir.filePath(name + ".csv"));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qDebug() << "Unable to open " << file.fileName() << " for export";
+            return false;
+        }
+
+        file.write("timestamp");
+        foreach (const QString &column, table.columnNames)
+            file.write("," + column.toUtf8());
+        file.write("\n");
+
+        QByteArray line;
+        for (int row = 0; row < table.timestamps.size(); row++) {
+            line = QByteArray::number(table.timestamps[row]);
+            for (int i = 0; i < table.columns.size(); i++) {
+                line += ',';
+                line += QByteArray::number(table.columns[i][row], 'g', 9);
+            }
+            line += '\n';
+            file.write(line);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief LogDecoder::exportColumnar Write all tables to a single binary file
+ *
+ * The file is little endian and holds a magic, a version and the number of
+ * tables. Each table is stored as its object ID, instance ID, name, row and
+ * column counts and column names, followed by the raw timestamps (uint32, ms)
+ * and then every column (float64) one after the other.
+ */
+bool LogDecoder::exportColumnar(const QString &fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "Unable to open " << fileName << " for export";
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    out << COLUMNAR_MAGIC << COLUMNAR_VERSION << (quint32) decodedTables.size();
+    foreach (const Table &table, decodedTables) {
+        out << table.objId << table.instId << table.name
+            << (quint32) table.timestamps.size() << (quint32) table.columns.size()
+            << table.columnNames;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        out.writeRawData((const char *) table.timestamps.constData(), table.timestamps.size() * sizeof(quint32));
+        foreach (const QVector<double> &column, table.columns)
+            out.writeRawData((const char *) column.constData(), column.size() * sizeof(double));
+#else
+        foreach (quint32 timestamp, table.timestamps)
+            out << timestamp;
+        foreach (const QVector<double> &column, table.columns)
+            foreach (double value, column)
+                out << value;
+#endif
+    }
+
+    return out.status() == QDataStream::Ok;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,102 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logdecoder.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      Headless decoder from .tll logs to per object column tables
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup   Logging
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef LOGDECODER_H
+#define LOGDECODER_H
+
+#include "uavobjectmanager.h"
+#include "uavobjectfield.h"
+#include "logindex.h"
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief The LogDecoder class decodes a .tll log as fast as possible,
+ * without replaying it through UAVTalk and the object manager.
+ *
+ * Every (object, instance) pair found in the log becomes a table with one
+ * timestamp column and one column per numeric field element. The packets
+ * of the log are split in chunks which are decoded in parallel and then
+ * concatenated in log order.
+ */
+class LogDecoder
+{
+public:
+    struct Table {
+        quint32 objId;
+        quint16 instId;
+        QString name;
+        QStringList columnNames;
+        QVector<quint32> timestamps;
+        QVector< QVector<double> > columns;
+    };
+
+    LogDecoder(UAVObjectManager *objMngr);
+
+    bool decode(const QString &fileName, int threads = 0);
+    const QList<Table> &tables() const { return decodedTables; }
+    quint32 packetErrors() const { return errors; }
+
+    bool exportCSV(const QString &directory) const;
+    bool exportColumnar(const QString &fileName) const;
+
+    static qint64 findDataStart(const QString &fileName);
+
+    // Per object layout, captured once so that the decoding threads
+    // don't have to touch the object manager
+    struct Element {
+        UAVObjectField::FieldType type;
+        quint32 offset;
+        quint32 bit;
+    };
+    struct Schema {
+        QString name;
+        quint32 numBytes;
+        bool singleInstance;
+        QStringList columnNames;
+        QVector<Element> elements;
+    };
+
+private:
+    static const quint32 COLUMNAR_MAGIC = 0x4c4f434c; // "LCOL"
+    static const quint32 COLUMNAR_VERSION = 1;
+
+    QHash<quint32, Schema> schemas;
+    QList<Table> decodedTables;
+    quint32 errors;
+};
+
+#endif // LOGDECODER_H
+
+/**
+ * @}
+ * @}
+ */
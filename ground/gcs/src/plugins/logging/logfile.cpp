@@ -38,7 +38,12 @@
 
 LogFile::LogFile(QObject *parent) :
     QIODevice(parent),
-    timestampBufferIdx(0)
+    dataStart(0),
+    firstTimestamp(0),
+    replayIdx(0),
+    readIdx(0),
+    readOffset(0),
+    pendingBytes(0)
 {
     connect(&timer, SIGNAL(timeout()), this, SLOT(timerFired()));
 }
@@ -124,6 +129,8 @@ bool LogFile::open(OpenMode mode) {
             file.seek(0);
         }
 
+        dataStart = file.pos();
+
     }
     else
     {
@@ -133,7 +140,9 @@ bool LogFile::open(OpenMode mode) {
     // Must call parent function for QIODevice to pass calls to writeData
     // We always open ReadWrite, because otherwise we will get tons of warnings
     // during a logfile replay. Read nature is checked upon write ops below.
-    QIODevice::open(QIODevice::ReadWrite);
+    // Replay data is copied straight from the mapped log in readData, so there
+    // is no need for QIODevice to buffer it again.
+    QIODevice::open(QIODevice::ReadWrite | QIODevice::Unbuffered);
 
     return true;
 }
@@ -145,6 +154,15 @@ void LogFile::close()
     if (timer.isActive())
         timer.stop();
     file.close();
+
+    mutex.lock();
+    index.close();
+    replayIdx = 0;
+    readIdx = 0;
+    readOffset = 0;
+    pendingBytes = 0;
+    mutex.unlock();
+
     QIODevice::close();
 }
 
@@ -166,124 +184,61 @@ qint64 LogFile::writeData(const char * data, qint64 dataSize) {
 
 qint64 LogFile::readData(char * data, qint64 maxSize) {
     QMutexLocker locker(&mutex);
-    qint64 toRead = qMin(maxSize,(qint64)dataBuffer.size());
-    memcpy(data,dataBuffer.data(),toRead);
-    dataBuffer.remove(0,toRead);
+    qint64 toRead = 0;
+
+    // Copy the released packets straight out of the mapped log
+    while (toRead < maxSize && readIdx < replayIdx)
+    {
+        qint32 chunk = qMin<qint64>(index.packetSize(readIdx) - readOffset, maxSize - toRead);
+        memcpy(data + toRead, index.packetData(readIdx) + readOffset, chunk);
+        toRead += chunk;
+        readOffset += chunk;
+        if (readOffset == index.packetSize(readIdx)) {
+            readIdx++;
+            readOffset = 0;
+        }
+    }
+
+    pendingBytes -= toRead;
     return toRead;
 }
 
 qint64 LogFile::bytesAvailable() const
 {
-    return dataBuffer.size();
+    return pendingBytes + QIODevice::bytesAvailable();
 }
 
 void LogFile::timerFired()
 {
-    qint64 dataSize;
-
-    if(file.bytesAvailable() > 4)
+    int time = myTime.elapsed();
+    lastPlayTime += (time - lastPlayTimeOffset) * playbackSpeed;
+    lastPlayTimeOffset = time;
+
+    // Release all packets whose time has come
+    int firstIdx = replayIdx;
+    mutex.lock();
+    while (replayIdx < index.count() && (qint64)index.timestamp(replayIdx) - firstTimestamp <= lastPlayTime)
     {
+        pendingBytes += index.packetSize(replayIdx);
+        replayIdx++;
+    }
+    mutex.unlock();
 
-        int time;
-        time = myTime.elapsed();
-
-        //Read packets
-        while ((lastPlayTime + ((time - lastPlayTimeOffset)* playbackSpeed) > (lastTimeStamp-firstTimestamp)))
-        {
-            lastPlayTime += ((time - lastPlayTimeOffset)* playbackSpeed);
-            if(file.bytesAvailable() < 4) {
-                stopReplay();
-                return;
-            }
-
-            file.seek(lastTimeStampPos+sizeof(lastTimeStamp));
-
-            file.read((char *) &dataSize, sizeof(dataSize));
-
-            if (dataSize<1 || dataSize>(1024*1024)) {
-                qDebug() << "Error: Logfile corrupted! Unlikely packet size: " << dataSize << "\n";
-                stopReplay();
-                return;
-            }
-            if(file.bytesAvailable() < dataSize) {
-                stopReplay();
-                return;
-            }
-
-            mutex.lock();
-            dataBuffer.append(file.read(dataSize));
-            mutex.unlock();
-            emit readyRead();
-
-            if(file.bytesAvailable() < 4) {
-                stopReplay();
-                return;
-            }
-
-            lastTimeStampPos = timestampPos[timestampBufferIdx];
-            lastTimeStamp = timestampBuffer[timestampBufferIdx];
-            timestampBufferIdx++;
-
-            lastPlayTimeOffset = time;
-            time = myTime.elapsed();
+    if (replayIdx != firstIdx)
+        emit readyRead();
 
-        }
-    } else {
+    if (replayIdx >= index.count())
         stopReplay();
-    }
-
 }
 
 bool LogFile::startReplay() {
-    dataBuffer.clear();
     myTime.restart();
     lastPlayTimeOffset = 0;
     lastPlayTime = 0;
     playbackSpeed = 1;
 
-    //Read all log timestamps into array
-    timestampBuffer.clear(); //Save beginning of log for later use
-    timestampPos.clear();
-    quint64 logFileStartIdx = file.pos();
-    timestampBufferIdx = 0;
-    lastTimeStamp = 0;
-
-    while (!file.atEnd()){
-        qint64 dataSize;
-
-        //Get time stamp position
-        timestampPos.append(file.pos());
-
-        //Read timestamp and logfile packet size
-        file.read((char *) &lastTimeStamp, sizeof(lastTimeStamp));
-        file.read((char *) &dataSize, sizeof(dataSize));
-
-        //Check if dataSize sync bytes are correct.
-        //TODO: LIKELY AS NOT, THIS WILL FAIL TO RESYNC BECAUSE THERE IS TOO LITTLE INFORMATION IN THE STRING OF SIX 0x00
-        if ((dataSize & 0xFFFFFFFFFFFF0000)!=0){
-            qDebug() << "Wrong sync byte. At file location 0x"  << QString("%1").arg(file.pos(),0,16) << "Got 0x" << QString("%1").arg(dataSize & 0xFFFFFFFFFFFF0000,0,16) << ", but expected 0x""00"".";
-            file.seek(timestampPos.last()+1);
-            timestampPos.pop_back();
-            continue;
-        }
-
-        //Check if timestamps are sequential.
-        if (!timestampBuffer.isEmpty() && lastTimeStamp < timestampBuffer.last()){
-            QMessageBox msgBox;
-            msgBox.setText("Corrupted file.");
-            msgBox.setInformativeText("Timestamps are not sequential. Playback may have unexpected behavior"); //<--TODO: add hyperlink to webpage with better description.
-            msgBox.exec();
-
-            qDebug() << "Timestamp: " << timestampBuffer.last() << " " << lastTimeStamp;
-        }
-
-        timestampBuffer.append(lastTimeStamp);
-
-        file.seek(timestampPos.last()+sizeof(lastTimeStamp)+sizeof(dataSize)+dataSize);
-    }
-
-    //Check if any timestamps were successfully read
-    if (timestampBuffer.size() == 0){
+    //Map the log and find all packets in it
+    if (!index.open(file.fileName(), dataStart) || index.count() == 0){
         QMessageBox msgBox;
         msgBox.setText("Empty logfile.");
         msgBox.setInformativeText("No log data can be found.");
@@ -293,12 +248,21 @@ bool LogFile::startReplay() {
         return false;
     }
 
-    //Reset to log beginning.
-    file.seek(logFileStartIdx+sizeof(lastTimeStamp));
-    lastTimeStampPos = timestampPos[0];
-    lastTimeStamp = timestampBuffer[0];
-    firstTimestamp = timestampBuffer[0];
-    timestampBufferIdx = 1;
+    //Check if timestamps are sequential.
+    if (!index.isSequential()){
+        QMessageBox msgBox;
+        msgBox.setText("Corrupted file.");
+        msgBox.setInformativeText("Timestamps are not sequential. Playback may have unexpected behavior"); //<--TODO: add hyperlink to webpage with better description.
+        msgBox.exec();
+    }
+
+    mutex.lock();
+    firstTimestamp = index.timestamp(0);
+    replayIdx = 0;
+    readIdx = 0;
+    readOffset = 0;
+    pendingBytes = 0;
+    mutex.unlock();
 
     timer.setInterval(10);
     timer.start();
@@ -325,21 +289,23 @@ void LogFile::resumeReplay()
 
 /**
  * @brief LogFile::setReplayTime, sets the playback time
- * @param val, the time in
+ * @param val, the time in seconds from the start of the log
  */
 void LogFile::setReplayTime(double val)
 {
-    quint32 tmpIdx=0;
-    while(timestampBuffer[tmpIdx++] <= val*1000 && tmpIdx <= timestampBufferIdx){
-    }
+    QMutexLocker locker(&mutex);
+    if (!index.isOpen())
+        return;
 
-    lastTimeStampPos=timestampPos[tmpIdx];
-    lastTimeStamp=timestampBuffer[tmpIdx];
-    timestampBufferIdx=tmpIdx;
+    // Drop whatever was released but not read yet and continue from the
+    // first packet at the requested time
+    replayIdx = index.findTimestamp(firstTimestamp + (quint32)(val*1000));
+    readIdx = replayIdx;
+    readOffset = 0;
+    pendingBytes = 0;
 
     lastPlayTimeOffset = myTime.elapsed();
-    lastPlayTime=lastTimeStamp;
+    lastPlayTime = val*1000;
 
-    qDebug() << "Replaying at: " << lastTimeStamp << ", but requestion at" << val*1000;
+    qDebug() << "Replaying at: " << (replayIdx < index.count() ? index.timestamp(replayIdx) - firstTimestamp : 0) << ", but requestion at" << val*1000;
 }
-
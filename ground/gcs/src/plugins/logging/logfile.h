@@ -35,6 +35,7 @@
 #include <QDebug>
 #include <QBuffer>
 #include "uavobjectmanager.h"
+#include "logindex.h"
 #include <math.h>
 
 class LogFile : public QIODevice
@@ -52,6 +53,7 @@ public:
 
     bool startReplay();
     bool stopReplay();
+    void setIndexCacheEnabled(bool enabled) { index.setSidecarEnabled(enabled); }
 
 public slots:
     void setReplaySpeed(double val) { playbackSpeed = val; qDebug() << "New playback speed: " << playbackSpeed; }
@@ -68,12 +70,10 @@ signals:
     void replayFinished();
 
 protected:
-    QByteArray dataBuffer;
     QTimer timer;
     QTime myTime;
     QFile file;
-    quint32 lastTimeStamp;
-    quint32 lastPlayTime;
+    double lastPlayTime;
     QMutex mutex;
 
 
@@ -81,11 +81,16 @@ protected:
     double playbackSpeed;
 
 private:
-    QList<quint32> timestampBuffer;
-    QList<quint32> timestampPos;
-    quint32 timestampBufferIdx;
-    quint32 lastTimeStampPos;
+    LogIndex index;
+    qint64 dataStart;
     quint32 firstTimestamp;
+
+    //! Next packet to be released by the replay clock
+    int replayIdx;
+    //! Packets in [readIdx, replayIdx) are waiting to be read, starting at readOffset in readIdx
+    int readIdx;
+    qint32 readOffset;
+    qint64 pendingBytes;
 };
 
 #endif // LOGFILE_H
@@ -6,6 +6,8 @@ include(../../taulabsgcsplugin.pri)
 include(logging_dependencies.pri)
 HEADERS += loggingplugin.h \
     logfile.h \
+    logindex.h \
+    logdecoder.h \
     logginggadgetwidget.h \
     logginggadget.h \
     logginggadgetfactory.h \
@@ -16,6 +18,8 @@ HEADERS += loggingplugin.h \
 
 SOURCES += loggingplugin.cpp \
     logfile.cpp \
+    logindex.cpp \
+    logdecoder.cpp \
     logginggadgetwidget.cpp \
     logginggadget.cpp \
     logginggadgetfactory.cpp \
@@ -32,6 +32,7 @@
 #include "loggingdevice.h"
 #include "logginggadgetfactory.h"
 #include "flightlogdownload.h"
+#include "logdecoder.h"
 
 #include <QDebug>
 #include <QtPlugin>
@@ -41,9 +42,14 @@
 #include <QFileDialog>
 #include <QList>
 #include <QErrorMessage>
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QMessageBox>
 #include <QWriteLocker>
 
 #include <extensionsystem/pluginmanager.h>
+#include <coreplugin/generalsettings.h>
 #include <QKeySequence>
 #include "uavobjectmanager.h"
 
@@ -91,6 +97,10 @@ QIODevice* LoggingConnection::openDevice(IDevice *deviceName)
 
 void LoggingConnection::startReplay(QString file)
 {
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    Core::Internal::GeneralSettings *settings = pm->getObject<Core::Internal::GeneralSettings>();
+    logFile.setIndexCacheEnabled(settings->cacheLogIndex());
+
     logFile.setFileName(file);
     if(logFile.open(QIODevice::ReadOnly)) {
         qDebug() << "Replaying " << file;
@@ -365,6 +375,15 @@ bool LoggingPlugin::initialize(const QStringList& args, QString *errMsg)
     ac->addAction(cmdDownload, "Logging");
     connect(cmdDownload->action(), SIGNAL(triggered(bool)), this, SLOT(downloadLog()));
 
+    // Command to decode a log to tables
+    cmdExport = am->registerAction(new QAction(this),
+                                            "LoggingPlugin.Export",
+                                            QList<int>() <<
+                                            Core::Constants::C_GLOBAL_ID);
+    cmdExport->action()->setText("Export log to tables...");
+    ac->addAction(cmdExport, "Logging");
+    connect(cmdExport->action(), SIGNAL(triggered(bool)), this, SLOT(exportLog()));
+
 
     mf = new LoggingGadgetFactory(this);
     addAutoReleasedObject(mf);
@@ -382,6 +401,45 @@ void LoggingPlugin::downloadLog()
     download.exec();
 }
 
+/**
+  * Decode a log file without replaying it and write one CSV file per
+  * object instance, plus all of them in a single binary columnar file
+  */
+void LoggingPlugin::exportLog()
+{
+    QString logName = QFileDialog::getOpenFileName(NULL, tr("Export Log"), QDir::homePath(), tr("Tau Labs Log (*.tll)"));
+    if (logName.isEmpty())
+        return;
+
+    QString directory = QFileDialog::getExistingDirectory(NULL, tr("Export Directory"), QFileInfo(logName).absolutePath());
+    if (directory.isEmpty())
+        return;
+
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    QElapsedTimer timer;
+    timer.start();
+
+    LogDecoder decoder(objManager);
+    bool success = decoder.decode(logName);
+    qint64 decodeTime = timer.elapsed();
+    if (success) {
+        success = decoder.exportCSV(directory) &&
+                decoder.exportColumnar(QDir(directory).filePath(QFileInfo(logName).completeBaseName() + ".tlc"));
+    }
+
+    QApplication::restoreOverrideCursor();
+
+    if (!success) {
+        QMessageBox::critical(NULL, tr("Export Log"), tr("Unable to export %1").arg(logName));
+        return;
+    }
+
+    qDebug() << "Logging: decoded" << decoder.tables().size() << "tables in" << decodeTime << "ms," << decoder.packetErrors() << "bad packets";
+}
+
 /**
   * The action that is triggered by the menu item which opens the
   * file and begins logging if successful
@@ -144,6 +144,7 @@ protected:
 
 private slots:
     void downloadLog();
+    void exportLog();
     void toggleLogging();
     void startLogging(QString file);
     void stopLogging();
@@ -155,6 +156,7 @@ private:
     LoggingGadgetFactory *mf;
     Core::Command* cmdLogging;
     Core::Command* cmdDownload;
+    Core::Command* cmdExport;
 
 };
 #endif /* LoggingPLUGIN_H_ */
@@ -0,0 +1,234 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logindex.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      Memory mapped packet index for .tll log files
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup   Logging
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "logindex.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QDebug>
+#include <algorithm>
+
+LogIndex::LogIndex() :
+    data(NULL),
+    size(0),
+    sidecarEnabled(false),
+    sequential(true)
+{
+}
+
+LogIndex::~LogIndex()
+{
+    close();
+}
+
+/**
+ * @brief LogIndex::open Map a log file and index its packets
+ * @param fileName The log file
+ * @param dataStart Offset of the first packet, i.e. the size of the text header
+ * @return true if the file could be mapped (or read), even if it holds no packets
+ */
+bool LogIndex::open(const QString &fileName, qint64 dataStart)
+{
+    close();
+
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "Unable to open " << fileName << " for indexing";
+        return false;
+    }
+
+    size = file.size();
+    data = file.map(0, size);
+    if (data == NULL) {
+        // Mapping fails on empty files and can fail for very large files
+        // in 32 bit address spaces, fall back to reading the whole file.
+        fallbackData = file.readAll();
+        data = (const uchar *) fallbackData.constData();
+        size = fallbackData.size();
+    }
+
+    if (!sidecarEnabled || !loadSidecar(dataStart)) {
+        build(dataStart);
+        if (sidecarEnabled)
+            saveSidecar(dataStart);
+    }
+
+    return true;
+}
+
+void LogIndex::close()
+{
+    if (data != NULL && fallbackData.isEmpty())
+        file.unmap((uchar *) data);
+    data = NULL;
+    size = 0;
+    fallbackData.clear();
+    file.close();
+
+    timestamps.clear();
+    offsets.clear();
+    sizes.clear();
+    sequential = true;
+}
+
+QString LogIndex::sidecarFileName(const QString &fileName)
+{
+    return fileName + ".idx";
+}
+
+/**
+ * @brief LogIndex::findTimestamp Locate a packet by time
+ * @param timestamp Log time in ms
+ * @return The index of the first packet at or after \a timestamp, or count()
+ * if all packets are older
+ */
+int LogIndex::findTimestamp(quint32 timestamp) const
+{
+    if (sequential)
+        return std::lower_bound(timestamps.constBegin(), timestamps.constEnd(), timestamp) - timestamps.constBegin();
+
+    // Timestamps of a corrupted log can't be bisected
+    for (int i = 0; i < timestamps.size(); i++) {
+        if (timestamps[i] >= timestamp)
+            return i;
+    }
+    return timestamps.size();
+}
+
+/**
+ * @brief LogIndex::build Scan the mapping for packets
+ */
+void LogIndex::build(qint64 dataStart)
+{
+    const qint64 recordHeaderSize = sizeof(quint32) + sizeof(qint64);
+
+    // Reserve for a typical packet size to avoid repeated reallocation
+    int estimate = (size - dataStart) / 64;
+    timestamps.reserve(estimate);
+    offsets.reserve(estimate);
+    sizes.reserve(estimate);
+
+    qint64 pos = dataStart;
+    while (pos + recordHeaderSize <= size) {
+        quint32 timestamp;
+        qint64 dataSize;
+        memcpy(&timestamp, data + pos, sizeof(timestamp));
+        memcpy(&dataSize, data + pos + sizeof(timestamp), sizeof(dataSize));
+
+        // Packet sizes are small, so the upper bytes of the size act as
+        // sync bytes. If they are not zero skip ahead and try to resync.
+        if ((dataSize & 0xFFFFFFFFFFFF0000) != 0 || dataSize > MAX_PACKET_SIZE) {
+            qDebug() << "Wrong sync byte. At file location 0x"  << QString("%1").arg(pos, 0, 16);
+            pos++;
+            continue;
+        }
+
+        if (pos + recordHeaderSize + dataSize > size)
+            break;
+
+        if (!timestamps.isEmpty() && timestamp < timestamps.last())
+            sequential = false;
+
+        timestamps.append(timestamp);
+        offsets.append(pos + recordHeaderSize);
+        sizes.append(dataSize);
+
+        pos += recordHeaderSize + dataSize;
+    }
+
+    timestamps.squeeze();
+    offsets.squeeze();
+    sizes.squeeze();
+}
+
+/**
+ * @brief LogIndex::loadSidecar Read the packet index from the sidecar file
+ * @return true if a sidecar matching the current log was loaded
+ */
+bool LogIndex::loadSidecar(qint64 dataStart)
+{
+    QFile sidecar(sidecarFileName(file.fileName()));
+    if (!sidecar.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&sidecar);
+    quint32 magic, version;
+    qint64 logSize, logModified, logDataStart;
+    qint32 packets;
+    bool isSequential;
+    in >> magic >> version >> logSize >> logModified >> logDataStart >> packets >> isSequential;
+
+    QFileInfo info(file);
+    if (in.status() != QDataStream::Ok || magic != SIDECAR_MAGIC || version != SIDECAR_VERSION ||
+            logSize != size || logModified != info.lastModified().toMSecsSinceEpoch() ||
+            logDataStart != dataStart || packets < 0)
+        return false;
+
+    timestamps.resize(packets);
+    offsets.resize(packets);
+    sizes.resize(packets);
+    int tsBytes = packets * sizeof(quint32);
+    int offsetBytes = packets * sizeof(qint64);
+    int sizeBytes = packets * sizeof(qint32);
+    if (in.readRawData((char *) timestamps.data(), tsBytes) != tsBytes ||
+            in.readRawData((char *) offsets.data(), offsetBytes) != offsetBytes ||
+            in.readRawData((char *) sizes.data(), sizeBytes) != sizeBytes) {
+        timestamps.clear();
+        offsets.clear();
+        sizes.clear();
+        return false;
+    }
+
+    sequential = isSequential;
+    return true;
+}
+
+/**
+ * @brief LogIndex::saveSidecar Store the packet index next to the log. Failing
+ * to write it (e.g. read only media) is not an error.
+ */
+void LogIndex::saveSidecar(qint64 dataStart)
+{
+    QFile sidecar(sidecarFileName(file.fileName()));
+    if (!sidecar.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return;
+
+    QFileInfo info(file);
+    QDataStream out(&sidecar);
+    out << SIDECAR_MAGIC << SIDECAR_VERSION << size << (qint64) info.lastModified().toMSecsSinceEpoch()
+        << dataStart << (qint32) timestamps.size() << sequential;
+    out.writeRawData((const char *) timestamps.constData(), timestamps.size() * sizeof(quint32));
+    out.writeRawData((const char *) offsets.constData(), offsets.size() * sizeof(qint64));
+    out.writeRawData((const char *) sizes.constData(), sizes.size() * sizeof(qint32));
+}
+
+/**
+ * @}
+ * @}
+ */
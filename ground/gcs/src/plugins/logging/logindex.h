@@ -0,0 +1,99 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logindex.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      Memory mapped packet index for .tll log files
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup   Logging
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef LOGINDEX_H
+#define LOGINDEX_H
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <QByteArray>
+
+/**
+ * @brief The LogIndex class maps a .tll log file into memory and keeps the
+ * position and timestamp of every packet in it.
+ *
+ * A log file starts with a text header and is followed by records of
+ * a 32 bit timestamp (ms), a 64 bit packet size and the UAVTalk bytes
+ * of the packet. Once the index is built packets can be accessed directly
+ * in the mapping and located by timestamp with a binary search.
+ *
+ * Building the index of a long log takes a full pass over the file, so
+ * the index can optionally be cached next to the log in a sidecar file
+ * which is reused as long as the log does not change.
+ */
+class LogIndex
+{
+public:
+    LogIndex();
+    ~LogIndex();
+
+    bool open(const QString &fileName, qint64 dataStart);
+    void close();
+    bool isOpen() const { return data != NULL; }
+
+    void setSidecarEnabled(bool enabled) { sidecarEnabled = enabled; }
+    static QString sidecarFileName(const QString &fileName);
+
+    int count() const { return timestamps.size(); }
+    quint32 timestamp(int packet) const { return timestamps[packet]; }
+    const uchar *packetData(int packet) const { return data + offsets[packet]; }
+    qint32 packetSize(int packet) const { return sizes[packet]; }
+    const uchar *fileData() const { return data; }
+    qint64 fileSize() const { return size; }
+    bool isSequential() const { return sequential; }
+
+    int findTimestamp(quint32 timestamp) const;
+
+private:
+    static const quint32 SIDECAR_MAGIC = 0x58494c54; // "TLIX"
+    static const quint32 SIDECAR_VERSION = 1;
+    static const qint64 MAX_PACKET_SIZE = 1024*1024;
+
+    QFile file;
+    QByteArray fallbackData;
+    const uchar *data;
+    qint64 size;
+    bool sidecarEnabled;
+    bool sequential;
+
+    QVector<quint32> timestamps;
+    QVector<qint64> offsets;
+    QVector<qint32> sizes;
+
+    void build(qint64 dataStart);
+    bool loadSidecar(qint64 dataStart);
+    void saveSidecar(qint64 dataStart);
+};
+
+#endif // LOGINDEX_H
+
+/**
+ * @}
+ * @}
+ */
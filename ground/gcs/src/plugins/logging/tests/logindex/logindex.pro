@@ -0,0 +1,15 @@
+# -------------------------------------------------
+# Test of the log packet index and its sidecar cache
+# -------------------------------------------------
+QT -= gui
+QT += testlib
+TARGET = logindex
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+INCLUDEPATH *= ../..
+
+SOURCES += tst_logindex.cpp \
+    ../../logindex.cpp
+HEADERS += ../../logindex.h
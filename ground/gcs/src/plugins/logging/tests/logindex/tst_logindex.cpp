@@ -0,0 +1,183 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_logindex.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      Packet index of .tll log files and its sidecar cache
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup   Logging
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "logindex.h"
+
+#include <QtCore/QObject>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QtTest>
+
+class tst_LogIndex : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void indexesPackets();
+    void sidecarDisabled();
+    void sidecarReused();
+    void staleSidecarRebuilt();
+
+private:
+    static const int PACKETS = 100;
+    // Magic, version, log size, log time, data start, packet count and sequential flag
+    static const int SIDECAR_HEADER_SIZE = 4 + 4 + 8 + 8 + 8 + 4 + 1;
+
+    QTemporaryDir *dir;
+    QString fileName;
+    qint64 dataStart;
+
+    void appendPacket(QFile &log, quint32 timestamp, int size);
+};
+
+/**
+ * Write a log of PACKETS packets of growing size, 10 ms apart
+ */
+void tst_LogIndex::init()
+{
+    dir = new QTemporaryDir();
+    QVERIFY(dir->isValid());
+    fileName = dir->path() + "/test.tll";
+
+    QFile log(fileName);
+    QVERIFY(log.open(QIODevice::WriteOnly));
+    QByteArray header("Tau Labs git hash:\ntest\nUAVO hash:\ntest\n");
+    log.write(header);
+    dataStart = header.size();
+    for (int i = 0; i < PACKETS; i++)
+        appendPacket(log, i * 10, 1 + i % 50);
+}
+
+void tst_LogIndex::cleanup()
+{
+    delete dir;
+}
+
+void tst_LogIndex::appendPacket(QFile &log, quint32 timestamp, int size)
+{
+    qint64 dataSize = size;
+    log.write((const char *) &timestamp, sizeof(timestamp));
+    log.write((const char *) &dataSize, sizeof(dataSize));
+    log.write(QByteArray(size, (char) timestamp));
+}
+
+void tst_LogIndex::indexesPackets()
+{
+    LogIndex index;
+    QVERIFY(index.open(fileName, dataStart));
+    QCOMPARE(index.count(), PACKETS);
+    QVERIFY(index.isSequential());
+
+    for (int i = 0; i < PACKETS; i++) {
+        QCOMPARE(index.timestamp(i), (quint32) i * 10);
+        QCOMPARE(index.packetSize(i), 1 + i % 50);
+        QCOMPARE(index.packetData(i)[0], (uchar) (i * 10));
+    }
+
+    QCOMPARE(index.findTimestamp(0), 0);
+    QCOMPARE(index.findTimestamp(15), 2);
+    QCOMPARE(index.findTimestamp(PACKETS * 10), PACKETS);
+}
+
+void tst_LogIndex::sidecarDisabled()
+{
+    LogIndex index;
+    QVERIFY(index.open(fileName, dataStart));
+    QVERIFY(!QFile::exists(LogIndex::sidecarFileName(fileName)));
+}
+
+/**
+ * A sidecar matching the log is used instead of scanning the log. The
+ * first timestamp in the sidecar is patched to tell the two apart.
+ */
+void tst_LogIndex::sidecarReused()
+{
+    {
+        LogIndex index;
+        index.setSidecarEnabled(true);
+        QVERIFY(index.open(fileName, dataStart));
+        QCOMPARE(index.count(), PACKETS);
+    }
+    QVERIFY(QFile::exists(LogIndex::sidecarFileName(fileName)));
+
+    QFile sidecar(LogIndex::sidecarFileName(fileName));
+    QVERIFY(sidecar.open(QIODevice::ReadWrite));
+    QVERIFY(sidecar.seek(SIDECAR_HEADER_SIZE));
+    quint32 marker = 12345;
+    sidecar.write((const char *) &marker, sizeof(marker));
+    sidecar.close();
+
+    LogIndex index;
+    index.setSidecarEnabled(true);
+    QVERIFY(index.open(fileName, dataStart));
+    QCOMPARE(index.count(), PACKETS);
+    QCOMPARE(index.timestamp(0), marker);
+    for (int i = 1; i < PACKETS; i++) {
+        QCOMPARE(index.timestamp(i), (quint32) i * 10);
+        QCOMPARE(index.packetSize(i), 1 + i % 50);
+    }
+}
+
+/**
+ * A sidecar of an older version of the log is ignored and rewritten
+ */
+void tst_LogIndex::staleSidecarRebuilt()
+{
+    {
+        LogIndex index;
+        index.setSidecarEnabled(true);
+        QVERIFY(index.open(fileName, dataStart));
+    }
+
+    QFile log(fileName);
+    QVERIFY(log.open(QIODevice::Append));
+    appendPacket(log, PACKETS * 10, 8);
+    log.close();
+
+    LogIndex index;
+    index.setSidecarEnabled(true);
+    QVERIFY(index.open(fileName, dataStart));
+    QCOMPARE(index.count(), PACKETS + 1);
+    QCOMPARE(index.timestamp(PACKETS), (quint32) PACKETS * 10);
+    index.close();
+
+    // The rewritten sidecar matches the new log
+    QVERIFY(index.open(fileName, dataStart));
+    QCOMPARE(index.count(), PACKETS + 1);
+}
+
+QTEST_MAIN(tst_LogIndex)
+
+#include "tst_logindex.moc"
+
+/**
+ * @}
+ * @}
+ */
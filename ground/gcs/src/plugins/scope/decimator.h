@@ -0,0 +1,129 @@
+/**
+ ******************************************************************************
+ *
+ * @file       decimator.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief Level of detail reduction for the scope plots
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef DECIMATOR_H
+#define DECIMATOR_H
+
+#include "ringbuffer.h"
+
+#include <QPointF>
+#include <math.h>
+
+
+/**
+ * @brief The MinMaxDecimator class reduces a curve to its minimum and maximum
+ * in every column of a fixed width along the x axis. With the column width set
+ * to one pixel the plotted line looks the same as with all the samples, but
+ * the number of points to draw is bounded by the width of the plot.
+ *
+ * Samples must be appended in increasing x order. Each sample only updates the
+ * open column, so the decimated curve is maintained as the data arrives.
+ */
+class MinMaxDecimator
+{
+public:
+    MinMaxDecimator() : columnWidth(0) { clear(); }
+
+    void setColumnWidth(double val) { columnWidth = val; clear(); }
+    double getColumnWidth() const { return columnWidth; }
+
+    void clear()
+    {
+        points.clear();
+        columnCount = 0;
+        columnEnd = 0;
+    }
+
+    void append(double x, double y)
+    {
+        if (columnCount > 0 && x >= columnEnd)
+            closeColumn();
+
+        if (columnCount == 0) {
+            columnEnd = columnWidth > 0 ? (floor(x / columnWidth) + 1) * columnWidth : x;
+            columnMin = columnMax = QPointF(x, y);
+        } else if (y < columnMin.y()) {
+            columnMin = QPointF(x, y);
+        } else if (y > columnMax.y()) {
+            columnMax = QPointF(x, y);
+        }
+        columnCount++;
+    }
+
+    //! Drop the points older than \a x
+    void removeBefore(double x)
+    {
+        while (!points.isEmpty() && points.first().x() < x)
+            points.takeFirst();
+    }
+
+    int size() const { return points.size() + openPoints(); }
+
+    QPointF at(int i) const
+    {
+        if (i < points.size())
+            return points.at(i);
+        return openPoint(i - points.size());
+    }
+
+private:
+    int openPoints() const
+    {
+        if (columnCount == 0)
+            return 0;
+        return columnMin == columnMax ? 1 : 2;
+    }
+
+    //! Points of the open column, in x order
+    QPointF openPoint(int i) const
+    {
+        bool minFirst = columnMin.x() <= columnMax.x();
+        return (i == 0) == minFirst ? columnMin : columnMax;
+    }
+
+    void closeColumn()
+    {
+        int n = openPoints();
+        for (int i = 0; i < n; i++)
+            points.append(openPoint(i));
+        columnCount = 0;
+    }
+
+    RingBuffer<QPointF> points;
+    double columnWidth;
+    double columnEnd;
+    int columnCount;
+    QPointF columnMin;
+    QPointF columnMax;
+};
+
+#endif // DECIMATOR_H
+
+/**
+ * @}
+ * @}
+ */
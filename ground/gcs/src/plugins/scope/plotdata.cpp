@@ -41,7 +41,6 @@
  * @param p_uavFieldName The plotted UAVO field name
  */
 Plot2dData::Plot2dData(QString p_uavObject, QString p_uavFieldName):
-    yDataHistory(0),
     dataUpdated(false)
 {
     uavObjectName = p_uavObject;
@@ -61,13 +60,15 @@ Plot2dData::Plot2dData(QString p_uavObject, QString p_uavFieldName):
 
     xData = new QVector<double>();
     yData = new QVector<double>();
-    yDataHistory = new QVector<double>();
 
     scalePower = 0;
+    scaleFactor = 1;
     meanSamples = 1;
     meanSum = 0.0f;
     correctionSum = 0.0f;
     correctionCount = 0;
+    uavFieldIndex = -1;
+    uavElementIndex = 0;
     yMinimum = 0;
     yMaximum = 120;
 
@@ -101,14 +102,15 @@ Plot3dData::Plot3dData(QString p_uavObject, QString p_uavFieldName):
     xData = new QVector<double>();
     yData = new QVector<double>();
     zData = new QVector<double>();
-    zDataHistory = new QVector<double>();
-    timeDataHistory = new QVector<double>();
 
     scalePower = 0;
+    scaleFactor = 1;
     meanSamples = 1;
     meanSum = 0.0f;
     correctionSum = 0.0f;
     correctionCount = 0;
+    uavFieldIndex = -1;
+    uavElementIndex = 0;
     xMinimum = 0;
     xMaximum = 16;
     yMinimum = 0;
@@ -124,8 +126,6 @@ Plot2dData::~Plot2dData()
         delete xData;
     if (yData != NULL)
         delete yData;
-    if (yDataHistory != NULL)
-        delete yDataHistory;
 }
 
 
@@ -137,31 +137,41 @@ Plot3dData::~Plot3dData()
         delete yData;
     if (zData != NULL)
         delete zData;
-    if (zDataHistory != NULL)
-        delete zDataHistory;
-    if (timeDataHistory != NULL)
-        delete timeDataHistory;
 }
 
 
 /**
- * @brief valueAsDouble Fetch the value from the UAVO and return it as a double
+ * @brief PlotData::bind Resolve the plotted field and element in the UAVO, so
+ * that new samples can be read without any lookup by name
  * @param obj UAVO
- * @param field UAVO field
- * @param haveSubField TRUE if UAVO has subfield. FALSE if not.
- * @param uavSubFieldName UAVO subfield, if it exists
- * @return
+ * @return TRUE if the field (and subfield) exist. FALSE if not.
  */
-double PlotData::valueAsDouble(UAVObject* obj, UAVObjectField* field, bool haveSubField, QString uavSubFieldName)
+bool PlotData::bind(UAVObject* obj)
 {
-    Q_UNUSED(obj);
-    QVariant value;
+    uavFieldIndex = obj->getFieldIndex(uavFieldName);
+    if (uavFieldIndex < 0)
+        return false;
+
+    uavElementIndex = 0;
+    if (haveSubField) {
+        uavElementIndex = obj->fieldAt(uavFieldIndex)->getElementNames().indexOf(uavSubFieldName);
+        if (uavElementIndex < 0)
+            return false;
+    }
+
+    scaleFactor = pow(10, scalePower);
+
+    return true;
+}
 
-    if(haveSubField){
-        int indexOfSubField = field->getElementNames().indexOf(QRegExp(uavSubFieldName, Qt::CaseSensitive, QRegExp::FixedString));
-        value = field->getValue(indexOfSubField);
-    }else
-        value = field->getValue();
 
-    return value.toDouble();
+/**
+ * @brief boundValue Fetch the bound value from the UAVO, or from another
+ * instance of it, and return it scaled as a double
+ * @param obj UAVO
+ * @return
+ */
+double PlotData::boundValue(UAVObject* obj)
+{
+    return obj->fieldAt(uavFieldIndex)->getDouble(uavElementIndex) * scaleFactor;
 }
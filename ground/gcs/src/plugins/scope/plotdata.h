@@ -46,7 +46,8 @@ class PlotData : public QObject
 {
     Q_OBJECT
 public:
-    double valueAsDouble(UAVObject* obj, UAVObjectField* field, bool haveSubField, QString uavSubFieldName);
+    bool bind(UAVObject* obj);
+    double boundValue(UAVObject* obj);
 
     //Setter functions
     void setXMinimum(double val){xMinimum=val;}
@@ -102,6 +103,7 @@ protected:
     bool haveSubField;
 
     int scalePower; //This is the power to which each value must be raised
+    double scaleFactor;
     unsigned int meanSamples;
     QString mathFunction;
     double meanSum;
@@ -109,6 +111,10 @@ protected:
     double correctionSum;
     int correctionCount;
 
+    // Field and element resolved by bind()
+    int uavFieldIndex;
+    int uavElementIndex;
+
 private:
 
 };
@@ -0,0 +1,191 @@
+/**
+ ******************************************************************************
+ *
+ * @file       ringbuffer.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief Sample storage for the scope plots
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <QVector>
+#include <math.h>
+
+
+/**
+ * @brief The RingBuffer class is a FIFO of samples. Appending at the back
+ * and removing from the front are O(1), unlike QVector::pop_front() which
+ * moves the whole buffer. The storage only grows, to the next power of two,
+ * when it is full.
+ */
+template <typename T>
+class RingBuffer
+{
+public:
+    RingBuffer(int capacity = 0) : head(0), count(0) { reserve(capacity); }
+
+    int size() const { return count; }
+    bool isEmpty() const { return count == 0; }
+    int capacity() const { return buffer.size(); }
+
+    const T &at(int i) const { return buffer.at((head + i) & (buffer.size() - 1)); }
+    const T &first() const { return at(0); }
+    const T &last() const { return at(count - 1); }
+
+    void append(const T &value)
+    {
+        if (count == buffer.size())
+            reserve(count + 1);
+        buffer[(head + count) & (buffer.size() - 1)] = value;
+        count++;
+    }
+
+    T takeFirst()
+    {
+        T value = buffer.at(head);
+        head = (head + 1) & (buffer.size() - 1);
+        count--;
+        return value;
+    }
+
+    void clear() { head = 0; count = 0; }
+
+    void reserve(int size)
+    {
+        int newSize = 1;
+        while (newSize < size)
+            newSize <<= 1;
+        if (newSize <= buffer.size())
+            return;
+
+        // Unwrap the samples at the start of the new storage
+        QVector<T> newBuffer(newSize);
+        for (int i = 0; i < count; i++)
+            newBuffer[i] = at(i);
+        buffer = newBuffer;
+        head = 0;
+    }
+
+private:
+    QVector<T> buffer;
+    int head;
+    int count;
+};
+
+
+/**
+ * @brief The WindowStatistics class keeps the mean and standard deviation
+ * of the last N samples, updated in O(1) per sample with Welford's method.
+ *
+ * Removing samples from the running sums slowly accumulates rounding
+ * errors, so the sums are recomputed from the window once every N samples.
+ */
+class WindowStatistics
+{
+public:
+    WindowStatistics() : window(1) { clear(); }
+
+    void setWindow(int val)
+    {
+        window = val > 0 ? val : 1;
+        while (samples.size() > window)
+            remove(samples.takeFirst());
+    }
+
+    void append(double value)
+    {
+        samples.append(value);
+        add(value);
+        if (samples.size() > window)
+            remove(samples.takeFirst());
+
+        if (++updates >= window)
+            recompute();
+    }
+
+    void clear()
+    {
+        samples.clear();
+        updates = 0;
+        m = 0;
+        m2 = 0;
+    }
+
+    double mean() const { return m; }
+
+    //! Sample standard deviation, with Bessel's correction
+    double standardDeviation() const
+    {
+        if (samples.size() < 2 || m2 <= 0)
+            return 0;
+        return sqrt(m2 / (samples.size() - 1));
+    }
+
+private:
+    void add(double value)
+    {
+        double delta = value - m;
+        m += delta / samples.size();
+        m2 += delta * (value - m);
+    }
+
+    void remove(double value)
+    {
+        if (samples.isEmpty()) {
+            m = 0;
+            m2 = 0;
+            return;
+        }
+        double delta = value - m;
+        m -= delta / samples.size();
+        m2 -= delta * (value - m);
+    }
+
+    void recompute()
+    {
+        updates = 0;
+        double sum = 0;
+        for (int i = 0; i < samples.size(); i++)
+            sum += samples.at(i);
+        m = sum / samples.size();
+
+        m2 = 0;
+        for (int i = 0; i < samples.size(); i++) {
+            double delta = samples.at(i) - m;
+            m2 += delta * delta;
+        }
+    }
+
+    RingBuffer<double> samples;
+    int window;
+    int updates;
+    double m;
+    double m2;
+};
+
+#endif // RINGBUFFER_H
+
+/**
+ * @}
+ * @}
+ */
@@ -19,6 +19,8 @@ HEADERS += scopeplugin.h \
     scopes3d/scopes3dconfig.h \
     scopesconfig.h \
     plotdata.h \
+    ringbuffer.h \
+    decimator.h \
     scope_global.h
 HEADERS += scopegadgetoptionspage.h
 HEADERS += scopegadgetconfiguration.h
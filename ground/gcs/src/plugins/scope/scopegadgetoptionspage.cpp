@@ -618,9 +618,11 @@ void ScopeGadgetOptionsPage::on_cmbXAxisScatterplot2d_currentIndexChanged(QStrin
 {
     if (currentText == "Series"){
         options_page->spnDataSize->setSuffix(" samples");
+        options_page->chkDecimation->setEnabled(false);
     }
     else if (currentText == "Time series"){
         options_page->spnDataSize->setSuffix(" seconds");
+        options_page->chkDecimation->setEnabled(true);
     }
 }
 
@@ -87,16 +87,7 @@ ScopeGadgetWidget::ScopeGadgetWidget(QWidget *parent) : QwtPlot(parent),
  */
 ScopeGadgetWidget::~ScopeGadgetWidget()
 {
-    // Get the object to de-monitor
-    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
-    foreach (QString uavObjName, m_connectedUAVObjects)
-    {
-        UAVDataObject *obj = dynamic_cast<UAVDataObject*>(objManager->getObject(uavObjName));
-        disconnect(obj, SIGNAL(objectUpdated(UAVObject*)), this, SLOT(uavObjectReceived(UAVObject*)));
-    }
-
-    // Clear the plot
+    // Clear the plot, this also de-monitors the objects
     clearPlotWidget();
 }
 
@@ -295,10 +286,14 @@ void ScopeGadgetWidget::showCurve(const QVariant & itemInfo, bool on, int index)
  */
 void ScopeGadgetWidget::uavObjectReceived(UAVObject* obj)
 {
-    foreach(PlotData* plotdData, m_dataSources.values()) {
-        bool ret = plotdData->append(obj);
+    // Only the plots bound to this object are updated
+    QMultiHash<UAVObject*, PlotData*>::const_iterator i = m_objectDataSources.constFind(obj);
+    while (i != m_objectDataSources.constEnd() && i.key() == obj) {
+        PlotData* plotData = i.value();
+        bool ret = plotData->append(obj);
         if (ret)
-            plotdData->setUpdatedFlagToTrue();
+            plotData->setUpdatedFlagToTrue();
+        ++i;
     }
 }
 
@@ -331,6 +326,13 @@ void ScopeGadgetWidget::replotNewData()
  */
 void ScopeGadgetWidget::clearPlotWidget()
 {
+    // De-monitor the objects, their updates must not reach the plots being cleared
+    foreach (UAVObject *obj, m_objectDataSources.uniqueKeys())
+    {
+        disconnect(obj, SIGNAL(objectUpdated(UAVObject*)), this, SLOT(uavObjectReceived(UAVObject*)));
+    }
+    m_objectDataSources.clear();
+
     if(m_grid){
         m_grid->detach();
     }
@@ -389,16 +391,22 @@ void ScopeGadgetWidget::showEvent(QShowEvent *event)
 
 
 /**
- * @brief ScopeGadgetWidget::connectUAVO Connects UAVO update signal, but only if it hasn't yet been connected
+ * @brief ScopeGadgetWidget::connectUAVO Binds the plot data to the UAVO and connects
+ * the UAVO update signal, but only if it hasn't yet been connected
  * @param obj
+ * @param plotData
  */
-void ScopeGadgetWidget::connectUAVO(UAVDataObject* obj){
-    //Link to the new signal data only if this UAVObject has not been connected yet
-    if (!m_connectedUAVObjects.contains(obj->getName())) {
-        m_connectedUAVObjects.append(obj->getName());
-        connect(obj, SIGNAL(objectUpdated(UAVObject*)), this, SLOT(uavObjectReceived(UAVObject*)));
+void ScopeGadgetWidget::connectUAVO(UAVDataObject* obj, PlotData* plotData){
+    if (!plotData->bind(obj)) {
+        qDebug() << "In scope gadget, field" << plotData->getUavoFieldName() << plotData->getUavoSubFieldName() << "of UAVObject" << obj->getName() << "is missing";
+        return;
     }
 
+    //Link to the new signal data only if this UAVObject has not been connected yet
+    if (!m_objectDataSources.contains(obj))
+        connect(obj, SIGNAL(objectUpdated(UAVObject*)), this, SLOT(uavObjectReceived(UAVObject*)), Qt::UniqueConnection);
+
+    m_objectDataSources.insert(obj, plotData);
 }
 
 
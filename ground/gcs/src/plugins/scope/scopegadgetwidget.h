@@ -50,6 +50,7 @@ class UAVDataObject;
 #include <QTime>
 #include <QVector>
 #include <QMutex>
+#include <QMultiHash>
 
 /*!
   \brief This class is used to render the time values on the horizontal axis for the
@@ -81,7 +82,7 @@ public:
     ~ScopeGadgetWidget();
 
     QString getUavObjectFieldUnits(QString uavObjectName, QString uavObjectFieldName);
-    void connectUAVO(UAVDataObject* obj);
+    void connectUAVO(UAVDataObject* obj, PlotData* plotData);
 
     void setScope(ScopeConfig *val){m_scope = val;}
     QMap<QString, PlotData*> getDataSources(){return m_dataSources;}
@@ -116,7 +117,7 @@ private:
     QMap<QString, PlotData*> m_dataSources;
     double m_xWindowSize;
     static QTimer *replotTimer;
-    QList<QString> m_connectedUAVObjects;
+    QMultiHash<UAVObject*, PlotData*> m_objectDataSources;
 
 };
 
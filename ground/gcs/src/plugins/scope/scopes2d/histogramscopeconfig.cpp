@@ -281,7 +281,7 @@ void HistogramScopeConfig::loadConfiguration(ScopeGadgetWidget *scopeGadgetWidge
         scopeGadgetWidget->insertDataSources(histogramNameScaled, histogramData);
 
         // Connect the UAVO
-        scopeGadgetWidget->connectUAVO(obj);
+        scopeGadgetWidget->connectUAVO(obj, histogramData);
     }
     mutex.lock();
     scopeGadgetWidget->replot();
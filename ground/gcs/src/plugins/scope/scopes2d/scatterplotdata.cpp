@@ -39,6 +39,74 @@
 #include "qwt/src/qwt_plot_curve.h"
 
 
+size_t ScatterplotSeries::size() const
+{
+    return plotData->seriesSize();
+}
+
+
+QPointF ScatterplotSeries::sample(size_t i) const
+{
+    return plotData->seriesSample(i);
+}
+
+
+QRectF ScatterplotSeries::boundingRect() const
+{
+    if (d_boundingRect.width() < 0.0)
+        d_boundingRect = qwtBoundingRect(*this);
+
+    return d_boundingRect;
+}
+
+
+/**
+ * @brief ScatterplotData::setCurve Attach the curve, which plots straight
+ * from the sample buffers
+ * @param val The curve
+ */
+void ScatterplotData::setCurve(QwtPlotCurve *val)
+{
+    curve = val;
+    series = new ScatterplotSeries(this);
+    curve->setSamples(series);
+}
+
+
+/**
+ * @brief ScatterplotData::updateCurve Tell the curve that the samples changed
+ */
+void ScatterplotData::updateCurve()
+{
+    if (curve == 0)
+        return;
+
+    series->dataChanged();
+    curve->itemChanged();
+}
+
+
+/**
+ * @brief ScatterplotData::applyMathFunction Apply the scope math to a new sample
+ * @param currentValue The new, scaled, sample
+ * @return The value to plot
+ */
+double ScatterplotData::applyMathFunction(double currentValue)
+{
+    if (mathFunction  == "Boxcar average" || mathFunction  == "Standard deviation"){
+        statistics.setWindow(meanSamples);
+        statistics.append(currentValue);
+
+        if ( mathFunction  == "Standard deviation" )
+            return statistics.standardDeviation();
+        else
+            return statistics.mean();
+    }
+
+    return currentValue;
+}
+
+
 /**
  * @brief Scatterplot2dScopeConfig::plotNewData Update plot with new data
  * @param scopeGadgetWidget
@@ -49,9 +117,13 @@ void TimeSeriesPlotData::plotNewData(PlotData *plot2dData, ScopeConfig *scopeCon
     Q_UNUSED(scopeConfig);
     Q_UNUSED(scopeGadgetWidget);
 
+    // The decimation follows the width of the plot, in pixels
+    if (decimationEnabled)
+        updateDecimation(scopeGadgetWidget->canvas()->width());
+
     //Plot new data
     if (readAndResetUpdatedFlag() == true)
-        curve->setSamples(*xData, *yData);
+        updateCurve();
 
     QDateTime NOW = QDateTime::currentDateTime();
     double toTime = NOW.toTime_t();
@@ -73,7 +145,7 @@ void SeriesPlotData::plotNewData(PlotData *plot2dData, ScopeConfig *scopeConfig,
 
     //Plot new data
     if (readAndResetUpdatedFlag() == true)
-        curve->setSamples(*xData, *yData);
+        updateCurve();
 }
 
 
@@ -84,64 +156,17 @@ void SeriesPlotData::plotNewData(PlotData *plot2dData, ScopeConfig *scopeConfig,
  */
 bool SeriesPlotData::append(UAVObject* obj)
 {
-    if (uavObjectName == obj->getName()) {
-
-        //Get the field of interest
-        UAVObjectField* field =  obj->getField(uavFieldName);
-
-        if (field) {
-
-            double currentValue = valueAsDouble(obj, field, haveSubField, uavSubFieldName) * pow(10, scalePower);
-
-            //Perform scope math, if necessary
-            if (mathFunction  == "Boxcar average" || mathFunction  == "Standard deviation"){
-                //Put the new value at the front
-                yDataHistory->append( currentValue );
-
-                // calculate average value
-                meanSum += currentValue;
-                if(yDataHistory->size() > (int)meanSamples) {
-                    meanSum -= yDataHistory->first();
-                    yDataHistory->pop_front();
-                }
-
-                // make sure to correct the sum every meanSamples steps to prevent it
-                // from running away due to floating point rounding errors
-                correctionSum+=currentValue;
-                if (++correctionCount >= (int)meanSamples) {
-                    meanSum = correctionSum;
-                    correctionSum = 0.0f;
-                    correctionCount = 0;
-                }
-
-                double boxcarAvg=meanSum/yDataHistory->size();
-
-                if ( mathFunction  == "Standard deviation" ){
-                    //Calculate square of sample standard deviation, with Bessel's correction
-                    double stdSum=0;
-                    for (int i=0; i < yDataHistory->size(); i++){
-                        stdSum+= pow(yDataHistory->at(i)- boxcarAvg,2)/(meanSamples-1);
-                    }
-                    yData->append(sqrt(stdSum));
-                }
-                else  {
-                    yData->append(boxcarAvg);
-                }
-            }
-            else{
-                yData->append( currentValue );
-            }
-
-            if (yData->size() > getXWindowSize()) { //If new data overflows the window, remove old data...
-                yData->pop_front();
-            } else //...otherwise, add a new y point at position xData
-                xData->insert(xData->size(), xData->size());
-
-            return true;
-        }
-    }
+    double currentValue = boundValue(obj);
+
+    //Perform scope math, if necessary
+    ySamples.append(applyMathFunction(currentValue));
 
-    return false;
+    if (ySamples.size() > getXWindowSize()) { //If new data overflows the window, remove old data...
+        ySamples.takeFirst();
+    } else //...otherwise, add a new y point at position xData
+        xSamples.append(xSamples.size());
+
+    return true;
 }
 
 
@@ -152,63 +177,22 @@ bool SeriesPlotData::append(UAVObject* obj)
  */
 bool TimeSeriesPlotData::append(UAVObject* obj)
 {
-    if (uavObjectName == obj->getName()) {
-        //Get the field of interest
-        UAVObjectField* field =  obj->getField(uavFieldName);
-
-        if (field) {
-            QDateTime NOW = QDateTime::currentDateTime(); //THINK ABOUT REIMPLEMENTING THIS TO SHOW UAVO TIME, NOT SYSTEM TIME
-            double currentValue = valueAsDouble(obj, field, haveSubField, uavSubFieldName) * pow(10, scalePower);
-
-            //Perform scope math, if necessary
-            if (mathFunction  == "Boxcar average" || mathFunction  == "Standard deviation"){
-                //Put the new value at the back
-                yDataHistory->append( currentValue );
-
-                // calculate average value
-                meanSum += currentValue;
-                if(yDataHistory->size() > (int)meanSamples) {
-                    meanSum -= yDataHistory->first();
-                    yDataHistory->pop_front();
-                }
-                // make sure to correct the sum every meanSamples steps to prevent it
-                // from running away due to floating point rounding errors
-                correctionSum+=currentValue;
-                if (++correctionCount >= (int)meanSamples) {
-                    meanSum = correctionSum;
-                    correctionSum = 0.0f;
-                    correctionCount = 0;
-                }
-
-                double boxcarAvg=meanSum/yDataHistory->size();
-
-                if ( mathFunction  == "Standard deviation" ){
-                    //Calculate square of sample standard deviation, with Bessel's correction
-                    double stdSum=0;
-                    for (int i=0; i < yDataHistory->size(); i++){
-                        stdSum+= pow(yDataHistory->at(i)- boxcarAvg,2)/(meanSamples-1);
-                    }
-                    yData->append(sqrt(stdSum));
-                }
-                else  {
-                    yData->append(boxcarAvg);
-                }
-            }
-            else{
-                yData->append( currentValue );
-            }
-
-            double valueX = NOW.toTime_t() + NOW.time().msec() / 1000.0;
-            xData->append(valueX);
-
-            //Remove stale data
-            removeStaleData();
-
-            return true;
-        }
-    }
+    QDateTime NOW = QDateTime::currentDateTime(); //THINK ABOUT REIMPLEMENTING THIS TO SHOW UAVO TIME, NOT SYSTEM TIME
+    double currentValue = boundValue(obj);
 
-    return false;
+    //Perform scope math, if necessary
+    ySamples.append(applyMathFunction(currentValue));
+
+    double valueX = NOW.toTime_t() + NOW.time().msec() / 1000.0;
+    xSamples.append(valueX);
+
+    if (decimationColumns > 0)
+        decimator.append(valueX, ySamples.last());
+
+    //Remove stale data
+    removeStaleData();
+
+    return true;
 }
 
 
@@ -221,18 +205,56 @@ void TimeSeriesPlotData::removeStaleData()
     double oldestValue;
 
     while (1) {
-        if (xData->size() == 0)
+        if (xSamples.size() == 0)
             break;
 
-        newestValue = xData->last();
-        oldestValue = xData->first();
+        newestValue = xSamples.last();
+        oldestValue = xSamples.first();
 
         if (newestValue - oldestValue > getXWindowSize()) {
-            yData->pop_front();
-            xData->pop_front();
+            ySamples.takeFirst();
+            xSamples.takeFirst();
         } else
             break;
     }
+
+    if (decimationColumns > 0 && xSamples.size() > 0)
+        decimator.removeBefore(xSamples.first());
+}
+
+
+/**
+ * @brief TimeSeriesPlotData::updateDecimation Rebuilds the decimated curve when
+ * the number of columns changes. After that the curve is kept up to date by append().
+ * @param columns Number of columns the time window is split in
+ */
+void TimeSeriesPlotData::updateDecimation(int columns)
+{
+    if (columns == decimationColumns || columns <= 0)
+        return;
+
+    decimationColumns = columns;
+    decimator.setColumnWidth(m_xWindowSize / columns);
+    for (int i = 0; i < xSamples.size(); i++)
+        decimator.append(xSamples.at(i), ySamples.at(i));
+
+    setUpdatedFlagToTrue();
+}
+
+
+int TimeSeriesPlotData::seriesSize() const
+{
+    if (decimationColumns > 0)
+        return decimator.size();
+    return ySamples.size();
+}
+
+
+QPointF TimeSeriesPlotData::seriesSample(int i) const
+{
+    if (decimationColumns > 0)
+        return decimator.at(i);
+    return QPointF(xSamples.at(i), ySamples.at(i));
 }
 
 
@@ -29,14 +29,41 @@
 #define SCATTERPLOTDATA_H
 
 #include "scopes2d/plotdata2d.h"
+#include "ringbuffer.h"
+#include "decimator.h"
 #include "uavobject.h"
 #include "qwt/src/qwt_plot_curve.h"
+#include "qwt/src/qwt_series_data.h"
 
 #include <QTimer>
 #include <QTime>
 #include <QVector>
 
 
+class ScatterplotData;
+
+/**
+ * @brief The ScatterplotSeries class gives the curve direct access to the
+ * samples of a ScatterplotData, so that nothing is copied when it is plotted.
+ * The curve takes ownership of the series.
+ */
+class ScatterplotSeries : public QwtSeriesData<QPointF>
+{
+public:
+    ScatterplotSeries(ScatterplotData *data) : plotData(data) { dataChanged(); }
+
+    virtual size_t size() const;
+    virtual QPointF sample(size_t i) const;
+    virtual QRectF boundingRect() const;
+
+    //! Drop the cached bounding rectangle after the samples changed
+    void dataChanged() { d_boundingRect = QRectF(0.0, 0.0, -1.0, -1.0); }
+
+private:
+    ScatterplotData *plotData;
+};
+
+
 /**
  * @brief The Scatterplot2dData class Base class that keeps the data for each curve in the plot.
  */
@@ -45,15 +72,27 @@ class ScatterplotData : public Plot2dData
     Q_OBJECT
 public:
     ScatterplotData(QString uavObject, QString uavField):
-        Plot2dData(uavObject, uavField){curve = 0;}
+        Plot2dData(uavObject, uavField){curve = 0; series = 0;}
     ~ScatterplotData(){}
 
     virtual void clearPlots(PlotData *);
 
-    void setCurve(QwtPlotCurve *val){curve = val;}
+    void setCurve(QwtPlotCurve *val);
+
+    //! Points handed to the curve, either the samples or a reduced set of them
+    virtual int seriesSize() const {return ySamples.size();}
+    virtual QPointF seriesSample(int i) const {return QPointF(xSamples.at(i), ySamples.at(i));}
 
 protected:
+    double applyMathFunction(double currentValue);
+    void updateCurve();
+
     QwtPlotCurve* curve;
+    ScatterplotSeries* series;
+
+    RingBuffer<double> xSamples;
+    RingBuffer<double> ySamples;
+    WindowStatistics statistics;
 };
 
 
@@ -95,6 +134,8 @@ public:
     TimeSeriesPlotData(QString uavObject, QString uavField)
             : ScatterplotData(uavObject, uavField) {
         scalePower = 1;
+        decimationEnabled = false;
+        decimationColumns = 0;
     }
     ~TimeSeriesPlotData() {
     }
@@ -104,6 +145,18 @@ public:
     virtual void removeStaleData();
     virtual void plotNewData(PlotData *, ScopeConfig *, ScopeGadgetWidget *);
 
+    void setDecimationEnabled(bool val){decimationEnabled = val;}
+
+    virtual int seriesSize() const;
+    virtual QPointF seriesSample(int i) const;
+
+private:
+    void updateDecimation(int columns);
+
+    bool decimationEnabled;
+    int decimationColumns;
+    MinMaxDecimator decimator;
+
 private slots:
     void removeStaleDataTimeout();
 };
@@ -45,6 +45,7 @@ Scatterplot2dScopeConfig::Scatterplot2dScopeConfig()
     scatterplot2dType = TIMESERIES2D;
     m_refreshInterval = 50;
     timeHorizon = 60;
+    decimation = true;
 }
 
 
@@ -57,6 +58,7 @@ Scatterplot2dScopeConfig::Scatterplot2dScopeConfig(QSettings *qSettings)
     this->m_refreshInterval = m_refreshInterval;
     scatterplot2dType =  (Scatterplot2dType) qSettings->value("scatterplot2dType").toUInt();
     timeHorizon = qSettings->value("timeHorizon").toDouble();
+    decimation = qSettings->value("decimation", true).toBool();
 
     int dataSourceCount = qSettings->value("dataSourceCount").toInt();
     for(int i = 0; i < dataSourceCount; i++)
@@ -90,6 +92,7 @@ Scatterplot2dScopeConfig::Scatterplot2dScopeConfig(Ui::ScopeGadgetOptionsPage *o
     bool parseOK = false;
 
     timeHorizon = options_page->spnDataSize->value();
+    decimation = options_page->chkDecimation->isChecked();
     scatterplot2dType = (Scatterplot2dType) options_page->cmbXAxisScatterplot2d->itemData(options_page->cmbXAxisScatterplot2d->currentIndex()).toInt();
 
     for(int iIndex = 0; iIndex < options_page->lst2dCurves->count();iIndex++) {
@@ -142,6 +145,7 @@ ScopeConfig* Scatterplot2dScopeConfig::cloneScope(ScopeConfig *originalScope)
     cloneObj->m_refreshInterval = originalScatterplot2dScopeConfig->m_refreshInterval;
     cloneObj->timeHorizon = originalScatterplot2dScopeConfig->timeHorizon;
     cloneObj->scatterplot2dType = originalScatterplot2dScopeConfig->scatterplot2dType;
+    cloneObj->decimation = originalScatterplot2dScopeConfig->decimation;
 
     int scatterplotSourceCount = originalScatterplot2dScopeConfig->m_scatterplotSourceConfigs.size();
 
@@ -176,6 +180,7 @@ void Scatterplot2dScopeConfig::saveConfiguration(QSettings* qSettings)
     qSettings->setValue("timeHorizon", timeHorizon);
     qSettings->setValue("plot2dType", SCATTERPLOT2D);
     qSettings->setValue("scatterplot2dType", scatterplot2dType);
+    qSettings->setValue("decimation", decimation);
 
     int dataSourceCount = m_scatterplotSourceConfigs.size();
     qSettings->setValue("dataSourceCount", dataSourceCount);
@@ -236,9 +241,12 @@ void Scatterplot2dScopeConfig::loadConfiguration(ScopeGadgetWidget *scopeGadgetW
         case SERIES2D:
             scatterplotData = new SeriesPlotData(uavObjectName, uavFieldName);
             break;
-        case TIMESERIES2D:
-            scatterplotData = new TimeSeriesPlotData(uavObjectName, uavFieldName);
+        case TIMESERIES2D: {
+            TimeSeriesPlotData *timeSeriesData = new TimeSeriesPlotData(uavObjectName, uavFieldName);
+            timeSeriesData->setDecimationEnabled(decimation);
+            scatterplotData = timeSeriesData;
             break;
+            }
         }
 
         scatterplotData->setXWindowSize(timeHorizon);
@@ -292,15 +300,14 @@ void Scatterplot2dScopeConfig::loadConfiguration(ScopeGadgetWidget *scopeGadgetW
         //Create the curve plot
         QwtPlotCurve* plotCurve = new QwtPlotCurve(curveNameScaledMath);
         plotCurve->setPen(QPen(QBrush(QColor(color), Qt::SolidPattern), (qreal)1, Qt::SolidLine, Qt::SquareCap, Qt::BevelJoin));
-        plotCurve->setSamples(*(scatterplotData->getXData()), *(scatterplotData->getYData()));
-        plotCurve->attach(scopeGadgetWidget);
         scatterplotData->setCurve(plotCurve);
+        plotCurve->attach(scopeGadgetWidget);
 
         //Keep the curve details for later
         scopeGadgetWidget->insertDataSources(curveNameScaledMath, scatterplotData);
 
         // Connect the UAVO
-        scopeGadgetWidget->connectUAVO(obj);
+        scopeGadgetWidget->connectUAVO(obj, scatterplotData);
     }
     mutex.lock();
     scopeGadgetWidget->replot();
@@ -327,6 +334,7 @@ void Scatterplot2dScopeConfig::setGuiConfiguration(Ui::ScopeGadgetOptionsPage *o
     foreach (Plot2dCurveConfiguration* plotData, m_scatterplotSourceConfigs) {
         options_page->cmbXAxisScatterplot2d->setCurrentIndex(scatterplot2dType);
         options_page->spnDataSize->setValue(timeHorizon);
+        options_page->chkDecimation->setChecked(decimation);
 
         QString uavObjectName = plotData->uavObjectName;
         QString uavFieldName = plotData->uavFieldName;
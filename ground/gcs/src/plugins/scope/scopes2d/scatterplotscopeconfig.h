@@ -65,10 +65,12 @@ public:
     double getTimeHorizon(){return timeHorizon;}
     virtual QList<Plot2dCurveConfiguration*> getDataSourceConfigs(){return m_scatterplotSourceConfigs;}
     Scatterplot2dType getScatterplot2dType(){return scatterplot2dType;}
+    bool getDecimation(){return decimation;}
 
     //Setter functions
     void setTimeHorizon(double val){timeHorizon = val;}
     void setScatterplot2dType(Scatterplot2dType val){scatterplot2dType = val;}
+    void setDecimation(bool val){decimation = val;}
     virtual void setGuiConfiguration(Ui::ScopeGadgetOptionsPage *options_page);
 
     virtual ScopeConfig* cloneScope(ScopeConfig *Scatterplot2dScopeConfig);
@@ -80,6 +82,7 @@ public:
 private:
     Scatterplot2dType scatterplot2dType;
     double timeHorizon;
+    bool decimation; //Reduce time series to their min/max per pixel column
 
     QList<Plot2dCurveConfiguration*> m_scatterplotSourceConfigs;
 
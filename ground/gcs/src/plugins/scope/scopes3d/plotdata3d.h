@@ -47,8 +47,6 @@ public:
     ~Plot3dData();
 
     QVector<double>* zData;
-    QVector<double>* zDataHistory;
-    QVector<double>* timeDataHistory;
 
     void setZMinimum(double val){zMinimum=val;}
     void setZMaximum(double val){zMaximum=val;}
@@ -26,7 +26,9 @@
  */
 
 #include <QDebug>
+#include <qnumeric.h>
 #include <math.h>
+#include <string.h>
 
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjectmanager.h"
@@ -36,12 +38,123 @@
 
 #include "qwt/src/qwt.h"
 #include "qwt/src/qwt_color_map.h"
-#include "qwt/src/qwt_matrix_raster_data.h"
 #include "qwt/src/qwt_plot_spectrogram.h"
 #include "qwt/src/qwt_scale_draw.h"
 #include "qwt/src/qwt_scale_widget.h"
 
 
+/**
+ * @brief SpectrogramRasterData::SpectrogramRasterData
+ * @param numColumns Number of values in a row
+ */
+SpectrogramRasterData::SpectrogramRasterData(int numColumns) :
+    numColumns(numColumns > 0 ? numColumns : 1),
+    capacityRows(0),
+    firstRow(0),
+    numRows(0)
+{
+}
+
+
+/**
+ * @brief SpectrogramRasterData::reserveRows Grow the storage, to the next power
+ * of two, so that it holds at least \a rows rows
+ */
+void SpectrogramRasterData::reserveRows(int rows)
+{
+    int newCapacity = 1;
+    while (newCapacity < rows)
+        newCapacity <<= 1;
+    if (newCapacity <= capacityRows)
+        return;
+
+    // Unwrap the rows at the start of the new storage
+    QVector<double> newValues(newCapacity * numColumns);
+    for (int row = 0; row < numRows; row++)
+        for (int col = 0; col < numColumns; col++)
+            newValues[row * numColumns + col] = at(row, col);
+
+    values = newValues;
+    capacityRows = newCapacity;
+    firstRow = 0;
+}
+
+
+/**
+ * @brief SpectrogramRasterData::appendRow Add a row after the newest one
+ * @param row The values, missing ones are set to 0
+ */
+void SpectrogramRasterData::appendRow(const QVector<double> &row)
+{
+    if (numRows == capacityRows)
+        reserveRows(numRows + 1);
+
+    double *dst = values.data() + ((firstRow + numRows) & (capacityRows - 1)) * numColumns;
+    int n = qMin(row.size(), numColumns);
+    memcpy(dst, row.constData(), n * sizeof(double));
+    for (int col = n; col < numColumns; col++)
+        dst[col] = 0;
+
+    numRows++;
+}
+
+
+/**
+ * @brief SpectrogramRasterData::removeFirstRow Drop the oldest row
+ */
+void SpectrogramRasterData::removeFirstRow()
+{
+    if (numRows == 0)
+        return;
+
+    firstRow = (firstRow + 1) & (capacityRows - 1);
+    numRows--;
+}
+
+
+/**
+ * @brief SpectrogramRasterData::pixelHint Each value covers a rectangle of the
+ * X and Y intervals, that's the resolution at which the data is rendered
+ */
+QRectF SpectrogramRasterData::pixelHint(const QRectF &area) const
+{
+    Q_UNUSED(area);
+
+    const QwtInterval xInterval = interval(Qt::XAxis);
+    const QwtInterval yInterval = interval(Qt::YAxis);
+    if (numRows == 0 || !xInterval.isValid() || !yInterval.isValid())
+        return QRectF();
+
+    return QRectF(xInterval.minValue(), yInterval.minValue(),
+                  xInterval.width() / numColumns, yInterval.width() / numRows);
+}
+
+
+/**
+ * @brief SpectrogramRasterData::value Nearest neighbour lookup, the same as
+ * QwtMatrixRasterData does
+ */
+double SpectrogramRasterData::value(double x, double y) const
+{
+    const QwtInterval xInterval = interval(Qt::XAxis);
+    const QwtInterval yInterval = interval(Qt::YAxis);
+
+    if (numRows == 0 || !(xInterval.contains(x) && yInterval.contains(y)))
+        return qQNaN();
+
+    int row = int((y - yInterval.minValue()) / yInterval.width() * numRows);
+    int col = int((x - xInterval.minValue()) / xInterval.width() * numColumns);
+
+    // The maximum of the intervals is included, it maps to the last row/col
+    if (row >= numRows)
+        row = numRows - 1;
+    if (col >= numColumns)
+        col = numColumns - 1;
+
+    return at(row, col);
+}
+
+
 /**
  * @brief SpectrogramData
  * @param uavObject
@@ -60,10 +173,13 @@ SpectrogramData::SpectrogramData(QString uavObject, QString uavField, double sam
     this->windowWidth = windowWidth;
     autoscaleValueUpdated = 0;
 
-    // Create raster data
-    rasterData = new QwtMatrixRasterData();
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    Q_ASSERT(pm != NULL);
+    objManager = pm->getObject<UAVObjectManager>();
+    Q_ASSERT(objManager != NULL);
 
-    rasterData->setValueMatrix( *zDataHistory, windowWidth );
+    // Create raster data
+    rasterData = new SpectrogramRasterData(windowWidth);
 
     // Set the ranges for the plot
     resetAxisRanges();
@@ -108,11 +224,8 @@ void SpectrogramData::plotNewData(PlotData *plot3dData, ScopeConfig *scopeConfig
 
     removeStaleData();
 
-    // Check for new data
+    // Check for new data. The raster data is updated in place, so there is nothing to copy
     if (readAndResetUpdatedFlag() == true){
-        // Plot new data
-        rasterData->setValueMatrix(*zDataHistory, windowWidth);
-
         // Check autoscale. (For some reason, QwtSpectrogram doesn't support autoscale)
         if (zMaximum == 0){
             double newVal = readAndResetAutoscaleValue();
@@ -134,82 +247,70 @@ bool SpectrogramData::append(UAVObject* multiObj)
 {
     QDateTime NOW = QDateTime::currentDateTime(); //TODO: Upgrade this to show UAVO time and not system time
 
-    // Check to make sure it's the correct UAVO
-    if (uavObjectName == multiObj->getName()) {
-
-        // Only run on UAVOs that have multiple instances
-        if (multiObj->isSingleInstance())
-            return false;
-
-        //Instantiate object manager
-        UAVObjectManager *objManager;
-
-        ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-        Q_ASSERT(pm != NULL);
-        objManager = pm->getObject<UAVObjectManager>();
-        Q_ASSERT(objManager != NULL);
+    // Only run on UAVOs that have multiple instances
+    if (multiObj->isSingleInstance())
+        return false;
 
+    // Refresh the list of object instances only when instances were added
+    if (objManager->getNumInstances(multiObj->getObjID()) != instances.size())
+        instances = objManager->getObjectInstancesVector(multiObj->getObjID());
 
-        // Get list of object instances
-        QVector<UAVObject*> list = objManager->getObjectInstancesVector(multiObj->getName());
+    // Remove a row's worth of data.
+    unsigned int spectrogramWidth = instances.size();
 
-        // Remove a row's worth of data.
-        unsigned int spectrogramWidth = list.size();
-
-        // Check that there is a full window worth of data. While GCS is starting up, the size of
-        // multiple instance UAVOs is 1, so it's possible for spurious data to come in before
-        // the flight controller board has had time to initialize the UAVO size.
-        if (spectrogramWidth != windowWidth){
-            qDebug() << "Incomplete data set in" << multiObj->getName() << "." << uavFieldName <<  "spectrogram: " << spectrogramWidth << " samples provided, but expected " << windowWidth;
-            return false;
-        }
-
-        //Initialize vector where we will read out an entire row of multiple instance UAVO
-        QVector<double> values;
+    // Check that there is a full window worth of data. While GCS is starting up, the size of
+    // multiple instance UAVOs is 1, so it's possible for spurious data to come in before
+    // the flight controller board has had time to initialize the UAVO size.
+    if (spectrogramWidth != windowWidth){
+        qDebug() << "Incomplete data set in" << multiObj->getName() << "." << uavFieldName <<  "spectrogram: " << spectrogramWidth << " samples provided, but expected " << windowWidth;
+        return false;
+    }
 
-        timeDataHistory->append(NOW.toTime_t() + NOW.time().msec() / 1000.0);
-        UAVObjectField* multiField =  multiObj->getField(uavFieldName);
-        Q_ASSERT(multiField);
-        if (multiField ) {
+    //Read out an entire row of multiple instance UAVO
+    rowValues.resize(spectrogramWidth);
 
-            // Get the field of interest
-            foreach (UAVObject *obj, list) {
-                UAVObjectField* field =  obj->getField(uavFieldName);
+    // Get the field of interest
+    for (unsigned int i = 0; i < spectrogramWidth; i++) {
+        double currentValue = boundValue(instances.at(i));
 
-                double currentValue = valueAsDouble(obj, field, haveSubField, uavSubFieldName) * pow(10, scalePower);
+        double vecVal = currentValue;
+        //Normally some math would go here, modifying vecVal before appending it to values
+        // .
+        // .
+        // .
 
-                double vecVal = currentValue;
-                //Normally some math would go here, modifying vecVal before appending it to values
-                // .
-                // .
-                // .
 
+        // Second to last step, see if autoscale is turned on and if the value exceeds the maximum for the scope.
+        if ( zMaximum == 0 &&  vecVal > rasterData->interval(Qt::ZAxis).maxValue()){
+            // Change scope maximum and color depth
+            rasterData->setInterval(Qt::ZAxis, QwtInterval(0, vecVal) );
+            autoscaleValueUpdated = vecVal;
+        }
+        // Last step, assign value to vector
+        rowValues[i] = vecVal;
+    }
 
-                // Second to last step, see if autoscale is turned on and if the value exceeds the maximum for the scope.
-                if ( zMaximum == 0 &&  vecVal > rasterData->interval(Qt::ZAxis).maxValue()){
-                    // Change scope maximum and color depth
-                    rasterData->setInterval(Qt::ZAxis, QwtInterval(0, vecVal) );
-                    autoscaleValueUpdated = vecVal;
-                }
-                // Last step, assign value to vector
-                values += vecVal;
-            }
+    double time = NOW.toTime_t() + NOW.time().msec() / 1000.0;
+    while (!timeHistory.isEmpty() && time - timeHistory.first() > timeHorizon){
+        timeHistory.takeFirst();
+        rasterData->removeFirstRow();
+    }
 
-            while (timeDataHistory->back() - timeDataHistory->front() > timeHorizon){
-                timeDataHistory->pop_front();
-                zDataHistory->remove(0, fminl(spectrogramWidth, zDataHistory->size()));
-            }
+    appendRow(time, rowValues);
 
-            // Doublecheck that there are the right number of samples. This can occur if the "field" assert fails
-            if(values.size() == (int) windowWidth){
-                *zDataHistory << values;
-            }
+    return true;
+}
 
-            return true;
-        }
-    }
 
-    return false;
+/**
+ * @brief SpectrogramData::appendRow Add a row of values to the history
+ * @param time Time of the row
+ * @param values One value per column
+ */
+void SpectrogramData::appendRow(double time, const QVector<double> &values)
+{
+    timeHistory.append(time);
+    rasterData->appendRow(values);
 }
 
 
@@ -29,14 +29,49 @@
 #define SPECTROGRAMDATA_H
 
 #include "scopes3d/plotdata3d.h"
+#include "ringbuffer.h"
 #include "uavobject.h"
 #include "qwt/src/qwt_plot_spectrogram.h"
-#include "qwt/src/qwt_matrix_raster_data.h"
+#include "qwt/src/qwt_raster_data.h"
 
 #include <QTimer>
 #include <QTime>
 #include <QVector>
 
+class UAVObjectManager;
+
+
+/**
+ * @brief The SpectrogramRasterData class keeps the rows of the spectrogram in a
+ * circular buffer. Adding a row only writes that row and dropping the oldest one
+ * is O(1), instead of copying the whole matrix into a QwtMatrixRasterData. The
+ * rows are spread over the Y interval and sampled as nearest neighbours.
+ */
+class SpectrogramRasterData : public QwtRasterData
+{
+public:
+    SpectrogramRasterData(int numColumns);
+
+    int rowCount() const {return numRows;}
+    int columnCount() const {return numColumns;}
+
+    void appendRow(const QVector<double> &row);
+    void removeFirstRow();
+
+    virtual QRectF pixelHint(const QRectF &area) const;
+    virtual double value(double x, double y) const;
+
+private:
+    double at(int row, int col) const {return values.at(((firstRow + row) & (capacityRows - 1)) * numColumns + col);}
+    void reserveRows(int rows);
+
+    QVector<double> values;
+    int numColumns;
+    int capacityRows;
+    int firstRow;
+    int numRows;
+};
+
 
 /**
  * @brief The SpectrogramData class The spectrogram plot has a fixed size
@@ -71,14 +106,22 @@ public:
     virtual void setYMaximum(double val);
     virtual void setZMaximum(double val);
 
-    QwtMatrixRasterData *getRasterData(){return rasterData;}
+    SpectrogramRasterData *getRasterData(){return rasterData;}
     void setSpectrogram(QwtPlotSpectrogram *val){spectrogram = val;}
 
+    void appendRow(double time, const QVector<double> &values);
+
 private:
     void resetAxisRanges();
 
     QwtPlotSpectrogram *spectrogram;
-    QwtMatrixRasterData *rasterData;
+    SpectrogramRasterData *rasterData;
+    RingBuffer<double> timeHistory;
+
+    // Instances of the plotted object, refreshed when their number changes
+    UAVObjectManager *objManager;
+    QVector<UAVObject*> instances;
+    QVector<double> rowValues;
 
     double samplingFrequency;
     double timeHorizon;
@@ -266,13 +266,11 @@ void SpectrogramScopeConfig::loadConfiguration(ScopeGadgetWidget *scopeGadgetWid
     // Initial raster data
 
     QDateTime NOW = QDateTime::currentDateTime(); //TODO: Upgrade this to show UAVO time and not system time
-    for ( uint i = 0; i < timeHorizon; i++ ){
-        spectrogramData->timeDataHistory->append(NOW.toTime_t() + NOW.time().msec() / 1000.0 + i);
-    }
 
-    if (((double) windowWidth) * timeHorizon < (double) 10000000.0 * sizeof(spectrogramData->zDataHistory->front())){ //Don't exceed 10MB for memory
-        for ( uint i = 0; i < windowWidth*timeHorizon; i++ ){
-            spectrogramData->zDataHistory->append(0);
+    if (((double) windowWidth) * timeHorizon < (double) 10000000.0 * sizeof(double)){ //Don't exceed 10MB for memory
+        QVector<double> zeros(windowWidth, 0);
+        for ( uint i = 0; i < timeHorizon; i++ ){
+            spectrogramData->appendRow(NOW.toTime_t() + NOW.time().msec() / 1000.0 + i, zeros);
         }
     }
     else{
@@ -298,7 +296,7 @@ void SpectrogramScopeConfig::loadConfiguration(ScopeGadgetWidget *scopeGadgetWid
     scopeGadgetWidget->insertDataSources(waterfallNameScaled, spectrogramData);
 
     // Connect the UAVO
-    scopeGadgetWidget->connectUAVO(obj);
+    scopeGadgetWidget->connectUAVO(obj, spectrogramData);
 
     mutex.lock();
     scopeGadgetWidget->replot();
@@ -0,0 +1,18 @@
+# -------------------------------------------------
+# Test of the scope min/max decimation and benchmark of the curve
+# repaint, built against the Qwt library of a configured GCS tree
+# -------------------------------------------------
+QT += testlib
+TARGET = decimator
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+include(../../../../../gcs.pri)
+
+INCLUDEPATH *= ../.. $$GCS_SOURCE_TREE/src/libs/qwt/src
+include(../../../../libs/qwt/qwt.pri)
+
+SOURCES += tst_decimator.cpp
+HEADERS += ../../decimator.h \
+    ../../ringbuffer.h
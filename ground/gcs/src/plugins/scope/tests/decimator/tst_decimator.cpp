@@ -0,0 +1,265 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_decimator.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      Min/max decimation of the scope curves and its repaint time
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "decimator.h"
+
+#include "qwt_plot_curve.h"
+#include "qwt_scale_map.h"
+#include "qwt_series_data.h"
+
+#include <QtCore/QObject>
+#include <QtGui/QImage>
+#include <QtGui/QPainter>
+#include <QtTest/QtTest>
+
+/**
+ * The curve reads the decimated points in place, as ScatterplotSeries does
+ * for the scope
+ */
+class DecimatedSeries : public QwtSeriesData<QPointF>
+{
+public:
+    DecimatedSeries(const MinMaxDecimator *decimator) : decimator(decimator) { d_boundingRect = QRectF(0.0, 0.0, -1.0, -1.0); }
+
+    virtual size_t size() const { return decimator->size(); }
+    virtual QPointF sample(size_t i) const { return decimator->at(i); }
+    virtual QRectF boundingRect() const
+    {
+        if (d_boundingRect.width() < 0.0)
+            d_boundingRect = qwtBoundingRect(*this);
+        return d_boundingRect;
+    }
+
+private:
+    const MinMaxDecimator *decimator;
+};
+
+class tst_Decimator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void keepsColumnExtremes_data();
+    void keepsColumnExtremes();
+    void removeBefore();
+    void repaint_data();
+    void repaint();
+
+private:
+    enum Pattern { NOISE, SINE, CONSTANT };
+
+    // A 1000 px wide plot of a 2000 s window of a 500 Hz signal
+    static const int WIDTH = 1000;
+    static const int HEIGHT = 300;
+    static const int WINDOW_SAMPLES = 1000000;
+    static const int RATE = 500;
+
+    static double sample(int pattern, quint32 &seed, int i);
+    static QVector<QPointF> columnExtremes(const QVector<QPointF> &samples, double width);
+};
+
+double tst_Decimator::sample(int pattern, quint32 &seed, int i)
+{
+    seed = seed * 1103515245 + 12345;
+    double noise = (double)((seed >> 8) % 1000) - 500;
+
+    switch (pattern) {
+    case NOISE:
+        return noise;
+    case SINE:
+        return 100 * sin(i * 0.01) + noise / 50;
+    default:
+        return 1;
+    }
+}
+
+/**
+ * The points the decimation must keep, found from scratch: the first
+ * minimum and the first maximum of each column, in x order, or only one
+ * of them if they are the same sample
+ */
+QVector<QPointF> tst_Decimator::columnExtremes(const QVector<QPointF> &samples, double width)
+{
+    QVector<QPointF> points;
+    int first = 0;
+    while (first < samples.size()) {
+        double column = floor(samples[first].x() / width);
+        int end = first;
+        int min = first;
+        int max = first;
+        while (end < samples.size() && floor(samples[end].x() / width) == column) {
+            if (samples[end].y() < samples[min].y())
+                min = end;
+            if (samples[end].y() > samples[max].y())
+                max = end;
+            end++;
+        }
+
+        points.append(samples[qMin(min, max)]);
+        if (min != max)
+            points.append(samples[qMax(min, max)]);
+        first = end;
+    }
+    return points;
+}
+
+void tst_Decimator::keepsColumnExtremes_data()
+{
+    QTest::addColumn<double>("width");
+    QTest::addColumn<int>("pattern");
+
+    // The x values are multiples of 1/4, so the columns are exact
+    QTest::newRow("noise, 1/4 sample per column") << 0.0625 << (int)NOISE;
+    QTest::newRow("noise, 1 sample per column") << 0.25 << (int)NOISE;
+    QTest::newRow("noise, 8 samples per column") << 2.0 << (int)NOISE;
+    QTest::newRow("noise, 1000 samples per column") << 250.0 << (int)NOISE;
+    QTest::newRow("sine, 8 samples per column") << 2.0 << (int)SINE;
+    QTest::newRow("constant, 8 samples per column") << 2.0 << (int)CONSTANT;
+}
+
+/**
+ * Every column of the decimated curve holds exactly the minimum and the
+ * maximum of the samples in it, whether it is closed or still open
+ */
+void tst_Decimator::keepsColumnExtremes()
+{
+    QFETCH(double, width);
+    QFETCH(int, pattern);
+
+    MinMaxDecimator decimator;
+    decimator.setColumnWidth(width);
+    QVector<QPointF> samples;
+    quint32 seed = 1;
+
+    for (int i = 0; i < 10007; i++) {
+        samples.append(QPointF(i * 0.25, sample(pattern, seed, i)));
+        decimator.append(samples.last().x(), samples.last().y());
+
+        // Check the open column now and then, and everything at the end
+        if (i % 997 != 0 && i != 10006)
+            continue;
+
+        QVector<QPointF> expected = columnExtremes(samples, width);
+        QCOMPARE(decimator.size(), expected.size());
+        for (int j = 0; j < expected.size(); j++) {
+            QVERIFY2(decimator.at(j) == expected[j],
+                     qPrintable(QString("sample %1, point %2: (%3, %4), expected (%5, %6)").arg(i).arg(j)
+                                .arg(decimator.at(j).x()).arg(decimator.at(j).y())
+                                .arg(expected[j].x()).arg(expected[j].y())));
+        }
+    }
+
+    // Never more than two points per column
+    QVERIFY(decimator.size() <= 2 * (int)ceil(samples.last().x() / width + 1));
+    if (pattern == CONSTANT)
+        QCOMPARE(decimator.size(), (int)ceil((samples.last().x() + 0.25) / width));
+}
+
+void tst_Decimator::removeBefore()
+{
+    MinMaxDecimator decimator;
+    decimator.setColumnWidth(1.0);
+    for (int i = 0; i < 100; i++)
+        decimator.append(i * 0.25, i % 3);
+
+    decimator.removeBefore(10.0);
+    QVERIFY(decimator.size() > 0);
+    QVERIFY(decimator.at(0).x() >= 10.0);
+    QVERIFY(decimator.at(0).x() < 11.0);
+    for (int i = 1; i < decimator.size(); i++)
+        QVERIFY(decimator.at(i).x() > decimator.at(i - 1).x());
+
+    decimator.clear();
+    QCOMPARE(decimator.size(), 0);
+}
+
+void tst_Decimator::repaint_data()
+{
+    QTest::addColumn<bool>("decimated");
+
+    QTest::newRow("all samples") << false;
+    QTest::newRow("decimated") << true;
+}
+
+/**
+ * Draw a curve of WINDOW_SAMPLES samples of noise over a sine, as a gyro
+ * seen over a long time window, with and without the decimation
+ */
+void tst_Decimator::repaint()
+{
+    QFETCH(bool, decimated);
+
+    double span = (double)WINDOW_SAMPLES / RATE;
+    MinMaxDecimator decimator;
+    decimator.setColumnWidth(span / WIDTH);
+    QVector<QPointF> samples;
+    samples.reserve(WINDOW_SAMPLES);
+    quint32 seed = 1;
+    for (int i = 0; i < WINDOW_SAMPLES; i++) {
+        QPointF point((double)i / RATE, sample(SINE, seed, i));
+        if (decimated)
+            decimator.append(point.x(), point.y());
+        else
+            samples.append(point);
+    }
+
+    QwtPlotCurve curve;
+    if (decimated) {
+        curve.setSamples(new DecimatedSeries(&decimator));
+        QVERIFY(curve.dataSize() <= 2 * (WIDTH + 1));
+    } else {
+        curve.setSamples(samples);
+        QCOMPARE((int)curve.dataSize(), WINDOW_SAMPLES);
+    }
+    qDebug("%d samples drawn as %d points", WINDOW_SAMPLES, (int)curve.dataSize());
+
+    QImage image(WIDTH, HEIGHT, QImage::Format_ARGB32_Premultiplied);
+    QwtScaleMap xMap;
+    xMap.setScaleInterval(0, span);
+    xMap.setPaintInterval(0, WIDTH);
+    QwtScaleMap yMap;
+    yMap.setScaleInterval(-120, 120);
+    yMap.setPaintInterval(HEIGHT, 0);
+    QRectF canvasRect(0, 0, WIDTH, HEIGHT);
+
+    QBENCHMARK {
+        image.fill(Qt::white);
+        QPainter painter(&image);
+        curve.draw(&painter, xMap, yMap, canvasRect);
+    }
+}
+
+QTEST_MAIN(tst_Decimator)
+
+#include "tst_decimator.moc"
+
+/**
+ * @}
+ * @}
+ */
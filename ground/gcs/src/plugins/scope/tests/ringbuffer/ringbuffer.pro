@@ -0,0 +1,14 @@
+# -------------------------------------------------
+# Test of the scope sample ring buffer and window statistics
+# -------------------------------------------------
+QT -= gui
+QT += testlib
+TARGET = ringbuffer
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+INCLUDEPATH *= ../..
+
+SOURCES += tst_ringbuffer.cpp
+HEADERS += ../../ringbuffer.h
@@ -0,0 +1,233 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_ringbuffer.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      Ring buffer and running window statistics of the scope
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "ringbuffer.h"
+
+#include <QtCore/QObject>
+#include <QtTest/QtTest>
+
+class tst_RingBuffer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void wrapsInPlace();
+    void growsWhenFull();
+    void statistics_data();
+    void statistics();
+    void shrinkWindow();
+
+private:
+    enum Pattern { RAMP, OFFSET_NOISE, WIDE_NOISE };
+
+    static double sample(int pattern, quint32 &seed, int i);
+    static void direct(const QVector<double> &all, int window, double &mean, double &stdDev);
+    static bool near(double value, double expected);
+};
+
+/**
+ * Test signals. The noise on a large offset is what makes the running sums
+ * lose precision.
+ */
+double tst_RingBuffer::sample(int pattern, quint32 &seed, int i)
+{
+    seed = seed * 1103515245 + 12345;
+    double noise = (double)((seed >> 8) % 100000) / 100000.0;
+
+    switch (pattern) {
+    case RAMP:
+        return i;
+    case OFFSET_NOISE:
+        return 1e6 + 10 * noise;
+    default:
+        return 1e4 * (noise - 0.5);
+    }
+}
+
+/**
+ * Mean and sample standard deviation of the last \a window samples of
+ * \a all, computed from scratch
+ */
+void tst_RingBuffer::direct(const QVector<double> &all, int window, double &mean, double &stdDev)
+{
+    int n = qMin(all.size(), window);
+    int first = all.size() - n;
+
+    double sum = 0;
+    for (int i = first; i < all.size(); i++)
+        sum += all[i];
+    mean = sum / n;
+
+    double m2 = 0;
+    for (int i = first; i < all.size(); i++)
+        m2 += (all[i] - mean) * (all[i] - mean);
+    stdDev = n < 2 ? 0 : sqrt(m2 / (n - 1));
+}
+
+bool tst_RingBuffer::near(double value, double expected)
+{
+    return fabs(value - expected) <= 1e-9 * qMax(1.0, fabs(expected));
+}
+
+/**
+ * Removing from the front and appending at the back wraps around the
+ * storage without growing it
+ */
+void tst_RingBuffer::wrapsInPlace()
+{
+    RingBuffer<int> buffer(8);
+    QCOMPARE(buffer.capacity(), 8);
+
+    int next = 0;
+    int expected = 0;
+    for (int round = 0; round < 20; round++) {
+        while (buffer.size() < 8)
+            buffer.append(next++);
+        for (int i = 0; i < 3; i++)
+            QCOMPARE(buffer.takeFirst(), expected++);
+
+        QCOMPARE(buffer.capacity(), 8);
+        QCOMPARE(buffer.size(), 5);
+        for (int i = 0; i < buffer.size(); i++)
+            QCOMPARE(buffer.at(i), expected + i);
+        QCOMPARE(buffer.first(), expected);
+        QCOMPARE(buffer.last(), next - 1);
+    }
+}
+
+/**
+ * A full buffer which has wrapped grows to the next power of two and keeps
+ * the samples in order
+ */
+void tst_RingBuffer::growsWhenFull()
+{
+    RingBuffer<int> buffer(4);
+    for (int i = 0; i < 4; i++)
+        buffer.append(i);
+    buffer.takeFirst();
+    buffer.takeFirst();
+    for (int i = 4; i < 6; i++)
+        buffer.append(i);
+    QCOMPARE(buffer.capacity(), 4);
+
+    buffer.append(6);
+    QCOMPARE(buffer.capacity(), 8);
+    QCOMPARE(buffer.size(), 5);
+    for (int i = 0; i < buffer.size(); i++)
+        QCOMPARE(buffer.at(i), i + 2);
+
+    buffer.clear();
+    QVERIFY(buffer.isEmpty());
+    QCOMPARE(buffer.capacity(), 8);
+}
+
+void tst_RingBuffer::statistics_data()
+{
+    QTest::addColumn<int>("window");
+    QTest::addColumn<int>("pattern");
+
+    int windows[] = { 1, 2, 10, 100, 1000 };
+    for (unsigned int i = 0; i < sizeof(windows) / sizeof(windows[0]); i++) {
+        QByteArray name = QByteArray::number(windows[i]);
+        QTest::newRow(name + " ramp") << windows[i] << (int)RAMP;
+        QTest::newRow(name + " offset noise") << windows[i] << (int)OFFSET_NOISE;
+        QTest::newRow(name + " wide noise") << windows[i] << (int)WIDE_NOISE;
+    }
+}
+
+/**
+ * The running statistics match a direct computation over the window after
+ * every sample, while the window fills and after it has wrapped many times
+ */
+void tst_RingBuffer::statistics()
+{
+    QFETCH(int, window);
+    QFETCH(int, pattern);
+
+    WindowStatistics stats;
+    stats.setWindow(window);
+    QVector<double> all;
+    quint32 seed = 1;
+
+    for (int i = 0; i < 10 * window + 7; i++) {
+        double value = sample(pattern, seed, i);
+        stats.append(value);
+        all.append(value);
+
+        double mean, stdDev;
+        direct(all, window, mean, stdDev);
+        QVERIFY2(near(stats.mean(), mean),
+                 qPrintable(QString("sample %1: mean %2, expected %3").arg(i).arg(stats.mean(), 0, 'g', 17).arg(mean, 0, 'g', 17)));
+        QVERIFY2(near(stats.standardDeviation(), stdDev),
+                 qPrintable(QString("sample %1: deviation %2, expected %3").arg(i).arg(stats.standardDeviation(), 0, 'g', 17).arg(stdDev, 0, 'g', 17)));
+    }
+
+    stats.clear();
+    QCOMPARE(stats.mean(), 0.0);
+    QCOMPARE(stats.standardDeviation(), 0.0);
+}
+
+/**
+ * Shrinking the window drops the oldest samples from the statistics
+ */
+void tst_RingBuffer::shrinkWindow()
+{
+    WindowStatistics stats;
+    stats.setWindow(100);
+    QVector<double> all;
+    quint32 seed = 7;
+
+    for (int i = 0; i < 250; i++) {
+        all.append(sample(WIDE_NOISE, seed, i));
+        stats.append(all.last());
+    }
+
+    stats.setWindow(10);
+    double mean, stdDev;
+    direct(all, 10, mean, stdDev);
+    QVERIFY(near(stats.mean(), mean));
+    QVERIFY(near(stats.standardDeviation(), stdDev));
+
+    for (int i = 0; i < 25; i++) {
+        all.append(sample(WIDE_NOISE, seed, i));
+        stats.append(all.last());
+        direct(all, 10, mean, stdDev);
+        QVERIFY(near(stats.mean(), mean));
+        QVERIFY(near(stats.standardDeviation(), stdDev));
+    }
+}
+
+QTEST_MAIN(tst_RingBuffer)
+
+#include "tst_ringbuffer.moc"
+
+/**
+ * @}
+ * @}
+ */
@@ -30,6 +30,7 @@
 #include "utils/stylehelper.h"
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjectmanager.h"
+#include "uavobjectupdatedispatcher.h"
 #include "systemalarms.h"
 #include <coreplugin/icore.h>
 #include <QDebug>
@@ -57,7 +58,8 @@ SystemHealthGadgetWidget::SystemHealthGadgetWidget(QWidget *parent) : QGraphicsV
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
 
     SystemAlarms* obj = SystemAlarms::GetInstance(objManager);
-    connect(obj, SIGNAL(objectUpdated(UAVObject*)), this, SLOT(updateAlarms(UAVObject*)));
+    UAVObjectUpdateDispatcher *updateDispatcher = pm->getObject<UAVObjectUpdateDispatcher>();
+    updateDispatcher->connectObject(obj, this, SLOT(updateAlarms(UAVObject*)));
 
     // Listen to autopilot connection events
     TelemetryManager* telMngr = pm->getObject<TelemetryManager>();
@@ -32,6 +32,7 @@
 #include "uavdataobject.h"
 #include "uavmetaobject.h"
 #include "uavobjectfield.h"
+#include "uavobjectupdatedispatcher.h"
 #include "extensionsystem/pluginmanager.h"
 #include <QColor>
 //#include <QIcon>
@@ -59,6 +60,7 @@ UAVObjectTreeModel::UAVObjectTreeModel(QObject *parent, bool useScientificNotati
 {
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     objManager = pm->getObject<UAVObjectManager>();
+    updateDispatcher = pm->getObject<UAVObjectUpdateDispatcher>();
 
     m_currentTime = QTime::currentTime();
     // Create timer that sets the rhythm for all highlight events.
@@ -153,6 +155,7 @@ void UAVObjectTreeModel::instanceRemove(UAVObject *obj)
             InstanceTreeItem *inst = dynamic_cast<InstanceTreeItem*>(item);
             if(inst && inst->object() == obj)
             {
+                updateDispatcher->disconnectObject(obj, this);
                 inst->parent()->removeChild(inst);
                 inst->deleteLater();
             }
@@ -210,7 +213,7 @@ TreeItem* UAVObjectTreeModel::createCategoryItems(QStringList categoryPath, Tree
 
 MetaObjectTreeItem* UAVObjectTreeModel::addMetaObject(UAVMetaObject *obj, TreeItem *parent)
 {
-    connect(obj, SIGNAL(objectUpdated(UAVObject*)), this, SLOT(highlightUpdatedObject(UAVObject*)));
+    updateDispatcher->connectObject(obj, this, SLOT(highlightUpdatedObject(UAVObject*)));
     MetaObjectTreeItem *meta = new MetaObjectTreeItem(obj, tr("Meta Data"));
 
     meta->setHighlightManager(m_highlightManager);
@@ -228,7 +231,7 @@ MetaObjectTreeItem* UAVObjectTreeModel::addMetaObject(UAVMetaObject *obj, TreeIt
 
 void UAVObjectTreeModel::addInstance(UAVObject *obj, TreeItem *parent)
 {
-    connect(obj, SIGNAL(objectUpdated(UAVObject*)), this, SLOT(highlightUpdatedObject(UAVObject*)));
+    updateDispatcher->connectObject(obj, this, SLOT(highlightUpdatedObject(UAVObject*)));
     TreeItem *item;
     DataObjectTreeItem *p = static_cast<DataObjectTreeItem*>(parent);
     if (obj->isSingleInstance()) {
@@ -43,6 +43,7 @@ class UAVDataObject;
 class UAVMetaObject;
 class UAVObjectField;
 class UAVObjectManager;
+class UAVObjectUpdateDispatcher;
 class QSignalMapper;
 class QTimer;
 
@@ -125,6 +126,7 @@ private:
     QTimer m_currentTimeTimer;
     QTime m_currentTime;
     UAVObjectManager *objManager;
+    UAVObjectUpdateDispatcher *updateDispatcher;
     // Highlight manager to handle highlighting of tree items.
     HighLightManager *m_highlightManager;
     QMutex mutex;
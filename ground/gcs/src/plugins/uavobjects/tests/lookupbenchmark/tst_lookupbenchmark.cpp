@@ -0,0 +1,181 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_lookupbenchmark.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      Indexed object lookups against a scan of every object
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+
+#include <QtCore/QObject>
+#include <QtCore/QElapsedTimer>
+#include <QtTest/QtTest>
+
+class tst_LookupBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void lookupsMatchScan();
+    void lookup_data();
+    void lookup();
+
+private:
+    enum Lookup { NAME_INDEX, NAME_SCAN, ID_INDEX, ID_SCAN };
+
+    // Lookups of each run, as the scope and the PFD do between two repaints
+    static const int LOOKUPS = 10000;
+
+    UAVObjectManager *objMngr;
+    QHash<quint32, QMap<quint32, UAVObject*> > objects;
+    QMutex scanMutex;
+    QStringList names;
+    QList<quint32> ids;
+
+    UAVObject *scanName(const QString &name, quint32 instId = 0);
+    UAVObject *scanId(quint32 objId, quint32 instId = 0);
+};
+
+void tst_LookupBenchmark::initTestCase()
+{
+    objMngr = new UAVObjectManager();
+    UAVObjectsInitialize(objMngr);
+
+    objects = objMngr->getObjects();
+    foreach (QVector<UAVObject*> instances, objMngr->getObjectsVector()) {
+        names.append(instances.first()->getName());
+        ids.append(instances.first()->getObjID());
+    }
+    QVERIFY(!names.isEmpty());
+}
+
+void tst_LookupBenchmark::cleanupTestCase()
+{
+    delete objMngr;
+}
+
+/**
+ * The name lookup before the index, a walk over every object type
+ */
+UAVObject *tst_LookupBenchmark::scanName(const QString &name, quint32 instId)
+{
+    QMutexLocker locker(&scanMutex);
+    foreach (const UAVObjectManager::ObjectMap &map, objects) {
+        if (map.first()->getName().compare(name) == 0)
+            return map.value(instId, NULL);
+    }
+    return NULL;
+}
+
+/**
+ * The ID lookup before constFind(), contains() followed by value()
+ */
+UAVObject *tst_LookupBenchmark::scanId(quint32 objId, quint32 instId)
+{
+    QMutexLocker locker(&scanMutex);
+    if (objects.contains(objId))
+        return objects.value(objId).value(instId);
+    return NULL;
+}
+
+void tst_LookupBenchmark::lookupsMatchScan()
+{
+    for (int i = 0; i < names.size(); ++i) {
+        UAVObject *obj = scanName(names[i]);
+        QVERIFY2(obj != NULL, qPrintable(names[i]));
+        QVERIFY2(objMngr->getObject(names[i]) == obj, qPrintable(names[i]));
+        QVERIFY2(objMngr->getObject(ids[i]) == scanId(ids[i]), qPrintable(names[i]));
+        QCOMPARE(objMngr->getObjectID(names[i]), ids[i]);
+        QCOMPARE(objMngr->getNumInstances(names[i]), objMngr->getNumInstances(ids[i]));
+    }
+
+    // Names are case sensitive, unknown ones are not found
+    QVERIFY(objMngr->getObject(names.first().toLower()) == scanName(names.first().toLower()));
+    QVERIFY(objMngr->getObject(QString("NoSuchObject")) == NULL);
+    QCOMPARE(objMngr->getNumInstances(QString("NoSuchObject")), 0);
+}
+
+void tst_LookupBenchmark::lookup_data()
+{
+    QTest::addColumn<int>("lookup");
+
+    QTest::newRow("name, index") << (int)NAME_INDEX;
+    QTest::newRow("name, scan") << (int)NAME_SCAN;
+    QTest::newRow("id, index") << (int)ID_INDEX;
+    QTest::newRow("id, scan") << (int)ID_SCAN;
+}
+
+/**
+ * Look up LOOKUPS objects, cycling through all of them, and print the
+ * lookups per second
+ */
+void tst_LookupBenchmark::lookup()
+{
+    QFETCH(int, lookup);
+
+    QElapsedTimer timer;
+    qint64 runs = 0;
+    int found = 0;
+    timer.start();
+    QBENCHMARK {
+        for (int i = 0; i < LOOKUPS; ++i) {
+            int n = i % names.size();
+            UAVObject *obj = NULL;
+            switch (lookup) {
+            case NAME_INDEX:
+                obj = objMngr->getObject(names[n]);
+                break;
+            case NAME_SCAN:
+                obj = scanName(names[n]);
+                break;
+            case ID_INDEX:
+                obj = objMngr->getObject(ids[n]);
+                break;
+            case ID_SCAN:
+                obj = scanId(ids[n]);
+                break;
+            }
+            if (obj != NULL)
+                ++found;
+        }
+        ++runs;
+    }
+    qint64 elapsed = timer.nsecsElapsed();
+
+    QCOMPARE((qint64)found, runs * LOOKUPS);
+    qDebug("%d objects: %.0f lookups/s", names.size(), (double)LOOKUPS * runs * 1e9 / elapsed);
+}
+
+QTEST_MAIN(tst_LookupBenchmark)
+
+#include "tst_lookupbenchmark.moc"
+
+/**
+ * @}
+ * @}
+ */
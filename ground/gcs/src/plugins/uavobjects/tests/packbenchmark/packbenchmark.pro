@@ -0,0 +1,31 @@
+# -------------------------------------------------
+# Benchmark of the generated UAVObject pack/unpack against the
+# per field path, built against the objects of a configured GCS tree
+# -------------------------------------------------
+QT -= gui
+QT += testlib
+TARGET = packbenchmark
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+include(../../../../../gcs.pri)
+
+UAVOBJECT_SYNTHETICS=$${GCS_BUILD_TREE}/../../uavobject-synthetics/gcs
+INCLUDEPATH *= ../.. $$UAVOBJECT_SYNTHETICS
+DEFINES += UAVOBJECTS_LIBRARY
+
+SOURCES += tst_packbenchmark.cpp \
+    ../../uavobject.cpp \
+    ../../uavmetaobject.cpp \
+    ../../uavobjectmanager.cpp \
+    ../../uavdataobject.cpp \
+    ../../uavobjectfield.cpp
+HEADERS += ../../uavobject.h \
+    ../../uavmetaobject.h \
+    ../../uavobjectmanager.h \
+    ../../uavdataobject.h \
+    ../../uavobjectfield.h
+
+HEADERS += $$files($$UAVOBJECT_SYNTHETICS/*.h)
+SOURCES += $$files($$UAVOBJECT_SYNTHETICS/*.cpp)
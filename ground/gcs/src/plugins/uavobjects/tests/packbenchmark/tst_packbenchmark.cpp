@@ -0,0 +1,186 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_packbenchmark.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      Generated pack/unpack of every object against the per field path
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+
+#include <QtCore/QObject>
+#include <QtCore/QElapsedTimer>
+#include <QtTest/QtTest>
+
+class tst_PackBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void unpackMatchesFields();
+    void packMatchesFields();
+    void unpackAllObjects();
+
+private:
+    static const int ITERATIONS = 1000000;
+
+    UAVObjectManager *objMngr;
+    QList<UAVDataObject*> objects;
+
+    static void fill(QByteArray &buf, quint32 seed);
+    static void packFields(UAVObject *obj, quint8 *dataOut);
+    static void unpackFields(UAVObject *obj, const quint8 *dataIn);
+};
+
+void tst_PackBenchmark::initTestCase()
+{
+    objMngr = new UAVObjectManager();
+    UAVObjectsInitialize(objMngr);
+
+    foreach (QVector<UAVDataObject*> instances, objMngr->getDataObjectsVector()) {
+        objects.append(instances.first());
+    }
+    QVERIFY(!objects.isEmpty());
+}
+
+void tst_PackBenchmark::cleanupTestCase()
+{
+    delete objMngr;
+}
+
+/**
+ * Fill a buffer with a pattern which differs between objects and bytes
+ */
+void tst_PackBenchmark::fill(QByteArray &buf, quint32 seed)
+{
+    for (int i = 0; i < buf.size(); ++i)
+        buf[i] = (char)((seed * 131 + i * 37) >> 1);
+}
+
+/**
+ * The path pack() took before it was generated, one field at a time
+ */
+void tst_PackBenchmark::packFields(UAVObject *obj, quint8 *dataOut)
+{
+    QMutexLocker locker(obj->getMutex());
+    quint32 offset = 0;
+    foreach (UAVObjectField *field, obj->getFields()) {
+        field->pack(&dataOut[offset]);
+        offset += field->getNumBytes();
+    }
+}
+
+/**
+ * The path unpack() took before it was generated, one field at a time
+ */
+void tst_PackBenchmark::unpackFields(UAVObject *obj, const quint8 *dataIn)
+{
+    QMutexLocker locker(obj->getMutex());
+    quint32 offset = 0;
+    foreach (UAVObjectField *field, obj->getFields()) {
+        field->unpack(&dataIn[offset]);
+        offset += field->getNumBytes();
+    }
+}
+
+void tst_PackBenchmark::unpackMatchesFields()
+{
+    foreach (UAVDataObject *obj, objects) {
+        QByteArray in(obj->getNumBytes(), 0);
+        QByteArray out(obj->getNumBytes(), 0);
+        fill(in, obj->getObjID());
+
+        obj->blockSignals(true);
+        QCOMPARE(obj->unpack((const quint8 *)in.constData()), (qint32)obj->getNumBytes());
+        obj->blockSignals(false);
+        packFields(obj, (quint8 *)out.data());
+
+        QVERIFY2(in == out, qPrintable(obj->getName()));
+    }
+}
+
+void tst_PackBenchmark::packMatchesFields()
+{
+    foreach (UAVDataObject *obj, objects) {
+        QByteArray in(obj->getNumBytes(), 0);
+        QByteArray out(obj->getNumBytes(), 0);
+        fill(in, ~obj->getObjID());
+
+        unpackFields(obj, (const quint8 *)in.constData());
+        QCOMPARE(obj->pack((quint8 *)out.data()), (qint32)obj->getNumBytes());
+
+        QVERIFY2(in == out, qPrintable(obj->getName()));
+    }
+}
+
+/**
+ * Unpack every object ITERATIONS times through both paths. The signals are
+ * blocked so that only the unpacking is measured, not the connected slots.
+ */
+void tst_PackBenchmark::unpackAllObjects()
+{
+    QElapsedTimer timer;
+    qint64 totalGenerated = 0;
+    qint64 totalFields = 0;
+
+    foreach (UAVDataObject *obj, objects) {
+        QByteArray buf(obj->getNumBytes(), 0);
+        fill(buf, obj->getObjID());
+        const quint8 *dataIn = (const quint8 *)buf.constData();
+
+        obj->blockSignals(true);
+        timer.start();
+        for (int i = 0; i < ITERATIONS; ++i)
+            obj->unpack(dataIn);
+        qint64 generated = timer.nsecsElapsed();
+        obj->blockSignals(false);
+
+        timer.start();
+        for (int i = 0; i < ITERATIONS; ++i)
+            unpackFields(obj, dataIn);
+        qint64 fields = timer.nsecsElapsed();
+
+        qDebug("%-32s %4u bytes %3d fields: generated %6.1f ns, per field %7.1f ns",
+               qPrintable(obj->getName()), obj->getNumBytes(), obj->getNumFields(),
+               (double)generated / ITERATIONS, (double)fields / ITERATIONS);
+
+        totalGenerated += generated;
+        totalFields += fields;
+    }
+
+    qDebug("%d objects unpacked %d times: generated %.2f s, per field %.2f s",
+           objects.size(), ITERATIONS, totalGenerated / 1e9, totalFields / 1e9);
+}
+
+QTEST_MAIN(tst_PackBenchmark)
+
+#include "tst_packbenchmark.moc"
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,220 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_updatedispatcher.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      Coalescing of the object updates delivered to the user interface
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavobject.h"
+#include "uavobjectupdatedispatcher.h"
+
+#include <QtCore/QObject>
+#include <QtTest/QtTest>
+
+/**
+ * Object without fields, only its updates matter here
+ */
+class TestObject : public UAVObject
+{
+    Q_OBJECT
+
+public:
+    TestObject(quint32 objID): UAVObject(objID, true, QString("TestObject%1").arg(objID)) {}
+
+    void setMetadata(const Metadata& mdata) { metadata = mdata; }
+    Metadata getMetadata() { return metadata; }
+    Metadata getDefaultMetadata() { return Metadata(); }
+
+private:
+    Metadata metadata;
+};
+
+/**
+ * User interface slot counting the notifications it gets
+ */
+class TestReceiver : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestReceiver(): count(0), last(NULL) {}
+
+    int count;
+    UAVObject *last;
+
+public slots:
+    void updated(UAVObject *obj) { count++; last = obj; }
+};
+
+class tst_UpdateDispatcher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void coalescesBurst();
+    void deliversEachObject();
+    void disconnectForgetsObject();
+    void destroyedReceiverForgetsObject();
+
+private:
+    // Updates of a telemetry burst, faster than the interval
+    static const int BURST = 100;
+
+    UAVObjectUpdateDispatcher *dispatcher;
+    TestObject *obj1;
+    TestObject *obj2;
+};
+
+void tst_UpdateDispatcher::init()
+{
+    dispatcher = new UAVObjectUpdateDispatcher();
+    obj1 = new TestObject(1);
+    obj2 = new TestObject(2);
+}
+
+void tst_UpdateDispatcher::cleanup()
+{
+    delete obj2;
+    delete obj1;
+    delete dispatcher;
+}
+
+/**
+ * A burst of updates reaches the receiver once, after the interval
+ */
+void tst_UpdateDispatcher::coalescesBurst()
+{
+    TestReceiver receiver;
+    QVERIFY(dispatcher->connectObject(obj1, &receiver, SLOT(updated(UAVObject*))));
+
+    for (int i = 0; i < BURST; ++i)
+        obj1->updated();
+    QCOMPARE(receiver.count, 0);
+
+    QTRY_COMPARE(receiver.count, 1);
+    QCOMPARE(receiver.last, (UAVObject *)obj1);
+
+    UAVObjectUpdateDispatcher::Statistics stats = dispatcher->getStatistics(obj1);
+    QCOMPARE(stats.raw, (quint32)BURST);
+    QCOMPARE(stats.delivered, (quint32)1);
+
+    // The next burst is delivered on its own
+    obj1->updated();
+    QTRY_COMPARE(receiver.count, 2);
+    stats = dispatcher->getStatistics(obj1);
+    QCOMPARE(stats.raw, (quint32)BURST + 1);
+    QCOMPARE(stats.delivered, (quint32)2);
+
+    dispatcher->resetStatistics();
+    stats = dispatcher->getStatistics(obj1);
+    QCOMPARE(stats.raw, (quint32)0);
+    QCOMPARE(stats.delivered, (quint32)0);
+}
+
+/**
+ * Objects updated within the same interval are each delivered once
+ */
+void tst_UpdateDispatcher::deliversEachObject()
+{
+    TestReceiver receiver1;
+    TestReceiver receiver2;
+    QVERIFY(dispatcher->connectObject(obj1, &receiver1, SLOT(updated(UAVObject*))));
+    QVERIFY(dispatcher->connectObject(obj2, &receiver2, SLOT(updated(UAVObject*))));
+
+    for (int i = 0; i < BURST; ++i) {
+        obj1->updated();
+        if (i % 2 == 0)
+            obj2->updated();
+    }
+
+    QTRY_VERIFY(receiver1.count == 1 && receiver2.count == 1);
+    QCOMPARE(receiver1.last, (UAVObject *)obj1);
+    QCOMPARE(receiver2.last, (UAVObject *)obj2);
+
+    QHash<UAVObject*, UAVObjectUpdateDispatcher::Statistics> all = dispatcher->getAllStatistics();
+    QCOMPARE(all.size(), 2);
+    QCOMPARE(all[obj1].raw, (quint32)BURST);
+    QCOMPARE(all[obj2].raw, (quint32)BURST / 2);
+    QCOMPARE(all[obj1].delivered, (quint32)1);
+    QCOMPARE(all[obj2].delivered, (quint32)1);
+}
+
+/**
+ * The object is no longer followed once its last receiver disconnects,
+ * even with an update pending
+ */
+void tst_UpdateDispatcher::disconnectForgetsObject()
+{
+    TestReceiver receiver;
+    QVERIFY(dispatcher->connectObject(obj1, &receiver, SLOT(updated(UAVObject*))));
+
+    obj1->updated();
+    QVERIFY(dispatcher->disconnectObject(obj1, &receiver));
+    QVERIFY(dispatcher->getAllStatistics().isEmpty());
+
+    obj1->updated();
+    QTest::qWait(dispatcher->getInterval() * 5);
+    QCOMPARE(receiver.count, 0);
+    QCOMPARE(dispatcher->getStatistics(obj1).raw, (quint32)0);
+}
+
+/**
+ * A destroyed receiver, such as a closed gadget, is dropped together with
+ * the objects only it was interested in
+ */
+void tst_UpdateDispatcher::destroyedReceiverForgetsObject()
+{
+    TestReceiver remaining;
+    TestReceiver *closed = new TestReceiver();
+    QVERIFY(dispatcher->connectObject(obj1, closed, SLOT(updated(UAVObject*))));
+    QVERIFY(dispatcher->connectObject(obj2, closed, SLOT(updated(UAVObject*))));
+    QVERIFY(dispatcher->connectObject(obj2, &remaining, SLOT(updated(UAVObject*))));
+
+    obj1->updated();
+    obj2->updated();
+    delete closed;
+
+    // Only the object with a receiver left is still followed
+    QHash<UAVObject*, UAVObjectUpdateDispatcher::Statistics> all = dispatcher->getAllStatistics();
+    QCOMPARE(all.size(), 1);
+    QVERIFY(all.contains(obj2));
+
+    QTRY_COMPARE(remaining.count, 1);
+    QCOMPARE(remaining.last, (UAVObject *)obj2);
+
+    obj1->updated();
+    QCOMPARE(dispatcher->getStatistics(obj1).raw, (quint32)0);
+}
+
+QTEST_MAIN(tst_UpdateDispatcher)
+
+#include "tst_updatedispatcher.moc"
+
+/**
+ * @}
+ * @}
+ */
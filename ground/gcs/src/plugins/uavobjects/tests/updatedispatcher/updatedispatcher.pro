@@ -0,0 +1,22 @@
+# -------------------------------------------------
+# Test of the coalesced object update notifications
+# -------------------------------------------------
+QT -= gui
+QT += testlib
+TARGET = updatedispatcher
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+include(../../../../../gcs.pri)
+
+INCLUDEPATH *= ../..
+DEFINES += UAVOBJECTS_LIBRARY
+
+SOURCES += tst_updatedispatcher.cpp \
+    ../../uavobject.cpp \
+    ../../uavobjectfield.cpp \
+    ../../uavobjectupdatedispatcher.cpp
+HEADERS += ../../uavobject.h \
+    ../../uavobjectfield.h \
+    ../../uavobjectupdatedispatcher.h
@@ -37,6 +37,11 @@ UAVDataObject::UAVDataObject(quint32 objID, bool isSingleInst, bool isSet,const
     mobj = NULL;
     this->isSet = isSet;
     this->isPresentOnHardware = false;
+    this->deltaEncoded = false;
+    this->notificationPeriod = 0;
+    this->notificationTimer = NULL;
+
+    connect(this, SIGNAL(objectUpdated(UAVObject*)), this, SLOT(scheduleNotifications()));
 }
 
 /**
@@ -66,6 +71,22 @@ bool UAVDataObject::isSettings()
     return isSet;
 }
 
+/**
+ * Returns true if updates of the object can be sent as a delta against the previous one
+ */
+bool UAVDataObject::isDeltaEncoded() const
+{
+    return deltaEncoded;
+}
+
+/**
+ * Select if updates of the object can be sent as a delta, set from the object definition
+ */
+void UAVDataObject::setDeltaEncoded(bool enable)
+{
+    deltaEncoded = enable;
+}
+
 /**
  * Set the object's metadata
  */
@@ -112,4 +133,73 @@ void UAVDataObject::setIsPresentOnHardware(bool value)
         emit presentOnHardwareChanged(this);
 }
 
+/**
+ * Limit the rate of the property change notifications of the object.
+ * Updates within the period are held back and the latest data is notified
+ * at its end, so a fast object doesn't re-evaluate its bindings on every update.
+ * @param ms Minimum time between notifications, 0 to notify every update
+ */
+void UAVDataObject::setNotificationPeriod(int ms)
+{
+    notificationPeriod = qMax(ms, 0);
+
+    if (notificationPeriod > 0 && notificationTimer == NULL)
+    {
+        notificationTimer = new QTimer(this);
+        notificationTimer->setSingleShot(true);
+        connect(notificationTimer, SIGNAL(timeout()), this, SLOT(sendNotifications()));
+    }
+
+    // Don't keep held back updates waiting for the old period
+    if (notificationTimer != NULL && notificationTimer->isActive())
+    {
+        notificationTimer->stop();
+        sendNotifications();
+    }
+}
+
+/**
+ * Get the minimum time between property change notifications, 0 if not limited
+ */
+int UAVDataObject::getNotificationPeriod() const
+{
+    return notificationPeriod;
+}
+
+/**
+ * Emit the property change notifications of the object, implemented by the
+ * generated objects
+ */
+void UAVDataObject::emitNotifications()
+{
+}
+
+/**
+ * Called on every update, notifies now or at the end of the notification period
+ */
+void UAVDataObject::scheduleNotifications()
+{
+    if (notificationPeriod == 0)
+    {
+        emitNotifications();
+        return;
+    }
+
+    // An update is already held back, it notifies the latest data
+    if (notificationTimer->isActive())
+        return;
+
+    qint64 elapsed = lastNotification.isValid() ? lastNotification.elapsed() : notificationPeriod;
+    if (elapsed >= notificationPeriod)
+        sendNotifications();
+    else
+        notificationTimer->start((int)(notificationPeriod - elapsed));
+}
+
+void UAVDataObject::sendNotifications()
+{
+    lastNotification.start();
+    emitNotifications();
+}
+
 
@@ -34,6 +34,8 @@
 #include "uavobjectfield.h"
 #include "uavmetaobject.h"
 #include <QList>
+#include <QTimer>
+#include <QElapsedTimer>
 
 class UAVOBJECTS_EXPORT UAVDataObject: public UAVObject
 {
@@ -44,6 +46,8 @@ public:
     void initialize(quint32 instID, UAVMetaObject* mobj);
     void initialize(UAVMetaObject* mobj);
     bool isSettings();
+    bool isDeltaEncoded() const;
+    void setDeltaEncoded(bool enable);
     void setMetadata(const Metadata& mdata);
     Metadata getMetadata();
     UAVMetaObject* getMetaObject();
@@ -53,13 +57,27 @@ public:
     bool getIsPresentOnHardware() const;
     void setIsPresentOnHardware(bool value);
 
+    Q_INVOKABLE void setNotificationPeriod(int ms);
+    Q_INVOKABLE int getNotificationPeriod() const;
+
 signals:
     void presentOnHardwareChanged(UAVDataObject*);
 
+protected:
+    virtual void emitNotifications();
+
+private slots:
+    void scheduleNotifications();
+    void sendNotifications();
+
 private:
     UAVMetaObject* mobj;
     bool isSet;
     bool isPresentOnHardware;
+    bool deltaEncoded;
+    int notificationPeriod;
+    QTimer* notificationTimer;
+    QElapsedTimer lastNotification;
 
 };
 
@@ -78,6 +78,27 @@ void UAVObject::initializeFields(QList<UAVObjectField*>& fields, quint8* data, q
     this->numBytes = numBytes;
     this->data = data;
     this->fields = fields;
+
+    // The field names are the same for all instances of a class, so the
+    // name index is built once per object ID and shared between instances
+    static QMutex fieldIndicesMutex;
+    static QHash<quint32, QHash<QString, int> > fieldIndicesCache;
+    {
+        QMutexLocker cacheLocker(&fieldIndicesMutex);
+        QHash<quint32, QHash<QString, int> >::const_iterator it = fieldIndicesCache.constFind(objID);
+        if (it != fieldIndicesCache.constEnd() && it->count() == fields.length())
+        {
+            fieldIndices = *it;
+        }
+        else
+        {
+            fieldIndices.clear();
+            for (int n = 0; n < fields.length(); ++n)
+                fieldIndices.insert(fields[n]->getName(), n);
+            fieldIndicesCache.insert(objID, fieldIndices);
+        }
+    }
+
     // Initialize fields
     quint32 offset = 0;
     for (int n = 0; n < fields.length(); ++n)
@@ -254,18 +275,39 @@ UAVObjectField* UAVObject::getField(const QString& name)
 {
     QMutexLocker locker(mutex);
     // Look for field
-    for (int n = 0; n < fields.length(); ++n)
+    int index = fieldIndices.value(name, -1);
+    if (index >= 0)
     {
-        if (name.compare(fields[n]->getName()) == 0)
-        {
-            return fields[n];
-        }
+        return fields[index];
     }
     // If this point is reached then the field was not found
     qWarning()<<"UAVObject::getField Non existant field "<<name<<" requested.  This indicates a bug.  Make sure you also have null checking for non-debug code.";
     return NULL;
 }
 
+/**
+ * Get the index of a field, which can be used with fieldAt() to access the
+ * field again without looking up its name
+ * @returns The field index or -1 if not found
+ */
+int UAVObject::getFieldIndex(const QString& name)
+{
+    QMutexLocker locker(mutex);
+    return fieldIndices.value(name, -1);
+}
+
+/**
+ * Get a field by its index
+ * @returns The field or NULL if the index is out of range
+ */
+UAVObjectField* UAVObject::fieldAt(int index)
+{
+    QMutexLocker locker(mutex);
+    if (index < 0 || index >= fields.length())
+        return NULL;
+    return fields[index];
+}
+
 /**
  * Pack the object data into a byte array
  * @returns The number of bytes copied
@@ -273,6 +315,30 @@ UAVObjectField* UAVObject::getField(const QString& name)
 qint32 UAVObject::pack(quint8* dataOut)
 {
     QMutexLocker locker(mutex);
+    packData(dataOut);
+    return numBytes;
+}
+
+/**
+ * Unpack the object data from a byte array
+ * @returns The number of bytes copied
+ */
+qint32 UAVObject::unpack(const quint8* dataIn)
+{
+    QMutexLocker locker(mutex);
+    unpackData(dataIn);
+    emit objectUnpacked(this); // trigger object updated event
+    emit objectUpdated(this);
+
+    return numBytes;
+}
+
+/**
+ * Pack the fields one at a time, called by pack() with the mutex held.
+ * The generated objects override this with a copy of the whole object.
+ */
+void UAVObject::packData(quint8* dataOut)
+{
     qint32 offset = 0;
     for (QList<UAVObjectField*>::iterator iter = fields.begin(); iter != fields.end(); ++iter)
     {
@@ -280,16 +346,14 @@ qint32 UAVObject::pack(quint8* dataOut)
         field->pack(&dataOut[offset]);
         offset += field->getNumBytes();
     }
-    return numBytes;
 }
 
 /**
- * Unpack the object data from a byte array
- * @returns The number of bytes copied
+ * Unpack the fields one at a time, called by unpack() with the mutex held.
+ * The generated objects override this with a copy of the whole object.
  */
-qint32 UAVObject::unpack(const quint8* dataIn)
+void UAVObject::unpackData(const quint8* dataIn)
 {
-    QMutexLocker locker(mutex);
     qint32 offset = 0;
     for (QList<UAVObjectField*>::iterator iter = fields.begin(); iter != fields.end(); ++iter)
     {
@@ -297,10 +361,6 @@ qint32 UAVObject::unpack(const quint8* dataIn)
         field->unpack(&dataIn[offset]);
         offset += field->getNumBytes();
     }
-    emit objectUnpacked(this); // trigger object updated event
-    emit objectUpdated(this);
-
-    return numBytes;
 }
 
 /**
@@ -36,6 +36,7 @@
 #include <QMutexLocker>
 #include <QString>
 #include <QList>
+#include <QHash>
 #include <QFile>
 #include <qglobal.h>
 #include "uavobjectfield.h"
@@ -125,6 +126,8 @@ public:
     qint32 getNumFields();
     QList<UAVObjectField*> getFields();
     UAVObjectField* getField(const QString& name);
+    int getFieldIndex(const QString& name);
+    UAVObjectField* fieldAt(int index);
     QString toString();
     QString toStringBrief();
     QString toStringData();
@@ -242,7 +245,10 @@ protected:
     QMutex* mutex;
     quint8* data;
     QList<UAVObjectField*> fields;
+    QHash<QString, int> fieldIndices;
     void initializeFields(QList<UAVObjectField*>& fields, quint8* data, quint32 numBytes);
+    virtual void packData(quint8* dataOut);
+    virtual void unpackData(const quint8* dataIn);
     void setDescription(const QString& description);
     void setCategory(const QString& category);
 
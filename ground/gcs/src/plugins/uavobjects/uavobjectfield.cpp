@@ -1044,11 +1044,99 @@ void UAVObjectField::setValue(const QVariant& value, quint32 index)
     }
 }
 
+/**
+ * Read a numeric element straight from the object data, without going
+ * through a QVariant
+ * @returns false for enum and string fields, which need getValue()
+ */
+template <typename T> bool UAVObjectField::getNumeric(quint32 index, T &value)
+{
+    QMutexLocker locker(obj->getMutex());
+    if ( index >= numElements )
+    {
+        value = 0;
+        return true;
+    }
+    const quint8 *element = &data[offset + numBytesPerElement*index];
+    switch (type)
+    {
+    case INT8:
+    {
+        qint8 tmpint8;
+        memcpy(&tmpint8, element, sizeof(tmpint8));
+        value = tmpint8;
+        return true;
+    }
+    case INT16:
+    {
+        qint16 tmpint16;
+        memcpy(&tmpint16, element, sizeof(tmpint16));
+        value = tmpint16;
+        return true;
+    }
+    case INT32:
+    {
+        qint32 tmpint32;
+        memcpy(&tmpint32, element, sizeof(tmpint32));
+        value = tmpint32;
+        return true;
+    }
+    case UINT8:
+        value = *element;
+        return true;
+    case UINT16:
+    {
+        quint16 tmpuint16;
+        memcpy(&tmpuint16, element, sizeof(tmpuint16));
+        value = tmpuint16;
+        return true;
+    }
+    case UINT32:
+    {
+        quint32 tmpuint32;
+        memcpy(&tmpuint32, element, sizeof(tmpuint32));
+        value = tmpuint32;
+        return true;
+    }
+    case FLOAT32:
+    {
+        float tmpfloat;
+        memcpy(&tmpfloat, element, sizeof(tmpfloat));
+        value = tmpfloat;
+        return true;
+    }
+    case BITFIELD:
+        value = (data[offset + numBytesPerElement*(index/8)] >> (index % 8)) & 1;
+        return true;
+    default:
+        return false;
+    }
+}
+
 double UAVObjectField::getDouble(quint32 index)
 {
+    double value;
+    if (getNumeric(index, value))
+        return value;
     return getValue(index).toDouble();
 }
 
+float UAVObjectField::getFloat(quint32 index)
+{
+    float value;
+    if (getNumeric(index, value))
+        return value;
+    return getValue(index).toFloat();
+}
+
+qint64 UAVObjectField::getInt(quint32 index)
+{
+    qint64 value;
+    if (getNumeric(index, value))
+        return value;
+    return getValue(index).toLongLong();
+}
+
 void UAVObjectField::setDouble(double value, quint32 index)
 {
     setValue(QVariant(value), index);
@@ -68,6 +68,8 @@ public:
     bool checkValue(const QVariant& data, quint32 index = 0);
     void setValue(const QVariant& data, quint32 index = 0);
     double getDouble(quint32 index = 0);
+    float getFloat(quint32 index = 0);
+    qint64 getInt(quint32 index = 0);
     void setDouble(double value, quint32 index = 0);
     quint32 getDataOffset();
     quint32 getNumBytes();
@@ -97,6 +99,7 @@ protected:
     void clear();
     void constructorInitialize(const QString& name, const QString& units, FieldType type, const QStringList& elementNames, const QStringList& options, const QList<int> &indices, const QString &limits);
     void limitsInitialize(const QString &limits);
+    template <typename T> bool getNumeric(quint32 index, T &value);
 
 
 };
@@ -72,6 +72,7 @@ bool UAVObjectManager::registerObject(UAVDataObject* obj)
             {
                 UAVDataObject* cobj = obj->clone(instidx);
                 cobj->initialize(instidx,mobj);
+                adoptObject(cobj);
                 QMap<quint32,UAVObject*> ppp;
                 ppp.insert(instidx,cobj);
                 objects[objID].insert(instidx,cobj);
@@ -86,6 +87,7 @@ bool UAVObjectManager::registerObject(UAVDataObject* obj)
             return false;
         }
         // Add the actual object instance in the list
+        adoptObject(obj);
         objects[objID].insert(obj->getInstID(),obj);
         getObject(objID)->emitNewInstance(obj);
         emit newInstance(obj);
@@ -130,12 +132,29 @@ bool UAVObjectManager::unRegisterObject(UAVDataObject* obj)
     return true;
 }
 
+/**
+ * Move an object created in another thread, such as an instance created by
+ * the telemetry on the link thread, to the thread of the manager. Its
+ * slots and timers then run in the same thread as the rest of the objects,
+ * and the notifications to the GUI keep being queued.
+ * Must be called from the thread which created the object.
+ */
+void UAVObjectManager::adoptObject(UAVObject* obj)
+{
+    if (obj->thread() != thread())
+        obj->moveToThread(thread());
+}
+
 void UAVObjectManager::addObject(UAVObject* obj)
 {
+    adoptObject(obj);
     // Add to list
     QMap<quint32,UAVObject*> list;
     list.insert(obj->getInstID(),obj);
     objects.insert(obj->getObjID(),list);
+    // Object types are never removed from the manager (only their instances are),
+    // so the name index only needs to grow here
+    objectIDs.insert(obj->getName(),obj->getObjID());
     emit newObject(obj);
 }
 
@@ -235,15 +254,10 @@ UAVObject* UAVObjectManager::getObject(const QString* name, quint32 objId, quint
 {
     QMutexLocker locker(mutex);
     if(name != NULL)
-    {
-        foreach(ObjectMap map,objects)
-        {
-            if(map.first()->getName().compare(name) == 0)
-                return map.value(instId,NULL);
-        }
-    }
-    else if(objects.contains(objId))
-        return objects.value(objId).value(instId);
+        objId = objectIDs.value(*name, 0);
+    QHash<quint32, ObjectMap>::const_iterator it = objects.constFind(objId);
+    if(it != objects.constEnd())
+        return it->value(instId, NULL);
     return NULL;
 }
 
@@ -270,15 +284,10 @@ QVector<UAVObject*> UAVObjectManager::getObjectInstancesVector(const QString* na
 {
     QMutexLocker locker(mutex);
     if(name != NULL)
-    {
-        foreach(ObjectMap map,objects)
-        {
-            if(map.first()->getName().compare(name) == 0)
-                return map.values().toVector();
-        }
-    }
-    else if(objects.contains(objId))
-        return objects.value(objId).values().toVector();
+        objId = objectIDs.value(*name, 0);
+    QHash<quint32, ObjectMap>::const_iterator it = objects.constFind(objId);
+    if(it != objects.constEnd())
+        return it->values().toVector();
     return  QVector<UAVObject*>();
 }
 
@@ -305,14 +314,21 @@ qint32 UAVObjectManager::getNumInstances(const QString* name, quint32 objId)
 {
     QMutexLocker locker(mutex);
     if(name != NULL)
-    {
-        foreach(ObjectMap map,objects)
-        {
-            if(map.first()->getName().compare(name) == 0)
-                return map.count();
-        }
-    }
-    else if(objects.contains(objId))
-        return objects.value(objId).count();
+        objId = objectIDs.value(*name, 0);
+    QHash<quint32, ObjectMap>::const_iterator it = objects.constFind(objId);
+    if(it != objects.constEnd())
+        return it->count();
     return -1;
 }
+
+/**
+ * Resolve an object name to its object ID. Callers which look up the same
+ * object repeatedly can resolve the name once and then use the ID based
+ * accessors, which avoid hashing the name on every call.
+ * @returns The object ID or 0 if no object with this name is registered
+ */
+quint32 UAVObjectManager::getObjectID(const QString& name)
+{
+    QMutexLocker locker(mutex);
+    return objectIDs.value(name, 0);
+}
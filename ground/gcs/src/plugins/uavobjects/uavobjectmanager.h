@@ -57,6 +57,7 @@ public:
     QVector<UAVObject*> getObjectInstancesVector(quint32 objId);
     qint32 getNumInstances(const QString& name);
     qint32 getNumInstances(quint32 objId);    
+    quint32 getObjectID(const QString& name);
     bool unRegisterObject(UAVDataObject *obj);
 signals:
     void newObject(UAVObject* obj);
@@ -65,9 +66,11 @@ signals:
 private:
     static const quint32 MAX_INSTANCES = 1000;
     QHash<quint32, QMap<quint32,UAVObject*> > objects;
+    QHash<QString, quint32> objectIDs;
     QMutex* mutex;
 
     void addObject(UAVObject* obj);
+    void adoptObject(UAVObject* obj);
     UAVObject* getObject(const QString* name, quint32 objId, quint32 instId);
     QVector<UAVObject*> getObjectInstancesVector(const QString* name, quint32 objId);
     qint32 getNumInstances(const QString* name, quint32 objId);
@@ -27,6 +27,7 @@
  */
 #include "uavobjectsplugin.h"
 #include "uavobjectsinit.h"
+#include "uavobjectupdatedispatcher.h"
 
 UAVObjectsPlugin::UAVObjectsPlugin()
 {
@@ -50,6 +51,8 @@ bool UAVObjectsPlugin::initialize(const QStringList & arguments, QString * error
     addAutoReleasedObject(objMngr);
     // Initialize UAVObjects
     UAVObjectsInitialize(objMngr);
+    // Expose the coalesced updates for the user interface
+    addAutoReleasedObject(new UAVObjectUpdateDispatcher());
     // Done
     Q_UNUSED(arguments);
     Q_UNUSED(errorString);
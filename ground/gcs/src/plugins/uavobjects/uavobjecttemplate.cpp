@@ -32,6 +32,8 @@
  */
 #include "$(NAMELC).h"
 #include "uavobjectfield.h"
+#include <QtEndian>
+#include <string.h>
 
 const QString $(NAME)::NAME = QString("$(NAME)");
 const QString $(NAME)::DESCRIPTION = QString("$(DESCRIPTION)");
@@ -49,14 +51,15 @@ $(FIELDSINIT)
     initializeFields(fields, (quint8*)&data, NUMBYTES);
     // Set the default field values
     setDefaultFieldValues();
+    notifiedData = data;
     // Set the object description
     setDescription(DESCRIPTION);
 
     // Set the Category of this object type
     setCategory(CATEGORY);
 
-    connect(this, SIGNAL(objectUpdated(UAVObject*)),
-            SLOT(emitNotifications()));
+    // Allow updates to be sent as deltas
+    setDeltaEncoded(ISDELTAENCODED);
 }
 
 /**
@@ -114,9 +117,45 @@ void $(NAME)::setData(const DataFields& data)
     }
 }
 
+/**
+ * Pack the object data, called by UAVObject::pack() with the mutex held.
+ * The packed data fields are laid out as on the wire, so on little endian
+ * hosts the whole object is a single copy.
+ */
+void $(NAME)::packData(quint8* dataOut)
+{
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    memcpy(dataOut, &data, NUMBYTES);
+#else
+$(PACKFIELDS)
+#endif
+}
+
+/**
+ * Unpack the object data, called by UAVObject::unpack() with the mutex held.
+ */
+void $(NAME)::unpackData(const quint8* dataIn)
+{
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    memcpy(&data, dataIn, NUMBYTES);
+#else
+$(UNPACKFIELDS)
+#endif
+}
+
+/**
+ * Emit the change notifications of the elements whose data changed since
+ * they were last notified
+ */
 void $(NAME)::emitNotifications()
 {
-    $(NOTIFY_PROPERTIES_CHANGED)
+    mutex->lock();
+    DataFields current = data;
+    DataFields previous = notifiedData;
+    notifiedData = data;
+    mutex->unlock();
+
+$(NOTIFY_PROPERTIES_CHANGED)
 }
 
 /**
@@ -67,6 +67,7 @@ $(DATAFIELDINFO)
     static const QString CATEGORY;
     static const bool ISSINGLEINST = $(ISSINGLEINST);
     static const bool ISSETTINGS = $(ISSETTINGS);
+    static const bool ISDELTAENCODED = $(ISDELTAENCODED);
     static const quint32 NUMBYTES = $(NUMBYTES);
 
     // Functions
@@ -89,11 +90,14 @@ $(PROPERTY_SETTERS)
 signals:
 $(PROPERTY_NOTIFICATIONS)
 
-private slots:
+protected:
+    void packData(quint8* dataOut);
+    void unpackData(const quint8* dataIn);
     void emitNotifications();
-	
+
 private:
     DataFields data;
+    DataFields notifiedData;
 
     void setDefaultFieldValues();
 
@@ -0,0 +1,216 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectupdatedispatcher.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      Coalesced object update notifications for the user interface
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "uavobjectupdatedispatcher.h"
+
+/**
+ * Constructor
+ * @param interval Time over which the updates of an object are collapsed (ms)
+ */
+UAVObjectUpdateDispatcher::UAVObjectUpdateDispatcher(int interval, QObject* parent):
+    QObject(parent)
+{
+    timer.setSingleShot(true);
+    timer.setInterval(interval);
+    connect(&timer, SIGNAL(timeout()), this, SLOT(deliver()));
+}
+
+UAVObjectUpdateDispatcher::~UAVObjectUpdateDispatcher()
+{
+}
+
+/**
+ * Connect a receiver to the coalesced updates of an object
+ * @param method Slot taking the UAVObject*, as given by SLOT()
+ * @returns true if connected
+ */
+bool UAVObjectUpdateDispatcher::connectObject(UAVObject* obj, const QObject* receiver, const char* method)
+{
+    if (obj == NULL)
+        return false;
+
+    if (!entries.contains(obj))
+    {
+        Entry entry;
+        entry.proxy = new UAVObjectUpdateProxy(this);
+        entry.stats.raw = 0;
+        entry.stats.delivered = 0;
+        entry.pending = false;
+        entries.insert(obj, entry);
+
+        connect(obj, SIGNAL(objectUpdated(UAVObject*)), this, SLOT(objectUpdated(UAVObject*)));
+        connect(obj, SIGNAL(destroyed(QObject*)), this, SLOT(objectDestroyed(QObject*)));
+    }
+
+    connect(receiver, SIGNAL(destroyed(QObject*)), this, SLOT(receiverDestroyed(QObject*)), Qt::UniqueConnection);
+
+    return connect(entries[obj].proxy, SIGNAL(objectUpdated(UAVObject*)), receiver, method, Qt::UniqueConnection);
+}
+
+/**
+ * Disconnect a receiver from the coalesced updates of an object
+ * @param method Slot to disconnect, NULL for all slots of the receiver
+ * @returns true if disconnected
+ */
+bool UAVObjectUpdateDispatcher::disconnectObject(UAVObject* obj, const QObject* receiver, const char* method)
+{
+    QHash<UAVObject*, Entry>::iterator it = entries.find(obj);
+    if (it == entries.end())
+        return false;
+
+    bool res = disconnect(it->proxy, SIGNAL(objectUpdated(UAVObject*)), receiver, method);
+
+    // Stop following the object once nobody is interested in it
+    if (!it->proxy->hasReceivers())
+    {
+        disconnect(obj, 0, this, 0);
+        removeEntry(obj);
+    }
+
+    return res;
+}
+
+/**
+ * Set the time over which the updates of an object are collapsed
+ */
+void UAVObjectUpdateDispatcher::setInterval(int ms)
+{
+    timer.setInterval(ms);
+}
+
+int UAVObjectUpdateDispatcher::getInterval() const
+{
+    return timer.interval();
+}
+
+/**
+ * Get the number of updates and of delivered notifications of an object
+ */
+UAVObjectUpdateDispatcher::Statistics UAVObjectUpdateDispatcher::getStatistics(UAVObject* obj) const
+{
+    Statistics stats = { 0, 0 };
+    QHash<UAVObject*, Entry>::const_iterator it = entries.constFind(obj);
+    if (it != entries.constEnd())
+        stats = it->stats;
+    return stats;
+}
+
+/**
+ * Get the statistics of all the objects with receivers
+ */
+QHash<UAVObject*, UAVObjectUpdateDispatcher::Statistics> UAVObjectUpdateDispatcher::getAllStatistics() const
+{
+    QHash<UAVObject*, Statistics> all;
+    for (QHash<UAVObject*, Entry>::const_iterator it = entries.constBegin(); it != entries.constEnd(); ++it)
+        all.insert(it.key(), it->stats);
+    return all;
+}
+
+void UAVObjectUpdateDispatcher::resetStatistics()
+{
+    for (QHash<UAVObject*, Entry>::iterator it = entries.begin(); it != entries.end(); ++it)
+    {
+        it->stats.raw = 0;
+        it->stats.delivered = 0;
+    }
+}
+
+/**
+ * Called on every update of a followed object, queues it for the next delivery
+ */
+void UAVObjectUpdateDispatcher::objectUpdated(UAVObject* obj)
+{
+    QHash<UAVObject*, Entry>::iterator it = entries.find(obj);
+    if (it == entries.end())
+        return;
+
+    it->stats.raw++;
+    if (it->pending)
+        return;
+
+    it->pending = true;
+    pending.append(obj);
+    if (!timer.isActive())
+        timer.start();
+}
+
+void UAVObjectUpdateDispatcher::objectDestroyed(QObject* obj)
+{
+    removeEntry(static_cast<UAVObject*>(obj));
+}
+
+/**
+ * Drop the connections of a destroyed receiver, and stop following the
+ * objects nobody else is interested in
+ */
+void UAVObjectUpdateDispatcher::receiverDestroyed(QObject* receiver)
+{
+    // The receiver is still connected to the proxies while it is being destroyed
+    foreach (UAVObject* obj, entries.keys())
+        disconnectObject(obj, receiver);
+}
+
+/**
+ * Notify the receivers of the objects updated since the last delivery
+ */
+void UAVObjectUpdateDispatcher::deliver()
+{
+    // The receivers may connect or disconnect objects, work on a copy
+    QVector<UAVObject*> objects = pending;
+    pending.clear();
+
+    foreach (UAVObject* obj, objects)
+    {
+        QHash<UAVObject*, Entry>::iterator it = entries.find(obj);
+        if (it == entries.end() || !it->pending)
+            continue;
+
+        it->pending = false;
+        it->stats.delivered++;
+        UAVObjectUpdateProxy* proxy = it->proxy;
+        proxy->emitUpdated(obj);
+    }
+}
+
+void UAVObjectUpdateDispatcher::removeEntry(UAVObject* obj)
+{
+    QHash<UAVObject*, Entry>::iterator it = entries.find(obj);
+    if (it == entries.end())
+        return;
+
+    it->proxy->deleteLater();
+    entries.erase(it);
+
+    int index = pending.indexOf(obj);
+    if (index >= 0)
+        pending.remove(index);
+}
+
+/**
+ * @}
+ * @}
+ */
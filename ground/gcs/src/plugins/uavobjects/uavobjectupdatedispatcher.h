@@ -0,0 +1,116 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectupdatedispatcher.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      Coalesced object update notifications for the user interface
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef UAVOBJECTUPDATEDISPATCHER_H
+#define UAVOBJECTUPDATEDISPATCHER_H
+
+#include "uavobjects_global.h"
+#include "uavobject.h"
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QTimer>
+
+class UAVObjectUpdateProxy;
+
+/**
+ * @brief The UAVObjectUpdateDispatcher class delivers the updates of the
+ * objects to the user interface at most once per interval.
+ *
+ * The updates of an object which arrive within an interval are collapsed
+ * into a single objectUpdated(UAVObject*) call of the receivers connected
+ * with connectObject(). Consumers which need every update, such as logging
+ * or relaying, keep connecting to UAVObject::objectUpdated directly.
+ */
+class UAVOBJECTS_EXPORT UAVObjectUpdateDispatcher: public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int DEFAULT_INTERVAL = 16;
+
+    struct Statistics {
+        quint32 raw;        /** Updates of the object */
+        quint32 delivered;  /** Notifications delivered to the receivers */
+    };
+
+    UAVObjectUpdateDispatcher(int interval = DEFAULT_INTERVAL, QObject* parent = 0);
+    ~UAVObjectUpdateDispatcher();
+
+    bool connectObject(UAVObject* obj, const QObject* receiver, const char* method);
+    bool disconnectObject(UAVObject* obj, const QObject* receiver, const char* method = 0);
+
+    void setInterval(int ms);
+    int getInterval() const;
+
+    Statistics getStatistics(UAVObject* obj) const;
+    QHash<UAVObject*, Statistics> getAllStatistics() const;
+    void resetStatistics();
+
+private slots:
+    void objectUpdated(UAVObject* obj);
+    void objectDestroyed(QObject* obj);
+    void receiverDestroyed(QObject* receiver);
+    void deliver();
+
+private:
+    struct Entry {
+        UAVObjectUpdateProxy* proxy;
+        Statistics stats;
+        bool pending;
+    };
+
+    QHash<UAVObject*, Entry> entries;
+    QVector<UAVObject*> pending;
+    QTimer timer;
+
+    void removeEntry(UAVObject* obj);
+};
+
+/**
+ * @brief Per object source of the coalesced updates, the receivers are
+ * connected to its signal
+ */
+class UAVObjectUpdateProxy: public QObject
+{
+    Q_OBJECT
+
+public:
+    UAVObjectUpdateProxy(QObject* parent): QObject(parent) {}
+    void emitUpdated(UAVObject* obj) { emit objectUpdated(obj); }
+    bool hasReceivers() const { return receivers(SIGNAL(objectUpdated(UAVObject*))) > 0; }
+
+signals:
+    void objectUpdated(UAVObject* obj);
+};
+
+#endif // UAVOBJECTUPDATEDISPATCHER_H
+
+/**
+ * @}
+ * @}
+ */
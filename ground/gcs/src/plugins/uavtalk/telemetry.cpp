@@ -368,6 +368,8 @@ void Telemetry::transactionTimeout(ObjectTransactionInfo *transInfo)
     {
         TELEMETRY_QXTLOG_DEBUG(QString("[telemetry.cpp] Transaction timeout:%0 Instance:%1 Retrying").arg(transInfo->obj->getName() + QString(QString(" 0x") + QString::number(transInfo->obj->getObjID(), 16).toUpper())).arg(transInfo->obj->getInstID()));
         --transInfo->retriesRemaining;
+        // The update may have been lost as a delta, retry it in full
+        utalk->resetDeltaEncoding(transInfo->obj);
         processObjectTransaction(transInfo);
         ++txRetries;
     }
@@ -419,7 +421,20 @@ void Telemetry::processObjectUpdates(UAVObject* obj, EventMask event, bool allIn
     objInfo.obj = obj;
     objInfo.event = event;
     objInfo.allInstances = allInstances;
-    if (priority)
+    if (event == EV_UNPACKED)
+    {
+        // Unpacked events are kept apart, they may complete a pending transaction
+        if ( objUnpackedQueue.length() < MAX_QUEUE_SIZE )
+        {
+            objUnpackedQueue.enqueue(objInfo);
+        }
+        else
+        {
+            ++txErrors;
+            TELEMETRY_QXTLOG_DEBUG(QString(tr("Telemetry: unpacked event queue is full, event lost (%1)").arg(obj->getName())));
+        }
+    }
+    else if (priority)
     {
         if ( objPriorityQueue.length() < MAX_QUEUE_SIZE )
         {
@@ -451,9 +466,36 @@ void Telemetry::processObjectUpdates(UAVObject* obj, EventMask event, bool allIn
 }
 
 /**
- * Process events from the object queue.
+ * Process events from the object queues. Transactions are not waited for one
+ * by one, up to MAX_PENDING_TRANSACTIONS of them can be in flight and the
+ * remaining events stay queued until one of them completes or fails.
+ * Unpacked events don't start a transaction, they may complete one, so they
+ * are never held back by the limit.
  */
 void Telemetry::processObjectQueue()
+{
+    while ( true )
+    {
+        if ( !objUnpackedQueue.isEmpty() )
+        {
+            processObjectEvent(objUnpackedQueue.dequeue());
+        }
+        else if ( ( !objPriorityQueue.isEmpty() || !objQueue.isEmpty() ) &&
+                  transMap.size() < MAX_PENDING_TRANSACTIONS )
+        {
+            processNextObject();
+        }
+        else
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * Process the next event from the object queue.
+ */
+void Telemetry::processNextObject()
 {
     if (objQueue.length() > 1)
     {
@@ -473,7 +515,14 @@ void Telemetry::processObjectQueue()
     {
         return;
     }
+    processObjectEvent(objInfo);
+}
 
+/**
+ * Process an event taken from one of the object queues.
+ */
+void Telemetry::processObjectEvent(const ObjectQueueInfo &objInfo)
+{
     // Check if a connection has been established, only process GCSTelemetryStats updates
     // (used to establish the connection)
     GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
@@ -637,6 +686,11 @@ Telemetry::TelemetryStats Telemetry::getStats()
     return stats;
 }
 
+void Telemetry::setDeltaEncoding(bool enable)
+{
+    utalk->setDeltaEncoding(enable);
+}
+
 void Telemetry::resetStats()
 {
     QMutexLocker locker(mutex);
@@ -79,6 +79,7 @@ public:
     ~Telemetry();
     TelemetryStats getStats();
     void resetStats();
+    void setDeltaEncoding(bool enable);
     void transactionTimeout(ObjectTransactionInfo *info);
 
 signals:
@@ -90,6 +91,7 @@ private:
     static const int MAX_UPDATE_PERIOD_MS = 1000;
     static const int MIN_UPDATE_PERIOD_MS = 1;
     static const int MAX_QUEUE_SIZE = 20;
+    static const int MAX_PENDING_TRANSACTIONS = 8;
 
     // Types
     /**
@@ -123,6 +125,7 @@ private:
     QVector<ObjectTimeInfo> objList;
     QQueue<ObjectQueueInfo> objQueue;
     QQueue<ObjectQueueInfo> objPriorityQueue;
+    QQueue<ObjectQueueInfo> objUnpackedQueue;
     QMap<TransactionKey, ObjectTransactionInfo*>transMap;
     QMutex* mutex;
     QTimer* updateTimer;
@@ -140,6 +143,8 @@ private:
     void processObjectUpdates(UAVObject* obj, EventMask event, bool allInstances, bool priority);
     void processObjectTransaction(ObjectTransactionInfo *transInfo);
     void processObjectQueue();
+    void processNextObject();
+    void processObjectEvent(const ObjectQueueInfo &objInfo);
     bool updateTransactionMap(UAVObject* obj, bool request);
 
 
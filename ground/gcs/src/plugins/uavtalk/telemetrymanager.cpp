@@ -32,8 +32,14 @@
 #include <coreplugin/threadmanager.h>
 
 TelemetryManager::TelemetryManager() :
+    utalk(NULL),
+    telemetry(NULL),
+    telemetryMon(NULL),
     autopilotConnected(false)
 {
+    // The link is parsed and the transactions are timed in the real time
+    // thread, which owns the devices of the connections, so that neither is
+    // held up by the GUI
     moveToThread(Core::ICore::instance()->threadManager()->getRealTimeThread());
     // Get UAVObjectManager instance
     ExtensionSystem::PluginManager* pm = ExtensionSystem::PluginManager::instance();
@@ -41,7 +47,9 @@ TelemetryManager::TelemetryManager() :
 
     // connect to start stop signals
     connect(this, SIGNAL(myStart()), this, SLOT(onStart()),Qt::QueuedConnection);
-    connect(this, SIGNAL(myStop()), this, SLOT(onStop()),Qt::QueuedConnection);
+    // Stopping waits for the telemetry to let go of the device, which is
+    // closed by the connection manager right after
+    connect(this, SIGNAL(myStop()), this, SLOT(onStop()),Qt::BlockingQueuedConnection);
     settings = pm->getObject<Core::Internal::GeneralSettings>();
     connect(settings, SIGNAL(generalSettingsChanged()), this, SLOT(onGeneralSettingsChanged()));
     connect(pm, SIGNAL(pluginsLoadEnded()), this, SLOT(onGeneralSettingsChanged()));
@@ -74,16 +82,25 @@ void TelemetryManager::onStart()
 
 void TelemetryManager::stop()
 {
-    emit myStop();
+    if (QThread::currentThread() == thread())
+        onStop();
+    else
+        emit myStop();
 }
 
 void TelemetryManager::onStop()
 {
+    if (telemetryMon == NULL)
+        return;
+
     telemetryMon->disconnect(this);
     sessions = telemetryMon->savedSessions();
     delete telemetryMon;
     delete telemetry;
     delete utalk;
+    telemetryMon = NULL;
+    telemetry = NULL;
+    utalk = NULL;
     onDisconnect();
 }
 
@@ -30,6 +30,7 @@
 #include "coreplugin/connectionmanager.h"
 #include "coreplugin/icore.h"
 #include "firmwareiapobj.h"
+#include "systemsettings.h"
 
 //Number of retries for initial session object fetching
 //This is needed because sometimes the object is lost when asked right uppon connection
@@ -40,7 +41,8 @@
 #define SESSION_RETRIEVE_TIMEOUT            20000
 //Number of retries for the session object fetching during negotiation
 #define SESSION_OBJ_RETRIEVE_RETRIES        3
-//Timeout for the object fetching fase, the system will stop fetching objects and emit connected after this
+//Timeout for the object fetching fase, the system will stop fetching objects and emit connected if no object
+//was received for this long
 #define OBJECT_RETRIEVE_TIMEOUT             5000
 //IAP object is very important, retry if not able to get it the first time
 #define IAP_OBJECT_RETRIES                  3
@@ -129,10 +131,16 @@ void TelemetryMonitor::startRetrievingObjects()
 {
     TELEMETRYMONITOR_QXTLOG_DEBUG(QString("%0 connectionStatus changed to CON_RETRIEVING_OBJECT").arg(Q_FUNC_INFO));
     connectionStatus = CON_RETRIEVING_OBJECTS;
-    // Get all objects, add metaobjects, settings and data objects with OnChange update mode to the queue
-    queue.empty();
+    // Get all objects, add metaobjects, settings and data objects with OnChange update mode to the queue.
+    // The objects needed to identify and configure the board come first, then the settings and the
+    // OnChange data, the metaobjects last.
+    stopRetrievingObjects();
     retries = 0;
     objectRetrieveTimeout->start(OBJECT_RETRIEVE_TIMEOUT);
+    QList<UAVObject*> critical;
+    QList<UAVObject*> settingsObjs;
+    QList<UAVObject*> dataObjs;
+    QList<UAVObject*> metaObjs;
     foreach(UAVObjectManager::ObjectMap map, objMngr->getObjects().values())
     {
         UAVObject* obj = map.first();
@@ -149,18 +157,23 @@ void TelemetryMonitor::startRetrievingObjects()
                 TELEMETRYMONITOR_QXTLOG_DEBUG(QString("%0 %1 not present on hardware, skipping").arg(Q_FUNC_INFO).arg(obj->getName()));
                 continue;
             }
-            queue.enqueue(dobj->getMetaObject());
-            if ( dobj->isSettings() )
+            metaObjs.append(dobj->getMetaObject());
+            if ( obj->getObjID() == FirmwareIAPObj::OBJID || obj->getObjID() == SystemSettings::OBJID )
+            {
+                TELEMETRYMONITOR_QXTLOG_DEBUG(QString("%0 queing critical object %1").arg(Q_FUNC_INFO).arg(dobj->getName()));
+                critical.append(obj);
+            }
+            else if ( dobj->isSettings() )
             {
                 TELEMETRYMONITOR_QXTLOG_DEBUG(QString("%0 queing settings object %1").arg(Q_FUNC_INFO).arg(dobj->getName()));
-                queue.enqueue(obj);
+                settingsObjs.append(obj);
             }
             else
             {
                 if ( UAVObject::GetFlightTelemetryUpdateMode(mdata) == UAVObject::UPDATEMODE_ONCHANGE )
                 {
                     TELEMETRYMONITOR_QXTLOG_DEBUG(QString("%0 queing UPDATEMODE_ONCHANGE object %1").arg(Q_FUNC_INFO).arg(dobj->getName()));
-                    queue.enqueue(obj);
+                    dataObjs.append(obj);
                 }
                 else
                 {
@@ -169,10 +182,14 @@ void TelemetryMonitor::startRetrievingObjects()
             }
         }
     }
+    queue.append(critical);
+    queue.append(settingsObjs);
+    queue.append(dataObjs);
+    queue.append(metaObjs);
     // Start retrieving
     TELEMETRYMONITOR_QXTLOG_DEBUG(QString(tr("Starting to retrieve meta and settings objects from the autopilot (%1 objects)"))
                                   .arg( queue.length()));
-    retrieveNextObject();
+    retrieveObjects();
 }
 
 void TelemetryMonitor::changeObjectInstances(quint32 objID, quint32 instID, bool delayed)
@@ -230,12 +247,25 @@ void TelemetryMonitor::changeObjectInstances(quint32 objID, quint32 instID, bool
 }
 
 /**
- * Retrieve the next object in the queue
+ * Request the next objects in the queue, keeping up to the configured number of
+ * requests in flight. Connected is emitted once all of them are answered.
  */
-void TelemetryMonitor::retrieveNextObject()
+void TelemetryMonitor::retrieveObjects()
 {
-    // If queue is empty return
-    if ( queue.isEmpty() )
+    int maxRequests = qMax(1, settings->objectRetrievalRequests());
+    while ( !queue.isEmpty() && inFlight.size() < maxRequests )
+    {
+        // Get next object from the queue
+        UAVObject* obj = queue.dequeue();
+        inFlight.insert(obj);
+        // Connect to object
+        TELEMETRYMONITOR_QXTLOG_DEBUG(QString("%0 requestiong %1 from board INSTID:%2").arg(Q_FUNC_INFO).arg(obj->getName()).arg(obj->getInstID()));
+        connect(obj, SIGNAL(transactionCompleted(UAVObject*,bool)), this, SLOT(transactionCompleted(UAVObject*,bool)));
+        // Request update
+        obj->requestUpdateAllInstances();
+    }
+    // Done once the queue is empty and all the requests are answered
+    if ( queue.isEmpty() && inFlight.isEmpty() && connectionStatus == CON_RETRIEVING_OBJECTS )
     {
         TELEMETRYMONITOR_QXTLOG_DEBUG(QString("%0 Object retrieval completed").arg(Q_FUNC_INFO));
         if(isManaged)
@@ -259,15 +289,20 @@ void TelemetryMonitor::retrieveNextObject()
         sessionRetrieveTimeout->stop();
         sessionInitialRetrieveTimeout->stop();
         objectRetrieveTimeout->stop();
-        return;
     }
-    // Get next object from the queue
-    UAVObject* obj = queue.dequeue();
-    // Connect to object
-    TELEMETRYMONITOR_QXTLOG_DEBUG(QString("%0 requestiong %1 from board INSTID:%2").arg(Q_FUNC_INFO).arg(obj->getName()).arg(obj->getInstID()));
-    connect(obj, SIGNAL(transactionCompleted(UAVObject*,bool)), this, SLOT(transactionCompleted(UAVObject*,bool)));
-    // Request update
-    obj->requestUpdateAllInstances();
+}
+
+/**
+ * Drop the queued objects and forget the requests in flight
+ */
+void TelemetryMonitor::stopRetrievingObjects()
+{
+    queue.clear();
+    foreach (UAVObject* obj, inFlight)
+    {
+        disconnect(obj, SIGNAL(transactionCompleted(UAVObject*,bool)), this, SLOT(transactionCompleted(UAVObject*,bool)));
+    }
+    inFlight.clear();
 }
 
 /**
@@ -276,29 +311,36 @@ void TelemetryMonitor::retrieveNextObject()
 void TelemetryMonitor::transactionCompleted(UAVObject* obj, bool success)
 {
     TELEMETRYMONITOR_QXTLOG_DEBUG(QString("%0 received %1 OBJID:%2 result:%3").arg(Q_FUNC_INFO).arg(obj->getName()).arg(obj->getObjID()).arg(success));
-    Q_UNUSED(success);
     QMutexLocker locker(mutex);
+    if ( !inFlight.contains(obj) )
+    {
+        return;
+    }
     if(obj->getObjID() == FirmwareIAPObj::OBJID)
     {
         if(!success && (retries < IAP_OBJECT_RETRIES))
         {
+            // Keep the request in flight until the retry completes
             ++retries;
             obj->requestUpdate();
+            return;
         }
     }
     // Disconnect from sending object
-    obj->disconnect(this);
-    // Process next object if telemetry is still available
+    disconnect(obj, SIGNAL(transactionCompleted(UAVObject*,bool)), this, SLOT(transactionCompleted(UAVObject*,bool)));
+    inFlight.remove(obj);
+    // Process next objects if telemetry is still available
     GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
     if ( gcsStats.Status == GCSTelemetryStats::STATUS_CONNECTED )
     {
         connectionStatus = CON_RETRIEVING_OBJECTS;
-        retrieveNextObject();
+        objectRetrieveTimeout->start(OBJECT_RETRIEVE_TIMEOUT);
+        retrieveObjects();
     }
     else
     {
         TELEMETRYMONITOR_QXTLOG_DEBUG(QString("%0 connection lost while retrieving objects, stopped object retrievel").arg(Q_FUNC_INFO));
-        queue.empty();
+        stopRetrievingObjects();
         objectRetrieveTimeout->stop();
         sessionRetrieveTimeout->stop();
         sessionInitialRetrieveTimeout->stop();
@@ -411,7 +453,13 @@ void TelemetryMonitor::sessionObjUnpackedCB(UAVObject *obj)
 
 void TelemetryMonitor::objectRetrieveTimeoutCB()
 {
-    queue.empty();
+    // Give up on the queued objects, connected is emitted when the requests in flight complete
+    TELEMETRYMONITOR_QXTLOG_DEBUG(QString("%0 object retrieve timeout, %1 objects not requested").arg(Q_FUNC_INFO).arg(queue.length()));
+    queue.clear();
+    if ( inFlight.isEmpty() )
+    {
+        retrieveObjects();
+    }
 }
 
 void TelemetryMonitor::sessionInitialRetrieveTimeoutCB()
@@ -594,6 +642,10 @@ void TelemetryMonitor::processStatsUpdates()
     gcsStats.RxFailures += telStats.rxErrors;
     gcsStats.TxFailures += telStats.txErrors;
     gcsStats.TxRetries += telStats.txRetries;
+    // Tell the flight side that our parser knows batched frames
+    gcsStats.BatchedFrames = GCSTelemetryStats::BATCHEDFRAMES_SUPPORTED;
+    // and deltas
+    gcsStats.DeltaEncoding = GCSTelemetryStats::DELTAENCODING_SUPPORTED;
 
     // Check for a connection timeout
     bool connectionTimeout;
@@ -636,6 +688,10 @@ void TelemetryMonitor::processStatsUpdates()
 
     emit telemetryUpdated((double)gcsStats.TxDataRate, (double)gcsStats.RxDataRate);
 
+    // Send deltas once the flight side is known to decode them
+    tel->setDeltaEncoding(gcsStats.Status == GCSTelemetryStats::STATUS_CONNECTED &&
+                          flightStats.DeltaEncoding == FlightTelemetryStats::DELTAENCODING_SUPPORTED);
+
     // Set data
     gcsStatsObj->setData(gcsStats);
 
@@ -670,6 +726,7 @@ void TelemetryMonitor::processStatsUpdates()
     {
         statsTimer->setInterval(STATS_CONNECT_PERIOD_MS);
         connectionStatus = CON_DISCONNECTED;
+        stopRetrievingObjects();
         ExtensionSystem::PluginManager* pm = ExtensionSystem::PluginManager::instance();
         Core::Internal::GeneralSettings * settings=pm->getObject<Core::Internal::GeneralSettings>();
         if (settings->useSessionManaging())
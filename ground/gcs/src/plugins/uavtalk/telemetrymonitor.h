@@ -31,6 +31,7 @@
 
 #include <QObject>
 #include <QQueue>
+#include <QSet>
 #include <QTimer>
 #include <QTime>
 #include <QMutex>
@@ -85,6 +86,7 @@ private:
     UAVObjectManager* objMngr;
     Telemetry* tel;
     QQueue<UAVObject*> queue;
+    QSet<UAVObject*> inFlight;
     GCSTelemetryStats* gcsStatsObj;
     FlightTelemetryStats* flightStatsObj;
     QTimer* statsTimer;
@@ -92,7 +94,8 @@ private:
     QTime* connectionTimer;
     SessionManaging* sessionObj;
     void startRetrievingObjects();
-    void retrieveNextObject();
+    void retrieveObjects();
+    void stopRetrievingObjects();
     quint16 sessionID;
     quint8 numberOfObjects;
     QTimer* objectRetrieveTimeout;
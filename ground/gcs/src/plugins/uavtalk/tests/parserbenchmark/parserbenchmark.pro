@@ -0,0 +1,20 @@
+# -------------------------------------------------
+# Benchmark of the UAVTalk input parser, one byte at a time against
+# whole blocks, built against the libraries of a configured GCS tree
+# -------------------------------------------------
+QT += network widgets testlib
+TARGET = parserbenchmark
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+include(../../../../../gcs.pri)
+
+INCLUDEPATH *= ../.. $$GCS_SOURCE_TREE/src/plugins
+LIBS += -L$$GCS_PLUGIN_PATH/TauLabs
+include(../../uavtalk_dependencies.pri)
+DEFINES += UAVTALK_LIBRARY
+
+SOURCES += tst_parserbenchmark.cpp \
+    ../../uavtalk.cpp
+HEADERS += ../../uavtalk.h
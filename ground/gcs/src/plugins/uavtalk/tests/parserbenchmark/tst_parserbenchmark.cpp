@@ -0,0 +1,164 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_parserbenchmark.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      Packets per second of the byte and block UAVTalk input parsers
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavtalk.h"
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include <coreplugin/generalsettings.h>
+#include <extensionsystem/pluginmanager.h>
+
+#include <QtCore/QObject>
+#include <QtCore/QBuffer>
+#include <QtCore/QElapsedTimer>
+#include <QtTest/QtTest>
+
+class tst_ParserBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void parse_data();
+    void parse();
+
+private:
+    // Size of the recorded stream, a few seconds of a fast link
+    static const int STREAM_SIZE = 256 * 1024;
+
+    ExtensionSystem::PluginManager *pm;
+    Core::Internal::GeneralSettings *settings;
+    UAVObjectManager *objMngr;
+    QByteArray stream;
+    int packets;
+
+    static void feed(UAVTalk *utalk, QByteArray &stream, int blockSize);
+};
+
+void tst_ParserBenchmark::initTestCase()
+{
+    // UAVTalk reads the UDP mirror option from the general settings
+    pm = new ExtensionSystem::PluginManager();
+    settings = new Core::Internal::GeneralSettings();
+    pm->addObject(settings);
+
+    objMngr = new UAVObjectManager();
+    UAVObjectsInitialize(objMngr);
+
+    // Record the updates of every object, over and over
+    QBuffer link(&stream);
+    link.open(QIODevice::WriteOnly);
+    UAVTalk sender(&link, objMngr);
+    packets = 0;
+    while (stream.size() < STREAM_SIZE) {
+        foreach (QVector<UAVDataObject*> instances, objMngr->getDataObjectsVector()) {
+            if (sender.sendObject(instances.first(), false, false))
+                ++packets;
+        }
+    }
+    QVERIFY(packets > 0);
+}
+
+void tst_ParserBenchmark::cleanupTestCase()
+{
+    delete objMngr;
+    pm->removeObject(settings);
+    delete settings;
+    delete pm;
+}
+
+/**
+ * Hand the stream to the parser the way processInputStream() does, in
+ * blocks of \a blockSize bytes, or one byte at a time if it is 0
+ */
+void tst_ParserBenchmark::feed(UAVTalk *utalk, QByteArray &stream, int blockSize)
+{
+    quint8 *data = (quint8 *)stream.data();
+    int length = stream.size();
+
+    if (blockSize == 0) {
+        for (int i = 0; i < length; ++i)
+            utalk->processInputByte(data[i]);
+        return;
+    }
+
+    for (int pos = 0; pos < length; pos += blockSize)
+        utalk->processInputBlock(&data[pos], qMin(blockSize, length - pos));
+}
+
+/**
+ * Parse one byte at a time, as before the block parser, and in blocks.
+ * The small blocks split many packets, which go through the byte state
+ * machine.
+ */
+void tst_ParserBenchmark::parse_data()
+{
+    QTest::addColumn<int>("blockSize");
+
+    QTest::newRow("bytes") << 0;
+    QTest::newRow("blocks of 64") << 64;
+    QTest::newRow("blocks of 16384") << 16384;
+}
+
+void tst_ParserBenchmark::parse()
+{
+    QFETCH(int, blockSize);
+
+    QBuffer link;
+    link.open(QIODevice::ReadWrite);
+    UAVTalk utalk(&link, objMngr);
+
+    // Every packet is parsed whatever the splitting
+    feed(&utalk, stream, blockSize);
+    UAVTalk::ComStats stats = utalk.getStats();
+    QCOMPARE((int)stats.rxObjects, packets);
+    QCOMPARE((int)stats.rxErrors, 0);
+    QCOMPARE((int)stats.rxBytes, stream.size());
+
+    QElapsedTimer timer;
+    qint64 runs = 0;
+    timer.start();
+    QBENCHMARK {
+        feed(&utalk, stream, blockSize);
+        ++runs;
+    }
+    qint64 elapsed = timer.nsecsElapsed();
+
+    qDebug("%d packets in %d bytes: %.0f packets/s",
+           packets, stream.size(), (double)packets * runs * 1e9 / elapsed);
+}
+
+QTEST_MAIN(tst_ParserBenchmark)
+
+#include "tst_parserbenchmark.moc"
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,22 @@
+# -------------------------------------------------
+# Test of the Telemetry object queues with the pending transaction
+# limit reached, built against the libraries of a configured GCS tree
+# -------------------------------------------------
+QT += network widgets testlib
+TARGET = telemetryqueue
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+include(../../../../../gcs.pri)
+
+INCLUDEPATH *= ../.. $$GCS_SOURCE_TREE/src/plugins
+LIBS += -L$$GCS_PLUGIN_PATH/TauLabs
+include(../../uavtalk_dependencies.pri)
+DEFINES += UAVTALK_LIBRARY
+
+SOURCES += tst_telemetryqueue.cpp \
+    ../../uavtalk.cpp \
+    ../../telemetry.cpp
+HEADERS += ../../uavtalk.h \
+    ../../telemetry.h
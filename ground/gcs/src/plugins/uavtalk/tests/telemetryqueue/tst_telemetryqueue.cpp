@@ -0,0 +1,163 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_telemetryqueue.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2014
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      Object requests completing while the transaction limit is reached
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "telemetry.h"
+#include "uavtalk.h"
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include "gcstelemetrystats.h"
+#include <coreplugin/generalsettings.h>
+#include <extensionsystem/pluginmanager.h>
+
+#include <QtCore/QObject>
+#include <QtCore/QBuffer>
+#include <QtTest/QtTest>
+
+class tst_TelemetryQueue : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void cleanup();
+    void repliesCompleteFullWindow();
+
+private:
+    // Telemetry::MAX_PENDING_TRANSACTIONS, plus one request left queued behind them
+    static const int PENDING = 8;
+    static const int REQUESTS = PENDING + 1;
+
+    ExtensionSystem::PluginManager *pm;
+    Core::Internal::GeneralSettings *settings;
+    UAVObjectManager *objMngr;
+    QBuffer *link;
+    UAVTalk *utalk;
+    Telemetry *tel;
+
+    static void reply(UAVObject *obj);
+};
+
+void tst_TelemetryQueue::initTestCase()
+{
+    // UAVTalk reads the UDP mirror option from the general settings
+    pm = new ExtensionSystem::PluginManager();
+    settings = new Core::Internal::GeneralSettings();
+    pm->addObject(settings);
+}
+
+void tst_TelemetryQueue::cleanupTestCase()
+{
+    pm->removeObject(settings);
+    delete settings;
+    delete pm;
+}
+
+void tst_TelemetryQueue::init()
+{
+    objMngr = new UAVObjectManager();
+    UAVObjectsInitialize(objMngr);
+
+    link = new QBuffer();
+    link->open(QIODevice::ReadWrite);
+    utalk = new UAVTalk(link, objMngr);
+    tel = new Telemetry(utalk, objMngr);
+
+    // Requests are only sent once the link is up
+    GCSTelemetryStats *gcsStatsObj = GCSTelemetryStats::GetInstance(objMngr);
+    GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
+    gcsStats.Status = GCSTelemetryStats::STATUS_CONNECTED;
+    gcsStatsObj->blockSignals(true);
+    gcsStatsObj->setData(gcsStats);
+    gcsStatsObj->blockSignals(false);
+}
+
+void tst_TelemetryQueue::cleanup()
+{
+    delete tel;
+    delete utalk;
+    delete link;
+    delete objMngr;
+}
+
+/**
+ * Answer a request the way UAVTalk does, by unpacking the object
+ */
+void tst_TelemetryQueue::reply(UAVObject *obj)
+{
+    QByteArray data(obj->getNumBytes(), 0);
+    obj->pack((quint8 *)data.data());
+    obj->unpack((const quint8 *)data.constData());
+}
+
+/**
+ * Fill the transaction window with requests and leave one more queued in
+ * front of the replies. Every reply must complete its request right away,
+ * before any of the transactions times out.
+ */
+void tst_TelemetryQueue::repliesCompleteFullWindow()
+{
+    QList<UAVDataObject *> objects;
+    foreach (QVector<UAVDataObject*> instances, objMngr->getDataObjectsVector()) {
+        UAVDataObject *obj = instances.first();
+        if (obj->isSettings() && obj->isSingleInstance())
+            objects.append(obj);
+        if (objects.size() == REQUESTS)
+            break;
+    }
+    QCOMPARE(objects.size(), REQUESTS);
+
+    QList<QSignalSpy *> spies;
+    foreach (UAVDataObject *obj, objects) {
+        spies.append(new QSignalSpy(obj, SIGNAL(transactionCompleted(UAVObject*,bool))));
+        obj->requestUpdate();
+    }
+
+    // The last request waits for a free transaction
+    for (int i = 0; i < REQUESTS; ++i)
+        QCOMPARE(spies[i]->count(), 0);
+
+    for (int i = 0; i < REQUESTS; ++i) {
+        reply(objects[i]);
+        QVERIFY2(spies[i]->count() == 1, qPrintable(objects[i]->getName()));
+        QCOMPARE(spies[i]->at(0).at(1).toBool(), true);
+    }
+
+    qDeleteAll(spies);
+}
+
+QTEST_MAIN(tst_TelemetryQueue)
+
+#include "tst_telemetryqueue.moc"
+
+/**
+ * @}
+ * @}
+ */
@@ -59,6 +59,25 @@ const quint8 UAVTalk::crc_table[256] = {
     0xde, 0xd9, 0xd0, 0xd7, 0xc2, 0xc5, 0xcc, 0xcb, 0xe6, 0xe1, 0xe8, 0xef, 0xfa, 0xfd, 0xf4, 0xf3
 };
 
+namespace {
+/**
+ * Tables for the slicing-by-8 CRC. table[k][i] is the CRC of byte i followed
+ * by k zero bytes, which lets eight input bytes be folded in with independent
+ * lookups instead of a chain of eight dependent ones.
+ */
+struct CRCSliceTables {
+    quint8 table[8][256];
+
+    CRCSliceTables(const quint8 *crc_table)
+    {
+        for (int i = 0; i < 256; ++i)
+            table[0][i] = crc_table[i];
+        for (int k = 1; k < 8; ++k)
+            for (int i = 0; i < 256; ++i)
+                table[k][i] = crc_table[table[k - 1][i]];
+    }
+};
+}
 
 /**
  * Constructor
@@ -72,6 +91,11 @@ UAVTalk::UAVTalk(QIODevice* iodev, UAVObjectManager* objMngr)
     rxState = STATE_SYNC;
     rxPacketLength = 0;
 
+    rxBlockBuffer.resize(RX_BLOCK_SIZE);
+    rxBlockActive = false;
+
+    deltaEncoding = false;
+
     mutex = new QMutex(QMutex::Recursive);
 
     memset(&stats, 0, sizeof(ComStats));
@@ -123,14 +147,21 @@ UAVTalk::ComStats UAVTalk::getStats()
  */
 void UAVTalk::processInputStream()
 {
-    quint8 tmp;
+    // A slot connected to a received object may spin a nested event loop.
+    // The outer call keeps draining the device, so don't interleave blocks.
+    if (rxBlockActive)
+        return;
 
     if (io && io->isReadable()) {
-        while (io->bytesAvailable() > 0)
+        rxBlockActive = true;
+        while (io && io->bytesAvailable() > 0)
         {
-            io->read((char*)&tmp, 1);
-            processInputByte(tmp);
+            qint64 length = io->read(rxBlockBuffer.data(), qMin<qint64>(io->bytesAvailable(), RX_BLOCK_SIZE));
+            if (length <= 0)
+                break;
+            processInputBlock((quint8*)rxBlockBuffer.data(), length);
         }
+        rxBlockActive = false;
     }
 }
 
@@ -178,6 +209,31 @@ bool UAVTalk::sendObject(UAVObject* obj, bool acked, bool allInstances)
     }
 }
 
+/**
+ * Enable or disable the delta encoding of the objects flagged for it. When
+ * it changes the next update of every object is sent in full.
+ * \param[in] enable True if the other end can decode deltas
+ */
+void UAVTalk::setDeltaEncoding(bool enable)
+{
+    QMutexLocker locker(mutex);
+    if (enable == deltaEncoding)
+        return;
+    deltaRefs.clear();
+    deltaEncoding = enable;
+}
+
+/**
+ * Send the next update of all instances of an object in full, e.g. before
+ * retrying an update which may not have been applied.
+ * \param[in] obj Object
+ */
+void UAVTalk::resetDeltaEncoding(UAVObject* obj)
+{
+    QMutexLocker locker(mutex);
+    resetDelta(obj);
+}
+
 /**
  * Execute the requested transaction on an object.
  * \param[in] obj Object
@@ -302,6 +358,22 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
 
             // Search for object, if not found reset state machine
             rxObjId = (qint32)qFromLittleEndian<quint32>(rxTmpBuffer);
+            if (rxType == TYPE_OBJ_BATCH)
+            {
+                // The records of a batched frame take the rest of the packet
+                rxLength = packetSize - rxPacketLength;
+                if (rxLength >= MAX_PAYLOAD_LENGTH)
+                {
+                    stats.rxErrors++;
+                    rxState = STATE_SYNC;
+                    UAVTALK_QXTLOG_DEBUG("UAVTalk: ObjID->Sync (oversize)");
+                    break;
+                }
+                rxState = (rxLength > 0) ? STATE_DATA : STATE_CS;
+                rxInstId = 0;
+                rxCount = 0;
+                break;
+            }
             {
                 UAVObject *rxObj = objMngr->getObject(rxObjId);
                 if (rxObj == NULL && rxType != TYPE_OBJ_REQ)
@@ -318,15 +390,25 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
                    rxState   = STATE_CS;
                    UAVTALK_QXTLOG_DEBUG("UAVTalk: ObjID->CSum (no obj)");
                    rxInstId = 0;
+                   rxLength = 0;
                    rxCount = 0;
                    break;
                 }
 
+                // NACKs never carry an instance ID
+                bool rxSingleInstance = rxObj->isSingleInstance() || rxType == TYPE_NACK;
+                quint8 rxInstanceLength = (rxSingleInstance ? 0 : 2);
+
                 // Determine data length
                 if (rxType == TYPE_OBJ_REQ || rxType == TYPE_ACK || rxType == TYPE_NACK)
                 {
                     rxLength = 0;
                 }
+                else if (rxType == TYPE_OBJ_DELTA || rxType == TYPE_OBJ_ACK_DELTA)
+                {
+                    // A delta takes the rest of the packet
+                    rxLength = packetSize - rxPacketLength - rxInstanceLength;
+                }
                 else
                 {
                     rxLength = rxObj->getNumBytes();
@@ -341,7 +423,6 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
                     break;
                 }
 
-                quint8 rxInstanceLength = (rxObj->isSingleInstance() ? 0 : 2);
                 if ((rxPacketLength + rxInstanceLength + rxLength) != packetSize)
                 {   // packet error - mismatched packet size
                     stats.rxErrors++;
@@ -350,7 +431,7 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
                     break;
                 }
 
-                if (rxObj->isSingleInstance())
+                if (rxSingleInstance)
                 {   // Check if this is a single instance object (i.e. if the instance ID field is coming next)
                     // If there is a payload get it, otherwise receive checksum
                     if (rxLength > 0)
@@ -407,9 +488,7 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
 
         case STATE_DATA:
 
-            // Update CRC
-            rxCS = updateCRC(rxCS, rxbyte);
-
+            // The CRC over the payload is computed once it is complete
             rxBuffer[rxCount++] = rxbyte;
             if (rxCount < rxLength)
             {
@@ -424,6 +503,10 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
 
         case STATE_CS:
 
+            // Update CRC with the payload
+            if (rxLength > 0)
+                rxCS = updateCRC(rxCS, rxBuffer, rxLength);
+
             // The CRC byte
             rxCSPacket = rxbyte;
 
@@ -444,7 +527,10 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
             }
 
             mutex->lock();
-                receiveObject(rxType, rxObjId, rxInstId, rxBuffer, rxLength);
+                if (rxType == TYPE_OBJ_BATCH)
+                    receiveBatch(rxBuffer, rxLength);
+                else
+                    receiveObject(rxType, rxObjId, rxInstId, rxBuffer, rxLength);
                 if(useUDPMirror)
                 {
                     udpSocketTx->writeDatagram(rxDataArray,QHostAddress::LocalHost,udpSocketRx->localPort());
@@ -467,9 +553,152 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
     return true;
 }
 
+/**
+ * Process a block of bytes from the telemetry stream.
+ *
+ * Whole packets that are contiguous in the block are validated and dispatched
+ * in one go. A packet that is split across two reads is handed to the byte
+ * state machine, which keeps its progress until the next block arrives.
+ * \param[in] data Received bytes
+ * \param[in] length Number of bytes in \a data
+ */
+void UAVTalk::processInputBlock(quint8 *data, qint64 length)
+{
+    qint64 pos = 0;
+
+    while (pos < length)
+    {
+        // Let the state machine finish a packet it has already started
+        if (rxState != STATE_SYNC)
+        {
+            processInputByte(data[pos++]);
+            continue;
+        }
+
+        // Skip everything up to the next sync byte
+        quint8 *sync = (quint8*)memchr(&data[pos], SYNC_VAL, length - pos);
+        if (sync == NULL)
+        {
+            stats.rxBytes += length - pos;
+            break;
+        }
+        stats.rxBytes += sync - &data[pos];
+        pos = sync - data;
+
+        qint32 consumed = processInputPacket(&data[pos], length - pos);
+        if (consumed > 0)
+        {
+            pos += consumed;
+        }
+        else if (consumed == 0)
+        {
+            // Fragmented packet, start the state machine on it
+            processInputByte(data[pos++]);
+        }
+        else
+        {
+            // Not a valid packet, resume the search after this sync byte
+            stats.rxBytes++;
+            pos++;
+        }
+    }
+}
+
+/**
+ * Validate and dispatch a packet which starts with a sync byte.
+ * \param[in] data Buffer starting at the sync byte
+ * \param[in] length Number of bytes available in \a data
+ * \return Number of bytes consumed, 0 if the packet is not complete yet or
+ * -1 if there is no valid packet at this position
+ */
+qint32 UAVTalk::processInputPacket(quint8 *data, qint64 length)
+{
+    if (length < MIN_HEADER_LENGTH)
+        return 0;
+
+    quint8 type = data[1];
+    if ((type & TYPE_MASK) != TYPE_VER)
+        return -1;
+
+    qint32 size = qFromLittleEndian<quint16>(&data[2]);
+    if (size < MIN_HEADER_LENGTH || size > MAX_HEADER_LENGTH + MAX_PAYLOAD_LENGTH)
+        return -1;
+
+    quint32 objId = qFromLittleEndian<quint32>(&data[4]);
+    UAVObject *obj = objMngr->getObject(objId);
+    qint32 dataOffset = MIN_HEADER_LENGTH;
+    qint32 dataLength = 0;
+    if (type == TYPE_OBJ_BATCH)
+    {
+        // The records of a batched frame take the rest of the packet
+        dataLength = size - MIN_HEADER_LENGTH;
+        if (dataLength >= MAX_PAYLOAD_LENGTH)
+        {
+            stats.rxErrors++;
+            return -1;
+        }
+    }
+    else if (obj == NULL)
+    {
+        // Only requests for unknown objects are answered (with a NACK)
+        if (type != TYPE_OBJ_REQ || size != MIN_HEADER_LENGTH)
+        {
+            stats.rxErrors++;
+            return -1;
+        }
+    }
+    else
+    {
+        // NACKs never carry an instance ID
+        if (!obj->isSingleInstance() && type != TYPE_NACK)
+            dataOffset += 2;
+        if (type == TYPE_OBJ_DELTA || type == TYPE_OBJ_ACK_DELTA)
+            dataLength = size - dataOffset; // A delta takes the rest of the packet
+        else if (type != TYPE_OBJ_REQ && type != TYPE_ACK && type != TYPE_NACK)
+            dataLength = obj->getNumBytes();
+
+        if (dataLength < 0 || dataLength >= MAX_PAYLOAD_LENGTH || dataOffset + dataLength != size)
+        {
+            stats.rxErrors++;
+            return -1;
+        }
+    }
+
+    if (length < size + CHECKSUM_LENGTH)
+        return 0;
+
+    if (updateCRC(0, data, size) != data[size])
+    {
+        stats.rxErrors++;
+        return -1;
+    }
+
+    quint16 instId = 0;
+    if (dataOffset > MIN_HEADER_LENGTH)
+        instId = qFromLittleEndian<quint16>(&data[MIN_HEADER_LENGTH]);
+
+    stats.rxBytes += size + CHECKSUM_LENGTH;
+
+    mutex->lock();
+        if (type == TYPE_OBJ_BATCH)
+            receiveBatch(&data[dataOffset], dataLength);
+        else
+            receiveObject(type, objId, instId, &data[dataOffset], dataLength);
+        if(useUDPMirror)
+        {
+            udpSocketTx->writeDatagram((const char*)data, size + CHECKSUM_LENGTH, QHostAddress::LocalHost, udpSocketRx->localPort());
+        }
+        stats.rxObjectBytes += dataLength;
+        stats.rxObjects++;
+    mutex->unlock();
+
+    return size + CHECKSUM_LENGTH;
+}
+
 /**
  * Receive an object. This function process objects received through the telemetry stream.
- * \param[in] type Type of received message (TYPE_OBJ, TYPE_OBJ_REQ, TYPE_OBJ_ACK, TYPE_ACK, TYPE_NACK)
+ * \param[in] type Type of received message (TYPE_OBJ, TYPE_OBJ_REQ, TYPE_OBJ_ACK, TYPE_ACK, TYPE_NACK,
+ *                 TYPE_OBJ_DELTA, TYPE_OBJ_ACK_DELTA)
  * \param[in] obj Handle of the received object
  * \param[in] instId The instance ID of UAVOBJ_ALL_INSTANCES for all instances.
  * \param[in] data Data buffer
@@ -478,7 +707,6 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
  */
 bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, quint8* data, qint32 length)
 {
-    Q_UNUSED(length);
     UAVObject* obj = NULL;
     bool error = false;
     bool allInstances =  (instId == ALL_INSTANCES);
@@ -526,6 +754,31 @@ bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, quint8*
             error = true;
         }
         break;
+    case TYPE_OBJ_DELTA: // We have received the changes of an object update
+    case TYPE_OBJ_ACK_DELTA:
+        // All instances, not allowed for delta messages
+        if (!allInstances)
+        {
+            // Deltas apply to the current data of an existing instance
+            obj = objMngr->getObject(objId, instId);
+            if (obj != NULL && receiveDelta(obj, data, length))
+            {
+                if (type == TYPE_OBJ_ACK_DELTA)
+                    transmitObject(obj, TYPE_ACK, false);
+            }
+            else
+            {
+                // Ask the other end to send the object in full
+                UAVTALK_QXTLOG_DEBUG(QString("[uavtalk.cpp  ] Received a delta which doesn't match the UAVObject OBJID:%0 INSTID:%1").arg(QString(QString("0x") + QString::number(objId, 16).toUpper())).arg(instId));
+                transmitNack(objId);
+                error = true;
+            }
+        }
+        else
+        {
+            error = true;
+        }
+        break;
     case TYPE_OBJ_REQ:  // We are being asked for an object
         // Get object, if all instances are requested get instance 0 of the object
         if (allInstances)
@@ -557,7 +810,11 @@ bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, quint8*
             // Get object
             obj = objMngr->getObject(objId, instId);
             // Check if object exists:
-            if (obj != NULL)
+            if (obj != NULL && resendFull(obj))
+            {
+                UAVTALK_QXTLOG_DEBUG(QString("[uavtalk.cpp  ] The %0 UAVObject could not apply a delta, sent it in full").arg(obj->getName()));
+            }
+            else if (obj != NULL)
             {
                 UAVTALK_QXTLOG_DEBUG(QString("[uavtalk.cpp  ] The %0 UAVObject does not exist on the remote end, got a Nack").arg(obj->getName() + QString(QString(" 0x") + QString::number(objId, 16).toUpper())));
                 emit nackReceived(obj);
@@ -596,6 +853,51 @@ bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, quint8*
     return !error;
 }
 
+/**
+ * Receive the objects of a batched frame. Every record is handed to
+ * receiveObject() as a separate TYPE_OBJ message.
+ * \param[in] data Payload of the frame
+ * \param[in] length Payload length
+ * \return Success (true), Failure (false) if a record is malformed or unknown
+ */
+bool UAVTalk::receiveBatch(quint8* data, qint32 length)
+{
+    bool error = false;
+    qint32 pos = 0;
+
+    while (pos + BATCH_RECORD_HEADER_LENGTH <= length)
+    {
+        quint32 objId = qFromLittleEndian<quint32>(&data[pos]);
+        qint32 recordLength = data[pos + 4];
+        pos += BATCH_RECORD_HEADER_LENGTH;
+
+        if (pos + recordLength > length)
+            return false;
+
+        // Skip the objects we don't know or whose size doesn't match
+        UAVObject *obj = objMngr->getObject(objId);
+        qint32 instanceLength = (obj != NULL && !obj->isSingleInstance()) ? 2 : 0;
+        if (obj != NULL && recordLength == instanceLength + (qint32)obj->getNumBytes())
+        {
+            quint16 instId = 0;
+            if (instanceLength > 0)
+                instId = qFromLittleEndian<quint16>(&data[pos]);
+            if (!receiveObject(TYPE_OBJ, objId, instId, &data[pos + instanceLength], recordLength - instanceLength))
+                error = true;
+        }
+        else
+        {
+            UAVTALK_QXTLOG_DEBUG(QString("[uavtalk.cpp  ] Skipped a batched record of an unknown UAVObject:%0").arg(QString(QString("0x") + QString::number(objId, 16).toUpper())));
+            error = true;
+        }
+
+        pos += recordLength;
+    }
+
+    // Done (exit value is "success", hence the "!" below)
+    return !error && pos == length;
+}
+
 /**
  * Update the data of an object from a byte array (unpack).
  * If the object instance could not be found in the list, then a
@@ -796,10 +1098,12 @@ bool UAVTalk::transmitSingleObject(UAVObject* obj, quint8 type, bool allInstance
     // Copy data (if any)
     if (length > 0)
     {
-        if ( !obj->pack(&txBuffer[dataOffset]) )
+        length = packDelta(obj, &type, &txBuffer[dataOffset]);
+        if (length < 0)
         {
             return false;
         }
+        txBuffer[1] = type;
     }
 
     qToLittleEndian<quint16>(dataOffset + length, &txBuffer[2]);
@@ -831,6 +1135,228 @@ bool UAVTalk::transmitSingleObject(UAVObject* obj, quint8 type, bool allInstance
     return true;
 }
 
+/**
+ * Run length encode the changes between two updates of an object. Runs of
+ * unchanged bytes are skipped, changed bytes are XORed with the reference.
+ * \param[in] ref The last update sent
+ * \param[in] update The new update
+ * \param[in] length Length of the updates
+ * \param[out] out Encoded delta
+ * \param[in] maxLength Space available in \a out
+ * \return Length of the delta, -1 if it doesn't fit
+ */
+qint32 UAVTalk::encodeDelta(const quint8* ref, const quint8* update, qint32 length, quint8* out, qint32 maxLength)
+{
+    qint32 outLength = 0;
+    qint32 unchanged = 0;
+    qint32 pos = 0;
+
+    while (pos < length)
+    {
+        if (ref[pos] == update[pos])
+        {
+            ++unchanged;
+            ++pos;
+            continue;
+        }
+
+        // Flush the unchanged bytes before this change, trailing ones are never sent
+        while (unchanged > 0)
+        {
+            qint32 run = (unchanged < DELTA_MAX_RUN) ? unchanged : DELTA_MAX_RUN;
+            if (outLength + 1 > maxLength)
+                return -1;
+            out[outLength++] = DELTA_RUN_UNCHANGED | (run - 1);
+            unchanged -= run;
+        }
+
+        // A single unchanged byte between two changes is cheaper to copy than to skip
+        qint32 run = 0;
+        while (pos + run < length && run < DELTA_MAX_RUN &&
+               (ref[pos + run] != update[pos + run] ||
+                (pos + run + 1 < length && ref[pos + run + 1] != update[pos + run + 1])))
+            ++run;
+
+        if (outLength + 1 + run > maxLength)
+            return -1;
+        out[outLength++] = run - 1;
+        for (qint32 i = 0; i < run; ++i)
+            out[outLength++] = ref[pos + i] ^ update[pos + i];
+        pos += run;
+    }
+
+    return outLength;
+}
+
+/**
+ * Apply a run length encoded delta, see encodeDelta()
+ * \param[in,out] data The reference, updated in place
+ * \param[in] length Length of the data
+ * \param[in] in Encoded delta
+ * \param[in] inLength Length of the delta
+ * \return Success (true), Failure (false) if the delta doesn't fit the data
+ */
+bool UAVTalk::decodeDelta(quint8* data, qint32 length, const quint8* in, qint32 inLength)
+{
+    qint32 pos = 0;
+    qint32 i = 0;
+
+    while (i < inLength)
+    {
+        quint8 control = in[i++];
+        qint32 run = (control & ~DELTA_RUN_UNCHANGED) + 1;
+        if (pos + run > length)
+            return false;
+
+        if ((control & DELTA_RUN_UNCHANGED) == 0)
+        {
+            if (i + run > inLength)
+                return false;
+            for (qint32 j = 0; j < run; ++j)
+                data[pos + j] ^= in[i + j];
+            i += run;
+        }
+        pos += run;
+    }
+
+    return true;
+}
+
+/**
+ * Pack an object update, as a delta against the last update sent of the
+ * instance when delta encoding is enabled and the delta is shorter.
+ * \param[in] obj Object instance to send
+ * \param[in,out] type Transaction type, changed to the delta type if a delta is packed
+ * \param[out] dataOut The packed update
+ * \return Number of bytes packed, -1 on failure
+ */
+qint32 UAVTalk::packDelta(UAVObject* obj, quint8* type, quint8* dataOut)
+{
+    qint32 numBytes = obj->getNumBytes();
+    UAVDataObject* dobj = dynamic_cast<UAVDataObject*>(obj);
+
+    if (!deltaEncoding || dobj == NULL || !dobj->isDeltaEncoded() ||
+            (*type != TYPE_OBJ && *type != TYPE_OBJ_ACK))
+    {
+        return obj->pack(dataOut) ? numBytes : -1;
+    }
+
+    QByteArray update(numBytes, 0);
+    if (!obj->pack((quint8*)update.data()))
+        return -1;
+
+    DeltaRef &ref = deltaRefs[((quint64)obj->getObjID() << 16) | obj->getInstID()];
+    bool acked = (*type == TYPE_OBJ_ACK);
+
+    // Acked updates recover from a lost delta through the NACK
+    bool keyframe = !acked && ref.sinceFull >= DELTA_KEYFRAME_INTERVAL - 1;
+
+    qint32 length = -1;
+    if (ref.data.size() == numBytes && !keyframe && numBytes > DELTA_HEADER_LENGTH + 1)
+    {
+        length = encodeDelta((const quint8*)ref.data.constData(), (const quint8*)update.constData(), numBytes,
+                             &dataOut[DELTA_HEADER_LENGTH], numBytes - DELTA_HEADER_LENGTH - 1);
+    }
+
+    if (length >= 0)
+    {
+        dataOut[0] = updateCRC(0, (const quint8*)ref.data.constData(), numBytes);
+        dataOut[1] = updateCRC(0, (const quint8*)update.constData(), numBytes);
+        length += DELTA_HEADER_LENGTH;
+        *type = acked ? TYPE_OBJ_ACK_DELTA : TYPE_OBJ_DELTA;
+        ++ref.sinceFull;
+        ref.sentDelta = true;
+        ref.acked = acked;
+    }
+    else
+    {
+        memcpy(dataOut, update.constData(), numBytes);
+        length = numBytes;
+        ref.sinceFull = 0;
+        ref.sentDelta = false;
+    }
+
+    ref.data = update;
+    return length;
+}
+
+/**
+ * Apply a received delta to the current data of an object instance.
+ * \param[in] obj Object instance
+ * \param[in] data The delta
+ * \param[in] length Length of the delta
+ * \return Success (true), Failure (false) if the delta is not based on the current data
+ */
+bool UAVTalk::receiveDelta(UAVObject* obj, quint8* data, qint32 length)
+{
+    qint32 numBytes = obj->getNumBytes();
+    if (length < DELTA_HEADER_LENGTH)
+        return false;
+
+    QByteArray update(numBytes, 0);
+    quint8* updateData = (quint8*)update.data();
+    if (!obj->pack(updateData) || updateCRC(0, updateData, numBytes) != data[0])
+        return false;
+
+    if (!decodeDelta(updateData, numBytes, &data[DELTA_HEADER_LENGTH], length - DELTA_HEADER_LENGTH) ||
+            updateCRC(0, updateData, numBytes) != data[1])
+        return false;
+
+    obj->unpack(updateData);
+    return true;
+}
+
+/**
+ * Send the next update of all instances of an object in full.
+ * \param[in] obj Object
+ */
+void UAVTalk::resetDelta(UAVObject* obj)
+{
+    QHash<quint64, DeltaRef>::iterator it = deltaRefs.begin();
+    while (it != deltaRefs.end())
+    {
+        if ((it.key() >> 16) == obj->getObjID())
+            it = deltaRefs.erase(it);
+        else
+            ++it;
+    }
+}
+
+/**
+ * Handle a NACK for an object. If a delta of the object was sent the other end
+ * could not apply it, the acked instances are then sent again in full.
+ * \param[in] obj Object
+ * \return True if the NACK was for a delta, false if the object doesn't exist on the other end
+ */
+bool UAVTalk::resendFull(UAVObject* obj)
+{
+    QList<quint16> ackedInstances;
+    bool sentDelta = false;
+    foreach (quint64 key, deltaRefs.keys())
+    {
+        const DeltaRef &ref = deltaRefs[key];
+        if ((key >> 16) == obj->getObjID() && ref.sentDelta)
+        {
+            sentDelta = true;
+            if (ref.acked)
+                ackedInstances.append(key & 0xFFFF);
+        }
+    }
+
+    // Objects the other end doesn't know are NACKed as well, only
+    // answer a NACK once so that the two ends can't ping pong.
+    resetDelta(obj);
+
+    foreach (quint16 instId, ackedInstances)
+    {
+        UAVObject* inst = objMngr->getObject(obj->getObjID(), instId);
+        if (inst != NULL)
+            transmitSingleObject(inst, TYPE_OBJ_ACK, false);
+    }
+
+    return sentDelta;
+}
+
 /**
  * Update the crc value with new data.
  *
@@ -855,6 +1381,17 @@ quint8 UAVTalk::updateCRC(quint8 crc, const quint8 data)
 }
 quint8 UAVTalk::updateCRC(quint8 crc, const quint8* data, qint32 length)
 {
+    static const CRCSliceTables slice(crc_table);
+    const quint8 (*t)[256] = slice.table;
+
+    while (length >= 8)
+    {
+        crc = t[7][crc ^ data[0]] ^ t[6][data[1]] ^ t[5][data[2]] ^ t[4][data[3]] ^
+              t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+        data += 8;
+        length -= 8;
+    }
+
     while (length--)
         crc = crc_table[crc ^ *data++];
     return crc;
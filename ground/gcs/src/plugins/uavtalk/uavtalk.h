@@ -61,7 +61,14 @@ public:
     ComStats getStats();
     void resetStats();
 
+    void setDeltaEncoding(bool enable);
+    void resetDeltaEncoding(UAVObject* obj);
+
     bool processInputByte(quint8 rxbyte);
+    void processInputBlock(quint8 *data, qint64 length);
+
+    static quint8 updateCRC(quint8 crc, const quint8 data);
+    static quint8 updateCRC(quint8 crc, const quint8* data, qint32 length);
 
 signals:
     // The only signals we send to the upper level are when we
@@ -83,12 +90,26 @@ protected:
     static const int TYPE_OBJ_ACK = (TYPE_VER | 0x02);
     static const int TYPE_ACK = (TYPE_VER | 0x03);
     static const int TYPE_NACK = (TYPE_VER | 0x04);
+    static const int TYPE_OBJ_BATCH = (TYPE_VER | 0x05);
+    static const int TYPE_OBJ_DELTA = (TYPE_VER | 0x06);
+    static const int TYPE_OBJ_ACK_DELTA = (TYPE_VER | 0x07);
 
     static const int MIN_HEADER_LENGTH = 8; // sync(1), type (1), size(2), object ID(4)
     static const int MAX_HEADER_LENGTH = 10; // sync(1), type (1), size(2), object ID (4), instance ID(2, not used in single objects)
 
     static const int CHECKSUM_LENGTH = 1;
 
+    // A batched frame holds records of object ID(4), length(1), instance ID (2, not used in single objects) and data
+    static const int BATCH_RECORD_HEADER_LENGTH = 5;
+
+    // A delta holds the CRC of the update it applies to, the CRC of the result and runs
+    // of unchanged bytes or of changed bytes XORed with the update it applies to
+    static const int DELTA_HEADER_LENGTH = 2;
+    static const quint8 DELTA_RUN_UNCHANGED = 0x80;
+    static const int DELTA_MAX_RUN = 128;
+    // Deltas which are not acked are followed by a full update at this interval
+    static const int DELTA_KEYFRAME_INTERVAL = 16;
+
     static const int MAX_PAYLOAD_LENGTH = 256;
 
     static const int MAX_PACKET_LENGTH = (MAX_HEADER_LENGTH + MAX_PAYLOAD_LENGTH + CHECKSUM_LENGTH);
@@ -97,11 +118,20 @@ protected:
     static const quint16 OBJID_NOTFOUND = 0x0000;
 
     static const int TX_BUFFER_SIZE = 2*1024;
+    static const int RX_BLOCK_SIZE = 16*1024;
     static const quint8 crc_table[256];
 
     // Types
     typedef enum {STATE_SYNC, STATE_TYPE, STATE_SIZE, STATE_OBJID, STATE_INSTID, STATE_DATA, STATE_CS} RxStateType;
 
+    // Last update sent of a delta encoded object instance
+    typedef struct {
+        QByteArray data;
+        int sinceFull;
+        bool sentDelta;
+        bool acked;
+    } DeltaRef;
+
     // Variables
     QPointer<QIODevice> io;
     UAVObjectManager* objMngr;
@@ -127,15 +157,29 @@ protected:
     QUdpSocket * udpSocketRx;
     QByteArray rxDataArray;
 
+    // Variables used by the block parser
+    QByteArray rxBlockBuffer;
+    bool rxBlockActive;
+
+    // Variables used by the delta encoding, the references are keyed by object and instance ID
+    bool deltaEncoding;
+    QHash<quint64, DeltaRef> deltaRefs;
+
     // Methods
+    qint32 processInputPacket(quint8 *data, qint64 length);
     bool objectTransaction(UAVObject* obj, quint8 type, bool allInstances);
     virtual bool receiveObject(quint8 type, quint32 objId, quint16 instId, quint8* data, qint32 length);
+    bool receiveBatch(quint8* data, qint32 length);
     UAVObject* updateObject(quint32 objId, quint16 instId, quint8* data);
     bool transmitNack(quint32 objId);
     bool transmitObject(UAVObject* obj, quint8 type, bool allInstances);
     bool transmitSingleObject(UAVObject* obj, quint8 type, bool allInstances);
-    quint8 updateCRC(quint8 crc, const quint8 data);
-    quint8 updateCRC(quint8 crc, const quint8* data, qint32 length);
+    qint32 packDelta(UAVObject* obj, quint8* type, quint8* dataOut);
+    bool receiveDelta(UAVObject* obj, quint8* data, qint32 length);
+    void resetDelta(UAVObject* obj);
+    bool resendFull(UAVObject* obj);
+    static qint32 encodeDelta(const quint8* ref, const quint8* update, qint32 length, quint8* out, qint32 maxLength);
+    static bool decodeDelta(quint8* data, qint32 length, const quint8* in, qint32 inLength);
 };
 
 #endif // UAVTALK_H
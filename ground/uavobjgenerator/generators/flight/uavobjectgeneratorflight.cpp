@@ -28,12 +28,18 @@
 
 using namespace std;
 
+static bool idLessThan(const ObjectInfo *a, const ObjectInfo *b)
+{
+    return a->id < b->id;
+}
+
 bool UAVObjectGeneratorFlight::generate(UAVObjectParser* parser,QString templatepath,QString outputpath) {
 
     fieldTypeStrC << "int8_t" << "int16_t" << "int32_t" <<"uint8_t"
             <<"uint16_t" << "uint32_t" << "float" << "uint8_t";
 
-    QString flightObjInit,objInc,objFileNames,objNames;
+    QString flightObjInit,objInc,objFileNames,objNames,objIds;
+    QList<ObjectInfo*> sortedObjects;
     qint32 sizeCalc;
     flightCodePath = QDir( templatepath + QString("flight/UAVObjects"));
     flightOutputPath = QDir( outputpath + QString("flight") );
@@ -43,9 +49,11 @@ bool UAVObjectGeneratorFlight::generate(UAVObjectParser* parser,QString template
     flightIncludeTemplate = readFile( flightCodePath.absoluteFilePath("inc/uavobjecttemplate.h") );
     flightInitTemplate = readFile( flightCodePath.absoluteFilePath("uavobjectsinittemplate.c") );
     flightInitIncludeTemplate = readFile( flightCodePath.absoluteFilePath("inc/uavobjectsinittemplate.h") );
+    flightIdsIncludeTemplate = readFile( flightCodePath.absoluteFilePath("inc/uavobjectidstemplate.h") );
     flightMakeTemplate = readFile( flightCodePath.absoluteFilePath("Makefiletemplate.inc") );
 
-    if ( flightCodeTemplate.isNull() || flightIncludeTemplate.isNull() || flightInitTemplate.isNull()) {
+    if ( flightCodeTemplate.isNull() || flightIncludeTemplate.isNull() || flightInitTemplate.isNull() ||
+            flightIdsIncludeTemplate.isNull()) {
             cerr << "Error: Could not open flight template files." << endl;
             return false;
         }
@@ -63,6 +71,15 @@ bool UAVObjectGeneratorFlight::generate(UAVObjectParser* parser,QString template
 	if (parser->getNumBytes(objidx)>sizeCalc) {
 		sizeCalc = parser->getNumBytes(objidx);
 	}
+        sortedObjects.append(info);
+    }
+
+    // Objects are only in the ID table of the firmwares they are built into
+    qSort(sortedObjects.begin(), sortedObjects.end(), idLessThan);
+    foreach (ObjectInfo *info, sortedObjects) {
+        objIds.append("#ifdef UAVOBJ_INIT_" + info->namelc + "\r\n");
+        objIds.append(QString("    0x%1, /* %2 */\r\n").arg(info->id, 8, 16, QChar('0')).arg(info->name));
+        objIds.append("#endif\r\n");
     }
 
     // Write the flight object inialization files
@@ -84,6 +101,15 @@ bool UAVObjectGeneratorFlight::generate(UAVObjectParser* parser,QString template
         return false;
     }
 
+    // Write the flight object ID table
+    flightIdsIncludeTemplate.replace( QString("$(OBJIDS)"), objIds);
+    res = writeFileIfDiffrent( flightOutputPath.absolutePath() + "/uavobjectids.h",
+                     flightIdsIncludeTemplate );
+    if (!res) {
+        cout << "Error: Could not write flight object ID header file" << endl;
+        return false;
+    }
+
     // Write the flight object Makefile
     flightMakeTemplate.replace( QString("$(UAVOBJFILENAMES)"), objFileNames);
     flightMakeTemplate.replace( QString("$(UAVOBJNAMES)"), objNames);
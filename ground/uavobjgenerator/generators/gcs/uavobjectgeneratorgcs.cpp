@@ -208,6 +208,7 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo* info)
                                 "   mutex->lock();\n"
                                 "   bool changed = data.%2[%5] != value;\n"
                                 "   data.%2[%5] = value;\n"
+                                "   if (changed) notifiedData.%2[%5] = value;\n"
                                 "   mutex->unlock();\n"
                                 "   if (changed) emit %2_%3Changed(value);\n"
                                 "}\n\n")
@@ -216,8 +217,8 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo* info)
                         QString("    void %1_%2Changed(%3 value);\n")
                         .arg(field->name).arg(elementName).arg(type);
                 propertyNotificationsImpl +=
-                        QString("        //if (data.%1[%2] != oldData.%1[%2])\n"
-                                "            emit %1_%3Changed(data.%1[%2]);\n")
+                        QString("    if (memcmp(&current.%1[%2], &previous.%1[%2], sizeof(current.%1[%2])) != 0)\n"
+                                "        emit %1_%3Changed(current.%1[%2]);\n")
                         .arg(field->name).arg(elementIndex).arg(elementName);
             }
         } else {
@@ -242,6 +243,7 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo* info)
                             "   mutex->lock();\n"
                             "   bool changed = data.%2 != value;\n"
                             "   data.%2 = value;\n"
+                            "   if (changed) notifiedData.%2 = value;\n"
                             "   mutex->unlock();\n"
                             "   if (changed) emit %2Changed(value);\n"
                             "}\n\n")
@@ -250,8 +252,8 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo* info)
                     QString("    void %1Changed(%2 value);\n")
                     .arg(field->name).arg(type);
             propertyNotificationsImpl +=
-                    QString("        //if (data.%1 != oldData.%1)\n"
-                            "            emit %1Changed(data.%1);\n")
+                    QString("    if (memcmp(&current.%1, &previous.%1, sizeof(current.%1)) != 0)\n"
+                            "        emit %1Changed(current.%1);\n")
                     .arg(field->name);
         }
     }
@@ -264,6 +266,54 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo* info)
     outCode.replace(QString("$(PROPERTIES_IMPL)"), propertiesImpl);
     outCode.replace(QString("$(NOTIFY_PROPERTIES_CHANGED)"), propertyNotificationsImpl);
 
+    // Replace the $(PACKFIELDS) and $(UNPACKFIELDS) tags, the byte swapping
+    // used in place of the single copy on big endian hosts
+    QString packFields;
+    QString unpackFields;
+    int offset = 0;
+    for (int n = 0; n < info->fields.length(); ++n)
+    {
+        FieldInfo *field = info->fields[n];
+        QString element = field->numElements > 1 ? QString("%1[n]").arg(field->name) : field->name;
+        QString wire = QString("%1 + %2*n").arg(offset).arg(field->numBytes);
+        QString loop;
+        QString indent = "    ";
+        if (field->numElements > 1) {
+            loop = QString("    for (quint32 n = 0; n < %1; ++n)\n").arg(field->numElements);
+            indent = "        ";
+        } else {
+            wire = QString::number(offset);
+        }
+
+        if (field->numBytes == 1) {
+            packFields.append( QString("    memcpy(&dataOut[%1], &data.%2, %3);\n")
+                               .arg(offset).arg(field->name).arg(field->numElements) );
+            unpackFields.append( QString("    memcpy(&data.%1, &dataIn[%2], %3);\n")
+                                 .arg(field->name).arg(offset).arg(field->numElements) );
+        } else if (field->type == FIELDTYPE_FLOAT32) {
+            packFields.append( loop + QString("    {\n"
+                                              "        quint32 value;\n"
+                                              "        memcpy(&value, &data.%1, 4);\n"
+                                              "        qToLittleEndian<quint32>(value, &dataOut[%2]);\n"
+                                              "    }\n")
+                               .arg(element).arg(wire) );
+            unpackFields.append( loop + QString("    {\n"
+                                                "        quint32 value = qFromLittleEndian<quint32>(&dataIn[%2]);\n"
+                                                "        memcpy(&data.%1, &value, 4);\n"
+                                                "    }\n")
+                                 .arg(element).arg(wire) );
+        } else {
+            type = fieldTypeStrCPP[field->type];
+            packFields.append( loop + indent + QString("qToLittleEndian<%1>(data.%2, &dataOut[%3]);\n")
+                               .arg(type).arg(element).arg(wire) );
+            unpackFields.append( loop + indent + QString("data.%2 = qFromLittleEndian<%1>(&dataIn[%3]);\n")
+                                 .arg(type).arg(element).arg(wire) );
+        }
+        offset += field->numBytes * field->numElements;
+    }
+    outCode.replace(QString("$(PACKFIELDS)"), packFields);
+    outCode.replace(QString("$(UNPACKFIELDS)"), unpackFields);
+
     // Replace the $(FIELDSINIT) tag
     QString finit;
     for (int n = 0; n < info->fields.length(); ++n)
@@ -73,6 +73,9 @@ void replaceCommonTags(QString& out, ObjectInfo* info)
     // Replace $(ISSETTINGS) tag
     out.replace(QString("$(ISSETTINGS)"), boolTo01String( info->isSettings ));
     out.replace(QString("$(ISSETTINGSTF)"), boolToTRUEFALSEString( info->isSettings ));    
+    // Replace $(ISDELTAENCODED) tag
+    out.replace(QString("$(ISDELTAENCODED)"), boolTo01String( info->isDeltaEncoded ));
+    out.replace(QString("$(ISDELTAENCODEDTF)"), boolToTRUEFALSEString( info->isDeltaEncoded ));
     // Replace $(NUMBYTES) tag
     out.replace(QString("$(NUMBYTES)"), QString().setNum(info->numBytes));
     // Replace $(GCSACCESS) tag
@@ -823,6 +823,15 @@ QString UAVObjectParser::processObjectAttributes(QDomNode& node, ObjectInfo* inf
     if ( info->isSettings && !info->isSingleInst )
         return QString("Object: Settings objects can not have multiple instances");
 
+    // Get deltaencoded attribute if present
+    attr = attributes.namedItem("deltaencoded");
+    if ( attr.isNull() || attr.nodeValue().compare(QString("false")) == 0 )
+        info->isDeltaEncoded = false;
+    else if ( attr.nodeValue().compare(QString("true")) == 0 )
+        info->isDeltaEncoded = true;
+    else
+        return QString("Object:deltaencoded attribute value is invalid");
+
     // Done
     return QString();
 }
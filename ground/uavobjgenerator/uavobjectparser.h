@@ -98,6 +98,7 @@ struct ObjectInfo_s {
     quint32 id;
     bool isSingleInst;
     bool isSettings;
+    bool isDeltaEncoded; /** Updates can be sent as a delta against the previous one, does not change the object ID */
     AccessMode gcsAccess;
     AccessMode flightAccess;
     bool flightTelemetryAcked;
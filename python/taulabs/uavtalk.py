@@ -20,6 +20,13 @@ __all__ = [ "send_object", "process_stream" ]
 (TYPE_MASK, TYPE_VER) = (0x78, 0x20)
 (TIMESTAMPED) = (0x80)
 (TYPE_OBJ, TYPE_OBJ_REQ, TYPE_OBJ_ACK, TYPE_ACK, TYPE_NACK, TYPE_OBJ_TS, TYPE_OBJ_ACK_TS) = (0x00, 0x01, 0x02, 0x03, 0x04, 0x80, 0x82)
+(TYPE_OBJ_DELTA, TYPE_OBJ_ACK_DELTA, TYPE_OBJ_DELTA_TS) = (0x06, 0x07, 0x86)
+
+# Deltas start with the CRC of the update they apply to and the CRC of the
+# result, followed by runs of unchanged bytes and of changed bytes XORed with
+# the previous update
+(DELTA_HEADER_LENGTH, DELTA_RUN_UNCHANGED) = (2, 0x80)
+DELTA_TYPES = (TYPE_OBJ_DELTA, TYPE_OBJ_ACK_DELTA, TYPE_OBJ_DELTA_TS)
 
 # Serialization of header elements
 
@@ -62,6 +69,9 @@ def process_stream(uavo_defs, use_walltime=False, gcs_timestamps=False):
 
     received = 0
 
+    # Last update of every object instance, deltas are applied to it
+    last_data = {}
+
     buf = ''
     buf_offset = 0
 
@@ -152,8 +162,14 @@ def process_stream(uavo_defs, use_walltime=False, gcs_timestamps=False):
             obj = None
         else:
             if obj is not None:
-                timestamp_len = timestamp_fmt.size if pack_type == TYPE_OBJ_TS or pack_type == TYPE_OBJ_ACK_TS else 0
-                obj_len = obj.get_size_of_data()
+                timestamp_len = timestamp_fmt.size if pack_type in (TYPE_OBJ_TS, TYPE_OBJ_ACK_TS, TYPE_OBJ_DELTA_TS) else 0
+                if pack_type in DELTA_TYPES:
+                    # deltas only fill the rest of the packet
+                    obj_len = pack_len - header_fmt.size - timestamp_len
+                    if not obj._single:
+                        obj_len -= instance_fmt.size
+                else:
+                    obj_len = obj.get_size_of_data()
             else:
                 # we don't know anything, so fudge to keep sync.
                 timestamp_len = 0
@@ -238,7 +254,18 @@ def process_stream(uavo_defs, use_walltime=False, gcs_timestamps=False):
 
         if obj is not None:
             offset = header_fmt.size + instance_len + timestamp_len + buf_offset
-            objInstance = obj.from_bytes(buf, timestamp, instance_id, offset=offset)
+            data = buf[offset:offset + obj_len]
+            if pack_type in DELTA_TYPES:
+                data = apply_delta(last_data.get((objId, instance_id)), data, obj.get_size_of_data())
+                if data is None:
+                    # the log starts in the middle or lost the previous update,
+                    # wait for the next full one
+                    print "delta without its reference id=%s"%(uavo_key)
+                    obj = None
+
+        if obj is not None:
+            last_data[(objId, instance_id)] = data
+            objInstance = obj.from_bytes(data, timestamp, instance_id)
             received += 1
             if not (received % 20000):
                 print "received %d objs"%(received)
@@ -274,6 +301,41 @@ def request_object(obj):
 
     return packet
 
+def apply_delta(ref, delta, length):
+    """
+    Apply a delta to the previous update of an object instance.  Returns the
+    new data, or None if the delta isn't based on that update.
+    """
+
+    if ref is None or len(delta) < DELTA_HEADER_LENGTH or calcCRC(ref) != delta[0]:
+        return None
+
+    data = bytearray(ref)
+    pos = 0
+    i = DELTA_HEADER_LENGTH
+
+    while i < len(delta):
+        control = ord(delta[i])
+        i += 1
+        run = (control & ~DELTA_RUN_UNCHANGED) + 1
+        if pos + run > length:
+            return None
+
+        if not control & DELTA_RUN_UNCHANGED:
+            if i + run > len(delta):
+                return None
+            for j in xrange(run):
+                data[pos + j] ^= ord(delta[i + j])
+            i += run
+
+        pos += run
+
+    data = str(data)
+    if calcCRC(data) != delta[1]:
+        return None
+
+    return data
+
 def calcCRC(str):
     """
     Calculate a CRC consistently with how they are computed on the firmware side